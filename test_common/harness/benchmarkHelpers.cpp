@@ -0,0 +1,262 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "benchmarkHelpers.h"
+#include "errorHelpers.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <tuple>
+
+std::string gBenchmarkJSONPath;
+std::string gBenchmarkBaselinePath;
+double gBenchmarkTolerance = 10.0;
+unsigned gBenchmarkWarmup = 1;
+unsigned gBenchmarkRepetitions = 0;
+
+namespace {
+
+struct BenchmarkRecord
+{
+    BenchmarkKey key;
+    size_t elements;
+    BenchmarkStats stats;
+};
+
+std::mutex gBenchmarkMutex;
+std::vector<BenchmarkRecord> gBenchmarkRecords;
+
+typedef std::tuple<std::string, int, std::string> KeyTuple;
+
+KeyTuple key_tuple(const BenchmarkKey &key)
+{
+    return KeyTuple(key.kernel, key.vector_size, key.rounding_mode);
+}
+
+std::string key_name(const BenchmarkKey &key)
+{
+    std::ostringstream name;
+    name << key.kernel << " (vector size " << key.vector_size;
+    if (!key.rounding_mode.empty()) name << ", " << key.rounding_mode;
+    name << ")";
+    return name.str();
+}
+
+// Nearest-rank percentile of sorted samples
+double percentile(const std::vector<double> &sorted, double p)
+{
+    size_t rank = (size_t)(p / 100.0 * sorted.size() + 0.5);
+    rank = std::min(std::max(rank, (size_t)1), sorted.size());
+    return sorted[rank - 1];
+}
+
+std::string json_escape(const std::string &value)
+{
+    std::string result;
+    for (char c : value)
+    {
+        if (c == '"' || c == '\\') result += '\\';
+        result += c;
+    }
+    return result;
+}
+
+// Reads the string or number following "name": on a line of a report
+bool json_field(const std::string &line, const char *name, std::string &value)
+{
+    std::string pattern = std::string("\"") + name + "\":";
+    size_t pos = line.find(pattern);
+    if (pos == std::string::npos) return false;
+    pos += pattern.size();
+    while (pos < line.size() && line[pos] == ' ') pos++;
+    if (pos < line.size() && line[pos] == '"')
+    {
+        value.clear();
+        for (pos++; pos < line.size() && line[pos] != '"'; pos++)
+        {
+            if (line[pos] == '\\' && pos + 1 < line.size()) pos++;
+            value += line[pos];
+        }
+        return pos < line.size();
+    }
+    size_t end = line.find_first_of(",}", pos);
+    if (end == std::string::npos) return false;
+    value = line.substr(pos, end - pos);
+    return !value.empty();
+}
+
+int write_report(const std::string &path)
+{
+    std::ofstream out(path.c_str());
+    if (!out)
+    {
+        log_error("ERROR: Unable to open benchmark report %s\n", path.c_str());
+        return -1;
+    }
+    // One result per line, which is what read_baseline() expects
+    out << "[\n";
+    for (size_t i = 0; i < gBenchmarkRecords.size(); i++)
+    {
+        const BenchmarkRecord &r = gBenchmarkRecords[i];
+        out << "  { \"kernel\": \"" << json_escape(r.key.kernel)
+            << "\", \"vector_size\": " << r.key.vector_size
+            << ", \"rounding_mode\": \"" << json_escape(r.key.rounding_mode)
+            << "\", \"elements\": " << r.elements
+            << ", \"samples\": " << r.stats.samples
+            << ", \"min_us_per_elem\": " << r.stats.min
+            << ", \"mean_us_per_elem\": " << r.stats.mean
+            << ", \"median_us_per_elem\": " << r.stats.median
+            << ", \"p90_us_per_elem\": " << r.stats.p90
+            << ", \"p99_us_per_elem\": " << r.stats.p99
+            << ", \"max_us_per_elem\": " << r.stats.max << " }"
+            << (i + 1 < gBenchmarkRecords.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+    if (!out)
+    {
+        log_error("ERROR: Unable to write benchmark report %s\n",
+                  path.c_str());
+        return -1;
+    }
+    log_info("Benchmark results written to %s\n", path.c_str());
+    return 0;
+}
+
+int read_baseline(const std::string &path, std::map<KeyTuple, double> &medians)
+{
+    std::ifstream in(path.c_str());
+    if (!in)
+    {
+        log_error("ERROR: Unable to open benchmark baseline %s\n",
+                  path.c_str());
+        return -1;
+    }
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::string kernel, vectorSize, roundingMode, median;
+        if (!json_field(line, "kernel", kernel)) continue;
+        if (!json_field(line, "vector_size", vectorSize)
+            || !json_field(line, "rounding_mode", roundingMode)
+            || !json_field(line, "median_us_per_elem", median))
+        {
+            log_error("ERROR: Malformed benchmark baseline entry: %s\n",
+                      line.c_str());
+            return -1;
+        }
+        medians[KeyTuple(kernel, atoi(vectorSize.c_str()), roundingMode)] =
+            atof(median.c_str());
+    }
+    return 0;
+}
+
+// Compares medians, which are less sensitive to scheduling noise than means
+int compare_to_baseline(const std::string &path)
+{
+    std::map<KeyTuple, double> baseline;
+    if (read_baseline(path, baseline)) return -1;
+
+    int regressions = 0;
+    for (const BenchmarkRecord &r : gBenchmarkRecords)
+    {
+        auto it = baseline.find(key_tuple(r.key));
+        if (it == baseline.end())
+        {
+            log_info("%s: no baseline\n", key_name(r.key).c_str());
+            continue;
+        }
+        double change =
+            it->second > 0 ? (r.stats.median / it->second - 1.0) * 100.0 : 0.0;
+        if (change > gBenchmarkTolerance)
+        {
+            log_error("REGRESSION: %s: median %g us/elem, baseline %g us/elem "
+                      "(%+.1f%%, tolerance %.1f%%)\n",
+                      key_name(r.key).c_str(), r.stats.median, it->second,
+                      change, gBenchmarkTolerance);
+            regressions++;
+        }
+        else
+        {
+            log_info("%s: median %g us/elem, baseline %g us/elem (%+.1f%%)\n",
+                     key_name(r.key).c_str(), r.stats.median, it->second,
+                     change);
+        }
+    }
+    log_info("%d benchmark regression(s) against %s\n", regressions,
+             path.c_str());
+    return regressions;
+}
+
+} // namespace
+
+BenchmarkStats compute_benchmark_stats(std::vector<double> samples,
+                                       size_t elements)
+{
+    BenchmarkStats stats = {};
+    stats.samples = samples.size();
+    if (samples.empty()) return stats;
+
+    double scale = 1e6 / (double)std::max(elements, (size_t)1);
+    for (double &sample : samples) sample *= scale;
+    std::sort(samples.begin(), samples.end());
+
+    stats.min = samples.front();
+    stats.max = samples.back();
+    stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0)
+        / (double)samples.size();
+    stats.median = percentile(samples, 50);
+    stats.p90 = percentile(samples, 90);
+    stats.p99 = percentile(samples, 99);
+    return stats;
+}
+
+BenchmarkStats record_benchmark(const BenchmarkKey &key, size_t elements,
+                                const std::vector<double> &samples)
+{
+    BenchmarkRecord record = { key, elements,
+                               compute_benchmark_stats(samples, elements) };
+    std::lock_guard<std::mutex> lock(gBenchmarkMutex);
+    // A rerun of the same configuration replaces the earlier result
+    for (BenchmarkRecord &r : gBenchmarkRecords)
+    {
+        if (key_tuple(r.key) == key_tuple(key))
+        {
+            r = record;
+            return record.stats;
+        }
+    }
+    gBenchmarkRecords.push_back(record);
+    return record.stats;
+}
+
+int finish_benchmarks()
+{
+    std::lock_guard<std::mutex> lock(gBenchmarkMutex);
+    if (gBenchmarkRecords.empty()) return 0;
+
+    int result = 0;
+    if (!gBenchmarkJSONPath.empty() && write_report(gBenchmarkJSONPath))
+        result = -1;
+    if (!gBenchmarkBaselinePath.empty())
+    {
+        int regressions = compare_to_baseline(gBenchmarkBaselinePath);
+        if (regressions != 0) result = regressions;
+    }
+    return result;
+}
@@ -0,0 +1,120 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef _benchmarkHelpers_h
+#define _benchmarkHelpers_h
+
+#include "compat.h"
+
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/opencl.h>
+#endif
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Benchmark options, set from the common command line options by
+// parseCustomParam():
+//   --benchmark-json <file>        write all results to <file>
+//   --benchmark-baseline <file>    compare results against a previous run
+//   --benchmark-tolerance <pct>    allowed slowdown against the baseline
+//   --benchmark-warmup <n>         untimed iterations before measuring
+//   --benchmark-repeat <n>         timed iterations, overrides test defaults
+extern std::string gBenchmarkJSONPath;
+extern std::string gBenchmarkBaselinePath;
+extern double gBenchmarkTolerance;
+extern unsigned gBenchmarkWarmup;
+extern unsigned gBenchmarkRepetitions;
+
+// Results are identified by the kernel, its vector size and rounding mode.
+// Tests without vector sizes or rounding modes leave them at 1 and "".
+struct BenchmarkKey
+{
+    std::string kernel;
+    int vector_size;
+    std::string rounding_mode;
+};
+
+struct BenchmarkStats
+{
+    size_t samples;
+    double min; // all in microseconds per element
+    double mean;
+    double median;
+    double p90;
+    double p99;
+    double max;
+};
+
+// Computes statistics of per-iteration times in seconds, normalized to
+// elements processed per iteration
+BenchmarkStats compute_benchmark_stats(std::vector<double> samples,
+                                       size_t elements);
+
+// Records the samples of one benchmark, to be written and compared by
+// finish_benchmarks(). Thread safe.
+BenchmarkStats record_benchmark(const BenchmarkKey &key, size_t elements,
+                                const std::vector<double> &samples);
+
+// Times iteration() after gBenchmarkWarmup untimed calls. The number of timed
+// calls is gBenchmarkRepetitions if set, or defaultRepetitions otherwise.
+// Stops at the first call that does not return CL_SUCCESS and returns its
+// result, otherwise records the samples and returns CL_SUCCESS.
+template <typename Fn>
+cl_int run_benchmark(const BenchmarkKey &key, size_t elements,
+                     unsigned defaultRepetitions, Fn iteration,
+                     BenchmarkStats *stats = nullptr)
+{
+    for (unsigned i = 0; i < gBenchmarkWarmup; i++)
+    {
+        cl_int error = iteration();
+        if (error != CL_SUCCESS) return error;
+    }
+
+    unsigned repetitions =
+        gBenchmarkRepetitions ? gBenchmarkRepetitions : defaultRepetitions;
+    std::vector<double> samples;
+    samples.reserve(repetitions);
+    for (unsigned i = 0; i < repetitions; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        cl_int error = iteration();
+        if (error != CL_SUCCESS) return error;
+        samples.push_back(std::chrono::duration<double>(
+                              std::chrono::steady_clock::now() - start)
+                              .count());
+    }
+
+    BenchmarkStats result = record_benchmark(key, elements, samples);
+    if (stats) *stats = result;
+    return CL_SUCCESS;
+}
+
+// True if results are written or compared, so tests should time their kernels
+// even without their own timing option
+inline bool benchmarks_requested()
+{
+    return !gBenchmarkJSONPath.empty() || !gBenchmarkBaselinePath.empty();
+}
+
+// Writes the JSON report and compares against the baseline, as requested on
+// the command line. Returns the number of regressions found, or -1 if the
+// report could not be written or the baseline could not be read.
+int finish_benchmarks();
+
+#endif // _benchmarkHelpers_h
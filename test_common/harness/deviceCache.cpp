@@ -0,0 +1,163 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "deviceCache.h"
+
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct DeviceEntry
+{
+    bool is_root;
+    DeviceCapabilities capabilities;
+};
+
+typedef std::pair<cl_mem_flags, cl_mem_object_type> FormatTableKey;
+
+struct ContextEntry
+{
+    // False if the context cannot be cached
+    bool evictable = false;
+    std::map<FormatTableKey, std::shared_ptr<const ImageFormatSet>> formats;
+};
+
+std::unordered_map<cl_device_id, DeviceEntry> device_entries;
+std::unordered_map<cl_context, ContextEntry> context_entries;
+
+void CL_CALLBACK evict_context(cl_context context, void *)
+{
+    std::lock_guard<std::mutex> lock(device_cache_mutex());
+    context_entries.erase(context);
+}
+
+// clSetContextDestructorCallback is an OpenCL 3.0 entry point, older ICDs
+// may not provide it at all.
+bool supports_destructor_callback(cl_context context)
+{
+    size_t size = 0;
+    cl_int error =
+        clGetContextInfo(context, CL_CONTEXT_DEVICES, 0, NULL, &size);
+    if (error != CL_SUCCESS || size < sizeof(cl_device_id)) return false;
+
+    std::vector<cl_device_id> devices(size / sizeof(cl_device_id));
+    error = clGetContextInfo(context, CL_CONTEXT_DEVICES, size, devices.data(),
+                             NULL);
+    if (error != CL_SUCCESS) return false;
+    return get_device_cl_version(devices[0]) >= Version(3, 0);
+}
+
+// Registers the eviction of context on first use. Returns false if the
+// context cannot be cached. Called without the cache mutex held, the version
+// query uses the cache itself.
+bool register_context(cl_context context)
+{
+    if (!supports_destructor_callback(context)) return false;
+
+    std::lock_guard<std::mutex> lock(device_cache_mutex());
+    auto it = context_entries.find(context);
+    if (it != context_entries.end()) return it->second.evictable;
+
+    ContextEntry &entry = context_entries[context];
+    entry.evictable = clSetContextDestructorCallback(context, evict_context,
+                                                     nullptr)
+        == CL_SUCCESS;
+    return entry.evictable;
+}
+
+cl_int query_image_formats(cl_context context, cl_mem_flags flags,
+                           cl_mem_object_type image_type, ImageFormatSet &set)
+{
+    cl_uint count = 0;
+    cl_int error =
+        clGetSupportedImageFormats(context, flags, image_type, 0, NULL, &count);
+    if (error != CL_SUCCESS || count == 0) return error;
+
+    std::vector<cl_image_format> list(count);
+    error = clGetSupportedImageFormats(context, flags, image_type, count,
+                                       list.data(), NULL);
+    if (error != CL_SUCCESS) return error;
+
+    for (const cl_image_format &format : list)
+        set.insert(image_format_key(&format));
+    return CL_SUCCESS;
+}
+
+} // namespace
+
+std::mutex &device_cache_mutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+DeviceCapabilities *get_device_capabilities(cl_device_id device)
+{
+    std::lock_guard<std::mutex> lock(device_cache_mutex());
+    auto it = device_entries.find(device);
+    if (it == device_entries.end())
+    {
+        cl_device_id parent = NULL;
+        cl_int error = clGetDeviceInfo(device, CL_DEVICE_PARENT_DEVICE,
+                                       sizeof(parent), &parent, NULL);
+        // A failed query is not cached, the handle may be invalid
+        if (error != CL_SUCCESS) return NULL;
+        it = device_entries.emplace(device, DeviceEntry{ parent == NULL, {} })
+                 .first;
+    }
+    return it->second.is_root ? &it->second.capabilities : NULL;
+}
+
+cl_int get_supported_image_format_set(
+    cl_context context, cl_mem_flags flags, cl_mem_object_type image_type,
+    std::shared_ptr<const ImageFormatSet> &formats)
+{
+    const FormatTableKey key(flags, image_type);
+    bool evictable = false;
+    bool registered = false;
+    {
+        std::lock_guard<std::mutex> lock(device_cache_mutex());
+        auto entry = context_entries.find(context);
+        if (entry != context_entries.end())
+        {
+            registered = true;
+            evictable = entry->second.evictable;
+            auto it = entry->second.formats.find(key);
+            if (evictable && it != entry->second.formats.end())
+            {
+                formats = it->second;
+                return CL_SUCCESS;
+            }
+        }
+    }
+    if (!registered) evictable = register_context(context);
+
+    std::shared_ptr<ImageFormatSet> set = std::make_shared<ImageFormatSet>();
+    cl_int error = query_image_formats(context, flags, image_type, *set);
+    if (error != CL_SUCCESS) return error;
+    formats = set;
+
+    if (evictable)
+    {
+        std::lock_guard<std::mutex> lock(device_cache_mutex());
+        auto it = context_entries.find(context);
+        if (it != context_entries.end() && it->second.evictable)
+            it->second.formats[key] = set;
+    }
+    return CL_SUCCESS;
+}
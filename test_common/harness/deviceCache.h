@@ -0,0 +1,104 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HARNESS_DEVICE_CACHE_H_
+#define HARNESS_DEVICE_CACHE_H_
+
+#include "featureHelpers.h"
+#include "testHarness.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+// Device and context capabilities that cannot change during a run, kept
+// after the first query so that tests checking them in loops stop going to
+// the driver. Only root devices are cached: a sub-device handle may be
+// released and reused for another partition. A context is cached until its
+// destructor callback runs, or not at all if the callback cannot be set.
+
+template <typename T> struct CachedValue
+{
+    bool valid = false;
+    T value{};
+};
+
+typedef std::unordered_set<std::string> ExtensionSet;
+
+struct DeviceCapabilities
+{
+    CachedValue<std::shared_ptr<const ExtensionSet>> extensions;
+    CachedValue<Version> cl_version;
+    CachedValue<Version> cl_c_version;
+    CachedValue<Version> latest_cl_c_version;
+    CachedValue<OpenCLCFeatures> cl_c_features;
+};
+
+// The cached capabilities of device, or NULL if it is a sub-device
+DeviceCapabilities *get_device_capabilities(cl_device_id device);
+
+std::mutex &device_cache_mutex();
+
+// Sets value from the cache entry field of device. On a miss calls
+// query(value), which returns false on failure, and caches its result if it
+// succeeded. Returns false if the query failed.
+template <typename T, typename Query>
+bool cached_device_query(cl_device_id device,
+                         CachedValue<T> DeviceCapabilities::*field, T &value,
+                         Query query)
+{
+    DeviceCapabilities *capabilities = get_device_capabilities(device);
+    if (capabilities)
+    {
+        std::lock_guard<std::mutex> lock(device_cache_mutex());
+        const CachedValue<T> &cached = capabilities->*field;
+        if (cached.valid)
+        {
+            value = cached.value;
+            return true;
+        }
+    }
+
+    // Queried without the lock, the query may use the cache itself
+    if (!query(value)) return false;
+
+    if (capabilities)
+    {
+        std::lock_guard<std::mutex> lock(device_cache_mutex());
+        CachedValue<T> &cached = capabilities->*field;
+        cached.value = value;
+        cached.valid = true;
+    }
+    return true;
+}
+
+// Image formats packed by image_format_key()
+typedef std::unordered_set<cl_ulong> ImageFormatSet;
+
+inline cl_ulong image_format_key(const cl_image_format *format)
+{
+    return ((cl_ulong)format->image_channel_order << 32)
+        | (cl_ulong)format->image_channel_data_type;
+}
+
+// Sets formats to the image formats context supports for flags and
+// image_type. Returns the error of clGetSupportedImageFormats. The tables are
+// only cached for contexts of OpenCL 3.0 devices, which evict them on release.
+cl_int get_supported_image_format_set(
+    cl_context context, cl_mem_flags flags, cl_mem_object_type image_type,
+    std::shared_ptr<const ImageFormatSet> &formats);
+
+#endif // HARNESS_DEVICE_CACHE_H_
@@ -19,6 +19,7 @@
 #include <vector>
 
 #include "deviceInfo.h"
+#include "deviceCache.h"
 #include "errorHelpers.h"
 #include "typeWrappers.h"
 
@@ -52,15 +53,18 @@ std::string get_device_info_string(cl_device_id device,
 /* Determines if an extension is supported by a device. */
 int is_extension_available(cl_device_id device, const char *extensionName)
 {
-    std::string extString = get_device_extensions_string(device);
-    std::istringstream ss(extString);
-    while (ss)
-    {
-        std::string found;
-        ss >> found;
-        if (found == extensionName) return true;
-    }
-    return false;
+    std::shared_ptr<const ExtensionSet> extensions;
+    cached_device_query(device, &DeviceCapabilities::extensions, extensions,
+                        [device](std::shared_ptr<const ExtensionSet> &value) {
+                            auto set = std::make_shared<ExtensionSet>();
+                            std::istringstream ss(
+                                get_device_extensions_string(device));
+                            std::string found;
+                            while (ss >> found) set->insert(found);
+                            value = set;
+                            return true;
+                        });
+    return extensions->count(extensionName) != 0;
 }
 
 cl_version get_extension_version(cl_device_id device, const char *extensionName)
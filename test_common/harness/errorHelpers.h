@@ -28,32 +28,23 @@
 #define HIGHER_IS_BETTER 1
 
 #include <stdio.h>
+#include "logBackend.h"
 #define test_start()
-#define log_info printf
-#define log_error printf
-#define log_missing_feature printf
+#define log_info(...) log_printf(LOG_LEVEL_INFO, __VA_ARGS__)
+#define log_error(...) log_printf(LOG_LEVEL_ERROR, __VA_ARGS__)
+#define log_missing_feature(...) log_printf(LOG_LEVEL_ERROR, __VA_ARGS__)
 #define log_perf(_number, _higherBetter, _numType, _format, ...)               \
-    printf("Performance Number " _format " (in %s, %s): %g\n", ##__VA_ARGS__,  \
-           _numType, _higherBetter ? "higher is better" : "lower is better",   \
-           _number)
+    log_perf_number(_number, _higherBetter, _numType, _format, ##__VA_ARGS__)
 #define vlog_perf(_number, _higherBetter, _numType, _format, ...)              \
-    printf("Performance Number " _format " (in %s, %s): %g\n", ##__VA_ARGS__,  \
-           _numType, _higherBetter ? "higher is better" : "lower is better",   \
-           _number)
-#ifdef _WIN32
-#ifdef __MINGW32__
-// Use __mingw_printf since it supports "%a" format specifier
-#define vlog __mingw_printf
-#define vlog_error __mingw_printf
-#else
+    log_perf_number(_number, _higherBetter, _numType, _format, ##__VA_ARGS__)
+#if defined(_WIN32) && !defined(__MINGW32__)
 // Use home-baked function that treats "%a" as "%f"
-static int vlog_win32(const char *format, ...);
-#define vlog vlog_win32
-#define vlog_error vlog_win32
-#endif
+static int vlog_win32(LogLevel level, const char *format, ...);
+#define vlog(...) vlog_win32(LOG_LEVEL_INFO, __VA_ARGS__)
+#define vlog_error(...) vlog_win32(LOG_LEVEL_ERROR, __VA_ARGS__)
 #else
-#define vlog_error printf
-#define vlog printf
+#define vlog_error(...) log_printf(LOG_LEVEL_ERROR, __VA_ARGS__)
+#define vlog(...) log_printf(LOG_LEVEL_INFO, __VA_ARGS__)
 #endif
 
 #define test_fail(msg, ...)                                                    \
@@ -210,7 +201,7 @@ extern const char *GetDataVectorString(void *dataBuffer, size_t typeSize,
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
-static int vlog_win32(const char *format, ...)
+static int vlog_win32(LogLevel level, const char *format, ...)
 {
     const char *new_format = format;
 
@@ -236,7 +227,7 @@ static int vlog_win32(const char *format, ...)
 
     va_list args;
     va_start(args, format);
-    vprintf(new_format, args);
+    log_vprintf(level, new_format, args);
     va_end(args);
 
     if (new_format != format)
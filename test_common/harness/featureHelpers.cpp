@@ -14,6 +14,7 @@
 // limitations under the License.
 //
 #include "featureHelpers.h"
+#include "deviceCache.h"
 #include "errorHelpers.h"
 
 #include <assert.h>
@@ -21,7 +22,8 @@
 
 #include <vector>
 
-int get_device_cl_c_features(cl_device_id device, OpenCLCFeatures& features)
+static int query_device_cl_c_features(cl_device_id device,
+                                      OpenCLCFeatures& features)
 {
     // Initially, all features are unsupported.
     features = { 0 };
@@ -73,3 +75,14 @@ int get_device_cl_c_features(cl_device_id device, OpenCLCFeatures& features)
 
     return TEST_PASS;
 }
+
+int get_device_cl_c_features(cl_device_id device, OpenCLCFeatures& features)
+{
+    int result = TEST_PASS;
+    cached_device_query(device, &DeviceCapabilities::cl_c_features, features,
+                        [device, &result](OpenCLCFeatures& value) {
+                            result = query_device_cl_c_features(device, value);
+                            return result == TEST_PASS;
+                        });
+    return result;
+}
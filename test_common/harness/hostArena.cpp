@@ -0,0 +1,261 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "hostArena.h"
+#include "alloc.h"
+#include "errorHelpers.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const size_t kMinArenaSize = 64 * 1024;
+const size_t kHugePageSize = 2 * 1024 * 1024;
+// Size classes per power of two, bounding the waste to a quarter
+const unsigned kSubClassBits = 2;
+
+struct Block
+{
+    void *base; // start of the mapping, including any guard page
+    size_t mapped;
+    size_t size_class;
+};
+
+size_t page_size()
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    return (size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+bool env_set(const char *name) { return getenv(name) != NULL; }
+
+class HostArena {
+public:
+    HostArena()
+        : page(page_size()), enabled(!env_set("CL_HOST_ARENA_DISABLE")),
+          guard_pages(env_set("CL_HOST_ARENA_GUARD_PAGES")),
+          huge_pages(env_set("CL_HOST_ARENA_HUGE_PAGES")),
+          cache_limit((size_t)1024 * 1024 * 1024)
+    {
+        const char *cache_mb = getenv("CL_HOST_ARENA_CACHE_MB");
+        if (cache_mb) cache_limit = (size_t)atol(cache_mb) * 1024 * 1024;
+    }
+
+    void *alloc(size_t size, size_t alignment)
+    {
+        if (!enabled || size < kMinArenaSize)
+            return align_malloc(size, alignment);
+
+        size_t size_class = class_of(size);
+        Block block;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.allocations++;
+            std::vector<Block> &free_list = free_blocks[size_class];
+            if (!free_list.empty())
+            {
+                block = free_list.back();
+                free_list.pop_back();
+                cached -= size_class;
+                stats.reused++;
+            }
+            else
+            {
+                block.base = nullptr;
+            }
+            in_use += size_class;
+            update_peaks();
+        }
+
+        if (block.base == nullptr && !map_block(size_class, block))
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            in_use -= size_class;
+            return nullptr;
+        }
+
+        char *data = (char *)block.base;
+        if (guard_pages)
+        {
+            // Against the trailing guard page, as far as alignment allows
+            uintptr_t end = (uintptr_t)block.base + page + size_class;
+            data = (char *)((end - size) & ~(uintptr_t)(alignment - 1));
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        blocks[data] = block;
+        return data;
+    }
+
+    void free(void *ptr)
+    {
+        if (ptr == nullptr) return;
+
+        Block block;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = blocks.find(ptr);
+            if (it == blocks.end())
+            {
+                align_free(ptr);
+                return;
+            }
+            block = it->second;
+            blocks.erase(it);
+            in_use -= block.size_class;
+            if (cached + block.size_class <= cache_limit)
+            {
+                free_blocks[block.size_class].push_back(block);
+                cached += block.size_class;
+                return;
+            }
+        }
+        unmap_block(block);
+    }
+
+    ArenaStats get_stats()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+private:
+    // Rounds up to kSubClassBits steps per power of two, and to whole pages
+    size_t class_of(size_t size) const
+    {
+        unsigned bits = 0;
+        while ((size >> bits) > 1) bits++;
+        size_t step = bits > kSubClassBits ? (size_t)1 << (bits - kSubClassBits)
+                                           : 1;
+        if (step < page) step = page;
+        if (huge_pages && size >= kHugePageSize) step = std::max(step, kHugePageSize);
+        return (size + step - 1) & ~(step - 1);
+    }
+
+    bool map_block(size_t size_class, Block &block)
+    {
+        size_t guard = guard_pages ? page : 0;
+        block.size_class = size_class;
+        block.mapped = size_class + 2 * guard;
+#if defined(_WIN32)
+        block.base = VirtualAlloc(NULL, block.mapped, MEM_RESERVE | MEM_COMMIT,
+                                  PAGE_READWRITE);
+        if (block.base == NULL) return false;
+        if (guard)
+        {
+            DWORD old;
+            VirtualProtect(block.base, guard, PAGE_NOACCESS, &old);
+            VirtualProtect((char *)block.base + guard + size_class, guard,
+                           PAGE_NOACCESS, &old);
+        }
+#else
+        block.base = mmap(NULL, block.mapped, PROT_READ | PROT_WRITE,
+                          MAP_ANON | MAP_PRIVATE, -1, 0);
+        if (block.base == MAP_FAILED)
+        {
+            block.base = nullptr;
+            return false;
+        }
+        if (guard)
+        {
+            mprotect(block.base, guard, PROT_NONE);
+            mprotect((char *)block.base + guard + size_class, guard,
+                     PROT_NONE);
+        }
+#if defined(MADV_HUGEPAGE)
+        if (huge_pages && size_class >= kHugePageSize)
+            madvise(block.base, block.mapped, MADV_HUGEPAGE);
+#endif
+#endif
+        return true;
+    }
+
+    void unmap_block(const Block &block)
+    {
+#if defined(_WIN32)
+        VirtualFree(block.base, 0, MEM_RELEASE);
+#else
+        munmap(block.base, block.mapped);
+#endif
+    }
+
+    void update_peaks()
+    {
+        stats.peak_in_use = std::max(stats.peak_in_use, in_use);
+        stats.peak_reserved = std::max(stats.peak_reserved, in_use + cached);
+    }
+
+    const size_t page;
+    const bool enabled;
+    const bool guard_pages;
+    const bool huge_pages;
+    size_t cache_limit;
+
+    std::mutex mutex;
+    std::map<size_t, std::vector<Block>> free_blocks;
+    std::unordered_map<void *, Block> blocks; // by data pointer
+    size_t in_use = 0;
+    size_t cached = 0;
+    ArenaStats stats = {};
+};
+
+// Never destroyed, blocks may be released by static destructors
+HostArena &arena()
+{
+    static HostArena *instance = new HostArena;
+    return *instance;
+}
+
+} // namespace
+
+void *arena_alloc(size_t size, size_t alignment)
+{
+    return arena().alloc(size, alignment);
+}
+
+void arena_free(void *ptr) { arena().free(ptr); }
+
+ArenaStats arena_stats() { return arena().get_stats(); }
+
+void arena_report()
+{
+    ArenaStats stats = arena_stats();
+    if (stats.allocations == 0) return;
+
+    const double mb = 1024.0 * 1024.0;
+    log_info("Host staging arena: %zu allocations, %.1f%% reused, peak "
+             "%.1fMB in use, %.1fMB reserved\n",
+             stats.allocations, 100.0 * stats.reused / stats.allocations,
+             stats.peak_in_use / mb, stats.peak_reserved / mb);
+}
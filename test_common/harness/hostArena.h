@@ -0,0 +1,56 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HARNESS_HOST_ARENA_H_
+#define HARNESS_HOST_ARENA_H_
+
+#include <stddef.h>
+
+// Host staging memory recycled across test iterations. Large blocks are
+// rounded up to a size class and kept on a free list of that class when
+// released, so tests allocating the same multi-megabyte buffers for every
+// image or format get back memory that is already mapped and faulted in.
+// Blocks smaller than 64KB are left to the system allocator.
+//
+// Configured from the environment when first used:
+//   CL_HOST_ARENA_DISABLE      use align_malloc() and align_free() only
+//   CL_HOST_ARENA_GUARD_PAGES  surround every block with inaccessible pages
+//                              and place its data against the trailing one,
+//                              so out of bounds accesses fault (debug mode)
+//   CL_HOST_ARENA_HUGE_PAGES   advise the system to back blocks of 2MB and
+//                              above with huge pages
+//   CL_HOST_ARENA_CACHE_MB     free memory kept for reuse, 1024 by default
+
+// Returns size bytes aligned to alignment, at most the page size, or NULL.
+// Large blocks are page aligned unless guard pages are enabled. Thread safe.
+void *arena_alloc(size_t size, size_t alignment);
+
+// Releases a block returned by arena_alloc(). NULL is ignored.
+void arena_free(void *ptr);
+
+struct ArenaStats
+{
+    size_t allocations; // served by the arena
+    size_t reused; // allocations served from a free list
+    size_t peak_in_use; // bytes, rounded up to size classes
+    size_t peak_reserved; // bytes in use or cached
+};
+
+ArenaStats arena_stats();
+
+// Logs the statistics of the run, if the arena served any allocation
+void arena_report();
+
+#endif // HARNESS_HOST_ARENA_H_
@@ -1185,8 +1185,8 @@ char *generate_random_image_data(image_descriptor *imageInfo,
     P.reset(NULL); // Free already allocated memory first, then try to allocate
                    // new block.
     char *data =
-        (char *)align_malloc(allocSize, get_pixel_alignment(imageInfo->format));
-    P.reset(data, NULL, 0, allocSize, true);
+        (char *)arena_alloc(allocSize, get_pixel_alignment(imageInfo->format));
+    P.reset(data, NULL, 0, allocSize, false, true);
 #endif
 
     if (data == NULL)
@@ -3242,9 +3242,11 @@ char *create_random_image_data(ExplicitType dataType,
         P.reset(data);
     }
 #else
+    // Freed first, so that the previous block of the same size is reused
+    P.reset(NULL);
     char *data =
-        (char *)align_malloc(allocSize, get_pixel_alignment(imageInfo->format));
-    P.reset(data, NULL, 0, allocSize, true);
+        (char *)arena_alloc(allocSize, get_pixel_alignment(imageInfo->format));
+    P.reset(data, NULL, 0, allocSize, false, true);
 #endif
 
     if (data == NULL)
@@ -15,6 +15,7 @@
 //
 #include "crc32.h"
 #include "kernelHelpers.h"
+#include "deviceCache.h"
 #include "deviceInfo.h"
 #include "errorHelpers.h"
 #include "imageHelpers.h"
@@ -1237,43 +1238,18 @@ int is_image_format_supported(cl_context context, cl_mem_flags flags,
                               cl_mem_object_type image_type,
                               const cl_image_format *fmt)
 {
-    cl_image_format *list;
-    cl_uint count = 0;
-    cl_int err = clGetSupportedImageFormats(context, flags, image_type, 128,
-                                            NULL, &count);
-    if (count == 0) return 0;
-
-    list = (cl_image_format *)malloc(count * sizeof(cl_image_format));
-    if (NULL == list)
-    {
-        log_error("Error: unable to allocate %zu byte buffer for image format "
-                  "list at %s:%d (err = %d)\n",
-                  count * sizeof(cl_image_format), __FILE__, __LINE__, err);
-        return 0;
-    }
-    BufferOwningPtr<cl_image_format> listBuf(list);
-
-
-    cl_int error = clGetSupportedImageFormats(context, flags, image_type, count,
-                                              list, NULL);
+    std::shared_ptr<const ImageFormatSet> formats;
+    cl_int error =
+        get_supported_image_format_set(context, flags, image_type, formats);
     if (error)
     {
         log_error("Error: failed to obtain supported image type list at %s:%d "
                   "(err = %d)\n",
-                  __FILE__, __LINE__, err);
+                  __FILE__, __LINE__, error);
         return 0;
     }
 
-    // iterate looking for a match.
-    cl_uint i;
-    for (i = 0; i < count; i++)
-    {
-        if (fmt->image_channel_data_type == list[i].image_channel_data_type
-            && fmt->image_channel_order == list[i].image_channel_order)
-            break;
-    }
-
-    return (i < count) ? 1 : 0;
+    return formats->count(image_format_key(fmt)) ? 1 : 0;
 }
 
 size_t get_pixel_bytes(const cl_image_format *fmt);
@@ -1605,7 +1581,7 @@ int printDeviceHeader(cl_device_id device)
     return CL_SUCCESS;
 }
 
-Version get_device_cl_c_version(cl_device_id device)
+static Version query_device_cl_c_version(cl_device_id device)
 {
     auto device_cl_version = get_device_cl_version(device);
 
@@ -1644,7 +1620,18 @@ Version get_device_cl_c_version(cl_device_id device)
     return Version{ major - '0', minor - '0' };
 }
 
-Version get_device_latest_cl_c_version(cl_device_id device)
+Version get_device_cl_c_version(cl_device_id device)
+{
+    Version version;
+    cached_device_query(device, &DeviceCapabilities::cl_c_version, version,
+                        [device](Version &value) {
+                            value = query_device_cl_c_version(device);
+                            return value >= Version(0, 0);
+                        });
+    return version;
+}
+
+static Version query_device_latest_cl_c_version(cl_device_id device)
 {
     auto device_cl_version = get_device_cl_version(device);
 
@@ -1687,6 +1674,17 @@ Version get_device_latest_cl_c_version(cl_device_id device)
     return get_device_cl_c_version(device);
 }
 
+Version get_device_latest_cl_c_version(cl_device_id device)
+{
+    Version version;
+    cached_device_query(device, &DeviceCapabilities::latest_cl_c_version,
+                        version, [device](Version &value) {
+                            value = query_device_latest_cl_c_version(device);
+                            return value >= Version(0, 0);
+                        });
+    return version;
+}
+
 Version get_max_OpenCL_C_for_context(cl_context context)
 {
     // Get all the devices in the context and find the maximum
@@ -0,0 +1,76 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "latencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const size_t kSubBuckets = (size_t)1 << LatencyHistogram::kSubBucketBits;
+
+unsigned highest_bit(cl_ulong value)
+{
+    unsigned bit = 0;
+    while (value >>= 1) bit++;
+    return bit;
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram()
+    : counts((64 - kSubBucketBits + 1) * kSubBuckets, 0)
+{}
+
+size_t LatencyHistogram::bucket_index(cl_ulong value)
+{
+    if (value < kSubBuckets) return (size_t)value;
+    unsigned shift = highest_bit(value) - kSubBucketBits;
+    return (shift + 1) * kSubBuckets + (size_t)(value >> shift) - kSubBuckets;
+}
+
+cl_ulong LatencyHistogram::bucket_highest(size_t index)
+{
+    if (index < kSubBuckets) return index;
+    unsigned shift = (unsigned)(index / kSubBuckets) - 1;
+    cl_ulong lowest = (cl_ulong)(index % kSubBuckets + kSubBuckets) << shift;
+    return lowest + (((cl_ulong)1 << shift) - 1);
+}
+
+void LatencyHistogram::record(cl_ulong value)
+{
+    counts[bucket_index(value)]++;
+    total++;
+    min_value = std::min(min_value, value);
+    max_value = std::max(max_value, value);
+    sum += (double)value;
+}
+
+cl_ulong LatencyHistogram::percentile(double p) const
+{
+    if (total == 0) return 0;
+    size_t target = (size_t)std::ceil(p / 100.0 * total);
+    target = std::min(std::max(target, (size_t)1), total);
+
+    size_t seen = 0;
+    for (size_t i = 0; i < counts.size(); i++)
+    {
+        seen += counts[i];
+        if (seen >= target)
+            return std::max(std::min(bucket_highest(i), max_value), min());
+    }
+    return max_value;
+}
@@ -0,0 +1,61 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HARNESS_LATENCY_HISTOGRAM_H_
+#define HARNESS_LATENCY_HISTOGRAM_H_
+
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/opencl.h>
+#endif
+
+#include <stddef.h>
+
+#include <vector>
+
+// Histogram with a bounded relative error in the style of HdrHistogram.
+// Values below 2^kSubBucketBits are counted exactly, larger values in
+// 2^kSubBucketBits linear sub-buckets per power of two, which keeps the
+// error of reported percentiles below 1 / 2^kSubBucketBits.
+class LatencyHistogram {
+public:
+    static const unsigned kSubBucketBits = 6;
+
+    LatencyHistogram();
+
+    void record(cl_ulong value);
+
+    size_t count() const { return total; }
+    cl_ulong min() const { return total ? min_value : 0; }
+    cl_ulong max() const { return max_value; }
+    double mean() const { return total ? sum / total : 0.0; }
+
+    // Smallest recorded value such that p percent of the values are less
+    // or equal, within the histogram precision
+    cl_ulong percentile(double p) const;
+
+private:
+    static size_t bucket_index(cl_ulong value);
+    static cl_ulong bucket_highest(size_t index);
+
+    std::vector<size_t> counts;
+    size_t total = 0;
+    cl_ulong min_value = ~(cl_ulong)0;
+    cl_ulong max_value = 0;
+    double sum = 0.0;
+};
+
+#endif // HARNESS_LATENCY_HISTOGRAM_H_
@@ -0,0 +1,469 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "logBackend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Interval at which the writer thread looks for new messages
+const std::chrono::milliseconds kWriterInterval(5);
+
+struct LogMessage
+{
+    unsigned long long seq;
+    LogLevel level;
+    unsigned thread;
+    std::string text;
+};
+
+struct LaterMessage
+{
+    bool operator()(const LogMessage &a, const LogMessage &b) const
+    {
+        return a.seq > b.seq;
+    }
+};
+
+// Unbounded queue with a single producer, the thread owning it, and a single
+// consumer, the writer thread. Neither side takes a lock.
+class ThreadLog {
+public:
+    explicit ThreadLog(unsigned thread_id)
+        : id(thread_id), head(new Node), tail(head)
+    {}
+
+    unsigned get_id() const { return id; }
+
+    void push(LogMessage &&message)
+    {
+        Node *node = new Node;
+        node->message = std::move(message);
+        tail->next.store(node, std::memory_order_release);
+        tail = node;
+    }
+
+    bool pop(LogMessage &message)
+    {
+        Node *next = head->next.load(std::memory_order_acquire);
+        if (!next) return false;
+        // The popped node becomes the new head, whose message is unused
+        message = std::move(next->message);
+        delete head;
+        head = next;
+        return true;
+    }
+
+private:
+    struct Node
+    {
+        LogMessage message;
+        std::atomic<Node *> next{ nullptr };
+    };
+
+    const unsigned id;
+    Node *head; // consumer side
+    Node *tail; // producer side
+};
+
+struct PerfNumber
+{
+    std::string name;
+    double number;
+    std::string unit;
+    bool higher_better;
+};
+
+std::string json_escape(const std::string &text)
+{
+    std::string result;
+    result.reserve(text.size());
+    for (unsigned char c : text)
+    {
+        switch (c)
+        {
+            case '"': result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\t': result += "\\t"; break;
+            default:
+                if (c < 0x20)
+                {
+                    char escaped[8];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    result += escaped;
+                }
+                else
+                {
+                    result += (char)c;
+                }
+        }
+    }
+    return result;
+}
+
+#ifdef __MINGW32__
+// The MinGW versions support the "%a" format specifier
+#define vsnprintf __mingw_vsnprintf
+#define vprintf __mingw_vprintf
+#endif
+
+std::string format_message(const char *format, va_list args)
+{
+    char buffer[512];
+    va_list copy;
+    va_copy(copy, args);
+    int length = vsnprintf(buffer, sizeof(buffer), format, copy);
+    va_end(copy);
+    if (length < 0) return std::string();
+    if ((size_t)length < sizeof(buffer)) return std::string(buffer, length);
+
+    std::string result(length + 1, '\0');
+    vsnprintf(&result[0], result.size(), format, args);
+    result.resize(length);
+    return result;
+}
+
+class LogBackend {
+public:
+    LogBackend()
+    {
+        async = getenv("CL_LOG_ASYNC") != NULL;
+        const char *level = getenv("CL_LOG_LEVEL");
+        max_level = (level && strcmp(level, "error") == 0) ? LOG_LEVEL_ERROR
+                                                           : LOG_LEVEL_INFO;
+        const char *limit = getenv("CL_LOG_ERROR_LIMIT");
+        error_limit = limit ? strtoul(limit, NULL, 10) : 0;
+        const char *json_path = getenv("CL_LOG_JSON");
+        if (json_path)
+        {
+            json = fopen(json_path, "w");
+            if (!json)
+                fprintf(stderr, "Unable to open log file %s\n", json_path);
+        }
+        const char *perf_path = getenv("CL_LOG_PERF_SUMMARY");
+        if (perf_path) perf_summary_path = perf_path;
+
+        if (async) writer = std::thread(&LogBackend::writer_loop, this);
+    }
+
+    int log(LogLevel level, const char *format, va_list args)
+    {
+        if (!accept(level, format)) return 0;
+
+        // Without a sink needing the text, this is the printf of before
+        if (!async_running() && !json) return vprintf(format, args);
+
+        LogMessage message;
+        message.level = level;
+        message.text = format_message(format, args);
+        int length = (int)message.text.size();
+        submit(std::move(message));
+        return length;
+    }
+
+    void perf(double number, int higher_better, const char *num_type,
+              const char *format, va_list args)
+    {
+        PerfNumber perf_number = { format_message(format, args), number,
+                                   num_type, higher_better != 0 };
+        {
+            std::lock_guard<std::mutex> lock(perf_mutex);
+            perf_numbers.push_back(perf_number);
+        }
+        log_printf(LOG_LEVEL_INFO,
+                   "Performance Number %s (in %s, %s): %g\n",
+                   perf_number.name.c_str(), num_type,
+                   higher_better ? "higher is better" : "lower is better",
+                   number);
+    }
+
+    void flush()
+    {
+        if (!async_running() || shutting_down.load())
+        {
+            std::lock_guard<std::mutex> lock(emit_mutex);
+            fflush(stdout);
+            return;
+        }
+        unsigned long long target = next_seq.load();
+        std::unique_lock<std::mutex> lock(writer_mutex);
+        wake.notify_one();
+        written_cv.wait(lock,
+                        [&] { return written >= target || stopped.load(); });
+    }
+
+    // Called at exit, writes what is left and the summaries
+    void shutdown()
+    {
+        if (async_running())
+        {
+            // From here on messages are written directly, then wait for the
+            // threads that were already queueing one
+            shutting_down = true;
+            while (producers.load()) std::this_thread::yield();
+            {
+                std::lock_guard<std::mutex> lock(writer_mutex);
+                stopping = true;
+            }
+            wake.notify_one();
+            writer.join();
+            // Everything queued is in the thread logs by now
+            drain(true);
+        }
+
+        report_suppressed();
+        write_perf_summary();
+        std::lock_guard<std::mutex> lock(emit_mutex);
+        if (json) fclose(json);
+        json = NULL;
+        fflush(stdout);
+    }
+
+private:
+    bool async_running() const { return async && !stopped.load(); }
+
+    bool accept(LogLevel level, const char *format)
+    {
+        if (level > max_level) return false;
+        if (level != LOG_LEVEL_ERROR || error_limit == 0) return true;
+
+        std::lock_guard<std::mutex> lock(limit_mutex);
+        unsigned long &count = error_counts[format];
+        return ++count <= error_limit;
+    }
+
+    ThreadLog *thread_log()
+    {
+        static thread_local ThreadLog *current = nullptr;
+        if (!current)
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            current = new ThreadLog((unsigned)thread_logs.size());
+            thread_logs.push_back(current);
+        }
+        return current;
+    }
+
+    void submit(LogMessage &&message)
+    {
+        ThreadLog *log = thread_log();
+        message.thread = log->get_id();
+        message.seq = next_seq.fetch_add(1);
+        if (async_running())
+        {
+            producers.fetch_add(1);
+            if (!shutting_down.load())
+            {
+                log->push(std::move(message));
+                producers.fetch_sub(1);
+                return;
+            }
+            producers.fetch_sub(1);
+        }
+        std::lock_guard<std::mutex> lock(emit_mutex);
+        emit(message);
+    }
+
+    void emit(const LogMessage &message)
+    {
+        fputs(message.text.c_str(), stdout);
+        if (json)
+            fprintf(json,
+                    "{\"seq\": %llu, \"thread\": %u, \"level\": \"%s\", "
+                    "\"message\": \"%s\"}\n",
+                    message.seq, message.thread,
+                    message.level == LOG_LEVEL_ERROR ? "error" : "info",
+                    json_escape(message.text).c_str());
+    }
+
+    // Moves the queued messages to pending and writes those next in
+    // sequence. Sequence numbers are taken just before a message is queued,
+    // so a gap only lasts until its message shows up. With all set, pending
+    // messages are written regardless of gaps.
+    void drain(bool all)
+    {
+        std::vector<ThreadLog *> logs;
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            logs = thread_logs;
+        }
+        LogMessage message;
+        for (ThreadLog *log : logs)
+            while (log->pop(message)) pending.push(std::move(message));
+
+        std::lock_guard<std::mutex> lock(emit_mutex);
+        bool wrote = false;
+        while (!pending.empty() && (all || pending.top().seq == next_write))
+        {
+            emit(pending.top());
+            next_write = pending.top().seq + 1;
+            pending.pop();
+            wrote = true;
+        }
+        if (wrote)
+        {
+            fflush(stdout);
+            if (json) fflush(json);
+        }
+    }
+
+    void writer_loop()
+    {
+        std::unique_lock<std::mutex> lock(writer_mutex);
+        while (true)
+        {
+            lock.unlock();
+            drain(false);
+            lock.lock();
+
+            written = next_write;
+            written_cv.notify_all();
+            // shutdown() drains what is left, messages written directly
+            // while it runs leave gaps that would never close
+            if (stopping) break;
+            wake.wait_for(lock, kWriterInterval);
+        }
+        stopped = true;
+        written_cv.notify_all();
+    }
+
+    void report_suppressed()
+    {
+        std::lock_guard<std::mutex> lock(limit_mutex);
+        for (const auto &entry : error_counts)
+        {
+            if (entry.second <= error_limit) continue;
+            std::string format(entry.first);
+            while (!format.empty() && format.back() == '\n') format.pop_back();
+            printf("%lu more error messages suppressed: %s\n",
+                   entry.second - error_limit, format.c_str());
+        }
+    }
+
+    void write_perf_summary()
+    {
+        if (perf_summary_path.empty()) return;
+        FILE *file = fopen(perf_summary_path.c_str(), "w");
+        if (!file)
+        {
+            fprintf(stderr, "Unable to open %s\n", perf_summary_path.c_str());
+            return;
+        }
+        std::lock_guard<std::mutex> lock(perf_mutex);
+        fprintf(file, "[\n");
+        for (size_t i = 0; i < perf_numbers.size(); i++)
+        {
+            const PerfNumber &p = perf_numbers[i];
+            fprintf(file,
+                    "  {\"name\": \"%s\", \"value\": %.17g, \"unit\": \"%s\", "
+                    "\"higher_is_better\": %s}%s\n",
+                    json_escape(p.name).c_str(), p.number,
+                    json_escape(p.unit).c_str(),
+                    p.higher_better ? "true" : "false",
+                    i + 1 < perf_numbers.size() ? "," : "");
+        }
+        fprintf(file, "]\n");
+        fclose(file);
+    }
+
+    bool async;
+    LogLevel max_level;
+    unsigned long error_limit;
+    FILE *json = NULL;
+    std::string perf_summary_path;
+
+    std::atomic<unsigned long long> next_seq{ 0 };
+
+    std::mutex registry_mutex;
+    std::vector<ThreadLog *> thread_logs;
+
+    // Owned by the writer thread, or by shutdown() once it stopped
+    std::priority_queue<LogMessage, std::vector<LogMessage>, LaterMessage>
+        pending;
+    unsigned long long next_write = 0;
+
+    std::thread writer;
+    std::mutex writer_mutex;
+    std::condition_variable wake;
+    std::condition_variable written_cv;
+    unsigned long long written = 0;
+    bool stopping = false;
+    std::atomic<bool> stopped{ false };
+    // Set by shutdown(), producers counts the threads queueing a message
+    std::atomic<bool> shutting_down{ false };
+    std::atomic<unsigned> producers{ 0 };
+
+    std::mutex emit_mutex;
+    std::mutex limit_mutex;
+    std::map<const char *, unsigned long> error_counts;
+    std::mutex perf_mutex;
+    std::vector<PerfNumber> perf_numbers;
+};
+
+void shutdown_at_exit();
+
+// Never destroyed, messages may be logged by static destructors
+LogBackend &backend()
+{
+    static LogBackend *instance = [] {
+        LogBackend *created = new LogBackend;
+        atexit(shutdown_at_exit);
+        return created;
+    }();
+    return *instance;
+}
+
+void shutdown_at_exit() { backend().shutdown(); }
+
+} // namespace
+
+int log_printf(LogLevel level, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int result = backend().log(level, format, args);
+    va_end(args);
+    return result;
+}
+
+int log_vprintf(LogLevel level, const char *format, va_list args)
+{
+    return backend().log(level, format, args);
+}
+
+void log_perf_number(double number, int higher_better, const char *num_type,
+                     const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    backend().perf(number, higher_better, num_type, format, args);
+    va_end(args);
+}
+
+void log_flush() { backend().flush(); }
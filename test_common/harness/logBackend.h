@@ -0,0 +1,60 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HARNESS_LOG_BACKEND_H_
+#define HARNESS_LOG_BACKEND_H_
+
+#include <stdarg.h>
+
+// Backend of the log_info(), log_error() and vlog() macros of
+// errorHelpers.h. Messages are written to stdout as they are logged, like
+// printf, unless configured otherwise from the environment:
+//   CL_LOG_ASYNC               buffer the messages of each thread without
+//                              locking and write them, in the order they
+//                              were logged, from a writer thread. Output
+//                              written with printf directly may interleave
+//                              differently, and messages not yet written are
+//                              lost if the process crashes.
+//   CL_LOG_LEVEL=error         drop informational messages
+//   CL_LOG_ERROR_LIMIT=<n>     print an error message logged with the same
+//                              format at most n times, and a count of the
+//                              suppressed ones at exit
+//   CL_LOG_JSON=<file>         also write every message as a JSON line
+//   CL_LOG_PERF_SUMMARY=<file> write the log_perf() numbers as JSON at exit
+
+#if defined(__GNUC__)
+#define LOG_FORMAT_ATTRIBUTE(f, a) __attribute__((format(printf, f, a)))
+#else
+#define LOG_FORMAT_ATTRIBUTE(f, a)
+#endif
+
+enum LogLevel
+{
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_INFO,
+};
+
+int log_printf(LogLevel level, const char *format, ...)
+    LOG_FORMAT_ATTRIBUTE(2, 3);
+int log_vprintf(LogLevel level, const char *format, va_list args);
+
+// Logs a performance number named by format, and keeps it for the summary
+void log_perf_number(double number, int higher_better, const char *num_type,
+                     const char *format, ...) LOG_FORMAT_ATTRIBUTE(4, 5);
+
+// Waits until every message logged so far has been written
+void log_flush();
+
+#endif // HARNESS_LOG_BACKEND_H_
@@ -15,6 +15,7 @@
 //
 #include "parseParameters.h"
 
+#include "benchmarkHelpers.h"
 #include "errorHelpers.h"
 #include "testHarness.h"
 #include "ThreadPool.h"
@@ -70,6 +71,19 @@ For offline compilation (binary and spir-v modes) only:
         Program to use for offline compilation, defaults to:
             )" DEFAULT_COMPILATION_PROGRAM R"(
 
+For tests that report performance numbers only:
+    --benchmark-json <file>
+        Write benchmark statistics to <file> in JSON format
+    --benchmark-baseline <file>
+        Compare benchmark results against a file written by --benchmark-json,
+        and fail the run if any of them regressed
+    --benchmark-tolerance <percent>
+        Slowdown of the median tolerated against the baseline (default 10)
+    --benchmark-warmup <num>
+        Untimed iterations before measuring (default 1)
+    --benchmark-repeat <num>
+        Timed iterations, overrides the default of each test
+
 For spir-v mode only:
     --disable-spirv-validation
         Disable validation of SPIR-V using the SPIR-V validator
@@ -228,6 +242,59 @@ int parseCustomParam(int argc, const char *argv[], const char *ignore)
                 return -1;
             }
         }
+        else if (!strcmp(argv[i], "--benchmark-json")
+                 || !strcmp(argv[i], "--benchmark-baseline"))
+        {
+            delArg++;
+            if ((i + 1) < argc)
+            {
+                delArg++;
+                if (!strcmp(argv[i], "--benchmark-json"))
+                    gBenchmarkJSONPath = argv[i + 1];
+                else
+                    gBenchmarkBaselinePath = argv[i + 1];
+            }
+            else
+            {
+                log_error("File argument for %s was not specified.\n",
+                          argv[i]);
+                return -1;
+            }
+        }
+        else if (!strcmp(argv[i], "--benchmark-tolerance"))
+        {
+            delArg++;
+            if ((i + 1) < argc)
+            {
+                delArg++;
+                gBenchmarkTolerance = atof(argv[i + 1]);
+            }
+            else
+            {
+                log_error("A parameter to --benchmark-tolerance must be "
+                          "provided!\n");
+                return -1;
+            }
+        }
+        else if (!strcmp(argv[i], "--benchmark-warmup")
+                 || !strcmp(argv[i], "--benchmark-repeat"))
+        {
+            delArg++;
+            if ((i + 1) < argc)
+            {
+                delArg++;
+                unsigned value = atoi(argv[i + 1]);
+                if (!strcmp(argv[i], "--benchmark-warmup"))
+                    gBenchmarkWarmup = value;
+                else
+                    gBenchmarkRepetitions = value;
+            }
+            else
+            {
+                log_error("A parameter to %s must be provided!\n", argv[i]);
+                return -1;
+            }
+        }
         else if (!strcmp(argv[i], "--disable-spirv-validation"))
         {
             delArg++;
@@ -0,0 +1,119 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "patternHelpers.h"
+
+#include <assert.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Whole repetitions of the pattern per block. With at least 64 of them a
+// block is a multiple of the vector width for any pattern size.
+const size_t kRepetitionsPerBlock = 64;
+const size_t kVectorSize = 16;
+
+// A block of back-to-back pattern copies, used as the source of wide stores
+// and as the reference of wide compares
+struct PatternBlock
+{
+    PatternBlock(const void *pattern, size_t pattern_size)
+        : size(pattern_size * kRepetitionsPerBlock)
+    {
+        assert(pattern_size > 0 && pattern_size <= MAX_FILL_PATTERN_SIZE);
+        for (size_t i = 0; i < size; i += pattern_size)
+            memcpy(bytes + i, pattern, pattern_size);
+    }
+
+    alignas(kVectorSize)
+        unsigned char bytes[MAX_FILL_PATTERN_SIZE * kRepetitionsPerBlock];
+    size_t size;
+};
+
+// Copies n bytes of a block, n being a multiple of kVectorSize
+void store_block(unsigned char *dest, const unsigned char *block, size_t n)
+{
+#ifdef __SSE2__
+    for (size_t i = 0; i < n; i += kVectorSize)
+        _mm_storeu_si128((__m128i *)(dest + i),
+                         _mm_load_si128((const __m128i *)(block + i)));
+#else
+    memcpy(dest, block, n);
+#endif
+}
+
+// Returns the offset of the first byte that differs in [0, n), or n
+size_t first_mismatch(const unsigned char *data, const unsigned char *block,
+                      size_t n)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i + kVectorSize <= n; i += kVectorSize)
+    {
+        __m128i equal =
+            _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(data + i)),
+                           _mm_load_si128((const __m128i *)(block + i)));
+        unsigned mask = (unsigned)_mm_movemask_epi8(equal) ^ 0xffffu;
+        if (mask)
+        {
+            while (!(mask & 1))
+            {
+                mask >>= 1;
+                i++;
+            }
+            return i;
+        }
+    }
+#else
+    if (memcmp(data, block, n) == 0) return n;
+#endif
+    for (; i < n; i++)
+        if (data[i] != block[i]) return i;
+    return n;
+}
+
+} // namespace
+
+void fill_pattern(void *dest, size_t bytes, const void *pattern,
+                  size_t pattern_size)
+{
+    PatternBlock block(pattern, pattern_size);
+    unsigned char *out = (unsigned char *)dest;
+
+    size_t offset = 0;
+    for (; offset + block.size <= bytes; offset += block.size)
+        store_block(out + offset, block.bytes, block.size);
+    // The block starts with a whole pattern, so the tail is its prefix
+    memcpy(out + offset, block.bytes, bytes - offset);
+}
+
+size_t verify_pattern(const void *data, size_t bytes, const void *pattern,
+                      size_t pattern_size)
+{
+    PatternBlock block(pattern, pattern_size);
+    const unsigned char *in = (const unsigned char *)data;
+
+    for (size_t offset = 0; offset < bytes; offset += block.size)
+    {
+        size_t n = bytes - offset < block.size ? bytes - offset : block.size;
+        size_t mismatch = first_mismatch(in + offset, block.bytes, n);
+        if (mismatch < n) return offset + mismatch;
+    }
+    return PATTERN_MATCH;
+}
@@ -0,0 +1,41 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HARNESS_PATTERN_HELPERS_H_
+#define HARNESS_PATTERN_HELPERS_H_
+
+#include <stddef.h>
+
+// Largest pattern accepted, which is also the largest clEnqueueFillBuffer
+// pattern (a double16 or long16)
+#define MAX_FILL_PATTERN_SIZE 128
+
+// Returned by verify_pattern() when every byte matches
+#define PATTERN_MATCH ((size_t)-1)
+
+// Fills bytes of dest with back-to-back copies of a 1 to
+// MAX_FILL_PATTERN_SIZE byte pattern. bytes need not be a multiple of
+// pattern_size, the last copy is truncated.
+void fill_pattern(void *dest, size_t bytes, const void *pattern,
+                  size_t pattern_size);
+
+// Checks that bytes of data hold back-to-back copies of pattern, as written
+// by fill_pattern(). Returns the offset of the first mismatching byte, or
+// PATTERN_MATCH. Only a small block of the expected contents is built, so
+// the cost in host memory does not depend on bytes.
+size_t verify_pattern(const void *data, size_t bytes, const void *pattern,
+                      size_t pattern_size);
+
+#endif // HARNESS_PATTERN_HELPERS_H_
@@ -31,6 +31,10 @@
 #include "typeWrappers.h"
 #include "imageHelpers.h"
 #include "parseParameters.h"
+#include "benchmarkHelpers.h"
+#include "deviceCache.h"
+#include "hostArena.h"
+#include "patternHelpers.h"
 
 #if !defined(_WIN32)
 #include <sys/utsname.h>
@@ -605,6 +609,10 @@ int runTestHarnessWithCheck(int argc, const char *argv[], int testNum,
     int error = parseAndCallCommandLineTests(argc, argv, device, testNum,
                                              testList, config);
 
+    // Regressions against a benchmark baseline fail the run
+    if (finish_benchmarks() != 0) error = 1;
+    arena_report();
+
 #if defined(__APPLE__) && defined(__arm__)
     // Restore the old FP mode before leaving.
     RestoreFPState(&oldMode);
@@ -879,7 +887,7 @@ test_status callSingleTestFunction(test_definition test,
     cl_command_queue queue = NULL;
 
     log_info("%s...\n", test.name);
-    fflush(stdout);
+    log_flush();
 
     const Version device_version = get_device_cl_version(deviceToUse);
     if (test.min_version > device_version)
@@ -949,6 +957,8 @@ test_status callSingleTestFunction(test_definition test,
     {
         int ret =
             test.func(deviceToUse, context, queue, config.numElementsToUse);
+        // Before the result, and before any output of the next test
+        log_flush();
         if (ret == TEST_SKIPPED_ITSELF)
         {
             /* Tests can also let us know they're not supported by the
@@ -995,17 +1005,7 @@ test_status callSingleTestFunction(test_definition test,
 #if !defined(__APPLE__)
 void memset_pattern4(void *dest, const void *src_pattern, size_t bytes)
 {
-    uint32_t pat = ((uint32_t *)src_pattern)[0];
-    size_t count = bytes / 4;
-    size_t i;
-    uint32_t *d = (uint32_t *)dest;
-
-    for (i = 0; i < count; i++) d[i] = pat;
-
-    d += i;
-
-    bytes &= 3;
-    if (bytes) memcpy(d, src_pattern, bytes);
+    fill_pattern(dest, bytes, src_pattern, 4);
 }
 #endif
 
@@ -1089,7 +1089,7 @@ cl_device_id GetOpposingDevice(cl_device_id device)
     return NULL;
 }
 
-Version get_device_cl_version(cl_device_id device)
+static Version query_device_cl_version(cl_device_id device)
 {
     size_t str_size;
     cl_int err = clGetDeviceInfo(device, CL_DEVICE_VERSION, 0, NULL, &str_size);
@@ -1119,6 +1119,17 @@ Version get_device_cl_version(cl_device_id device)
                              + str.data());
 }
 
+Version get_device_cl_version(cl_device_id device)
+{
+    Version version;
+    cached_device_query(device, &DeviceCapabilities::cl_version, version,
+                        [device](Version &value) {
+                            value = query_device_cl_version(device);
+                            return true;
+                        });
+    return version;
+}
+
 bool check_device_spirv_version_reported(cl_device_id device)
 {
     size_t str_size;
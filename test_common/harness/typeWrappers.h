@@ -21,6 +21,7 @@
 #endif
 
 #include "compat.h"
+#include "hostArena.h"
 #include "mt19937.h"
 #include "errorHelpers.h"
 #include "kernelHelpers.h"
@@ -292,13 +293,33 @@ template <typename T> class BufferOwningPtr {
     // Bytes allocated in unprotected pages, pointed to by ptr:
     size_t allocsize;
     bool aligned;
+    // Allocated with arena_alloc()
+    bool arena;
+
+    void release()
+    {
+        if (arena)
+        {
+            arena_free(ptr);
+        }
+        else if (aligned)
+        {
+            align_free(ptr);
+        }
+        else
+        {
+            free(ptr);
+        }
+    }
 
 public:
     explicit BufferOwningPtr(void *p = 0)
-        : ptr(p), map(0), mapsize(0), allocsize(0), aligned(false)
+        : ptr(p), map(0), mapsize(0), allocsize(0), aligned(false),
+          arena(false)
     {}
     explicit BufferOwningPtr(void *p, void *m, size_t s)
-        : ptr(p), map(m), mapsize(s), allocsize(0), aligned(false)
+        : ptr(p), map(m), mapsize(s), allocsize(0), aligned(false),
+          arena(false)
     {
 #if !defined(__APPLE__)
         if (m)
@@ -321,18 +342,11 @@ public:
         }
         else
         {
-            if (aligned)
-            {
-                align_free(ptr);
-            }
-            else
-            {
-                free(ptr);
-            }
+            release();
         }
     }
     void reset(void *p, void *m = 0, size_t mapsize_ = 0, size_t allocsize_ = 0,
-               bool aligned_ = false)
+               bool aligned_ = false, bool arena_ = false)
     {
         if (map)
         {
@@ -348,14 +362,7 @@ public:
         }
         else
         {
-            if (aligned)
-            {
-                align_free(ptr);
-            }
-            else
-            {
-                free(ptr);
-            }
+            release();
         }
         ptr = p;
         map = m;
@@ -363,6 +370,7 @@ public:
         // Force allocsize to zero if ptr is NULL:
         allocsize = (ptr != NULL) ? allocsize_ : 0;
         aligned = aligned_;
+        arena = arena_;
 #if !defined(__APPLE__)
         if (m)
         {
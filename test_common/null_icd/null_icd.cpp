@@ -0,0 +1,3161 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "null_icd.h"
+
+#include <CL/cl_ext.h>
+#include <CL/cl_icd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#define NULL_ICD_EXPORT extern "C" __declspec(dllexport)
+#else
+#define NULL_ICD_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+// Every object handed out to the ICD loader starts with the dispatch table
+// pointer. All commands execute synchronously on the enqueuing thread, unless
+// they depend on an incomplete event, in which case they are deferred until
+// the event completes.
+
+struct _cl_platform_id
+{
+    struct _cl_icd_dispatch *dispatch;
+};
+
+struct _cl_device_id
+{
+    struct _cl_icd_dispatch *dispatch;
+};
+
+struct _cl_context
+{
+    struct _cl_icd_dispatch *dispatch;
+    std::atomic<cl_uint> refCount;
+    std::vector<cl_context_properties> properties;
+    std::vector<std::pair<void(CL_CALLBACK *)(cl_context, void *), void *>>
+        destructorCallbacks;
+};
+
+struct NullCommand
+{
+    cl_event event;
+    std::vector<cl_event> waitList;
+    std::function<void()> run;
+};
+
+struct _cl_command_queue
+{
+    struct _cl_icd_dispatch *dispatch;
+    std::atomic<cl_uint> refCount;
+    cl_context context;
+    cl_command_queue_properties properties;
+    std::vector<cl_queue_properties> propertiesArray;
+    std::deque<NullCommand> pending;
+    cl_event lastBarrier;
+};
+
+struct _cl_mem
+{
+    struct _cl_icd_dispatch *dispatch;
+    std::atomic<cl_uint> refCount;
+    cl_context context;
+    cl_mem_object_type type;
+    cl_mem_flags flags;
+    size_t size;
+    void *hostPtr; // user pointer for CL_MEM_USE_HOST_PTR
+    unsigned char *storage;
+    bool ownsStorage;
+    cl_mem parent; // parent buffer of sub-buffers and 1D image buffers
+    size_t offset;
+    cl_uint mapCount;
+    cl_image_format format;
+    cl_image_desc desc;
+    size_t elementSize;
+    size_t rowPitch;
+    size_t slicePitch;
+    std::vector<cl_mem_properties> properties;
+    std::vector<std::pair<void(CL_CALLBACK *)(cl_mem, void *), void *>>
+        destructorCallbacks;
+};
+
+struct _cl_sampler
+{
+    struct _cl_icd_dispatch *dispatch;
+    std::atomic<cl_uint> refCount;
+    cl_context context;
+    cl_bool normalizedCoords;
+    cl_addressing_mode addressingMode;
+    cl_filter_mode filterMode;
+    std::vector<cl_sampler_properties> properties;
+};
+
+struct _cl_program
+{
+    struct _cl_icd_dispatch *dispatch;
+    std::atomic<cl_uint> refCount;
+    cl_context context;
+    std::string source;
+    std::string options;
+    cl_build_status buildStatus;
+    cl_program_binary_type binaryType;
+    std::map<std::string, cl_uint> kernels; // kernel name -> argument count
+    std::vector<std::pair<void(CL_CALLBACK *)(cl_program, void *), void *>>
+        releaseCallbacks;
+};
+
+struct _cl_kernel
+{
+    struct _cl_icd_dispatch *dispatch;
+    std::atomic<cl_uint> refCount;
+    cl_program program;
+    std::string name;
+    cl_uint numArgs;
+    std::vector<std::vector<unsigned char>> argValues;
+    std::vector<size_t> argSizes;
+    std::vector<bool> argIsSet;
+    std::vector<cl_mem> argMem;
+};
+
+struct _cl_event
+{
+    struct _cl_icd_dispatch *dispatch;
+    std::atomic<cl_uint> refCount;
+    cl_context context;
+    cl_command_queue queue;
+    cl_command_type commandType;
+    cl_int status;
+    cl_ulong timestamps[4]; // queued, submit, start, end
+    std::vector<std::pair<void(CL_CALLBACK *)(cl_event, cl_int, void *),
+                          std::pair<cl_int, void *>>>
+        callbacks;
+};
+
+namespace {
+
+struct _cl_icd_dispatch gDispatch;
+_cl_platform_id gPlatform = { &gDispatch };
+_cl_device_id gDevice = { &gDispatch };
+
+// One lock serializes all API calls that touch shared state. Kernel
+// callbacks may re-enter the API from the same thread, so the lock is
+// recursive. It is taken through ApiLock, which tracks the depth.
+std::recursive_mutex gLock;
+thread_local unsigned gLockDepth = 0;
+
+// Event callbacks are queued under gLock and run once the thread releases
+// it, so that they can call any API function
+struct EventCallback
+{
+    void(CL_CALLBACK *fn)(cl_event, cl_int, void *);
+    cl_event event; // retained until the callback has run
+    cl_int status;
+    void *userData;
+};
+std::vector<EventCallback> gEventCallbacks;
+
+// Waits use their own mutex, as a wait on the recursive gLock would only
+// release one level of it. gCompletions counts completed events.
+std::mutex gCompletionMutex;
+std::condition_variable gEventCompleted;
+unsigned long long gCompletions = 0;
+std::set<cl_command_queue> gQueues;
+std::set<cl_mem> gMemObjects;
+std::map<void *, size_t> gSVMAllocations;
+bool gProcessing = false;
+bool gReprocess = false;
+
+struct KernelCallback
+{
+    cl_null_icd_kernel_fn fn;
+    void *userData;
+};
+std::map<std::string, KernelCallback> gKernelCallbacks;
+KernelCallback gDefaultKernelCallback = { nullptr, nullptr };
+
+const size_t kMaxAllocSize = size_t(1) << 30;
+const cl_ulong kGlobalMemSize = cl_ulong(4) << 30;
+const size_t kMaxWorkGroupSize = 1024;
+const size_t kStorageAlignment = 4096;
+
+const char *kPlatformName = "Null OpenCL platform";
+const char *kDeviceName = "Null OpenCL device";
+const char *kVendor = "Khronos CTS";
+const char *kVersion = "OpenCL 1.2 Null";
+
+cl_ulong NowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void *AlignedAlloc(size_t size)
+{
+    if (size == 0) size = 1;
+#if defined(_WIN32)
+    return _aligned_malloc(size, kStorageAlignment);
+#else
+    void *ptr = nullptr;
+    if (posix_memalign(&ptr, kStorageAlignment, size)) return nullptr;
+    return ptr;
+#endif
+}
+
+void AlignedFree(void *ptr)
+{
+#if defined(_WIN32)
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+void SetError(cl_int *errcode_ret, cl_int error)
+{
+    if (errcode_ret) *errcode_ret = error;
+}
+
+cl_int ReturnData(const void *data, size_t size, size_t param_value_size,
+                  void *param_value, size_t *param_value_size_ret)
+{
+    if (param_value)
+    {
+        if (param_value_size < size) return CL_INVALID_VALUE;
+        if (size) memcpy(param_value, data, size);
+    }
+    if (param_value_size_ret) *param_value_size_ret = size;
+    return CL_SUCCESS;
+}
+
+template <typename T>
+cl_int ReturnValue(const T &value, size_t param_value_size, void *param_value,
+                   size_t *param_value_size_ret)
+{
+    return ReturnData(&value, sizeof(T), param_value_size, param_value,
+                      param_value_size_ret);
+}
+
+cl_int ReturnString(const std::string &value, size_t param_value_size,
+                    void *param_value, size_t *param_value_size_ret)
+{
+    return ReturnData(value.c_str(), value.size() + 1, param_value_size,
+                      param_value, param_value_size_ret);
+}
+
+template <typename T>
+cl_int ReturnVector(const std::vector<T> &value, size_t param_value_size,
+                    void *param_value, size_t *param_value_size_ret)
+{
+    return ReturnData(value.empty() ? nullptr : &value[0],
+                      value.size() * sizeof(T), param_value_size, param_value,
+                      param_value_size_ret);
+}
+
+// Copies properties up to and including the terminating zero
+template <typename T> std::vector<T> CopyProperties(const T *properties)
+{
+    std::vector<T> result;
+    if (!properties) return result;
+    while (properties[0] != 0)
+    {
+        result.push_back(properties[0]);
+        result.push_back(properties[1]);
+        properties += 2;
+    }
+    result.push_back(0);
+    return result;
+}
+
+size_t ChannelCount(cl_channel_order order)
+{
+    switch (order)
+    {
+        case CL_R:
+        case CL_A:
+        case CL_INTENSITY:
+        case CL_LUMINANCE:
+        case CL_DEPTH: return 1;
+        case CL_RG:
+        case CL_RA:
+        case CL_Rx: return 2;
+        case CL_RGB:
+        case CL_RGx:
+        case CL_sRGB: return 3;
+        default: return 4;
+    }
+}
+
+size_t ElementSize(const cl_image_format *format)
+{
+    switch (format->image_channel_data_type)
+    {
+        case CL_UNORM_SHORT_565:
+        case CL_UNORM_SHORT_555: return 2;
+        case CL_UNORM_INT_101010: return 4;
+        case CL_SNORM_INT8:
+        case CL_UNORM_INT8:
+        case CL_SIGNED_INT8:
+        case CL_UNSIGNED_INT8:
+            return ChannelCount(format->image_channel_order);
+        case CL_SNORM_INT16:
+        case CL_UNORM_INT16:
+        case CL_SIGNED_INT16:
+        case CL_UNSIGNED_INT16:
+        case CL_HALF_FLOAT:
+            return 2 * ChannelCount(format->image_channel_order);
+        case CL_SIGNED_INT32:
+        case CL_UNSIGNED_INT32:
+        case CL_FLOAT: return 4 * ChannelCount(format->image_channel_order);
+        default: return 0;
+    }
+}
+
+std::vector<cl_image_format> SupportedImageFormats()
+{
+    static const cl_channel_order orders[] = { CL_R, CL_RG, CL_RGBA };
+    static const cl_channel_type types[] = {
+        CL_SNORM_INT8,      CL_SNORM_INT16,     CL_UNORM_INT8,
+        CL_UNORM_INT16,     CL_SIGNED_INT8,     CL_SIGNED_INT16,
+        CL_SIGNED_INT32,    CL_UNSIGNED_INT8,   CL_UNSIGNED_INT16,
+        CL_UNSIGNED_INT32,  CL_HALF_FLOAT,      CL_FLOAT
+    };
+    std::vector<cl_image_format> formats;
+    for (size_t o = 0; o < sizeof(orders) / sizeof(orders[0]); o++)
+        for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); t++)
+        {
+            cl_image_format format = { orders[o], types[t] };
+            formats.push_back(format);
+        }
+    cl_image_format bgra = { CL_BGRA, CL_UNORM_INT8 };
+    formats.push_back(bgra);
+    return formats;
+}
+
+// Copies a 3D region between two linear allocations; origins and region
+// width are in bytes
+void CopyRect(unsigned char *dst, const size_t *dstOrigin, size_t dstRowPitch,
+              size_t dstSlicePitch, const unsigned char *src,
+              const size_t *srcOrigin, size_t srcRowPitch,
+              size_t srcSlicePitch, const size_t *region)
+{
+    for (size_t z = 0; z < region[2]; z++)
+        for (size_t y = 0; y < region[1]; y++)
+            memmove(dst + dstOrigin[0] + (dstOrigin[1] + y) * dstRowPitch
+                        + (dstOrigin[2] + z) * dstSlicePitch,
+                    src + srcOrigin[0] + (srcOrigin[1] + y) * srcRowPitch
+                        + (srcOrigin[2] + z) * srcSlicePitch,
+                    region[0]);
+}
+
+void FillPattern(unsigned char *dst, const void *pattern, size_t patternSize,
+                 size_t size)
+{
+    for (size_t offset = 0; offset + patternSize <= size;
+         offset += patternSize)
+        memcpy(dst + offset, pattern, patternSize);
+}
+
+// Image origin and region expressed in bytes/rows/slices of the backing store
+void ImageRegion(cl_mem image, const size_t *origin, const size_t *region,
+                 size_t byteOrigin[3], size_t byteRegion[3])
+{
+    byteOrigin[0] = origin[0] * image->elementSize;
+    byteOrigin[1] = origin[1];
+    byteOrigin[2] = origin[2];
+    byteRegion[0] = region[0] * image->elementSize;
+    byteRegion[1] = region[1];
+    byteRegion[2] = region[2];
+    // 1D image arrays keep the array index in the second coordinate
+    if (image->type == CL_MEM_OBJECT_IMAGE1D_ARRAY)
+    {
+        byteOrigin[2] = byteOrigin[1];
+        byteOrigin[1] = 0;
+        byteRegion[2] = byteRegion[1];
+        byteRegion[1] = 1;
+    }
+}
+
+bool IsImage(cl_mem mem) { return mem && mem->type != CL_MEM_OBJECT_BUFFER; }
+
+bool IsEventDone(cl_event event) { return event->status <= CL_COMPLETE; }
+
+void RunEventCallbacks()
+{
+    std::vector<EventCallback> callbacks;
+    {
+        std::lock_guard<std::recursive_mutex> lock(gLock);
+        callbacks.swap(gEventCallbacks);
+    }
+    for (size_t i = 0; i < callbacks.size(); i++)
+    {
+        callbacks[i].fn(callbacks[i].event, callbacks[i].status,
+                        callbacks[i].userData);
+        clReleaseEvent(callbacks[i].event);
+    }
+}
+
+class ApiLock {
+public:
+    ApiLock() { lock(); }
+    ~ApiLock()
+    {
+        if (locked) unlock();
+    }
+
+    void lock()
+    {
+        gLock.lock();
+        gLockDepth++;
+        locked = true;
+    }
+
+    // Runs the queued event callbacks when the outermost lock is released
+    void unlock()
+    {
+        locked = false;
+        gLockDepth--;
+        gLock.unlock();
+        if (gLockDepth == 0) RunEventCallbacks();
+    }
+
+private:
+    bool locked = false;
+};
+
+void QueueEventCallback(void(CL_CALLBACK *fn)(cl_event, cl_int, void *),
+                        cl_event event, cl_int status, void *user_data)
+{
+    clRetainEvent(event);
+    EventCallback callback = { fn, event, status, user_data };
+    gEventCallbacks.push_back(callback);
+}
+
+// Waits until done() holds, checking it under gLock after every completed
+// event. Fails when the calling thread already holds gLock, as no other
+// thread could complete an event while it waits.
+template <typename Predicate> bool WaitUntil(Predicate done)
+{
+    while (true)
+    {
+        unsigned long long seen;
+        {
+            std::lock_guard<std::mutex> lock(gCompletionMutex);
+            seen = gCompletions;
+        }
+        {
+            ApiLock lock;
+            if (done()) return true;
+            if (gLockDepth > 1) return false;
+        }
+        std::unique_lock<std::mutex> lock(gCompletionMutex);
+        gEventCompleted.wait(lock, [&] { return gCompletions != seen; });
+    }
+}
+
+void ProcessQueues();
+
+void SetEventStatus(cl_event event, cl_int status)
+{
+    event->status = status;
+    if (status == CL_SUBMITTED) event->timestamps[1] = NowNs();
+    if (status == CL_RUNNING) event->timestamps[2] = NowNs();
+    if (status <= CL_COMPLETE) event->timestamps[3] = NowNs();
+
+    for (size_t i = 0; i < event->callbacks.size(); i++)
+    {
+        cl_int type = event->callbacks[i].second.first;
+        if ((status <= CL_COMPLETE && type == CL_COMPLETE)
+            || status == type)
+            QueueEventCallback(event->callbacks[i].first, event, status,
+                               event->callbacks[i].second.second);
+    }
+    if (status <= CL_COMPLETE)
+    {
+        {
+            std::lock_guard<std::mutex> lock(gCompletionMutex);
+            gCompletions++;
+        }
+        gEventCompleted.notify_all();
+        ProcessQueues();
+    }
+}
+
+cl_event CreateEvent(cl_context context, cl_command_queue queue,
+                     cl_command_type type)
+{
+    cl_event event = new _cl_event;
+    event->dispatch = &gDispatch;
+    event->refCount = 1;
+    event->context = context;
+    event->queue = queue;
+    event->commandType = type;
+    event->status = CL_QUEUED;
+    std::fill(event->timestamps, event->timestamps + 4, NowNs());
+    if (queue) clRetainCommandQueue(queue);
+    clRetainContext(context);
+    return event;
+}
+
+// Runs all commands whose wait lists have completed
+void ProcessQueue(cl_command_queue queue)
+{
+    bool inOrder =
+        !(queue->properties & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE);
+    for (size_t i = 0; i < queue->pending.size();)
+    {
+        NullCommand &command = queue->pending[i];
+        bool ready = true, failed = false;
+        for (size_t w = 0; w < command.waitList.size(); w++)
+        {
+            if (!IsEventDone(command.waitList[w])) ready = false;
+            if (command.waitList[w]->status < 0) failed = true;
+        }
+        if (!ready)
+        {
+            if (inOrder) break;
+            i++;
+            continue;
+        }
+        NullCommand done = command;
+        queue->pending.erase(queue->pending.begin() + i);
+        if (!failed)
+        {
+            SetEventStatus(done.event, CL_SUBMITTED);
+            SetEventStatus(done.event, CL_RUNNING);
+            if (done.run) done.run();
+        }
+        for (size_t w = 0; w < done.waitList.size(); w++)
+            clReleaseEvent(done.waitList[w]);
+        SetEventStatus(done.event,
+                       failed ? CL_EXEC_STATUS_ERROR_FOR_EVENTS_IN_WAIT_LIST
+                              : CL_COMPLETE);
+        clReleaseEvent(done.event);
+        // The queue may have changed while running the command
+        i = 0;
+    }
+}
+
+void ProcessQueues()
+{
+    if (gProcessing)
+    {
+        gReprocess = true;
+        return;
+    }
+    gProcessing = true;
+    do
+    {
+        gReprocess = false;
+        std::vector<cl_command_queue> queues(gQueues.begin(), gQueues.end());
+        for (size_t q = 0; q < queues.size(); q++)
+            if (gQueues.count(queues[q])) ProcessQueue(queues[q]);
+    } while (gReprocess);
+    gProcessing = false;
+}
+
+cl_int WaitForEvent(cl_event event)
+{
+    if (!WaitUntil([&] { return IsEventDone(event); }))
+        return CL_INVALID_OPERATION;
+    return event->status < 0 ? CL_EXEC_STATUS_ERROR_FOR_EVENTS_IN_WAIT_LIST
+                             : CL_SUCCESS;
+}
+
+cl_int ValidateWaitList(cl_uint num_events, const cl_event *event_wait_list)
+{
+    if ((num_events == 0) != (event_wait_list == nullptr))
+        return CL_INVALID_EVENT_WAIT_LIST;
+    for (cl_uint i = 0; i < num_events; i++)
+        if (!event_wait_list[i]) return CL_INVALID_EVENT_WAIT_LIST;
+    return CL_SUCCESS;
+}
+
+// Queues a command and runs it right away if nothing it depends on is
+// outstanding. Blocking commands wait until the command has completed.
+cl_int Enqueue(cl_command_queue queue, cl_command_type type,
+               cl_uint num_events, const cl_event *event_wait_list,
+               cl_event *event, std::function<void()> run,
+               bool blocking = false, bool barrier = false)
+{
+    if (!queue) return CL_INVALID_COMMAND_QUEUE;
+    cl_int error = ValidateWaitList(num_events, event_wait_list);
+    if (error != CL_SUCCESS) return error;
+
+    ApiLock lock;
+    NullCommand command;
+    command.event = CreateEvent(queue->context, queue, type);
+    command.run = run;
+    for (cl_uint i = 0; i < num_events; i++)
+        command.waitList.push_back(event_wait_list[i]);
+    bool outOfOrder =
+        (queue->properties & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) != 0;
+    if (outOfOrder && barrier && num_events == 0)
+    {
+        // Barriers and markers without a wait list wait for everything
+        // enqueued before them
+        for (size_t i = 0; i < queue->pending.size(); i++)
+            command.waitList.push_back(queue->pending[i].event);
+    }
+    if (outOfOrder && queue->lastBarrier)
+        command.waitList.push_back(queue->lastBarrier);
+    for (size_t i = 0; i < command.waitList.size(); i++)
+        clRetainEvent(command.waitList[i]);
+
+    cl_event commandEvent = command.event;
+    clRetainEvent(commandEvent);
+    if (outOfOrder && barrier)
+    {
+        if (queue->lastBarrier) clReleaseEvent(queue->lastBarrier);
+        clRetainEvent(commandEvent);
+        queue->lastBarrier = commandEvent;
+    }
+    queue->pending.push_back(command);
+    ProcessQueues();
+    lock.unlock();
+
+    error = blocking ? WaitForEvent(commandEvent) : CL_SUCCESS;
+    if (event)
+        *event = commandEvent;
+    else
+        clReleaseEvent(commandEvent);
+    return error;
+}
+
+unsigned char *MemHostPtr(cl_mem mem) { return mem->storage; }
+
+cl_mem CreateMemObject(cl_context context, const cl_mem_properties *properties,
+                       cl_mem_flags flags, cl_mem_object_type type, size_t size,
+                       void *host_ptr, cl_int *errcode_ret)
+{
+    if (!context)
+    {
+        SetError(errcode_ret, CL_INVALID_CONTEXT);
+        return nullptr;
+    }
+    bool useHostPtr = (flags & CL_MEM_USE_HOST_PTR) != 0;
+    bool copyHostPtr = (flags & CL_MEM_COPY_HOST_PTR) != 0;
+    if ((useHostPtr || copyHostPtr) != (host_ptr != nullptr)
+        || (useHostPtr && (flags & CL_MEM_ALLOC_HOST_PTR)))
+    {
+        SetError(errcode_ret, CL_INVALID_HOST_PTR);
+        return nullptr;
+    }
+    if (type == CL_MEM_OBJECT_BUFFER && (size == 0 || size > kMaxAllocSize))
+    {
+        SetError(errcode_ret, CL_INVALID_BUFFER_SIZE);
+        return nullptr;
+    }
+
+    cl_mem mem = new _cl_mem;
+    mem->dispatch = &gDispatch;
+    mem->refCount = 1;
+    mem->context = context;
+    mem->type = type;
+    mem->flags = flags;
+    mem->size = size;
+    mem->hostPtr = useHostPtr ? host_ptr : nullptr;
+    mem->parent = nullptr;
+    mem->offset = 0;
+    mem->mapCount = 0;
+    memset(&mem->format, 0, sizeof(mem->format));
+    memset(&mem->desc, 0, sizeof(mem->desc));
+    mem->elementSize = 1;
+    mem->rowPitch = 0;
+    mem->slicePitch = 0;
+    mem->properties = CopyProperties(properties);
+    if (useHostPtr)
+    {
+        mem->storage = (unsigned char *)host_ptr;
+        mem->ownsStorage = false;
+    }
+    else
+    {
+        mem->storage = (unsigned char *)AlignedAlloc(size);
+        mem->ownsStorage = true;
+        if (!mem->storage)
+        {
+            delete mem;
+            SetError(errcode_ret, CL_OUT_OF_HOST_MEMORY);
+            return nullptr;
+        }
+        if (copyHostPtr) memcpy(mem->storage, host_ptr, size);
+    }
+    clRetainContext(context);
+    ApiLock lock;
+    gMemObjects.insert(mem);
+    SetError(errcode_ret, CL_SUCCESS);
+    return mem;
+}
+
+cl_mem CreateImage(cl_context context, const cl_mem_properties *properties,
+                   cl_mem_flags flags, const cl_image_format *image_format,
+                   const cl_image_desc *image_desc, void *host_ptr,
+                   cl_int *errcode_ret)
+{
+    if (!image_format || !ElementSize(image_format))
+    {
+        SetError(errcode_ret, CL_INVALID_IMAGE_FORMAT_DESCRIPTOR);
+        return nullptr;
+    }
+    if (!image_desc)
+    {
+        SetError(errcode_ret, CL_INVALID_IMAGE_DESCRIPTOR);
+        return nullptr;
+    }
+    size_t elementSize = ElementSize(image_format);
+    size_t width = image_desc->image_width;
+    size_t height = 1, depth = 1;
+    switch (image_desc->image_type)
+    {
+        case CL_MEM_OBJECT_IMAGE1D:
+        case CL_MEM_OBJECT_IMAGE1D_BUFFER: break;
+        case CL_MEM_OBJECT_IMAGE1D_ARRAY:
+            depth = image_desc->image_array_size;
+            break;
+        case CL_MEM_OBJECT_IMAGE2D: height = image_desc->image_height; break;
+        case CL_MEM_OBJECT_IMAGE2D_ARRAY:
+            height = image_desc->image_height;
+            depth = image_desc->image_array_size;
+            break;
+        case CL_MEM_OBJECT_IMAGE3D:
+            height = image_desc->image_height;
+            depth = image_desc->image_depth;
+            break;
+        default:
+            SetError(errcode_ret, CL_INVALID_IMAGE_DESCRIPTOR);
+            return nullptr;
+    }
+    if (width == 0 || height == 0 || depth == 0)
+    {
+        SetError(errcode_ret, CL_INVALID_IMAGE_SIZE);
+        return nullptr;
+    }
+
+    size_t rowPitch = width * elementSize;
+    if (host_ptr && image_desc->image_row_pitch)
+        rowPitch = image_desc->image_row_pitch;
+    size_t slicePitch = rowPitch * height;
+    if (host_ptr && image_desc->image_slice_pitch)
+        slicePitch = image_desc->image_slice_pitch;
+
+    cl_mem mem;
+    cl_mem buffer = image_desc->buffer;
+    if (image_desc->image_type == CL_MEM_OBJECT_IMAGE1D_BUFFER || buffer)
+    {
+        if (!buffer)
+        {
+            SetError(errcode_ret, CL_INVALID_IMAGE_DESCRIPTOR);
+            return nullptr;
+        }
+        // Images created from buffers share the storage of the buffer
+        mem = new _cl_mem;
+        mem->dispatch = &gDispatch;
+        mem->refCount = 1;
+        mem->context = context;
+        mem->flags = flags ? flags : buffer->flags;
+        mem->size = slicePitch * depth;
+        mem->hostPtr = nullptr;
+        mem->storage = buffer->storage;
+        mem->ownsStorage = false;
+        mem->parent = buffer;
+        mem->offset = 0;
+        mem->mapCount = 0;
+        mem->properties = CopyProperties(properties);
+        clRetainMemObject(buffer);
+        clRetainContext(context);
+        ApiLock lock;
+        gMemObjects.insert(mem);
+        SetError(errcode_ret, CL_SUCCESS);
+    }
+    else
+    {
+        mem = CreateMemObject(context, properties, flags,
+                              image_desc->image_type, slicePitch * depth,
+                              host_ptr, errcode_ret);
+        if (!mem) return nullptr;
+    }
+    mem->type = image_desc->image_type;
+    mem->format = *image_format;
+    mem->desc = *image_desc;
+    mem->elementSize = elementSize;
+    mem->rowPitch = rowPitch;
+    mem->slicePitch = slicePitch;
+    return mem;
+}
+
+// Parses kernel names and argument counts out of OpenCL C source
+void ParseKernels(cl_program program)
+{
+    const std::string &src = program->source;
+    program->kernels.clear();
+    const char *keywords[] = { "__kernel", "kernel" };
+    for (size_t k = 0; k < 2; k++)
+    {
+        std::string keyword = keywords[k];
+        for (size_t pos = src.find(keyword); pos != std::string::npos;
+             pos = src.find(keyword, pos + keyword.size()))
+        {
+            bool wordStart = pos == 0
+                || !(isalnum((unsigned char)src[pos - 1]) || src[pos - 1] == '_');
+            size_t end = pos + keyword.size();
+            bool wordEnd = end >= src.size()
+                || !(isalnum((unsigned char)src[end]) || src[end] == '_');
+            if (!wordStart || !wordEnd) continue;
+
+            size_t open = src.find('(', src.find("void", end));
+            if (open == std::string::npos) continue;
+            // Kernel name is the identifier right before the parenthesis
+            size_t nameEnd = open;
+            while (nameEnd > end && isspace((unsigned char)src[nameEnd - 1]))
+                nameEnd--;
+            size_t nameStart = nameEnd;
+            while (nameStart > end
+                   && (isalnum((unsigned char)src[nameStart - 1])
+                       || src[nameStart - 1] == '_'))
+                nameStart--;
+            if (nameStart == nameEnd) continue;
+            std::string name = src.substr(nameStart, nameEnd - nameStart);
+            if (name == "__attribute__") continue;
+
+            cl_uint args = 0, depth = 0;
+            bool any = false;
+            for (size_t i = open + 1; i < src.size(); i++)
+            {
+                char c = src[i];
+                if (c == '(')
+                    depth++;
+                else if (c == ')')
+                {
+                    if (depth == 0) break;
+                    depth--;
+                }
+                else if (c == ',' && depth == 0)
+                    args++;
+                else if (!isspace((unsigned char)c))
+                    any = true;
+            }
+            std::string params = src.substr(open + 1, 4);
+            if (any && params != "void") args++;
+            program->kernels[name] = args;
+        }
+    }
+}
+
+cl_program CreateProgram(cl_context context, const std::string &source,
+                         cl_program_binary_type binaryType,
+                         cl_int *errcode_ret)
+{
+    if (!context)
+    {
+        SetError(errcode_ret, CL_INVALID_CONTEXT);
+        return nullptr;
+    }
+    cl_program program = new _cl_program;
+    program->dispatch = &gDispatch;
+    program->refCount = 1;
+    program->context = context;
+    program->source = source;
+    program->buildStatus = CL_BUILD_NONE;
+    program->binaryType = binaryType;
+    ParseKernels(program);
+    clRetainContext(context);
+    SetError(errcode_ret, CL_SUCCESS);
+    return program;
+}
+
+cl_kernel CreateKernel(cl_program program, const std::string &name)
+{
+    cl_kernel kernel = new _cl_kernel;
+    kernel->dispatch = &gDispatch;
+    kernel->refCount = 1;
+    kernel->program = program;
+    kernel->name = name;
+    std::map<std::string, cl_uint>::const_iterator it =
+        program->kernels.find(name);
+    kernel->numArgs = it != program->kernels.end() ? it->second : 0;
+    clRetainProgram(program);
+    return kernel;
+}
+
+void RunKernel(cl_kernel kernel, cl_uint work_dim,
+               const std::vector<size_t> &offset,
+               const std::vector<size_t> &global,
+               const std::vector<size_t> &local)
+{
+    KernelCallback callback = gDefaultKernelCallback;
+    std::map<std::string, KernelCallback>::const_iterator it =
+        gKernelCallbacks.find(kernel->name);
+    if (it != gKernelCallbacks.end()) callback = it->second;
+    if (!callback.fn) return;
+
+    std::vector<cl_null_icd_kernel_arg> args(kernel->argValues.size());
+    for (size_t i = 0; i < args.size(); i++)
+    {
+        args[i].size = kernel->argSizes[i];
+        args[i].value =
+            kernel->argValues[i].empty() ? nullptr : &kernel->argValues[i][0];
+        args[i].mem_host_ptr =
+            kernel->argMem[i] ? MemHostPtr(kernel->argMem[i]) : nullptr;
+    }
+    callback.fn(kernel->name.c_str(), work_dim, &offset[0], &global[0],
+                local.empty() ? nullptr : &local[0], (cl_uint)args.size(),
+                args.empty() ? nullptr : &args[0], callback.userData);
+}
+
+} // namespace
+
+//
+// Platform and device
+//
+
+NULL_ICD_EXPORT CL_API_ENTRY cl_int CL_API_CALL clIcdGetPlatformIDsKHR(
+    cl_uint num_entries, cl_platform_id *platforms, cl_uint *num_platforms)
+{
+    if ((num_entries == 0 && platforms) || (!platforms && !num_platforms))
+        return CL_INVALID_VALUE;
+    if (platforms) platforms[0] = &gPlatform;
+    if (num_platforms) *num_platforms = 1;
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetPlatformIDs(cl_uint num_entries,
+                                                 cl_platform_id *platforms,
+                                                 cl_uint *num_platforms)
+{
+    return clIcdGetPlatformIDsKHR(num_entries, platforms, num_platforms);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetPlatformInfo(
+    cl_platform_id platform, cl_platform_info param_name,
+    size_t param_value_size, void *param_value, size_t *param_value_size_ret)
+{
+    if (platform != &gPlatform) return CL_INVALID_PLATFORM;
+    switch (param_name)
+    {
+        case CL_PLATFORM_PROFILE:
+            return ReturnString("FULL_PROFILE", param_value_size, param_value,
+                                param_value_size_ret);
+        case CL_PLATFORM_VERSION:
+            return ReturnString(kVersion, param_value_size, param_value,
+                                param_value_size_ret);
+        case CL_PLATFORM_NAME:
+            return ReturnString(kPlatformName, param_value_size, param_value,
+                                param_value_size_ret);
+        case CL_PLATFORM_VENDOR:
+            return ReturnString(kVendor, param_value_size, param_value,
+                                param_value_size_ret);
+        case CL_PLATFORM_EXTENSIONS:
+            return ReturnString("cl_khr_icd", param_value_size, param_value,
+                                param_value_size_ret);
+        case CL_PLATFORM_ICD_SUFFIX_KHR:
+            return ReturnString("NULL", param_value_size, param_value,
+                                param_value_size_ret);
+        case CL_PLATFORM_HOST_TIMER_RESOLUTION:
+            return ReturnValue(cl_ulong(1), param_value_size, param_value,
+                               param_value_size_ret);
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetDeviceIDs(cl_platform_id platform,
+                                               cl_device_type device_type,
+                                               cl_uint num_entries,
+                                               cl_device_id *devices,
+                                               cl_uint *num_devices)
+{
+    if (platform && platform != &gPlatform) return CL_INVALID_PLATFORM;
+    if ((num_entries == 0 && devices) || (!devices && !num_devices))
+        return CL_INVALID_VALUE;
+    const cl_device_type matching = CL_DEVICE_TYPE_DEFAULT
+        | CL_DEVICE_TYPE_CPU | CL_DEVICE_TYPE_ALL;
+    if (!(device_type & matching))
+    {
+        if (num_devices) *num_devices = 0;
+        return CL_DEVICE_NOT_FOUND;
+    }
+    if (devices) devices[0] = &gDevice;
+    if (num_devices) *num_devices = 1;
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetDeviceInfo(cl_device_id device,
+                                                cl_device_info param_name,
+                                                size_t param_value_size,
+                                                void *param_value,
+                                                size_t *param_value_size_ret)
+{
+    if (device != &gDevice) return CL_INVALID_DEVICE;
+    size_t s = param_value_size;
+    void *v = param_value;
+    size_t *r = param_value_size_ret;
+    cl_uint computeUnits = std::max(std::thread::hardware_concurrency(), 1U);
+    switch (param_name)
+    {
+        case CL_DEVICE_TYPE:
+            return ReturnValue(cl_device_type(CL_DEVICE_TYPE_CPU), s, v, r);
+        case CL_DEVICE_VENDOR_ID: return ReturnValue(cl_uint(0), s, v, r);
+        case CL_DEVICE_MAX_COMPUTE_UNITS:
+            return ReturnValue(computeUnits, s, v, r);
+        case CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS:
+            return ReturnValue(cl_uint(3), s, v, r);
+        case CL_DEVICE_MAX_WORK_ITEM_SIZES: {
+            std::vector<size_t> sizes(3, kMaxWorkGroupSize);
+            return ReturnVector(sizes, s, v, r);
+        }
+        case CL_DEVICE_MAX_WORK_GROUP_SIZE:
+            return ReturnValue(kMaxWorkGroupSize, s, v, r);
+        case CL_DEVICE_PREFERRED_VECTOR_WIDTH_CHAR:
+        case CL_DEVICE_NATIVE_VECTOR_WIDTH_CHAR:
+            return ReturnValue(cl_uint(16), s, v, r);
+        case CL_DEVICE_PREFERRED_VECTOR_WIDTH_SHORT:
+        case CL_DEVICE_NATIVE_VECTOR_WIDTH_SHORT:
+            return ReturnValue(cl_uint(8), s, v, r);
+        case CL_DEVICE_PREFERRED_VECTOR_WIDTH_INT:
+        case CL_DEVICE_NATIVE_VECTOR_WIDTH_INT:
+        case CL_DEVICE_PREFERRED_VECTOR_WIDTH_FLOAT:
+        case CL_DEVICE_NATIVE_VECTOR_WIDTH_FLOAT:
+            return ReturnValue(cl_uint(4), s, v, r);
+        case CL_DEVICE_PREFERRED_VECTOR_WIDTH_LONG:
+        case CL_DEVICE_NATIVE_VECTOR_WIDTH_LONG:
+            return ReturnValue(cl_uint(2), s, v, r);
+        case CL_DEVICE_PREFERRED_VECTOR_WIDTH_DOUBLE:
+        case CL_DEVICE_NATIVE_VECTOR_WIDTH_DOUBLE:
+        case CL_DEVICE_PREFERRED_VECTOR_WIDTH_HALF:
+        case CL_DEVICE_NATIVE_VECTOR_WIDTH_HALF:
+            return ReturnValue(cl_uint(0), s, v, r);
+        case CL_DEVICE_MAX_CLOCK_FREQUENCY:
+            return ReturnValue(cl_uint(1000), s, v, r);
+        case CL_DEVICE_ADDRESS_BITS:
+            return ReturnValue(cl_uint(sizeof(void *) * 8), s, v, r);
+        case CL_DEVICE_MAX_READ_IMAGE_ARGS:
+            return ReturnValue(cl_uint(128), s, v, r);
+        case CL_DEVICE_MAX_WRITE_IMAGE_ARGS:
+            return ReturnValue(cl_uint(64), s, v, r);
+        case CL_DEVICE_MAX_MEM_ALLOC_SIZE:
+            return ReturnValue(cl_ulong(kMaxAllocSize), s, v, r);
+        case CL_DEVICE_IMAGE2D_MAX_WIDTH:
+        case CL_DEVICE_IMAGE2D_MAX_HEIGHT:
+            return ReturnValue(size_t(16384), s, v, r);
+        case CL_DEVICE_IMAGE3D_MAX_WIDTH:
+        case CL_DEVICE_IMAGE3D_MAX_HEIGHT:
+        case CL_DEVICE_IMAGE3D_MAX_DEPTH:
+        case CL_DEVICE_IMAGE_MAX_ARRAY_SIZE:
+            return ReturnValue(size_t(2048), s, v, r);
+        case CL_DEVICE_IMAGE_MAX_BUFFER_SIZE:
+            return ReturnValue(size_t(65536), s, v, r);
+        case CL_DEVICE_IMAGE_SUPPORT:
+        case CL_DEVICE_ENDIAN_LITTLE:
+        case CL_DEVICE_AVAILABLE:
+        case CL_DEVICE_COMPILER_AVAILABLE:
+        case CL_DEVICE_LINKER_AVAILABLE:
+        case CL_DEVICE_HOST_UNIFIED_MEMORY:
+        case CL_DEVICE_PREFERRED_INTEROP_USER_SYNC:
+            return ReturnValue(cl_bool(CL_TRUE), s, v, r);
+        case CL_DEVICE_ERROR_CORRECTION_SUPPORT:
+            return ReturnValue(cl_bool(CL_FALSE), s, v, r);
+        case CL_DEVICE_MAX_PARAMETER_SIZE:
+            return ReturnValue(size_t(1024), s, v, r);
+        case CL_DEVICE_MAX_SAMPLERS: return ReturnValue(cl_uint(16), s, v, r);
+        case CL_DEVICE_MEM_BASE_ADDR_ALIGN:
+            return ReturnValue(cl_uint(kStorageAlignment * 8), s, v, r);
+        case CL_DEVICE_MIN_DATA_TYPE_ALIGN_SIZE:
+            return ReturnValue(cl_uint(128), s, v, r);
+        case CL_DEVICE_SINGLE_FP_CONFIG:
+            return ReturnValue(
+                cl_device_fp_config(CL_FP_DENORM | CL_FP_INF_NAN
+                                    | CL_FP_ROUND_TO_NEAREST
+                                    | CL_FP_ROUND_TO_ZERO | CL_FP_ROUND_TO_INF
+                                    | CL_FP_FMA),
+                s, v, r);
+        case CL_DEVICE_DOUBLE_FP_CONFIG:
+            return ReturnValue(cl_device_fp_config(0), s, v, r);
+        case CL_DEVICE_GLOBAL_MEM_CACHE_TYPE:
+            return ReturnValue(cl_device_mem_cache_type(CL_READ_WRITE_CACHE), s,
+                               v, r);
+        case CL_DEVICE_GLOBAL_MEM_CACHELINE_SIZE:
+            return ReturnValue(cl_uint(64), s, v, r);
+        case CL_DEVICE_GLOBAL_MEM_CACHE_SIZE:
+            return ReturnValue(cl_ulong(1) << 20, s, v, r);
+        case CL_DEVICE_GLOBAL_MEM_SIZE:
+            return ReturnValue(kGlobalMemSize, s, v, r);
+        case CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE:
+            return ReturnValue(cl_ulong(64) << 10, s, v, r);
+        case CL_DEVICE_MAX_CONSTANT_ARGS:
+            return ReturnValue(cl_uint(8), s, v, r);
+        case CL_DEVICE_LOCAL_MEM_TYPE:
+            return ReturnValue(cl_device_local_mem_type(CL_GLOBAL), s, v, r);
+        case CL_DEVICE_LOCAL_MEM_SIZE:
+            return ReturnValue(cl_ulong(32) << 10, s, v, r);
+        case CL_DEVICE_PROFILING_TIMER_RESOLUTION:
+            return ReturnValue(size_t(1), s, v, r);
+        case CL_DEVICE_EXECUTION_CAPABILITIES:
+            return ReturnValue(
+                cl_device_exec_capabilities(CL_EXEC_KERNEL
+                                            | CL_EXEC_NATIVE_KERNEL),
+                s, v, r);
+        case CL_DEVICE_QUEUE_PROPERTIES:
+            return ReturnValue(
+                cl_command_queue_properties(
+                    CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE
+                    | CL_QUEUE_PROFILING_ENABLE),
+                s, v, r);
+        case CL_DEVICE_PLATFORM:
+            return ReturnValue(cl_platform_id(&gPlatform), s, v, r);
+        case CL_DEVICE_NAME: return ReturnString(kDeviceName, s, v, r);
+        case CL_DEVICE_VENDOR: return ReturnString(kVendor, s, v, r);
+        case CL_DRIVER_VERSION: return ReturnString("1.0", s, v, r);
+        case CL_DEVICE_PROFILE: return ReturnString("FULL_PROFILE", s, v, r);
+        case CL_DEVICE_VERSION: return ReturnString(kVersion, s, v, r);
+        case CL_DEVICE_OPENCL_C_VERSION:
+            return ReturnString("OpenCL C 1.2 ", s, v, r);
+        case CL_DEVICE_EXTENSIONS:
+        case CL_DEVICE_BUILT_IN_KERNELS: return ReturnString("", s, v, r);
+        case CL_DEVICE_PRINTF_BUFFER_SIZE:
+            return ReturnValue(size_t(1) << 20, s, v, r);
+        case CL_DEVICE_PARENT_DEVICE:
+            return ReturnValue(cl_device_id(nullptr), s, v, r);
+        case CL_DEVICE_PARTITION_MAX_SUB_DEVICES:
+            return ReturnValue(cl_uint(0), s, v, r);
+        case CL_DEVICE_PARTITION_PROPERTIES:
+            return ReturnValue(cl_device_partition_property(0), s, v, r);
+        case CL_DEVICE_PARTITION_AFFINITY_DOMAIN:
+            return ReturnValue(cl_device_affinity_domain(0), s, v, r);
+        case CL_DEVICE_PARTITION_TYPE:
+            return ReturnData(nullptr, 0, s, v, r);
+        case CL_DEVICE_REFERENCE_COUNT:
+            return ReturnValue(cl_uint(1), s, v, r);
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+CL_API_ENTRY cl_int CL_API_CALL
+clCreateSubDevices(cl_device_id in_device,
+                   const cl_device_partition_property *properties,
+                   cl_uint num_devices, cl_device_id *out_devices,
+                   cl_uint *num_devices_ret)
+{
+    if (in_device != &gDevice) return CL_INVALID_DEVICE;
+    return CL_INVALID_VALUE;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainDevice(cl_device_id device)
+{
+    return device == &gDevice ? CL_SUCCESS : CL_INVALID_DEVICE;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseDevice(cl_device_id device)
+{
+    return device == &gDevice ? CL_SUCCESS : CL_INVALID_DEVICE;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetDeviceAndHostTimer(
+    cl_device_id device, cl_ulong *device_timestamp, cl_ulong *host_timestamp)
+{
+    if (device != &gDevice) return CL_INVALID_DEVICE;
+    if (!device_timestamp || !host_timestamp) return CL_INVALID_VALUE;
+    *device_timestamp = *host_timestamp = NowNs();
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetHostTimer(cl_device_id device,
+                                               cl_ulong *host_timestamp)
+{
+    if (device != &gDevice) return CL_INVALID_DEVICE;
+    if (!host_timestamp) return CL_INVALID_VALUE;
+    *host_timestamp = NowNs();
+    return CL_SUCCESS;
+}
+
+//
+// Context
+//
+
+CL_API_ENTRY cl_context CL_API_CALL clCreateContext(
+    const cl_context_properties *properties, cl_uint num_devices,
+    const cl_device_id *devices,
+    void(CL_CALLBACK *pfn_notify)(const char *, const void *, size_t, void *),
+    void *user_data, cl_int *errcode_ret)
+{
+    if (num_devices == 0 || !devices)
+    {
+        SetError(errcode_ret, CL_INVALID_VALUE);
+        return nullptr;
+    }
+    for (cl_uint i = 0; i < num_devices; i++)
+        if (devices[i] != &gDevice)
+        {
+            SetError(errcode_ret, CL_INVALID_DEVICE);
+            return nullptr;
+        }
+    cl_context context = new _cl_context;
+    context->dispatch = &gDispatch;
+    context->refCount = 1;
+    context->properties = CopyProperties(properties);
+    SetError(errcode_ret, CL_SUCCESS);
+    return context;
+}
+
+CL_API_ENTRY cl_context CL_API_CALL clCreateContextFromType(
+    const cl_context_properties *properties, cl_device_type device_type,
+    void(CL_CALLBACK *pfn_notify)(const char *, const void *, size_t, void *),
+    void *user_data, cl_int *errcode_ret)
+{
+    cl_device_id device;
+    cl_int error = clGetDeviceIDs(nullptr, device_type, 1, &device, nullptr);
+    if (error != CL_SUCCESS)
+    {
+        SetError(errcode_ret, error);
+        return nullptr;
+    }
+    return clCreateContext(properties, 1, &device, pfn_notify, user_data,
+                           errcode_ret);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainContext(cl_context context)
+{
+    if (!context) return CL_INVALID_CONTEXT;
+    context->refCount++;
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseContext(cl_context context)
+{
+    if (!context) return CL_INVALID_CONTEXT;
+    if (--context->refCount == 0)
+    {
+        for (size_t i = context->destructorCallbacks.size(); i > 0; i--)
+            context->destructorCallbacks[i - 1].first(
+                context, context->destructorCallbacks[i - 1].second);
+        delete context;
+    }
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetContextInfo(cl_context context,
+                                                 cl_context_info param_name,
+                                                 size_t param_value_size,
+                                                 void *param_value,
+                                                 size_t *param_value_size_ret)
+{
+    if (!context) return CL_INVALID_CONTEXT;
+    switch (param_name)
+    {
+        case CL_CONTEXT_REFERENCE_COUNT:
+            return ReturnValue(cl_uint(context->refCount), param_value_size,
+                               param_value, param_value_size_ret);
+        case CL_CONTEXT_NUM_DEVICES:
+            return ReturnValue(cl_uint(1), param_value_size, param_value,
+                               param_value_size_ret);
+        case CL_CONTEXT_DEVICES:
+            return ReturnValue(cl_device_id(&gDevice), param_value_size,
+                               param_value, param_value_size_ret);
+        case CL_CONTEXT_PROPERTIES:
+            return ReturnVector(context->properties, param_value_size,
+                                param_value, param_value_size_ret);
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clSetContextDestructorCallback(
+    cl_context context,
+    void(CL_CALLBACK *pfn_notify)(cl_context context, void *user_data),
+    void *user_data)
+{
+    if (!context) return CL_INVALID_CONTEXT;
+    if (!pfn_notify) return CL_INVALID_VALUE;
+    context->destructorCallbacks.push_back(
+        std::make_pair(pfn_notify, user_data));
+    return CL_SUCCESS;
+}
+
+//
+// Command queue
+//
+
+CL_API_ENTRY cl_command_queue CL_API_CALL clCreateCommandQueueWithProperties(
+    cl_context context, cl_device_id device,
+    const cl_queue_properties *properties, cl_int *errcode_ret)
+{
+    if (!context)
+    {
+        SetError(errcode_ret, CL_INVALID_CONTEXT);
+        return nullptr;
+    }
+    if (device != &gDevice)
+    {
+        SetError(errcode_ret, CL_INVALID_DEVICE);
+        return nullptr;
+    }
+    cl_command_queue_properties queueProperties = 0;
+    for (const cl_queue_properties *p = properties; p && p[0]; p += 2)
+    {
+        if (p[0] == CL_QUEUE_PROPERTIES)
+            queueProperties = (cl_command_queue_properties)p[1];
+        else if (p[0] != CL_QUEUE_SIZE)
+        {
+            SetError(errcode_ret, CL_INVALID_VALUE);
+            return nullptr;
+        }
+    }
+    if (queueProperties
+        & ~(cl_command_queue_properties)(CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE
+                                         | CL_QUEUE_PROFILING_ENABLE))
+    {
+        SetError(errcode_ret, CL_INVALID_QUEUE_PROPERTIES);
+        return nullptr;
+    }
+    cl_command_queue queue = new _cl_command_queue;
+    queue->dispatch = &gDispatch;
+    queue->refCount = 1;
+    queue->context = context;
+    queue->properties = queueProperties;
+    queue->propertiesArray = CopyProperties(properties);
+    queue->lastBarrier = nullptr;
+    clRetainContext(context);
+    ApiLock lock;
+    gQueues.insert(queue);
+    SetError(errcode_ret, CL_SUCCESS);
+    return queue;
+}
+
+CL_API_ENTRY cl_command_queue CL_API_CALL
+clCreateCommandQueue(cl_context context, cl_device_id device,
+                     cl_command_queue_properties properties,
+                     cl_int *errcode_ret)
+{
+    cl_queue_properties queueProperties[] = { CL_QUEUE_PROPERTIES,
+                                              properties, 0 };
+    return clCreateCommandQueueWithProperties(
+        context, device, properties ? queueProperties : nullptr, errcode_ret);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainCommandQueue(cl_command_queue queue)
+{
+    if (!queue) return CL_INVALID_COMMAND_QUEUE;
+    queue->refCount++;
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clFinish(cl_command_queue queue)
+{
+    if (!queue) return CL_INVALID_COMMAND_QUEUE;
+    if (!WaitUntil([&] { return queue->pending.empty(); }))
+        return CL_INVALID_OPERATION;
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clFlush(cl_command_queue queue)
+{
+    return queue ? CL_SUCCESS : CL_INVALID_COMMAND_QUEUE;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseCommandQueue(cl_command_queue queue)
+{
+    if (!queue) return CL_INVALID_COMMAND_QUEUE;
+    if (queue->refCount == 1) clFinish(queue);
+    if (--queue->refCount == 0)
+    {
+        {
+            ApiLock lock;
+            gQueues.erase(queue);
+        }
+        if (queue->lastBarrier) clReleaseEvent(queue->lastBarrier);
+        clReleaseContext(queue->context);
+        delete queue;
+    }
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetCommandQueueInfo(
+    cl_command_queue queue, cl_command_queue_info param_name,
+    size_t param_value_size, void *param_value, size_t *param_value_size_ret)
+{
+    if (!queue) return CL_INVALID_COMMAND_QUEUE;
+    switch (param_name)
+    {
+        case CL_QUEUE_CONTEXT:
+            return ReturnValue(queue->context, param_value_size, param_value,
+                               param_value_size_ret);
+        case CL_QUEUE_DEVICE:
+            return ReturnValue(cl_device_id(&gDevice), param_value_size,
+                               param_value, param_value_size_ret);
+        case CL_QUEUE_REFERENCE_COUNT:
+            return ReturnValue(cl_uint(queue->refCount), param_value_size,
+                               param_value, param_value_size_ret);
+        case CL_QUEUE_PROPERTIES:
+            return ReturnValue(queue->properties, param_value_size,
+                               param_value, param_value_size_ret);
+        case CL_QUEUE_PROPERTIES_ARRAY:
+            return ReturnVector(queue->propertiesArray, param_value_size,
+                                param_value, param_value_size_ret);
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clSetDefaultDeviceCommandQueue(
+    cl_context context, cl_device_id device, cl_command_queue command_queue)
+{
+    return CL_INVALID_OPERATION;
+}
+
+//
+// Memory objects
+//
+
+CL_API_ENTRY cl_mem CL_API_CALL clCreateBuffer(cl_context context,
+                                               cl_mem_flags flags, size_t size,
+                                               void *host_ptr,
+                                               cl_int *errcode_ret)
+{
+    return CreateMemObject(context, nullptr, flags, CL_MEM_OBJECT_BUFFER, size,
+                           host_ptr, errcode_ret);
+}
+
+CL_API_ENTRY cl_mem CL_API_CALL clCreateBufferWithProperties(
+    cl_context context, const cl_mem_properties *properties, cl_mem_flags flags,
+    size_t size, void *host_ptr, cl_int *errcode_ret)
+{
+    return CreateMemObject(context, properties, flags, CL_MEM_OBJECT_BUFFER,
+                           size, host_ptr, errcode_ret);
+}
+
+CL_API_ENTRY cl_mem CL_API_CALL clCreateSubBuffer(
+    cl_mem buffer, cl_mem_flags flags, cl_buffer_create_type buffer_create_type,
+    const void *buffer_create_info, cl_int *errcode_ret)
+{
+    if (!buffer || buffer->type != CL_MEM_OBJECT_BUFFER || buffer->parent)
+    {
+        SetError(errcode_ret, CL_INVALID_MEM_OBJECT);
+        return nullptr;
+    }
+    const cl_buffer_region *region =
+        (const cl_buffer_region *)buffer_create_info;
+    if (buffer_create_type != CL_BUFFER_CREATE_TYPE_REGION || !region)
+    {
+        SetError(errcode_ret, CL_INVALID_VALUE);
+        return nullptr;
+    }
+    if (region->size == 0 || region->origin + region->size > buffer->size)
+    {
+        SetError(errcode_ret, CL_INVALID_BUFFER_SIZE);
+        return nullptr;
+    }
+    cl_mem mem = new _cl_mem;
+    mem->dispatch = &gDispatch;
+    mem->refCount = 1;
+    mem->context = buffer->context;
+    mem->type = CL_MEM_OBJECT_BUFFER;
+    mem->flags = flags ? flags : buffer->flags;
+    mem->size = region->size;
+    mem->hostPtr = buffer->hostPtr
+        ? (unsigned char *)buffer->hostPtr + region->origin
+        : nullptr;
+    mem->storage = buffer->storage + region->origin;
+    mem->ownsStorage = false;
+    mem->parent = buffer;
+    mem->offset = region->origin;
+    mem->mapCount = 0;
+    memset(&mem->format, 0, sizeof(mem->format));
+    memset(&mem->desc, 0, sizeof(mem->desc));
+    mem->elementSize = 1;
+    mem->rowPitch = 0;
+    mem->slicePitch = 0;
+    clRetainMemObject(buffer);
+    clRetainContext(mem->context);
+    ApiLock lock;
+    gMemObjects.insert(mem);
+    SetError(errcode_ret, CL_SUCCESS);
+    return mem;
+}
+
+CL_API_ENTRY cl_mem CL_API_CALL clCreateImage(
+    cl_context context, cl_mem_flags flags, const cl_image_format *image_format,
+    const cl_image_desc *image_desc, void *host_ptr, cl_int *errcode_ret)
+{
+    return CreateImage(context, nullptr, flags, image_format, image_desc,
+                       host_ptr, errcode_ret);
+}
+
+CL_API_ENTRY cl_mem CL_API_CALL clCreateImageWithProperties(
+    cl_context context, const cl_mem_properties *properties, cl_mem_flags flags,
+    const cl_image_format *image_format, const cl_image_desc *image_desc,
+    void *host_ptr, cl_int *errcode_ret)
+{
+    return CreateImage(context, properties, flags, image_format, image_desc,
+                       host_ptr, errcode_ret);
+}
+
+CL_API_ENTRY cl_mem CL_API_CALL clCreateImage2D(
+    cl_context context, cl_mem_flags flags, const cl_image_format *image_format,
+    size_t image_width, size_t image_height, size_t image_row_pitch,
+    void *host_ptr, cl_int *errcode_ret)
+{
+    cl_image_desc desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.image_type = CL_MEM_OBJECT_IMAGE2D;
+    desc.image_width = image_width;
+    desc.image_height = image_height;
+    desc.image_row_pitch = image_row_pitch;
+    return CreateImage(context, nullptr, flags, image_format, &desc, host_ptr,
+                       errcode_ret);
+}
+
+CL_API_ENTRY cl_mem CL_API_CALL clCreateImage3D(
+    cl_context context, cl_mem_flags flags, const cl_image_format *image_format,
+    size_t image_width, size_t image_height, size_t image_depth,
+    size_t image_row_pitch, size_t image_slice_pitch, void *host_ptr,
+    cl_int *errcode_ret)
+{
+    cl_image_desc desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.image_type = CL_MEM_OBJECT_IMAGE3D;
+    desc.image_width = image_width;
+    desc.image_height = image_height;
+    desc.image_depth = image_depth;
+    desc.image_row_pitch = image_row_pitch;
+    desc.image_slice_pitch = image_slice_pitch;
+    return CreateImage(context, nullptr, flags, image_format, &desc, host_ptr,
+                       errcode_ret);
+}
+
+CL_API_ENTRY cl_mem CL_API_CALL clCreatePipe(
+    cl_context context, cl_mem_flags flags, cl_uint pipe_packet_size,
+    cl_uint pipe_max_packets, const cl_pipe_properties *properties,
+    cl_int *errcode_ret)
+{
+    SetError(errcode_ret, CL_INVALID_OPERATION);
+    return nullptr;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetPipeInfo(cl_mem pipe,
+                                              cl_pipe_info param_name,
+                                              size_t param_value_size,
+                                              void *param_value,
+                                              size_t *param_value_size_ret)
+{
+    return CL_INVALID_MEM_OBJECT;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainMemObject(cl_mem memobj)
+{
+    if (!memobj) return CL_INVALID_MEM_OBJECT;
+    memobj->refCount++;
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseMemObject(cl_mem memobj)
+{
+    if (!memobj) return CL_INVALID_MEM_OBJECT;
+    if (--memobj->refCount == 0)
+    {
+        {
+            ApiLock lock;
+            gMemObjects.erase(memobj);
+        }
+        for (size_t i = memobj->destructorCallbacks.size(); i > 0; i--)
+            memobj->destructorCallbacks[i - 1].first(
+                memobj, memobj->destructorCallbacks[i - 1].second);
+        if (memobj->ownsStorage) AlignedFree(memobj->storage);
+        if (memobj->parent) clReleaseMemObject(memobj->parent);
+        clReleaseContext(memobj->context);
+        delete memobj;
+    }
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clSetMemObjectDestructorCallback(
+    cl_mem memobj, void(CL_CALLBACK *pfn_notify)(cl_mem memobj, void *user_data),
+    void *user_data)
+{
+    if (!memobj) return CL_INVALID_MEM_OBJECT;
+    if (!pfn_notify) return CL_INVALID_VALUE;
+    memobj->destructorCallbacks.push_back(
+        std::make_pair(pfn_notify, user_data));
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetSupportedImageFormats(
+    cl_context context, cl_mem_flags flags, cl_mem_object_type image_type,
+    cl_uint num_entries, cl_image_format *image_formats,
+    cl_uint *num_image_formats)
+{
+    if (!context) return CL_INVALID_CONTEXT;
+    if (num_entries == 0 && image_formats) return CL_INVALID_VALUE;
+    std::vector<cl_image_format> formats = SupportedImageFormats();
+    if (image_formats)
+        for (cl_uint i = 0; i < num_entries && i < formats.size(); i++)
+            image_formats[i] = formats[i];
+    if (num_image_formats) *num_image_formats = (cl_uint)formats.size();
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetMemObjectInfo(cl_mem memobj,
+                                                   cl_mem_info param_name,
+                                                   size_t param_value_size,
+                                                   void *param_value,
+                                                   size_t *param_value_size_ret)
+{
+    if (!memobj) return CL_INVALID_MEM_OBJECT;
+    size_t s = param_value_size;
+    void *v = param_value;
+    size_t *r = param_value_size_ret;
+    switch (param_name)
+    {
+        case CL_MEM_TYPE: return ReturnValue(memobj->type, s, v, r);
+        case CL_MEM_FLAGS: return ReturnValue(memobj->flags, s, v, r);
+        case CL_MEM_SIZE: return ReturnValue(memobj->size, s, v, r);
+        case CL_MEM_HOST_PTR: return ReturnValue(memobj->hostPtr, s, v, r);
+        case CL_MEM_MAP_COUNT: return ReturnValue(memobj->mapCount, s, v, r);
+        case CL_MEM_REFERENCE_COUNT:
+            return ReturnValue(cl_uint(memobj->refCount), s, v, r);
+        case CL_MEM_CONTEXT: return ReturnValue(memobj->context, s, v, r);
+        case CL_MEM_ASSOCIATED_MEMOBJECT:
+            return ReturnValue(memobj->parent, s, v, r);
+        case CL_MEM_OFFSET: return ReturnValue(memobj->offset, s, v, r);
+        case CL_MEM_USES_SVM_POINTER:
+            return ReturnValue(cl_bool(CL_FALSE), s, v, r);
+        case CL_MEM_PROPERTIES:
+            return ReturnVector(memobj->properties, s, v, r);
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetImageInfo(cl_mem image,
+                                               cl_image_info param_name,
+                                               size_t param_value_size,
+                                               void *param_value,
+                                               size_t *param_value_size_ret)
+{
+    if (!IsImage(image)) return CL_INVALID_MEM_OBJECT;
+    size_t s = param_value_size;
+    void *v = param_value;
+    size_t *r = param_value_size_ret;
+    switch (param_name)
+    {
+        case CL_IMAGE_FORMAT: return ReturnValue(image->format, s, v, r);
+        case CL_IMAGE_ELEMENT_SIZE:
+            return ReturnValue(image->elementSize, s, v, r);
+        case CL_IMAGE_ROW_PITCH: return ReturnValue(image->rowPitch, s, v, r);
+        case CL_IMAGE_SLICE_PITCH:
+            return ReturnValue(image->type == CL_MEM_OBJECT_IMAGE3D
+                                       || image->type
+                                           == CL_MEM_OBJECT_IMAGE1D_ARRAY
+                                       || image->type
+                                           == CL_MEM_OBJECT_IMAGE2D_ARRAY
+                                   ? image->slicePitch
+                                   : size_t(0),
+                               s, v, r);
+        case CL_IMAGE_WIDTH:
+            return ReturnValue(image->desc.image_width, s, v, r);
+        case CL_IMAGE_HEIGHT:
+            return ReturnValue(image->desc.image_height, s, v, r);
+        case CL_IMAGE_DEPTH:
+            return ReturnValue(image->desc.image_depth, s, v, r);
+        case CL_IMAGE_ARRAY_SIZE:
+            return ReturnValue(image->desc.image_array_size, s, v, r);
+        case CL_IMAGE_BUFFER: return ReturnValue(image->desc.buffer, s, v, r);
+        case CL_IMAGE_NUM_MIP_LEVELS:
+        case CL_IMAGE_NUM_SAMPLES: return ReturnValue(cl_uint(0), s, v, r);
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+CL_API_ENTRY void *CL_API_CALL clSVMAlloc(cl_context context,
+                                          cl_svm_mem_flags flags, size_t size,
+                                          cl_uint alignment)
+{
+    if (!context || size == 0 || size > kMaxAllocSize) return nullptr;
+    void *ptr = AlignedAlloc(size);
+    ApiLock lock;
+    if (ptr) gSVMAllocations[ptr] = size;
+    return ptr;
+}
+
+CL_API_ENTRY void CL_API_CALL clSVMFree(cl_context context, void *svm_pointer)
+{
+    if (!svm_pointer) return;
+    ApiLock lock;
+    gSVMAllocations.erase(svm_pointer);
+    AlignedFree(svm_pointer);
+}
+
+//
+// Samplers
+//
+
+CL_API_ENTRY cl_sampler CL_API_CALL clCreateSamplerWithProperties(
+    cl_context context, const cl_sampler_properties *sampler_properties,
+    cl_int *errcode_ret)
+{
+    if (!context)
+    {
+        SetError(errcode_ret, CL_INVALID_CONTEXT);
+        return nullptr;
+    }
+    cl_sampler sampler = new _cl_sampler;
+    sampler->dispatch = &gDispatch;
+    sampler->refCount = 1;
+    sampler->context = context;
+    sampler->normalizedCoords = CL_TRUE;
+    sampler->addressingMode = CL_ADDRESS_CLAMP;
+    sampler->filterMode = CL_FILTER_NEAREST;
+    sampler->properties = CopyProperties(sampler_properties);
+    for (const cl_sampler_properties *p = sampler_properties; p && p[0];
+         p += 2)
+    {
+        if (p[0] == CL_SAMPLER_NORMALIZED_COORDS)
+            sampler->normalizedCoords = (cl_bool)p[1];
+        else if (p[0] == CL_SAMPLER_ADDRESSING_MODE)
+            sampler->addressingMode = (cl_addressing_mode)p[1];
+        else if (p[0] == CL_SAMPLER_FILTER_MODE)
+            sampler->filterMode = (cl_filter_mode)p[1];
+    }
+    clRetainContext(context);
+    SetError(errcode_ret, CL_SUCCESS);
+    return sampler;
+}
+
+CL_API_ENTRY cl_sampler CL_API_CALL clCreateSampler(
+    cl_context context, cl_bool normalized_coords,
+    cl_addressing_mode addressing_mode, cl_filter_mode filter_mode,
+    cl_int *errcode_ret)
+{
+    cl_sampler_properties properties[] = { CL_SAMPLER_NORMALIZED_COORDS,
+                                           normalized_coords,
+                                           CL_SAMPLER_ADDRESSING_MODE,
+                                           addressing_mode,
+                                           CL_SAMPLER_FILTER_MODE,
+                                           filter_mode,
+                                           0 };
+    return clCreateSamplerWithProperties(context, properties, errcode_ret);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainSampler(cl_sampler sampler)
+{
+    if (!sampler) return CL_INVALID_SAMPLER;
+    sampler->refCount++;
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseSampler(cl_sampler sampler)
+{
+    if (!sampler) return CL_INVALID_SAMPLER;
+    if (--sampler->refCount == 0)
+    {
+        clReleaseContext(sampler->context);
+        delete sampler;
+    }
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetSamplerInfo(cl_sampler sampler,
+                                                 cl_sampler_info param_name,
+                                                 size_t param_value_size,
+                                                 void *param_value,
+                                                 size_t *param_value_size_ret)
+{
+    if (!sampler) return CL_INVALID_SAMPLER;
+    size_t s = param_value_size;
+    void *v = param_value;
+    size_t *r = param_value_size_ret;
+    switch (param_name)
+    {
+        case CL_SAMPLER_REFERENCE_COUNT:
+            return ReturnValue(cl_uint(sampler->refCount), s, v, r);
+        case CL_SAMPLER_CONTEXT: return ReturnValue(sampler->context, s, v, r);
+        case CL_SAMPLER_NORMALIZED_COORDS:
+            return ReturnValue(sampler->normalizedCoords, s, v, r);
+        case CL_SAMPLER_ADDRESSING_MODE:
+            return ReturnValue(sampler->addressingMode, s, v, r);
+        case CL_SAMPLER_FILTER_MODE:
+            return ReturnValue(sampler->filterMode, s, v, r);
+        case CL_SAMPLER_PROPERTIES:
+            return ReturnVector(sampler->properties, s, v, r);
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+//
+// Programs
+//
+
+CL_API_ENTRY cl_program CL_API_CALL
+clCreateProgramWithSource(cl_context context, cl_uint count,
+                          const char **strings, const size_t *lengths,
+                          cl_int *errcode_ret)
+{
+    if (count == 0 || !strings)
+    {
+        SetError(errcode_ret, CL_INVALID_VALUE);
+        return nullptr;
+    }
+    std::string source;
+    for (cl_uint i = 0; i < count; i++)
+    {
+        if (!strings[i])
+        {
+            SetError(errcode_ret, CL_INVALID_VALUE);
+            return nullptr;
+        }
+        if (lengths && lengths[i])
+            source.append(strings[i], lengths[i]);
+        else
+            source.append(strings[i]);
+    }
+    return CreateProgram(context, source, CL_PROGRAM_BINARY_TYPE_NONE,
+                         errcode_ret);
+}
+
+CL_API_ENTRY cl_program CL_API_CALL clCreateProgramWithBinary(
+    cl_context context, cl_uint num_devices, const cl_device_id *device_list,
+    const size_t *lengths, const unsigned char **binaries,
+    cl_int *binary_status, cl_int *errcode_ret)
+{
+    if (num_devices == 0 || !device_list || !lengths || !binaries)
+    {
+        SetError(errcode_ret, CL_INVALID_VALUE);
+        return nullptr;
+    }
+    // Binaries returned by this implementation are the program source
+    std::string source((const char *)binaries[0], lengths[0]);
+    for (cl_uint i = 0; i < num_devices && binary_status; i++)
+        binary_status[i] = CL_SUCCESS;
+    return CreateProgram(context, source, CL_PROGRAM_BINARY_TYPE_EXECUTABLE,
+                         errcode_ret);
+}
+
+CL_API_ENTRY cl_program CL_API_CALL clCreateProgramWithIL(cl_context context,
+                                                          const void *il,
+                                                          size_t length,
+                                                          cl_int *errcode_ret)
+{
+    if (!il || length == 0)
+    {
+        SetError(errcode_ret, CL_INVALID_VALUE);
+        return nullptr;
+    }
+    return CreateProgram(context, std::string(), CL_PROGRAM_BINARY_TYPE_NONE,
+                         errcode_ret);
+}
+
+CL_API_ENTRY cl_program CL_API_CALL clCreateProgramWithBuiltInKernels(
+    cl_context context, cl_uint num_devices, const cl_device_id *device_list,
+    const char *kernel_names, cl_int *errcode_ret)
+{
+    SetError(errcode_ret, CL_INVALID_VALUE);
+    return nullptr;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainProgram(cl_program program)
+{
+    if (!program) return CL_INVALID_PROGRAM;
+    program->refCount++;
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseProgram(cl_program program)
+{
+    if (!program) return CL_INVALID_PROGRAM;
+    if (--program->refCount == 0)
+    {
+        for (size_t i = program->releaseCallbacks.size(); i > 0; i--)
+            program->releaseCallbacks[i - 1].first(
+                program, program->releaseCallbacks[i - 1].second);
+        clReleaseContext(program->context);
+        delete program;
+    }
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clBuildProgram(
+    cl_program program, cl_uint num_devices, const cl_device_id *device_list,
+    const char *options,
+    void(CL_CALLBACK *pfn_notify)(cl_program program, void *user_data),
+    void *user_data)
+{
+    if (!program) return CL_INVALID_PROGRAM;
+    program->options = options ? options : "";
+    program->buildStatus = CL_BUILD_SUCCESS;
+    program->binaryType = CL_PROGRAM_BINARY_TYPE_EXECUTABLE;
+    if (pfn_notify) pfn_notify(program, user_data);
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clCompileProgram(
+    cl_program program, cl_uint num_devices, const cl_device_id *device_list,
+    const char *options, cl_uint num_input_headers,
+    const cl_program *input_headers, const char **header_include_names,
+    void(CL_CALLBACK *pfn_notify)(cl_program program, void *user_data),
+    void *user_data)
+{
+    if (!program) return CL_INVALID_PROGRAM;
+    program->options = options ? options : "";
+    program->buildStatus = CL_BUILD_SUCCESS;
+    program->binaryType = CL_PROGRAM_BINARY_TYPE_COMPILED_OBJECT;
+    if (pfn_notify) pfn_notify(program, user_data);
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_program CL_API_CALL clLinkProgram(
+    cl_context context, cl_uint num_devices, const cl_device_id *device_list,
+    const char *options, cl_uint num_input_programs,
+    const cl_program *input_programs,
+    void(CL_CALLBACK *pfn_notify)(cl_program program, void *user_data),
+    void *user_data, cl_int *errcode_ret)
+{
+    if (num_input_programs == 0 || !input_programs)
+    {
+        SetError(errcode_ret, CL_INVALID_VALUE);
+        return nullptr;
+    }
+    std::string source;
+    for (cl_uint i = 0; i < num_input_programs; i++)
+    {
+        if (!input_programs[i])
+        {
+            SetError(errcode_ret, CL_INVALID_PROGRAM);
+            return nullptr;
+        }
+        source += input_programs[i]->source;
+    }
+    bool library = options && strstr(options, "-create-library");
+    cl_program program = CreateProgram(
+        context, source,
+        library ? CL_PROGRAM_BINARY_TYPE_LIBRARY
+                : CL_PROGRAM_BINARY_TYPE_EXECUTABLE,
+        errcode_ret);
+    if (!program) return nullptr;
+    program->options = options ? options : "";
+    program->buildStatus = CL_BUILD_SUCCESS;
+    if (pfn_notify) pfn_notify(program, user_data);
+    return program;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clUnloadPlatformCompiler(cl_platform_id platform)
+{
+    return platform == &gPlatform ? CL_SUCCESS : CL_INVALID_PLATFORM;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clUnloadCompiler(void) { return CL_SUCCESS; }
+
+CL_API_ENTRY cl_int CL_API_CALL clSetProgramReleaseCallback(
+    cl_program program,
+    void(CL_CALLBACK *pfn_notify)(cl_program program, void *user_data),
+    void *user_data)
+{
+    if (!program) return CL_INVALID_PROGRAM;
+    if (!pfn_notify) return CL_INVALID_VALUE;
+    program->releaseCallbacks.push_back(std::make_pair(pfn_notify, user_data));
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clSetProgramSpecializationConstant(
+    cl_program program, cl_uint spec_id, size_t spec_size,
+    const void *spec_value)
+{
+    return program ? CL_INVALID_OPERATION : CL_INVALID_PROGRAM;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetProgramInfo(cl_program program,
+                                                 cl_program_info param_name,
+                                                 size_t param_value_size,
+                                                 void *param_value,
+                                                 size_t *param_value_size_ret)
+{
+    if (!program) return CL_INVALID_PROGRAM;
+    size_t s = param_value_size;
+    void *v = param_value;
+    size_t *r = param_value_size_ret;
+    switch (param_name)
+    {
+        case CL_PROGRAM_REFERENCE_COUNT:
+            return ReturnValue(cl_uint(program->refCount), s, v, r);
+        case CL_PROGRAM_CONTEXT: return ReturnValue(program->context, s, v, r);
+        case CL_PROGRAM_NUM_DEVICES: return ReturnValue(cl_uint(1), s, v, r);
+        case CL_PROGRAM_DEVICES:
+            return ReturnValue(cl_device_id(&gDevice), s, v, r);
+        case CL_PROGRAM_SOURCE: return ReturnString(program->source, s, v, r);
+        case CL_PROGRAM_IL: return ReturnData(nullptr, 0, s, v, r);
+        case CL_PROGRAM_BINARY_SIZES:
+            return ReturnValue(program->source.size(), s, v, r);
+        case CL_PROGRAM_BINARIES: {
+            if (v)
+            {
+                if (s < sizeof(unsigned char *)) return CL_INVALID_VALUE;
+                unsigned char *binary = ((unsigned char **)v)[0];
+                if (binary && !program->source.empty())
+                    memcpy(binary, program->source.data(),
+                           program->source.size());
+            }
+            if (r) *r = sizeof(unsigned char *);
+            return CL_SUCCESS;
+        }
+        case CL_PROGRAM_NUM_KERNELS:
+            return ReturnValue(program->kernels.size(), s, v, r);
+        case CL_PROGRAM_KERNEL_NAMES: {
+            std::string names;
+            for (std::map<std::string, cl_uint>::const_iterator it =
+                     program->kernels.begin();
+                 it != program->kernels.end(); ++it)
+            {
+                if (!names.empty()) names += ";";
+                names += it->first;
+            }
+            return ReturnString(names, s, v, r);
+        }
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetProgramBuildInfo(
+    cl_program program, cl_device_id device, cl_program_build_info param_name,
+    size_t param_value_size, void *param_value, size_t *param_value_size_ret)
+{
+    if (!program) return CL_INVALID_PROGRAM;
+    if (device != &gDevice) return CL_INVALID_DEVICE;
+    size_t s = param_value_size;
+    void *v = param_value;
+    size_t *r = param_value_size_ret;
+    switch (param_name)
+    {
+        case CL_PROGRAM_BUILD_STATUS:
+            return ReturnValue(program->buildStatus, s, v, r);
+        case CL_PROGRAM_BUILD_OPTIONS:
+            return ReturnString(program->options, s, v, r);
+        case CL_PROGRAM_BUILD_LOG: return ReturnString("", s, v, r);
+        case CL_PROGRAM_BINARY_TYPE:
+            return ReturnValue(program->binaryType, s, v, r);
+        case CL_PROGRAM_BUILD_GLOBAL_VARIABLE_TOTAL_SIZE:
+            return ReturnValue(size_t(0), s, v, r);
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+//
+// Kernels
+//
+
+CL_API_ENTRY cl_kernel CL_API_CALL clCreateKernel(cl_program program,
+                                                  const char *kernel_name,
+                                                  cl_int *errcode_ret)
+{
+    if (!program)
+    {
+        SetError(errcode_ret, CL_INVALID_PROGRAM);
+        return nullptr;
+    }
+    if (!kernel_name)
+    {
+        SetError(errcode_ret, CL_INVALID_VALUE);
+        return nullptr;
+    }
+    SetError(errcode_ret, CL_SUCCESS);
+    return CreateKernel(program, kernel_name);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clCreateKernelsInProgram(
+    cl_program program, cl_uint num_kernels, cl_kernel *kernels,
+    cl_uint *num_kernels_ret)
+{
+    if (!program) return CL_INVALID_PROGRAM;
+    if (kernels && num_kernels < program->kernels.size())
+        return CL_INVALID_VALUE;
+    if (kernels)
+    {
+        cl_uint i = 0;
+        for (std::map<std::string, cl_uint>::const_iterator it =
+                 program->kernels.begin();
+             it != program->kernels.end(); ++it)
+            kernels[i++] = CreateKernel(program, it->first);
+    }
+    if (num_kernels_ret) *num_kernels_ret = (cl_uint)program->kernels.size();
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_kernel CL_API_CALL clCloneKernel(cl_kernel source_kernel,
+                                                 cl_int *errcode_ret)
+{
+    if (!source_kernel)
+    {
+        SetError(errcode_ret, CL_INVALID_KERNEL);
+        return nullptr;
+    }
+    cl_kernel kernel = CreateKernel(source_kernel->program, source_kernel->name);
+    kernel->numArgs = source_kernel->numArgs;
+    kernel->argValues = source_kernel->argValues;
+    kernel->argSizes = source_kernel->argSizes;
+    kernel->argIsSet = source_kernel->argIsSet;
+    kernel->argMem = source_kernel->argMem;
+    SetError(errcode_ret, CL_SUCCESS);
+    return kernel;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainKernel(cl_kernel kernel)
+{
+    if (!kernel) return CL_INVALID_KERNEL;
+    kernel->refCount++;
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseKernel(cl_kernel kernel)
+{
+    if (!kernel) return CL_INVALID_KERNEL;
+    if (--kernel->refCount == 0)
+    {
+        clReleaseProgram(kernel->program);
+        delete kernel;
+    }
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clSetKernelArg(cl_kernel kernel,
+                                               cl_uint arg_index,
+                                               size_t arg_size,
+                                               const void *arg_value)
+{
+    if (!kernel) return CL_INVALID_KERNEL;
+    if (kernel->numArgs && arg_index >= kernel->numArgs)
+        return CL_INVALID_ARG_INDEX;
+    if (arg_index >= kernel->argValues.size())
+    {
+        kernel->argValues.resize(arg_index + 1);
+        kernel->argSizes.resize(arg_index + 1, 0);
+        kernel->argIsSet.resize(arg_index + 1, false);
+        kernel->argMem.resize(arg_index + 1, nullptr);
+    }
+    const unsigned char *value = (const unsigned char *)arg_value;
+    kernel->argValues[arg_index].assign(value, value ? value + arg_size : value);
+    kernel->argSizes[arg_index] = arg_size;
+    kernel->argIsSet[arg_index] = true;
+    kernel->argMem[arg_index] = nullptr;
+    if (value && arg_size == sizeof(cl_mem))
+    {
+        cl_mem mem = *(const cl_mem *)arg_value;
+        ApiLock lock;
+        if (gMemObjects.count(mem)) kernel->argMem[arg_index] = mem;
+    }
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clSetKernelArgSVMPointer(cl_kernel kernel,
+                                                         cl_uint arg_index,
+                                                         const void *arg_value)
+{
+    return clSetKernelArg(kernel, arg_index, sizeof(arg_value), &arg_value);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clSetKernelExecInfo(cl_kernel kernel,
+                                                    cl_kernel_exec_info param_name,
+                                                    size_t param_value_size,
+                                                    const void *param_value)
+{
+    return kernel ? CL_SUCCESS : CL_INVALID_KERNEL;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetKernelInfo(cl_kernel kernel,
+                                                cl_kernel_info param_name,
+                                                size_t param_value_size,
+                                                void *param_value,
+                                                size_t *param_value_size_ret)
+{
+    if (!kernel) return CL_INVALID_KERNEL;
+    size_t s = param_value_size;
+    void *v = param_value;
+    size_t *r = param_value_size_ret;
+    switch (param_name)
+    {
+        case CL_KERNEL_FUNCTION_NAME: return ReturnString(kernel->name, s, v, r);
+        case CL_KERNEL_NUM_ARGS:
+            return ReturnValue(
+                std::max(kernel->numArgs, (cl_uint)kernel->argValues.size()), s,
+                v, r);
+        case CL_KERNEL_REFERENCE_COUNT:
+            return ReturnValue(cl_uint(kernel->refCount), s, v, r);
+        case CL_KERNEL_CONTEXT:
+            return ReturnValue(kernel->program->context, s, v, r);
+        case CL_KERNEL_PROGRAM: return ReturnValue(kernel->program, s, v, r);
+        case CL_KERNEL_ATTRIBUTES: return ReturnString("", s, v, r);
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetKernelArgInfo(
+    cl_kernel kernel, cl_uint arg_index, cl_kernel_arg_info param_name,
+    size_t param_value_size, void *param_value, size_t *param_value_size_ret)
+{
+    return kernel ? CL_KERNEL_ARG_INFO_NOT_AVAILABLE : CL_INVALID_KERNEL;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetKernelWorkGroupInfo(
+    cl_kernel kernel, cl_device_id device, cl_kernel_work_group_info param_name,
+    size_t param_value_size, void *param_value, size_t *param_value_size_ret)
+{
+    if (!kernel) return CL_INVALID_KERNEL;
+    if (device && device != &gDevice) return CL_INVALID_DEVICE;
+    size_t s = param_value_size;
+    void *v = param_value;
+    size_t *r = param_value_size_ret;
+    switch (param_name)
+    {
+        case CL_KERNEL_WORK_GROUP_SIZE:
+            return ReturnValue(kMaxWorkGroupSize, s, v, r);
+        case CL_KERNEL_COMPILE_WORK_GROUP_SIZE: {
+            std::vector<size_t> sizes(3, 0);
+            return ReturnVector(sizes, s, v, r);
+        }
+        case CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE:
+            return ReturnValue(size_t(1), s, v, r);
+        case CL_KERNEL_LOCAL_MEM_SIZE:
+        case CL_KERNEL_PRIVATE_MEM_SIZE:
+            return ReturnValue(cl_ulong(0), s, v, r);
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetKernelSubGroupInfo(
+    cl_kernel kernel, cl_device_id device, cl_kernel_sub_group_info param_name,
+    size_t input_value_size, const void *input_value, size_t param_value_size,
+    void *param_value, size_t *param_value_size_ret)
+{
+    return kernel ? CL_INVALID_OPERATION : CL_INVALID_KERNEL;
+}
+
+//
+// Events
+//
+
+CL_API_ENTRY cl_int CL_API_CALL clWaitForEvents(cl_uint num_events,
+                                                const cl_event *event_list)
+{
+    if (num_events == 0 || !event_list) return CL_INVALID_VALUE;
+    cl_int result = CL_SUCCESS;
+    for (cl_uint i = 0; i < num_events; i++)
+    {
+        if (!event_list[i]) return CL_INVALID_EVENT;
+        cl_int error = WaitForEvent(event_list[i]);
+        if (error == CL_INVALID_OPERATION) return error;
+        if (error != CL_SUCCESS)
+            result = CL_EXEC_STATUS_ERROR_FOR_EVENTS_IN_WAIT_LIST;
+    }
+    return result;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetEventInfo(cl_event event,
+                                               cl_event_info param_name,
+                                               size_t param_value_size,
+                                               void *param_value,
+                                               size_t *param_value_size_ret)
+{
+    if (!event) return CL_INVALID_EVENT;
+    size_t s = param_value_size;
+    void *v = param_value;
+    size_t *r = param_value_size_ret;
+    ApiLock lock;
+    switch (param_name)
+    {
+        case CL_EVENT_COMMAND_QUEUE: return ReturnValue(event->queue, s, v, r);
+        case CL_EVENT_CONTEXT: return ReturnValue(event->context, s, v, r);
+        case CL_EVENT_COMMAND_TYPE:
+            return ReturnValue(event->commandType, s, v, r);
+        case CL_EVENT_COMMAND_EXECUTION_STATUS:
+            return ReturnValue(event->status, s, v, r);
+        case CL_EVENT_REFERENCE_COUNT:
+            return ReturnValue(cl_uint(event->refCount), s, v, r);
+        default: return CL_INVALID_VALUE;
+    }
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetEventProfilingInfo(
+    cl_event event, cl_profiling_info param_name, size_t param_value_size,
+    void *param_value, size_t *param_value_size_ret)
+{
+    if (!event) return CL_INVALID_EVENT;
+    if (!event->queue
+        || !(event->queue->properties & CL_QUEUE_PROFILING_ENABLE))
+        return CL_PROFILING_INFO_NOT_AVAILABLE;
+    ApiLock lock;
+    if (!IsEventDone(event)) return CL_PROFILING_INFO_NOT_AVAILABLE;
+    size_t index;
+    switch (param_name)
+    {
+        case CL_PROFILING_COMMAND_QUEUED: index = 0; break;
+        case CL_PROFILING_COMMAND_SUBMIT: index = 1; break;
+        case CL_PROFILING_COMMAND_START: index = 2; break;
+        case CL_PROFILING_COMMAND_END:
+        case CL_PROFILING_COMMAND_COMPLETE: index = 3; break;
+        default: return CL_INVALID_VALUE;
+    }
+    return ReturnValue(event->timestamps[index], param_value_size, param_value,
+                       param_value_size_ret);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clRetainEvent(cl_event event)
+{
+    if (!event) return CL_INVALID_EVENT;
+    event->refCount++;
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseEvent(cl_event event)
+{
+    if (!event) return CL_INVALID_EVENT;
+    if (--event->refCount == 0)
+    {
+        if (event->queue) clReleaseCommandQueue(event->queue);
+        clReleaseContext(event->context);
+        delete event;
+    }
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_event CL_API_CALL clCreateUserEvent(cl_context context,
+                                                    cl_int *errcode_ret)
+{
+    if (!context)
+    {
+        SetError(errcode_ret, CL_INVALID_CONTEXT);
+        return nullptr;
+    }
+    cl_event event = CreateEvent(context, nullptr, CL_COMMAND_USER);
+    event->status = CL_SUBMITTED;
+    SetError(errcode_ret, CL_SUCCESS);
+    return event;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clSetUserEventStatus(cl_event event,
+                                                     cl_int execution_status)
+{
+    if (!event || event->commandType != CL_COMMAND_USER)
+        return CL_INVALID_EVENT;
+    if (execution_status > CL_COMPLETE) return CL_INVALID_VALUE;
+    ApiLock lock;
+    if (IsEventDone(event)) return CL_INVALID_OPERATION;
+    SetEventStatus(event, execution_status);
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clSetEventCallback(
+    cl_event event, cl_int command_exec_callback_type,
+    void(CL_CALLBACK *pfn_notify)(cl_event event, cl_int event_command_status,
+                                  void *user_data),
+    void *user_data)
+{
+    if (!event) return CL_INVALID_EVENT;
+    if (!pfn_notify
+        || (command_exec_callback_type != CL_COMPLETE
+            && command_exec_callback_type != CL_SUBMITTED
+            && command_exec_callback_type != CL_RUNNING))
+        return CL_INVALID_VALUE;
+    ApiLock lock;
+    // Callbacks for states the event has already reached are called right away
+    if (event->status <= command_exec_callback_type)
+        QueueEventCallback(pfn_notify, event, event->status, user_data);
+    else
+        event->callbacks.push_back(std::make_pair(
+            pfn_notify, std::make_pair(command_exec_callback_type, user_data)));
+    return CL_SUCCESS;
+}
+
+//
+// Enqueued commands
+//
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueReadBuffer(
+    cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_read,
+    size_t offset, size_t size, void *ptr, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event)
+{
+    if (!buffer || buffer->type != CL_MEM_OBJECT_BUFFER)
+        return CL_INVALID_MEM_OBJECT;
+    if (!ptr || offset + size > buffer->size) return CL_INVALID_VALUE;
+    unsigned char *src = MemHostPtr(buffer) + offset;
+    return Enqueue(
+        command_queue, CL_COMMAND_READ_BUFFER, num_events_in_wait_list,
+        event_wait_list, event, [=] { memcpy(ptr, src, size); }, blocking_read);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueWriteBuffer(
+    cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_write,
+    size_t offset, size_t size, const void *ptr,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event)
+{
+    if (!buffer || buffer->type != CL_MEM_OBJECT_BUFFER)
+        return CL_INVALID_MEM_OBJECT;
+    if (!ptr || offset + size > buffer->size) return CL_INVALID_VALUE;
+    unsigned char *dst = MemHostPtr(buffer) + offset;
+    return Enqueue(command_queue, CL_COMMAND_WRITE_BUFFER,
+                   num_events_in_wait_list, event_wait_list, event,
+                   [=] { memcpy(dst, ptr, size); }, blocking_write);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueReadBufferRect(
+    cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_read,
+    const size_t *buffer_origin, const size_t *host_origin,
+    const size_t *region, size_t buffer_row_pitch, size_t buffer_slice_pitch,
+    size_t host_row_pitch, size_t host_slice_pitch, void *ptr,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event)
+{
+    if (!buffer || buffer->type != CL_MEM_OBJECT_BUFFER)
+        return CL_INVALID_MEM_OBJECT;
+    if (!ptr || !buffer_origin || !host_origin || !region)
+        return CL_INVALID_VALUE;
+    if (!buffer_row_pitch) buffer_row_pitch = region[0];
+    if (!buffer_slice_pitch) buffer_slice_pitch = region[1] * buffer_row_pitch;
+    if (!host_row_pitch) host_row_pitch = region[0];
+    if (!host_slice_pitch) host_slice_pitch = region[1] * host_row_pitch;
+    unsigned char *src = MemHostPtr(buffer);
+    std::vector<size_t> bo(buffer_origin, buffer_origin + 3),
+        ho(host_origin, host_origin + 3), rg(region, region + 3);
+    return Enqueue(
+        command_queue, CL_COMMAND_READ_BUFFER_RECT, num_events_in_wait_list,
+        event_wait_list, event,
+        [=] {
+            CopyRect((unsigned char *)ptr, &ho[0], host_row_pitch,
+                     host_slice_pitch, src, &bo[0], buffer_row_pitch,
+                     buffer_slice_pitch, &rg[0]);
+        },
+        blocking_read);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueWriteBufferRect(
+    cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_write,
+    const size_t *buffer_origin, const size_t *host_origin,
+    const size_t *region, size_t buffer_row_pitch, size_t buffer_slice_pitch,
+    size_t host_row_pitch, size_t host_slice_pitch, const void *ptr,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event)
+{
+    if (!buffer || buffer->type != CL_MEM_OBJECT_BUFFER)
+        return CL_INVALID_MEM_OBJECT;
+    if (!ptr || !buffer_origin || !host_origin || !region)
+        return CL_INVALID_VALUE;
+    if (!buffer_row_pitch) buffer_row_pitch = region[0];
+    if (!buffer_slice_pitch) buffer_slice_pitch = region[1] * buffer_row_pitch;
+    if (!host_row_pitch) host_row_pitch = region[0];
+    if (!host_slice_pitch) host_slice_pitch = region[1] * host_row_pitch;
+    unsigned char *dst = MemHostPtr(buffer);
+    std::vector<size_t> bo(buffer_origin, buffer_origin + 3),
+        ho(host_origin, host_origin + 3), rg(region, region + 3);
+    return Enqueue(
+        command_queue, CL_COMMAND_WRITE_BUFFER_RECT, num_events_in_wait_list,
+        event_wait_list, event,
+        [=] {
+            CopyRect(dst, &bo[0], buffer_row_pitch, buffer_slice_pitch,
+                     (const unsigned char *)ptr, &ho[0], host_row_pitch,
+                     host_slice_pitch, &rg[0]);
+        },
+        blocking_write);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueFillBuffer(
+    cl_command_queue command_queue, cl_mem buffer, const void *pattern,
+    size_t pattern_size, size_t offset, size_t size,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event)
+{
+    if (!buffer || buffer->type != CL_MEM_OBJECT_BUFFER)
+        return CL_INVALID_MEM_OBJECT;
+    if (!pattern || pattern_size == 0 || offset + size > buffer->size
+        || offset % pattern_size || size % pattern_size)
+        return CL_INVALID_VALUE;
+    unsigned char *dst = MemHostPtr(buffer) + offset;
+    std::vector<unsigned char> bytes((const unsigned char *)pattern,
+                                     (const unsigned char *)pattern
+                                         + pattern_size);
+    return Enqueue(command_queue, CL_COMMAND_FILL_BUFFER,
+                   num_events_in_wait_list, event_wait_list, event, [=] {
+                       FillPattern(dst, &bytes[0], bytes.size(), size);
+                   });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyBuffer(
+    cl_command_queue command_queue, cl_mem src_buffer, cl_mem dst_buffer,
+    size_t src_offset, size_t dst_offset, size_t size,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event)
+{
+    if (!src_buffer || !dst_buffer || IsImage(src_buffer) || IsImage(dst_buffer))
+        return CL_INVALID_MEM_OBJECT;
+    if (src_offset + size > src_buffer->size
+        || dst_offset + size > dst_buffer->size)
+        return CL_INVALID_VALUE;
+    unsigned char *src = MemHostPtr(src_buffer) + src_offset;
+    unsigned char *dst = MemHostPtr(dst_buffer) + dst_offset;
+    return Enqueue(command_queue, CL_COMMAND_COPY_BUFFER,
+                   num_events_in_wait_list, event_wait_list, event,
+                   [=] { memmove(dst, src, size); });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyBufferRect(
+    cl_command_queue command_queue, cl_mem src_buffer, cl_mem dst_buffer,
+    const size_t *src_origin, const size_t *dst_origin, const size_t *region,
+    size_t src_row_pitch, size_t src_slice_pitch, size_t dst_row_pitch,
+    size_t dst_slice_pitch, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event)
+{
+    if (!src_buffer || !dst_buffer || IsImage(src_buffer) || IsImage(dst_buffer))
+        return CL_INVALID_MEM_OBJECT;
+    if (!src_origin || !dst_origin || !region) return CL_INVALID_VALUE;
+    if (!src_row_pitch) src_row_pitch = region[0];
+    if (!src_slice_pitch) src_slice_pitch = region[1] * src_row_pitch;
+    if (!dst_row_pitch) dst_row_pitch = region[0];
+    if (!dst_slice_pitch) dst_slice_pitch = region[1] * dst_row_pitch;
+    unsigned char *src = MemHostPtr(src_buffer);
+    unsigned char *dst = MemHostPtr(dst_buffer);
+    std::vector<size_t> so(src_origin, src_origin + 3),
+        dO(dst_origin, dst_origin + 3), rg(region, region + 3);
+    return Enqueue(command_queue, CL_COMMAND_COPY_BUFFER_RECT,
+                   num_events_in_wait_list, event_wait_list, event, [=] {
+                       CopyRect(dst, &dO[0], dst_row_pitch, dst_slice_pitch,
+                                src, &so[0], src_row_pitch, src_slice_pitch,
+                                &rg[0]);
+                   });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueReadImage(
+    cl_command_queue command_queue, cl_mem image, cl_bool blocking_read,
+    const size_t *origin, const size_t *region, size_t row_pitch,
+    size_t slice_pitch, void *ptr, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event)
+{
+    if (!IsImage(image)) return CL_INVALID_MEM_OBJECT;
+    if (!ptr || !origin || !region) return CL_INVALID_VALUE;
+    std::vector<size_t> io(3), rg(3), ho(3, 0);
+    ImageRegion(image, origin, region, &io[0], &rg[0]);
+    if (!row_pitch) row_pitch = rg[0];
+    if (!slice_pitch) slice_pitch = row_pitch * rg[1];
+    unsigned char *src = MemHostPtr(image);
+    size_t imageRowPitch = image->rowPitch, imageSlicePitch = image->slicePitch;
+    return Enqueue(
+        command_queue, CL_COMMAND_READ_IMAGE, num_events_in_wait_list,
+        event_wait_list, event,
+        [=] {
+            CopyRect((unsigned char *)ptr, &ho[0], row_pitch, slice_pitch, src,
+                     &io[0], imageRowPitch, imageSlicePitch, &rg[0]);
+        },
+        blocking_read);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueWriteImage(
+    cl_command_queue command_queue, cl_mem image, cl_bool blocking_write,
+    const size_t *origin, const size_t *region, size_t input_row_pitch,
+    size_t input_slice_pitch, const void *ptr, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event)
+{
+    if (!IsImage(image)) return CL_INVALID_MEM_OBJECT;
+    if (!ptr || !origin || !region) return CL_INVALID_VALUE;
+    std::vector<size_t> io(3), rg(3), ho(3, 0);
+    ImageRegion(image, origin, region, &io[0], &rg[0]);
+    if (!input_row_pitch) input_row_pitch = rg[0];
+    if (!input_slice_pitch) input_slice_pitch = input_row_pitch * rg[1];
+    unsigned char *dst = MemHostPtr(image);
+    size_t imageRowPitch = image->rowPitch, imageSlicePitch = image->slicePitch;
+    return Enqueue(
+        command_queue, CL_COMMAND_WRITE_IMAGE, num_events_in_wait_list,
+        event_wait_list, event,
+        [=] {
+            CopyRect(dst, &io[0], imageRowPitch, imageSlicePitch,
+                     (const unsigned char *)ptr, &ho[0], input_row_pitch,
+                     input_slice_pitch, &rg[0]);
+        },
+        blocking_write);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueFillImage(
+    cl_command_queue command_queue, cl_mem image, const void *fill_color,
+    const size_t *origin, const size_t *region,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event)
+{
+    if (!IsImage(image)) return CL_INVALID_MEM_OBJECT;
+    if (!fill_color || !origin || !region) return CL_INVALID_VALUE;
+    // The fill color is stored without conversion to the image format, the
+    // contents of filled images are not meaningful
+    std::vector<unsigned char> pixel(image->elementSize);
+    memcpy(&pixel[0], fill_color, std::min(pixel.size(), size_t(16)));
+    std::vector<size_t> io(3), rg(3);
+    ImageRegion(image, origin, region, &io[0], &rg[0]);
+    unsigned char *dst = MemHostPtr(image);
+    size_t imageRowPitch = image->rowPitch, imageSlicePitch = image->slicePitch;
+    return Enqueue(command_queue, CL_COMMAND_FILL_IMAGE,
+                   num_events_in_wait_list, event_wait_list, event, [=] {
+                       for (size_t z = 0; z < rg[2]; z++)
+                           for (size_t y = 0; y < rg[1]; y++)
+                               FillPattern(dst + io[0]
+                                               + (io[1] + y) * imageRowPitch
+                                               + (io[2] + z) * imageSlicePitch,
+                                           &pixel[0], pixel.size(), rg[0]);
+                   });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyImage(
+    cl_command_queue command_queue, cl_mem src_image, cl_mem dst_image,
+    const size_t *src_origin, const size_t *dst_origin, const size_t *region,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event)
+{
+    if (!IsImage(src_image) || !IsImage(dst_image))
+        return CL_INVALID_MEM_OBJECT;
+    if (!src_origin || !dst_origin || !region) return CL_INVALID_VALUE;
+    std::vector<size_t> so(3), dO(3), rg(3), dstRegion(3);
+    ImageRegion(src_image, src_origin, region, &so[0], &rg[0]);
+    ImageRegion(dst_image, dst_origin, region, &dO[0], &dstRegion[0]);
+    unsigned char *src = MemHostPtr(src_image);
+    unsigned char *dst = MemHostPtr(dst_image);
+    size_t srcRowPitch = src_image->rowPitch,
+           srcSlicePitch = src_image->slicePitch;
+    size_t dstRowPitch = dst_image->rowPitch,
+           dstSlicePitch = dst_image->slicePitch;
+    return Enqueue(command_queue, CL_COMMAND_COPY_IMAGE,
+                   num_events_in_wait_list, event_wait_list, event, [=] {
+                       CopyRect(dst, &dO[0], dstRowPitch, dstSlicePitch, src,
+                                &so[0], srcRowPitch, srcSlicePitch, &rg[0]);
+                   });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyImageToBuffer(
+    cl_command_queue command_queue, cl_mem src_image, cl_mem dst_buffer,
+    const size_t *src_origin, const size_t *region, size_t dst_offset,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event)
+{
+    if (!IsImage(src_image) || !dst_buffer || IsImage(dst_buffer))
+        return CL_INVALID_MEM_OBJECT;
+    if (!src_origin || !region) return CL_INVALID_VALUE;
+    std::vector<size_t> so(3), rg(3), dO(3, 0);
+    ImageRegion(src_image, src_origin, region, &so[0], &rg[0]);
+    unsigned char *src = MemHostPtr(src_image);
+    unsigned char *dst = MemHostPtr(dst_buffer) + dst_offset;
+    size_t srcRowPitch = src_image->rowPitch,
+           srcSlicePitch = src_image->slicePitch;
+    return Enqueue(command_queue, CL_COMMAND_COPY_IMAGE_TO_BUFFER,
+                   num_events_in_wait_list, event_wait_list, event, [=] {
+                       CopyRect(dst, &dO[0], rg[0], rg[0] * rg[1], src, &so[0],
+                                srcRowPitch, srcSlicePitch, &rg[0]);
+                   });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyBufferToImage(
+    cl_command_queue command_queue, cl_mem src_buffer, cl_mem dst_image,
+    size_t src_offset, const size_t *dst_origin, const size_t *region,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event)
+{
+    if (!src_buffer || IsImage(src_buffer) || !IsImage(dst_image))
+        return CL_INVALID_MEM_OBJECT;
+    if (!dst_origin || !region) return CL_INVALID_VALUE;
+    std::vector<size_t> dO(3), rg(3), so(3, 0);
+    ImageRegion(dst_image, dst_origin, region, &dO[0], &rg[0]);
+    unsigned char *src = MemHostPtr(src_buffer) + src_offset;
+    unsigned char *dst = MemHostPtr(dst_image);
+    size_t dstRowPitch = dst_image->rowPitch,
+           dstSlicePitch = dst_image->slicePitch;
+    return Enqueue(command_queue, CL_COMMAND_COPY_BUFFER_TO_IMAGE,
+                   num_events_in_wait_list, event_wait_list, event, [=] {
+                       CopyRect(dst, &dO[0], dstRowPitch, dstSlicePitch, src,
+                                &so[0], rg[0], rg[0] * rg[1], &rg[0]);
+                   });
+}
+
+CL_API_ENTRY void *CL_API_CALL clEnqueueMapBuffer(
+    cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_map,
+    cl_map_flags map_flags, size_t offset, size_t size,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event, cl_int *errcode_ret)
+{
+    if (!buffer || buffer->type != CL_MEM_OBJECT_BUFFER)
+    {
+        SetError(errcode_ret, CL_INVALID_MEM_OBJECT);
+        return nullptr;
+    }
+    if (offset + size > buffer->size)
+    {
+        SetError(errcode_ret, CL_INVALID_VALUE);
+        return nullptr;
+    }
+    // Memory is always host resident, mapping hands out the storage itself
+    cl_int error = Enqueue(command_queue, CL_COMMAND_MAP_BUFFER,
+                           num_events_in_wait_list, event_wait_list, event,
+                           nullptr, blocking_map);
+    SetError(errcode_ret, error);
+    if (error != CL_SUCCESS) return nullptr;
+    ApiLock lock;
+    buffer->mapCount++;
+    return MemHostPtr(buffer) + offset;
+}
+
+CL_API_ENTRY void *CL_API_CALL clEnqueueMapImage(
+    cl_command_queue command_queue, cl_mem image, cl_bool blocking_map,
+    cl_map_flags map_flags, const size_t *origin, const size_t *region,
+    size_t *image_row_pitch, size_t *image_slice_pitch,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event, cl_int *errcode_ret)
+{
+    if (!IsImage(image))
+    {
+        SetError(errcode_ret, CL_INVALID_MEM_OBJECT);
+        return nullptr;
+    }
+    if (!origin || !region || !image_row_pitch)
+    {
+        SetError(errcode_ret, CL_INVALID_VALUE);
+        return nullptr;
+    }
+    cl_int error = Enqueue(command_queue, CL_COMMAND_MAP_IMAGE,
+                           num_events_in_wait_list, event_wait_list, event,
+                           nullptr, blocking_map);
+    SetError(errcode_ret, error);
+    if (error != CL_SUCCESS) return nullptr;
+    size_t io[3], rg[3];
+    ImageRegion(image, origin, region, io, rg);
+    *image_row_pitch = image->rowPitch;
+    if (image_slice_pitch) *image_slice_pitch = image->slicePitch;
+    ApiLock lock;
+    image->mapCount++;
+    return MemHostPtr(image) + io[0] + io[1] * image->rowPitch
+        + io[2] * image->slicePitch;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueUnmapMemObject(
+    cl_command_queue command_queue, cl_mem memobj, void *mapped_ptr,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event)
+{
+    if (!memobj) return CL_INVALID_MEM_OBJECT;
+    if (!mapped_ptr) return CL_INVALID_VALUE;
+    {
+        ApiLock lock;
+        if (memobj->mapCount == 0) return CL_INVALID_VALUE;
+        memobj->mapCount--;
+    }
+    return Enqueue(command_queue, CL_COMMAND_UNMAP_MEM_OBJECT,
+                   num_events_in_wait_list, event_wait_list, event, nullptr);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueMigrateMemObjects(
+    cl_command_queue command_queue, cl_uint num_mem_objects,
+    const cl_mem *mem_objects, cl_mem_migration_flags flags,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event)
+{
+    if (num_mem_objects == 0 || !mem_objects) return CL_INVALID_VALUE;
+    return Enqueue(command_queue, CL_COMMAND_MIGRATE_MEM_OBJECTS,
+                   num_events_in_wait_list, event_wait_list, event, nullptr);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueNDRangeKernel(
+    cl_command_queue command_queue, cl_kernel kernel, cl_uint work_dim,
+    const size_t *global_work_offset, const size_t *global_work_size,
+    const size_t *local_work_size, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event)
+{
+    if (!kernel) return CL_INVALID_KERNEL;
+    if (work_dim < 1 || work_dim > 3) return CL_INVALID_WORK_DIMENSION;
+    if (!global_work_size) return CL_INVALID_GLOBAL_WORK_SIZE;
+    size_t groupSize = 1;
+    for (cl_uint d = 0; d < work_dim; d++)
+    {
+        if (local_work_size)
+        {
+            if (local_work_size[d] == 0 || local_work_size[d] > kMaxWorkGroupSize)
+                return CL_INVALID_WORK_ITEM_SIZE;
+            groupSize *= local_work_size[d];
+        }
+    }
+    if (groupSize > kMaxWorkGroupSize) return CL_INVALID_WORK_GROUP_SIZE;
+    for (size_t i = 0; i < kernel->argIsSet.size(); i++)
+        if (!kernel->argIsSet[i]) return CL_INVALID_KERNEL_ARGS;
+    if (kernel->argIsSet.size() < kernel->numArgs)
+        return CL_INVALID_KERNEL_ARGS;
+
+    std::vector<size_t> offset(work_dim, 0), global(global_work_size,
+                                                    global_work_size + work_dim),
+        local;
+    if (global_work_offset)
+        offset.assign(global_work_offset, global_work_offset + work_dim);
+    if (local_work_size)
+        local.assign(local_work_size, local_work_size + work_dim);
+    clRetainKernel(kernel);
+    // Arguments are captured at enqueue time, as required by the spec
+    cl_kernel snapshot = clCloneKernel(kernel, nullptr);
+    clReleaseKernel(kernel);
+    cl_int error = Enqueue(command_queue, CL_COMMAND_NDRANGE_KERNEL,
+                           num_events_in_wait_list, event_wait_list, event, [=] {
+                               RunKernel(snapshot, work_dim, offset, global,
+                                         local);
+                               clReleaseKernel(snapshot);
+                           });
+    if (error != CL_SUCCESS) clReleaseKernel(snapshot);
+    return error;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueTask(cl_command_queue command_queue,
+                                              cl_kernel kernel,
+                                              cl_uint num_events_in_wait_list,
+                                              const cl_event *event_wait_list,
+                                              cl_event *event)
+{
+    size_t one = 1;
+    return clEnqueueNDRangeKernel(command_queue, kernel, 1, nullptr, &one,
+                                  &one, num_events_in_wait_list,
+                                  event_wait_list, event);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueNativeKernel(
+    cl_command_queue command_queue, void(CL_CALLBACK *user_func)(void *),
+    void *args, size_t cb_args, cl_uint num_mem_objects, const cl_mem *mem_list,
+    const void **args_mem_loc, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event)
+{
+    if (!user_func) return CL_INVALID_VALUE;
+    // Native kernels get their own copy of the arguments, with memory object
+    // handles replaced by host pointers
+    std::vector<unsigned char> argCopy;
+    if (args && cb_args)
+        argCopy.assign((unsigned char *)args, (unsigned char *)args + cb_args);
+    for (cl_uint i = 0; i < num_mem_objects; i++)
+    {
+        size_t location =
+            (const unsigned char *)args_mem_loc[i] - (const unsigned char *)args;
+        unsigned char *hostPtr = MemHostPtr(mem_list[i]);
+        memcpy(&argCopy[location], &hostPtr, sizeof(hostPtr));
+    }
+    return Enqueue(command_queue, CL_COMMAND_NATIVE_KERNEL,
+                   num_events_in_wait_list, event_wait_list, event, [=] {
+                       std::vector<unsigned char> runArgs = argCopy;
+                       user_func(runArgs.empty() ? nullptr : &runArgs[0]);
+                   });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueMarkerWithWaitList(
+    cl_command_queue command_queue, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event)
+{
+    return Enqueue(command_queue, CL_COMMAND_MARKER, num_events_in_wait_list,
+                   event_wait_list, event, nullptr, false,
+                   num_events_in_wait_list == 0);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueBarrierWithWaitList(
+    cl_command_queue command_queue, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event)
+{
+    return Enqueue(command_queue, CL_COMMAND_BARRIER, num_events_in_wait_list,
+                   event_wait_list, event, nullptr, false, true);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueMarker(cl_command_queue command_queue,
+                                                cl_event *event)
+{
+    if (!event) return CL_INVALID_VALUE;
+    return clEnqueueMarkerWithWaitList(command_queue, 0, nullptr, event);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueWaitForEvents(
+    cl_command_queue command_queue, cl_uint num_events,
+    const cl_event *event_list)
+{
+    if (num_events == 0 || !event_list) return CL_INVALID_VALUE;
+    return clEnqueueBarrierWithWaitList(command_queue, num_events, event_list,
+                                        nullptr);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueBarrier(cl_command_queue command_queue)
+{
+    return clEnqueueBarrierWithWaitList(command_queue, 0, nullptr, nullptr);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueSVMFree(
+    cl_command_queue command_queue, cl_uint num_svm_pointers,
+    void *svm_pointers[],
+    void(CL_CALLBACK *pfn_free_func)(cl_command_queue queue,
+                                     cl_uint num_svm_pointers,
+                                     void *svm_pointers[], void *user_data),
+    void *user_data, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event)
+{
+    if (num_svm_pointers == 0 || !svm_pointers) return CL_INVALID_VALUE;
+    std::vector<void *> pointers(svm_pointers, svm_pointers + num_svm_pointers);
+    cl_context context = command_queue ? command_queue->context : nullptr;
+    return Enqueue(command_queue, CL_COMMAND_SVM_FREE, num_events_in_wait_list,
+                   event_wait_list, event, [=] {
+                       std::vector<void *> freed = pointers;
+                       if (pfn_free_func)
+                           pfn_free_func(command_queue, (cl_uint)freed.size(),
+                                         &freed[0], user_data);
+                       else
+                           for (size_t i = 0; i < freed.size(); i++)
+                               clSVMFree(context, freed[i]);
+                   });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueSVMMemcpy(
+    cl_command_queue command_queue, cl_bool blocking_copy, void *dst_ptr,
+    const void *src_ptr, size_t size, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event)
+{
+    if (!dst_ptr || !src_ptr) return CL_INVALID_VALUE;
+    return Enqueue(command_queue, CL_COMMAND_SVM_MEMCPY,
+                   num_events_in_wait_list, event_wait_list, event,
+                   [=] { memmove(dst_ptr, src_ptr, size); }, blocking_copy);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueSVMMemFill(
+    cl_command_queue command_queue, void *svm_ptr, const void *pattern,
+    size_t pattern_size, size_t size, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event)
+{
+    if (!svm_ptr || !pattern || pattern_size == 0 || size % pattern_size)
+        return CL_INVALID_VALUE;
+    std::vector<unsigned char> bytes((const unsigned char *)pattern,
+                                     (const unsigned char *)pattern
+                                         + pattern_size);
+    return Enqueue(command_queue, CL_COMMAND_SVM_MEMFILL,
+                   num_events_in_wait_list, event_wait_list, event, [=] {
+                       FillPattern((unsigned char *)svm_ptr, &bytes[0],
+                                   bytes.size(), size);
+                   });
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueSVMMap(
+    cl_command_queue command_queue, cl_bool blocking_map, cl_map_flags flags,
+    void *svm_ptr, size_t size, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event)
+{
+    if (!svm_ptr || size == 0) return CL_INVALID_VALUE;
+    return Enqueue(command_queue, CL_COMMAND_SVM_MAP, num_events_in_wait_list,
+                   event_wait_list, event, nullptr, blocking_map);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueSVMUnmap(
+    cl_command_queue command_queue, void *svm_ptr,
+    cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
+    cl_event *event)
+{
+    if (!svm_ptr) return CL_INVALID_VALUE;
+    return Enqueue(command_queue, CL_COMMAND_SVM_UNMAP,
+                   num_events_in_wait_list, event_wait_list, event, nullptr);
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueSVMMigrateMem(
+    cl_command_queue command_queue, cl_uint num_svm_pointers,
+    const void **svm_pointers, const size_t *sizes,
+    cl_mem_migration_flags flags, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event)
+{
+    if (num_svm_pointers == 0 || !svm_pointers) return CL_INVALID_VALUE;
+    return Enqueue(command_queue, CL_COMMAND_SVM_MIGRATE_MEM,
+                   num_events_in_wait_list, event_wait_list, event, nullptr);
+}
+
+//
+// Extensions and ICD entry points
+//
+
+namespace {
+
+cl_int CL_API_CALL SetKernelHostCallback(const char *kernel_name,
+                                         cl_null_icd_kernel_fn fn,
+                                         void *user_data)
+{
+    ApiLock lock;
+    KernelCallback callback = { fn, user_data };
+    if (!kernel_name)
+        gDefaultKernelCallback = callback;
+    else if (fn)
+        gKernelCallbacks[kernel_name] = callback;
+    else
+        gKernelCallbacks.erase(kernel_name);
+    return CL_SUCCESS;
+}
+
+} // namespace
+
+CL_API_ENTRY void *CL_API_CALL
+clGetExtensionFunctionAddressForPlatform(cl_platform_id platform,
+                                         const char *func_name)
+{
+    if (platform != &gPlatform) return nullptr;
+    return clGetExtensionFunctionAddress(func_name);
+}
+
+NULL_ICD_EXPORT CL_API_ENTRY void *CL_API_CALL
+clGetExtensionFunctionAddress(const char *func_name)
+{
+    if (!func_name) return nullptr;
+    if (!strcmp(func_name, "clIcdGetPlatformIDsKHR"))
+        return (void *)&clIcdGetPlatformIDsKHR;
+    if (!strcmp(func_name, "clSetKernelHostCallbackNULL"))
+        return (void *)&SetKernelHostCallback;
+    return nullptr;
+}
+
+namespace {
+
+struct DispatchInitializer
+{
+    DispatchInitializer()
+    {
+        struct _cl_icd_dispatch &d = gDispatch;
+        memset(&d, 0, sizeof(d));
+        // OpenCL 1.0
+        d.clGetPlatformIDs = clGetPlatformIDs;
+        d.clGetPlatformInfo = clGetPlatformInfo;
+        d.clGetDeviceIDs = clGetDeviceIDs;
+        d.clGetDeviceInfo = clGetDeviceInfo;
+        d.clCreateContext = clCreateContext;
+        d.clCreateContextFromType = clCreateContextFromType;
+        d.clRetainContext = clRetainContext;
+        d.clReleaseContext = clReleaseContext;
+        d.clGetContextInfo = clGetContextInfo;
+        d.clCreateCommandQueue = clCreateCommandQueue;
+        d.clRetainCommandQueue = clRetainCommandQueue;
+        d.clReleaseCommandQueue = clReleaseCommandQueue;
+        d.clGetCommandQueueInfo = clGetCommandQueueInfo;
+        d.clCreateBuffer = clCreateBuffer;
+        d.clCreateImage2D = clCreateImage2D;
+        d.clCreateImage3D = clCreateImage3D;
+        d.clRetainMemObject = clRetainMemObject;
+        d.clReleaseMemObject = clReleaseMemObject;
+        d.clGetSupportedImageFormats = clGetSupportedImageFormats;
+        d.clGetMemObjectInfo = clGetMemObjectInfo;
+        d.clGetImageInfo = clGetImageInfo;
+        d.clCreateSampler = clCreateSampler;
+        d.clRetainSampler = clRetainSampler;
+        d.clReleaseSampler = clReleaseSampler;
+        d.clGetSamplerInfo = clGetSamplerInfo;
+        d.clCreateProgramWithSource = clCreateProgramWithSource;
+        d.clCreateProgramWithBinary = clCreateProgramWithBinary;
+        d.clRetainProgram = clRetainProgram;
+        d.clReleaseProgram = clReleaseProgram;
+        d.clBuildProgram = clBuildProgram;
+        d.clUnloadCompiler = clUnloadCompiler;
+        d.clGetProgramInfo = clGetProgramInfo;
+        d.clGetProgramBuildInfo = clGetProgramBuildInfo;
+        d.clCreateKernel = clCreateKernel;
+        d.clCreateKernelsInProgram = clCreateKernelsInProgram;
+        d.clRetainKernel = clRetainKernel;
+        d.clReleaseKernel = clReleaseKernel;
+        d.clSetKernelArg = clSetKernelArg;
+        d.clGetKernelInfo = clGetKernelInfo;
+        d.clGetKernelWorkGroupInfo = clGetKernelWorkGroupInfo;
+        d.clWaitForEvents = clWaitForEvents;
+        d.clGetEventInfo = clGetEventInfo;
+        d.clRetainEvent = clRetainEvent;
+        d.clReleaseEvent = clReleaseEvent;
+        d.clGetEventProfilingInfo = clGetEventProfilingInfo;
+        d.clFlush = clFlush;
+        d.clFinish = clFinish;
+        d.clEnqueueReadBuffer = clEnqueueReadBuffer;
+        d.clEnqueueWriteBuffer = clEnqueueWriteBuffer;
+        d.clEnqueueCopyBuffer = clEnqueueCopyBuffer;
+        d.clEnqueueReadImage = clEnqueueReadImage;
+        d.clEnqueueWriteImage = clEnqueueWriteImage;
+        d.clEnqueueCopyImage = clEnqueueCopyImage;
+        d.clEnqueueCopyImageToBuffer = clEnqueueCopyImageToBuffer;
+        d.clEnqueueCopyBufferToImage = clEnqueueCopyBufferToImage;
+        d.clEnqueueMapBuffer = clEnqueueMapBuffer;
+        d.clEnqueueMapImage = clEnqueueMapImage;
+        d.clEnqueueUnmapMemObject = clEnqueueUnmapMemObject;
+        d.clEnqueueNDRangeKernel = clEnqueueNDRangeKernel;
+        d.clEnqueueTask = clEnqueueTask;
+        d.clEnqueueNativeKernel = clEnqueueNativeKernel;
+        d.clEnqueueMarker = clEnqueueMarker;
+        d.clEnqueueWaitForEvents = clEnqueueWaitForEvents;
+        d.clEnqueueBarrier = clEnqueueBarrier;
+        d.clGetExtensionFunctionAddress = clGetExtensionFunctionAddress;
+        // OpenCL 1.1
+        d.clSetEventCallback = clSetEventCallback;
+        d.clCreateSubBuffer = clCreateSubBuffer;
+        d.clSetMemObjectDestructorCallback = clSetMemObjectDestructorCallback;
+        d.clCreateUserEvent = clCreateUserEvent;
+        d.clSetUserEventStatus = clSetUserEventStatus;
+        d.clEnqueueReadBufferRect = clEnqueueReadBufferRect;
+        d.clEnqueueWriteBufferRect = clEnqueueWriteBufferRect;
+        d.clEnqueueCopyBufferRect = clEnqueueCopyBufferRect;
+        // OpenCL 1.2
+        d.clCreateSubDevices = clCreateSubDevices;
+        d.clRetainDevice = clRetainDevice;
+        d.clReleaseDevice = clReleaseDevice;
+        d.clCreateImage = clCreateImage;
+        d.clCreateProgramWithBuiltInKernels =
+            clCreateProgramWithBuiltInKernels;
+        d.clCompileProgram = clCompileProgram;
+        d.clLinkProgram = clLinkProgram;
+        d.clUnloadPlatformCompiler = clUnloadPlatformCompiler;
+        d.clGetKernelArgInfo = clGetKernelArgInfo;
+        d.clEnqueueFillBuffer = clEnqueueFillBuffer;
+        d.clEnqueueFillImage = clEnqueueFillImage;
+        d.clEnqueueMigrateMemObjects = clEnqueueMigrateMemObjects;
+        d.clEnqueueMarkerWithWaitList = clEnqueueMarkerWithWaitList;
+        d.clEnqueueBarrierWithWaitList = clEnqueueBarrierWithWaitList;
+        d.clGetExtensionFunctionAddressForPlatform =
+            clGetExtensionFunctionAddressForPlatform;
+        // OpenCL 2.0
+        d.clCreateCommandQueueWithProperties =
+            clCreateCommandQueueWithProperties;
+        d.clCreatePipe = clCreatePipe;
+        d.clGetPipeInfo = clGetPipeInfo;
+        d.clSVMAlloc = clSVMAlloc;
+        d.clSVMFree = clSVMFree;
+        d.clEnqueueSVMFree = clEnqueueSVMFree;
+        d.clEnqueueSVMMemcpy = clEnqueueSVMMemcpy;
+        d.clEnqueueSVMMemFill = clEnqueueSVMMemFill;
+        d.clEnqueueSVMMap = clEnqueueSVMMap;
+        d.clEnqueueSVMUnmap = clEnqueueSVMUnmap;
+        d.clCreateSamplerWithProperties = clCreateSamplerWithProperties;
+        d.clSetKernelArgSVMPointer = clSetKernelArgSVMPointer;
+        d.clSetKernelExecInfo = clSetKernelExecInfo;
+        // OpenCL 2.1
+        d.clCloneKernel = clCloneKernel;
+        d.clCreateProgramWithIL = clCreateProgramWithIL;
+        d.clEnqueueSVMMigrateMem = clEnqueueSVMMigrateMem;
+        d.clGetDeviceAndHostTimer = clGetDeviceAndHostTimer;
+        d.clGetHostTimer = clGetHostTimer;
+        d.clGetKernelSubGroupInfo = clGetKernelSubGroupInfo;
+        d.clSetDefaultDeviceCommandQueue = clSetDefaultDeviceCommandQueue;
+        // OpenCL 2.2
+        d.clSetProgramReleaseCallback = clSetProgramReleaseCallback;
+        d.clSetProgramSpecializationConstant =
+            clSetProgramSpecializationConstant;
+        // OpenCL 3.0
+        d.clCreateBufferWithProperties = clCreateBufferWithProperties;
+        d.clCreateImageWithProperties = clCreateImageWithProperties;
+        d.clSetContextDestructorCallback = clSetContextDestructorCallback;
+    }
+};
+
+DispatchInitializer gDispatchInitializer;
+
+} // namespace
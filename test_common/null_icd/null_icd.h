@@ -0,0 +1,61 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef NULL_ICD_H_
+#define NULL_ICD_H_
+
+// The null ICD is a device-less OpenCL implementation backed by host memory.
+// It accepts any program and executes kernels as no-ops, which makes it
+// possible to profile the host side of the test harness (data generation,
+// reference computation, verification) without a real device.
+//
+// Kernels can optionally be executed by host callbacks, registered through
+// the function returned by
+//   clGetExtensionFunctionAddressForPlatform(platform,
+//                                            "clSetKernelHostCallbackNULL")
+
+#if defined(__APPLE__)
+#include <OpenCL/opencl.h>
+#else
+#include <CL/cl.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    size_t size; // size passed to clSetKernelArg
+    const void *value; // value passed to clSetKernelArg, NULL for local memory
+    void *mem_host_ptr; // host storage of a cl_mem argument, NULL otherwise
+} cl_null_icd_kernel_arg;
+
+typedef void(CL_CALLBACK *cl_null_icd_kernel_fn)(
+    const char *kernel_name, cl_uint work_dim, const size_t *global_work_offset,
+    const size_t *global_work_size, const size_t *local_work_size,
+    cl_uint num_args, const cl_null_icd_kernel_arg *args, void *user_data);
+
+// Registers fn to be called for every NDRange of kernels named kernel_name,
+// or of all kernels without a dedicated callback if kernel_name is NULL.
+// Passing a NULL fn removes the registration.
+typedef cl_int(CL_API_CALL *clSetKernelHostCallbackNULL_fn)(
+    const char *kernel_name, cl_null_icd_kernel_fn fn, void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NULL_ICD_H_
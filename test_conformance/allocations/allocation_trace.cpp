@@ -0,0 +1,308 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "allocation_trace.h"
+#include "allocation_utils.h"
+#include "harness/benchmarkHelpers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+TraceDistribution g_trace_distribution = TRACE_BIMODAL;
+int g_trace_operations = 0;
+
+extern int g_reduction_percentage;
+extern cl_long g_max_individual_allocation_size;
+extern cl_long g_global_mem_size;
+
+typedef long long unsigned llu;
+
+// Replays a seeded sequence of buffer allocations and releases that keeps
+// the device close to a memory budget, the pattern of a long-running
+// service. Every allocation is touched, so that drivers allocating lazily
+// report failures at that point. Failures while the live buffers leave
+// room in the budget are counted as caused by fragmentation, and the
+// largest buffer that can still be allocated is probed at regular
+// checkpoints.
+
+namespace {
+
+const size_t kMinTraceSize = 4096;
+const size_t kProbeGranularity = 1024 * 1024;
+const int kDefaultOperations = 2000;
+const int kBenchmarkOperations = 20000;
+const int kCheckpoints = 8;
+// Allocations are only attempted while the live buffers fit in this share
+// of the budget, so the trace churns close to full occupancy
+const double kTargetOccupancy = 0.9;
+// Probability of allocating rather than freeing when both are possible
+const double kAllocateProbability = 0.55;
+
+const char *distribution_name(TraceDistribution distribution)
+{
+    switch (distribution)
+    {
+        case TRACE_UNIFORM: return "uniform";
+        case TRACE_LOG_UNIFORM: return "log_uniform";
+        case TRACE_BIMODAL: return "bimodal";
+    }
+    return "unknown";
+}
+
+size_t uniform_size(size_t lo, size_t hi, MTdata d)
+{
+    return lo + (size_t)(genrand_real2(d) * (double)(hi - lo));
+}
+
+// Sizes from kMinTraceSize to max_size, rounded to whole pages
+size_t draw_size(TraceDistribution distribution, size_t max_size, MTdata d)
+{
+    size_t size;
+    switch (distribution)
+    {
+        case TRACE_UNIFORM:
+            size = uniform_size(kMinTraceSize, max_size, d);
+            break;
+        case TRACE_LOG_UNIFORM: {
+            double lo = std::log((double)kMinTraceSize);
+            double hi = std::log((double)max_size);
+            size = (size_t)std::exp(lo + genrand_real2(d) * (hi - lo));
+            break;
+        }
+        default:
+            // Mostly small buffers, pinned in place between a few large ones
+            if (genrand_real2(d) < 0.8)
+                size = uniform_size(kMinTraceSize,
+                                    std::max(max_size / 64, kMinTraceSize), d);
+            else
+                size = uniform_size(max_size / 4, max_size, d);
+            break;
+    }
+    size = (size + kMinTraceSize - 1) & ~(kMinTraceSize - 1);
+    return std::min(std::max(size, kMinTraceSize), max_size);
+}
+
+struct LiveBuffer
+{
+    cl_mem mem;
+    size_t size;
+};
+
+// Creates a buffer and writes its last word. Returns SUCCEEDED,
+// FAILED_TOO_BIG or FAILED_ABORT as the other allocation functions.
+int create_touched_buffer(cl_context context, cl_command_queue *queue,
+                          cl_device_id device, size_t size, cl_mem *mem)
+{
+    int error;
+    *mem = clCreateBuffer(context, CL_MEM_READ_WRITE, size, NULL, &error);
+    int result = check_allocation_error(context, device, error, queue);
+    if (result != SUCCEEDED) return result;
+
+    cl_uint value = 0;
+    error = clEnqueueWriteBuffer(*queue, *mem, CL_TRUE, size - sizeof(value),
+                                 sizeof(value), &value, 0, NULL, NULL);
+    result = check_allocation_error(context, device, error, queue);
+    if (result != SUCCEEDED)
+    {
+        clReleaseMemObject(*mem);
+        *mem = NULL;
+    }
+    return result;
+}
+
+// Largest buffer, to kProbeGranularity, that can be allocated and touched
+// now, between 0 and limit bytes. Returns FAILED_ABORT on unexpected errors.
+int probe_largest(cl_context context, cl_command_queue *queue,
+                  cl_device_id device, size_t limit, size_t *largest)
+{
+    size_t lo = 0;
+    size_t hi = limit / kProbeGranularity;
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi + 1) / 2;
+        cl_mem mem;
+        int result = create_touched_buffer(context, queue, device,
+                                           mid * kProbeGranularity, &mem);
+        if (result == FAILED_ABORT) return FAILED_ABORT;
+        if (result == SUCCEEDED)
+        {
+            clReleaseMemObject(mem);
+            lo = mid;
+        }
+        else
+        {
+            hi = mid - 1;
+        }
+    }
+    *largest = lo * kProbeGranularity;
+    return SUCCEEDED;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                         - start)
+        .count();
+}
+
+void release_all(std::vector<LiveBuffer> &live)
+{
+    for (LiveBuffer &buffer : live) clReleaseMemObject(buffer.mem);
+    live.clear();
+}
+
+} // namespace
+
+int test_buffer_fragmentation(cl_device_id device, cl_context context,
+                              cl_command_queue queue, int num_elements)
+{
+    size_t budget = (size_t)g_global_mem_size;
+    if (g_reduction_percentage != 100)
+        budget = (size_t)((double)budget * g_reduction_percentage / 100.0);
+    size_t max_alloc = std::min((size_t)g_max_individual_allocation_size,
+                                budget);
+    // Large enough to fragment the budget, small enough for many to be live
+    size_t max_size = std::max(std::min(max_alloc, budget / 8), kMinTraceSize);
+
+    int operations = g_trace_operations;
+    if (operations == 0)
+        operations =
+            benchmarks_requested() ? kBenchmarkOperations : kDefaultOperations;
+    int checkpoint_interval = std::max(operations / kCheckpoints, 1);
+    const char *name = distribution_name(g_trace_distribution);
+
+    log_info("** Replaying %d %s allocate/free operations of up to %gMB "
+             "against a budget of %gMB.\n",
+             operations, name, toMB(max_size), toMB(budget));
+
+    size_t initial_largest;
+    if (probe_largest(context, &queue, device, max_alloc, &initial_largest)
+        != SUCCEEDED)
+        return 1;
+    log_info("\tLargest allocation before the trace: %gMB\n",
+             toMB(initial_largest));
+
+    RandomSeed seed(gRandomSeed);
+    std::vector<LiveBuffer> live;
+    size_t live_bytes = 0;
+    size_t peak_live_bytes = 0;
+    std::vector<double> create_times, release_times;
+    int fragmentation_failures = 0;
+    size_t smallest_failure = SIZE_MAX;
+    size_t worst_largest = initial_largest;
+
+    log_info("\t%10s %12s %14s %12s\n", "operation", "live (MB)",
+             "largest (MB)", "failures");
+    for (int op = 1; op <= operations; op++)
+    {
+        size_t size = draw_size(g_trace_distribution, max_size, seed);
+        bool fits = live_bytes + size <= budget * kTargetOccupancy;
+        bool allocate = live.empty()
+            || (fits && genrand_real2(seed) < kAllocateProbability);
+
+        if (allocate && fits)
+        {
+            cl_mem mem;
+            auto start = std::chrono::steady_clock::now();
+            int result =
+                create_touched_buffer(context, &queue, device, size, &mem);
+            if (result == FAILED_ABORT)
+            {
+                release_all(live);
+                return 1;
+            }
+            if (result == SUCCEEDED)
+            {
+                create_times.push_back(seconds_since(start));
+                live.push_back({ mem, size });
+                live_bytes += size;
+                peak_live_bytes = std::max(peak_live_bytes, live_bytes);
+            }
+            else
+            {
+                // The live buffers leave room for this one by construction
+                fragmentation_failures++;
+                smallest_failure = std::min(smallest_failure, size);
+                allocate = false;
+            }
+        }
+        else
+        {
+            allocate = false;
+        }
+
+        if (!allocate && !live.empty())
+        {
+            size_t index = genrand_int32(seed) % live.size();
+            auto start = std::chrono::steady_clock::now();
+            clReleaseMemObject(live[index].mem);
+            release_times.push_back(seconds_since(start));
+            live_bytes -= live[index].size;
+            live[index] = live.back();
+            live.pop_back();
+        }
+
+        if (op % checkpoint_interval == 0 || op == operations)
+        {
+            size_t largest;
+            if (probe_largest(context, &queue, device,
+                              std::min(max_alloc, budget - live_bytes),
+                              &largest)
+                != SUCCEEDED)
+            {
+                release_all(live);
+                return 1;
+            }
+            worst_largest = std::min(worst_largest, largest);
+            log_info("\t%10d %12.1f %14.1f %12d\n", op, toMB(live_bytes),
+                     toMB(largest), fragmentation_failures);
+        }
+    }
+    release_all(live);
+
+    size_t final_largest;
+    if (probe_largest(context, &queue, device, max_alloc, &final_largest)
+        != SUCCEEDED)
+        return 1;
+
+    std::string key = std::string("buffer_fragmentation/") + name;
+    BenchmarkStats create_stats =
+        record_benchmark({ key + "/clCreateBuffer", 1, "" }, 1, create_times);
+    BenchmarkStats release_stats = record_benchmark(
+        { key + "/clReleaseMemObject", 1, "" }, 1, release_times);
+    log_info("\tclCreateBuffer and first write: p50 %.1f us, p99 %.1f us, max "
+             "%.1f us over %llu allocations\n",
+             create_stats.median, create_stats.p99, create_stats.max,
+             llu(create_stats.samples));
+    log_info("\tclReleaseMemObject: p50 %.1f us, p99 %.1f us, max %.1f us\n",
+             release_stats.median, release_stats.p99, release_stats.max);
+    log_info("\tPeak live allocations: %gMB. Largest allocation: %gMB before, "
+             "%gMB at worst, %gMB after releasing everything.\n",
+             toMB(peak_live_bytes), toMB(initial_largest), toMB(worst_largest),
+             toMB(final_largest));
+
+    if (fragmentation_failures)
+        log_info("\tWARNING: %d allocations, the smallest of %gMB, failed "
+                 "while the live buffers left room for them in the budget.\n",
+                 fragmentation_failures, toMB(smallest_failure));
+    if (final_largest + kProbeGranularity < initial_largest)
+        log_info("\tWARNING: releasing every buffer did not restore the "
+                 "largest allocation of %gMB.\n",
+                 toMB(initial_largest));
+
+    return 0;
+}
@@ -0,0 +1,36 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef _allocation_trace_h
+#define _allocation_trace_h
+
+#include "testBase.h"
+
+// Size distributions of the randomized allocate/free trace
+enum TraceDistribution
+{
+    TRACE_UNIFORM,
+    TRACE_LOG_UNIFORM,
+    TRACE_BIMODAL,
+};
+
+extern TraceDistribution g_trace_distribution;
+// Allocate and free operations of the trace, 0 for the default
+extern int g_trace_operations;
+
+int test_buffer_fragmentation(cl_device_id device, cl_context context,
+                              cl_command_queue queue, int num_elements);
+
+#endif // _allocation_trace_h
@@ -18,6 +18,7 @@
 #include "allocation_functions.h"
 #include "allocation_fill.h"
 #include "allocation_execute.h"
+#include "allocation_trace.h"
 #include "harness/testHarness.h"
 #include "harness/parseParameters.h"
 #include <time.h>
@@ -323,6 +324,7 @@ test_definition test_list[] = {
     ADD_TEST(buffer_non_blocking),
     ADD_TEST(image2d_read_non_blocking),
     ADD_TEST(image2d_write_non_blocking),
+    ADD_TEST(buffer_fragmentation),
 };
 
 const int test_num = ARRAY_SIZE(test_list);
@@ -381,6 +383,18 @@ int main(int argc, const char *argv[])
             g_execute_kernel = 0;
         }
 
+        else if (strcmp(argv[i], "trace_uniform") == 0)
+            g_trace_distribution = TRACE_UNIFORM;
+        else if (strcmp(argv[i], "trace_log_uniform") == 0)
+            g_trace_distribution = TRACE_LOG_UNIFORM;
+        else if (strcmp(argv[i], "trace_bimodal") == 0)
+            g_trace_distribution = TRACE_BIMODAL;
+
+        else if (strcmp(argv[i], "trace_ops") == 0 && i + 1 < argc)
+        {
+            g_trace_operations = (int)strtol(argv[++i], NULL, 10);
+        }
+
         else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0)
         {
             printUsage(argv[0]);
@@ -428,6 +442,12 @@ void printUsage(const char *execName)
     log_info("\tdo_not_execute - Disable executing a kernel that accesses all "
              "of the memory objects.\n");
     log_info("\n");
+    log_info("\ttrace_uniform, trace_log_uniform, trace_bimodal - Size "
+             "distribution of the buffer_fragmentation trace (defaults to "
+             "bimodal)\n");
+    log_info("\ttrace_ops <n> - Allocate and free operations of the "
+             "buffer_fragmentation trace\n");
+    log_info("\n");
     log_info("Test names (Allocation Types):\n");
     for (int i = 0; i < test_num; i++)
     {
@@ -50,6 +50,7 @@
 #include "harness/errorHelpers.h"
 #include "harness/featureHelpers.h"
 #include "harness/mt19937.h"
+#include "harness/parseParameters.h"
 #include "procs.h"
 
 
@@ -422,17 +423,22 @@ static std::string global_check_function(const TypeInfo& ti);
 static std::string writer_function(const TypeInfo& ti);
 static std::string reader_function(const TypeInfo& ti);
 
+static std::string type_section(const TypeInfo& ti, int itype,
+                                bool with_init);
+
 static int l_write_read(cl_device_id device, cl_context context,
                         cl_command_queue queue);
 static int l_write_read_for_type(cl_device_id device, cl_context context,
                                  cl_command_queue queue, const TypeInfo& ti,
+                                 int itype, cl_program program,
                                  RandomSeed& rand_state);
 
 static int l_init_write_read(cl_device_id device, cl_context context,
                              cl_command_queue queue);
 static int l_init_write_read_for_type(cl_device_id device, cl_context context,
                                       cl_command_queue queue,
-                                      const TypeInfo& ti,
+                                      const TypeInfo& ti, int itype,
+                                      cl_program program,
                                       RandomSeed& rand_state);
 
 static int l_capacity(cl_device_id device, cl_context context,
@@ -1062,9 +1068,209 @@ static std::string reader_function(const TypeInfo& ti)
     return result;
 }
 
+// Program-scope names used by the generated source of a type
+static const char* const l_section_names[] = {
+    "var",    "g_var",  "a_var",  "p_var",       "from_buf",
+    "to_buf", "writer", "reader", "global_check"
+};
+
+// The name given to a program-scope name in the section of type itype
+static std::string section_name(const char* name, int itype)
+{
+    return std::string(name) + "_" + std::to_string(itype);
+}
+
+// Return the source text of the variables and kernels of the given type,
+// with every program-scope name suffixed by the type index, so that the
+// sections of all types can be compiled into the same program.
+static std::string type_section(const TypeInfo& ti, int itype, bool with_init)
+{
+    std::string result;
+    for (const char* name : l_section_names)
+        result += std::string("#define ") + name + " "
+            + section_name(name, itype) + "\n";
+    result += conversion_functions(ti);
+    result += global_decls(ti, with_init);
+    if (!with_init) result += global_check_function(ti);
+    result += writer_function(ti);
+    result += reader_function(ti);
+    for (const char* name : l_section_names)
+        result += std::string("#undef ") + name + "\n";
+    result += "#undef INIT_VAR\n\n";
+    return result;
+}
+
+// Add the source of the types [first, last) of type_info[].
+static void l_add_type_sources(StringTable& ksrc, int first, int last,
+                               bool with_init)
+{
+    ksrc.add(l_get_fp64_pragma());
+    ksrc.add(l_get_cles_int64_pragma());
+    for (int itype = first; itype < last; itype++)
+    {
+        if (type_info[itype].is_atomic_64bit())
+        {
+            ksrc.add(l_get_int64_atomic_pragma());
+            break;
+        }
+    }
+    for (int itype = first; itype < last; itype++)
+        ksrc.add(type_section(type_info[itype], itype, with_init));
+}
+
+// Bytes of program-scope variables declared for a type: two regular
+// variables, an array of 2 elements and a pointer.
+static size_t l_global_variables_size(const TypeInfo& ti)
+{
+    return (NUM_TESTED_VALUES - 1) * ti.get_size() + (l_64bit_device ? 8 : 4);
+}
+
+static int l_check_global_variables_size(cl_device_id device,
+                                         cl_program program,
+                                         size_t expected_used_bytes)
+{
+    size_t used_bytes = 0;
+    int status = clGetProgramBuildInfo(
+        program, device, CL_PROGRAM_BUILD_GLOBAL_VARIABLE_TOTAL_SIZE,
+        sizeof(used_bytes), &used_bytes, 0);
+    test_error_ret(status, "Failed to query global variable total size",
+                   status);
+    if (used_bytes < expected_used_bytes)
+    {
+        log_error("Error: program query for global variable total size query "
+                  "failed: Expected at least %llu but got %llu\n",
+                  (unsigned long long)expected_used_bytes,
+                  (unsigned long long)used_bytes);
+        return 1;
+    }
+    return CL_SUCCESS;
+}
+
+// Build the variables and kernels of the types [first, last) into one
+// program. When the device has a linker the source is compiled and linked
+// in a single step each, otherwise it is built. A quiet build reports its
+// failure through log_info only, the caller has a fallback for it.
+static int l_build_types_program(cl_device_id device, cl_context context,
+                                 int first, int last, bool with_init,
+                                 bool quiet, clProgramWrapper& program)
+{
+    StringTable ksrc;
+    l_add_type_sources(ksrc, first, last, with_init);
+    const std::string options = get_build_options(device);
+
+    auto failed = [&](cl_program failed_program, bool with_source,
+                      const char* step, int status) {
+        if (quiet)
+            log_info("Unable to %s the program (%s)\n", step,
+                     IGetErrorString(status));
+        else
+        {
+            check_error(status, "Failed to %s program (%s)", step,
+                        IGetErrorString(status));
+            if (failed_program)
+                print_build_log(failed_program, 1, &device,
+                                with_source ? ksrc.num_str() : 0,
+                                with_source ? ksrc.strs() : NULL,
+                                with_source ? ksrc.lengths() : NULL,
+                                with_source ? options.c_str() : "");
+        }
+        return status;
+    };
+
+    int status = CL_SUCCESS;
+    if (l_linker_available && gCompilationMode == kOnline)
+    {
+        clProgramWrapper compiled(clCreateProgramWithSource(
+            context, ksrc.num_str(), ksrc.strs(), ksrc.lengths(), &status));
+        if (status != CL_SUCCESS) return failed(NULL, false, "create", status);
+
+        status = clCompileProgram(compiled, 1, &device, options.c_str(), 0, 0,
+                                  0, 0, 0);
+        if (status != CL_SUCCESS)
+            return failed(compiled, true, "compile", status);
+
+        cl_program input = compiled;
+        program =
+            clLinkProgram(context, 1, &device, "", 1, &input, 0, 0, &status);
+        if (status != CL_SUCCESS) return failed(program, false, "link", status);
+        return CL_SUCCESS;
+    }
+
+    status = create_single_kernel_helper_create_program(
+        context, &program, ksrc.num_str(), ksrc.strs(), options.c_str());
+    if (status != CL_SUCCESS) return failed(NULL, false, "create", status);
+
+    status = clBuildProgram(program, 1, &device, options.c_str(), 0, 0);
+    if (status != CL_SUCCESS) return failed(program, true, "build", status);
+    return CL_SUCCESS;
+}
+
+typedef int (*TypeTestFn)(cl_device_id device, cl_context context,
+                          cl_command_queue queue, const TypeInfo& ti,
+                          int itype, cl_program program,
+                          RandomSeed& rand_state);
+
+// Run test_fn for every type of type_info[]. All types share one program,
+// built once. Should that build fail, every type is built into a program of
+// its own so that the failure is reported for the types that cause it.
+static int l_for_each_type(cl_device_id device, cl_context context,
+                           cl_command_queue queue, bool with_init,
+                           TypeTestFn test_fn)
+{
+    int status = CL_SUCCESS;
+    RandomSeed rand_state(gRandomSeed);
+
+    clProgramWrapper shared_program;
+    if (l_build_types_program(device, context, 0, num_type_info, with_init,
+                              true, shared_program)
+        != CL_SUCCESS)
+    {
+        log_info("Unable to build the program of all %d types, building "
+                 "one program per type\n",
+                 num_type_info);
+        shared_program = nullptr;
+    }
+    else
+    {
+        size_t expected_used_bytes = 0;
+        for (int itype = 0; itype < num_type_info; itype++)
+            expected_used_bytes += l_global_variables_size(type_info[itype]);
+        status |= l_check_global_variables_size(device, shared_program,
+                                                expected_used_bytes);
+    }
+
+    for (int itype = 0; itype < num_type_info; itype++)
+    {
+        const TypeInfo& ti = type_info[itype];
+        cl_program program = shared_program;
+        clProgramWrapper type_program;
+        if (!program)
+        {
+            int type_status = l_build_types_program(
+                device, context, itype, itype + 1, with_init, false,
+                type_program);
+            if (type_status == CL_SUCCESS)
+                type_status = l_check_global_variables_size(
+                    device, type_program, l_global_variables_size(ti));
+            if (type_status != CL_SUCCESS)
+            {
+                log_error("Error: unable to build the program of type %s\n",
+                          ti.get_name_c_str());
+                status |= type_status;
+                continue;
+            }
+            program = type_program;
+        }
+        status |= test_fn(device, context, queue, ti, itype, program,
+                          rand_state);
+        FLUSH;
+    }
+    return status;
+}
+
 // Check that all globals where appropriately default-initialized.
 static int check_global_initialization(cl_context context, cl_program program,
-                                       cl_command_queue queue)
+                                       cl_command_queue queue, int itype)
 {
     int status = CL_SUCCESS;
 
@@ -1076,8 +1282,8 @@ static int check_global_initialization(cl_context context, cl_program program,
     test_error_ret(status, "Failed to allocate buffer", status);
 
     // Create, setup and invoke kernel.
-    clKernelWrapper global_check(
-        clCreateKernel(program, "global_check", &status));
+    clKernelWrapper global_check(clCreateKernel(
+        program, section_name("global_check", itype).c_str(), &status));
     test_error_ret(status, "Failed to create global_check kernel", status);
     status = clSetKernelArg(global_check, 0, sizeof(cl_mem), &buffer);
     test_error_ret(status,
@@ -1111,24 +1317,13 @@ static int check_global_initialization(cl_context context, cl_program program,
 static int l_write_read(cl_device_id device, cl_context context,
                         cl_command_queue queue)
 {
-    int status = CL_SUCCESS;
-    int itype;
-
-    RandomSeed rand_state(gRandomSeed);
-
-    for (itype = 0; itype < num_type_info; itype++)
-    {
-        status = status
-            | l_write_read_for_type(device, context, queue, type_info[itype],
-                                    rand_state);
-        FLUSH;
-    }
-
-    return status;
+    return l_for_each_type(device, context, queue, false,
+                           l_write_read_for_type);
 }
 
 static int l_write_read_for_type(cl_device_id device, cl_context context,
                                  cl_command_queue queue, const TypeInfo& ti,
+                                 int itype, cl_program program,
                                  RandomSeed& rand_state)
 {
     int err = CL_SUCCESS;
@@ -1136,50 +1331,20 @@ static int l_write_read_for_type(cl_device_id device, cl_context context,
     const char* tn = type_name.c_str();
     log_info("  %s ", tn);
 
-    StringTable ksrc;
-    ksrc.add(l_get_fp64_pragma());
-    ksrc.add(l_get_cles_int64_pragma());
-    if (ti.is_atomic_64bit()) ksrc.add(l_get_int64_atomic_pragma());
-    ksrc.add(conversion_functions(ti));
-    ksrc.add(global_decls(ti, false));
-    ksrc.add(global_check_function(ti));
-    ksrc.add(writer_function(ti));
-    ksrc.add(reader_function(ti));
-
     int status = CL_SUCCESS;
-    clProgramWrapper program;
-    clKernelWrapper writer;
-
-    status = create_single_kernel_helper(context, &program, &writer,
-                                         ksrc.num_str(), ksrc.strs(), "writer");
-    test_error_ret(status, "Failed to create program for read-after-write test",
+    clKernelWrapper writer(
+        clCreateKernel(program, section_name("writer", itype).c_str(), &status));
+    test_error_ret(status,
+                   "Failed to create writer kernel for read-after-write test",
                    status);
 
-    clKernelWrapper reader(clCreateKernel(program, "reader", &status));
+    clKernelWrapper reader(
+        clCreateKernel(program, section_name("reader", itype).c_str(), &status));
     test_error_ret(status,
                    "Failed to create reader kernel for read-after-write test",
                    status);
 
-    // Check size query.
-    size_t used_bytes = 0;
-    status = clGetProgramBuildInfo(program, device,
-                                   CL_PROGRAM_BUILD_GLOBAL_VARIABLE_TOTAL_SIZE,
-                                   sizeof(used_bytes), &used_bytes, 0);
-    test_error_ret(status, "Failed to query global variable total size",
-                   status);
-    size_t expected_used_bytes = (NUM_TESTED_VALUES - 1)
-            * ti.get_size() // Two regular variables and an array of 2 elements.
-        + (l_64bit_device ? 8 : 4); // The pointer
-    if (used_bytes < expected_used_bytes)
-    {
-        log_error("Error program query for global variable total size query "
-                  "failed: Expected at least %llu but got %llu\n",
-                  (unsigned long long)expected_used_bytes,
-                  (unsigned long long)used_bytes);
-        err |= 1;
-    }
-
-    err |= check_global_initialization(context, program, queue);
+    err |= check_global_initialization(context, program, queue, itype);
 
     // We need to create 5 random values of the given type,
     // and read 4 of them back.
@@ -1323,22 +1488,13 @@ static int l_write_read_for_type(cl_device_id device, cl_context context,
 static int l_init_write_read(cl_device_id device, cl_context context,
                              cl_command_queue queue)
 {
-    int status = CL_SUCCESS;
-    int itype;
-
-    RandomSeed rand_state(gRandomSeed);
-
-    for (itype = 0; itype < num_type_info; itype++)
-    {
-        status = status
-            | l_init_write_read_for_type(device, context, queue,
-                                         type_info[itype], rand_state);
-    }
-    return status;
+    return l_for_each_type(device, context, queue, true,
+                           l_init_write_read_for_type);
 }
 static int l_init_write_read_for_type(cl_device_id device, cl_context context,
                                       cl_command_queue queue,
-                                      const TypeInfo& ti,
+                                      const TypeInfo& ti, int itype,
+                                      cl_program program,
                                       RandomSeed& rand_state)
 {
     int err = CL_SUCCESS;
@@ -1346,49 +1502,19 @@ static int l_init_write_read_for_type(cl_device_id device, cl_context context,
     const char* tn = type_name.c_str();
     log_info("  %s ", tn);
 
-    StringTable ksrc;
-    ksrc.add(l_get_fp64_pragma());
-    ksrc.add(l_get_cles_int64_pragma());
-    if (ti.is_atomic_64bit()) ksrc.add(l_get_int64_atomic_pragma());
-    ksrc.add(conversion_functions(ti));
-    ksrc.add(global_decls(ti, true));
-    ksrc.add(writer_function(ti));
-    ksrc.add(reader_function(ti));
-
     int status = CL_SUCCESS;
-    clProgramWrapper program;
-    clKernelWrapper writer;
-
-    status = create_single_kernel_helper(context, &program, &writer,
-                                         ksrc.num_str(), ksrc.strs(), "writer");
-    test_error_ret(status,
-                   "Failed to create program for init-read-after-write test",
-                   status);
+    clKernelWrapper writer(
+        clCreateKernel(program, section_name("writer", itype).c_str(), &status));
+    test_error_ret(
+        status, "Failed to create writer kernel for init-read-after-write test",
+        status);
 
-    clKernelWrapper reader(clCreateKernel(program, "reader", &status));
+    clKernelWrapper reader(
+        clCreateKernel(program, section_name("reader", itype).c_str(), &status));
     test_error_ret(
         status, "Failed to create reader kernel for init-read-after-write test",
         status);
 
-    // Check size query.
-    size_t used_bytes = 0;
-    status = clGetProgramBuildInfo(program, device,
-                                   CL_PROGRAM_BUILD_GLOBAL_VARIABLE_TOTAL_SIZE,
-                                   sizeof(used_bytes), &used_bytes, 0);
-    test_error_ret(status, "Failed to query global variable total size",
-                   status);
-    size_t expected_used_bytes = (NUM_TESTED_VALUES - 1)
-            * ti.get_size() // Two regular variables and an array of 2 elements.
-        + (l_64bit_device ? 8 : 4); // The pointer
-    if (used_bytes < expected_used_bytes)
-    {
-        log_error("Error: program query for global variable total size query "
-                  "failed: Expected at least %llu but got %llu\n",
-                  (unsigned long long)expected_used_bytes,
-                  (unsigned long long)used_bytes);
-        err |= 1;
-    }
-
     // We need to create 5 random values of the given type,
     // and read 4 of them back.
     const size_t write_data_size = NUM_TESTED_VALUES * sizeof(cl_ulong16);
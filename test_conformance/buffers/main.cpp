@@ -120,6 +120,11 @@ test_definition test_list[] = {
 
     ADD_TEST(buffer_migrate),
     ADD_TEST(image_migrate),
+
+    ADD_TEST(buffer_read_bandwidth),
+    ADD_TEST(buffer_write_bandwidth),
+    ADD_TEST(buffer_map_bandwidth),
+    ADD_TEST(buffer_copy_bandwidth),
 };
 
 const int test_num = ARRAY_SIZE( test_list );
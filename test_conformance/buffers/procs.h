@@ -128,5 +128,10 @@ extern int      test_buffer_fill_ulong( cl_device_id deviceID, cl_context contex
 extern int      test_buffer_fill_float( cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements );
 extern int      test_buffer_fill_struct( cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements );
 
+extern int      test_buffer_read_bandwidth( cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements );
+extern int      test_buffer_write_bandwidth( cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements );
+extern int      test_buffer_map_bandwidth( cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements );
+extern int      test_buffer_copy_bandwidth( cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements );
+
 #endif    // #ifndef __PROCS_H__
 
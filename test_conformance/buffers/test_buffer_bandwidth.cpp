@@ -0,0 +1,381 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "harness/compat.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "procs.h"
+#include "harness/benchmarkHelpers.h"
+
+// Transfer bandwidth tests. By default they only check the transfers for
+// sizes up to kDefaultMaxTransferSize. When benchmark results are requested
+// (--benchmark-json or --benchmark-baseline) they sweep up to
+// CL_DEVICE_MAX_MEM_ALLOC_SIZE and report bandwidth and latency measured
+// from event profiling timestamps.
+
+namespace {
+
+const size_t kMinTransferSize = 4096;
+const size_t kDefaultMaxTransferSize = 1 << 20;
+const unsigned kDefaultRepetitions = 10;
+
+enum class TransferOp
+{
+    read,
+    write,
+    map,
+    copy
+};
+
+const char *op_name(TransferOp op)
+{
+    switch (op)
+    {
+        case TransferOp::read: return "buffer_read";
+        case TransferOp::write: return "buffer_write";
+        case TransferOp::map: return "buffer_map";
+        case TransferOp::copy: return "buffer_copy";
+    }
+    return "";
+}
+
+struct AllocationKind
+{
+    cl_mem_flags flags;
+    const char *name;
+};
+
+const AllocationKind allocation_kinds[] = {
+    { 0, "device" },
+    { CL_MEM_ALLOC_HOST_PTR, "CL_MEM_ALLOC_HOST_PTR" },
+    { CL_MEM_USE_HOST_PTR, "CL_MEM_USE_HOST_PTR" },
+};
+
+// Offsets of host pointers from a page boundary
+struct HostAlignment
+{
+    size_t offset;
+    const char *name;
+};
+
+const HostAlignment host_alignments[] = {
+    { 0, "page" },
+    { 64, "cacheline" },
+    { 4, "unaligned" },
+};
+
+// Host memory starting at a given offset from a page boundary
+class HostBuffer {
+    std::vector<cl_uchar> storage;
+    cl_uchar *ptr = nullptr;
+
+public:
+    HostBuffer(size_t size, size_t alignment, size_t offset)
+        : storage(size + alignment + offset)
+    {
+        uintptr_t base = (uintptr_t)storage.data();
+        base = (base + alignment - 1) / alignment * alignment;
+        ptr = (cl_uchar *)base + offset;
+    }
+    cl_uchar *data() { return ptr; }
+};
+
+void fill_pattern(cl_uchar *data, size_t size, cl_uint seed)
+{
+    for (size_t i = 0; i < size; i++)
+        data[i] = (cl_uchar)((i * 2654435761u + seed) >> 13);
+}
+
+bool check_pattern(const cl_uchar *data, size_t size, cl_uint seed)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        cl_uchar expected = (cl_uchar)((i * 2654435761u + seed) >> 13);
+        if (data[i] != expected)
+        {
+            log_error("ERROR: byte %zu is 0x%02x, expected 0x%02x\n", i,
+                      data[i], expected);
+            return false;
+        }
+    }
+    return true;
+}
+
+cl_int event_duration(cl_event event, double &seconds)
+{
+    cl_ulong start, end;
+    cl_int error = clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START,
+                                           sizeof(start), &start, nullptr);
+    test_error(error, "clGetEventProfilingInfo failed");
+    error = clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END,
+                                    sizeof(end), &end, nullptr);
+    test_error(error, "clGetEventProfilingInfo failed");
+    seconds += (end - start) * 1e-9;
+    return CL_SUCCESS;
+}
+
+bool is_allocation_failure(cl_int error)
+{
+    return error == CL_MEM_OBJECT_ALLOCATION_FAILURE
+        || error == CL_OUT_OF_RESOURCES || error == CL_OUT_OF_HOST_MEMORY
+        || error == CL_INVALID_BUFFER_SIZE;
+}
+
+class TransferTest {
+public:
+    TransferTest(cl_context context, cl_command_queue queue, TransferOp op,
+                 size_t alignment)
+        : context(context), queue(queue), op(op), alignment(alignment)
+    {}
+
+    // Returns CL_SUCCESS, CL_MEM_OBJECT_ALLOCATION_FAILURE if the host or
+    // device memory for this size is not available, or another error
+    cl_int run(const AllocationKind &kind, const HostAlignment &align,
+               size_t size, unsigned warmup, unsigned repetitions)
+    {
+        try
+        {
+            HostBuffer src(size, alignment, align.offset);
+            HostBuffer dst(size, alignment, align.offset);
+            std::vector<HostBuffer> backing;
+            if (kind.flags & CL_MEM_USE_HOST_PTR)
+            {
+                backing.emplace_back(size, alignment, align.offset);
+                if (op == TransferOp::copy)
+                    backing.emplace_back(size, alignment, align.offset);
+            }
+            return run(kind, align, size, warmup, repetitions, src.data(),
+                       dst.data(), backing);
+        } catch (const std::bad_alloc &)
+        {
+            return CL_MEM_OBJECT_ALLOCATION_FAILURE;
+        }
+    }
+
+private:
+    cl_int run(const AllocationKind &kind, const HostAlignment &align,
+               size_t size, unsigned warmup, unsigned repetitions,
+               cl_uchar *src, cl_uchar *dst, std::vector<HostBuffer> &backing)
+    {
+        cl_int error;
+        clMemWrapper buffers[2];
+        size_t buffer_count = op == TransferOp::copy ? 2 : 1;
+        for (size_t i = 0; i < buffer_count; i++)
+        {
+            void *host_ptr = backing.empty() ? nullptr : backing[i].data();
+            buffers[i] = clCreateBuffer(context, CL_MEM_READ_WRITE | kind.flags,
+                                        size, host_ptr, &error);
+            if (is_allocation_failure(error)) return error;
+            test_error(error, "clCreateBuffer failed");
+        }
+
+        const cl_uint seed = (cl_uint)size;
+        fill_pattern(src, size, seed);
+        if (op != TransferOp::write)
+        {
+            error = clEnqueueWriteBuffer(queue, buffers[0], CL_TRUE, 0, size,
+                                         src, 0, nullptr, nullptr);
+            if (is_allocation_failure(error)) return error;
+            test_error(error, "clEnqueueWriteBuffer failed");
+        }
+
+        std::vector<double> samples;
+        for (unsigned i = 0; i < warmup + repetitions; i++)
+        {
+            double seconds = 0.0;
+            error = transfer(buffers, size, src, dst, seed, i == 0, seconds);
+            if (error != CL_SUCCESS) return error;
+            if (i >= warmup) samples.push_back(seconds);
+        }
+
+        if (op != TransferOp::map)
+        {
+            if (op != TransferOp::read)
+            {
+                error = clEnqueueReadBuffer(queue, buffers[buffer_count - 1],
+                                            CL_TRUE, 0, size, dst, 0, nullptr,
+                                            nullptr);
+                test_error(error, "clEnqueueReadBuffer failed");
+            }
+            if (!check_pattern(dst, size, seed))
+            {
+                log_error("ERROR: %s with %s, %s host memory, %zu bytes "
+                          "returned wrong data\n",
+                          op_name(op), kind.name, align.name, size);
+                return CL_INVALID_VALUE;
+            }
+        }
+
+        report(kind, align, size, samples);
+        return CL_SUCCESS;
+    }
+
+    cl_int transfer(clMemWrapper *buffers, size_t size, cl_uchar *src,
+                    cl_uchar *dst, cl_uint seed, bool verify, double &seconds)
+    {
+        cl_int error = CL_SUCCESS;
+        clEventWrapper event;
+        switch (op)
+        {
+            case TransferOp::read:
+                error = clEnqueueReadBuffer(queue, buffers[0], CL_FALSE, 0,
+                                            size, dst, 0, nullptr, &event);
+                break;
+            case TransferOp::write:
+                error = clEnqueueWriteBuffer(queue, buffers[0], CL_FALSE, 0,
+                                             size, src, 0, nullptr, &event);
+                break;
+            case TransferOp::copy:
+                error = clEnqueueCopyBuffer(queue, buffers[0], buffers[1], 0, 0,
+                                            size, 0, nullptr, &event);
+                break;
+            case TransferOp::map: {
+                clEventWrapper map_event;
+                void *mapped = clEnqueueMapBuffer(
+                    queue, buffers[0], CL_TRUE, CL_MAP_READ, 0, size, 0,
+                    nullptr, &map_event, &error);
+                if (error != CL_SUCCESS) return error;
+                error = event_duration(map_event, seconds);
+                if (error != CL_SUCCESS) return error;
+                if (verify && !check_pattern((cl_uchar *)mapped, size, seed))
+                {
+                    log_error("ERROR: mapped buffer of %zu bytes contains "
+                              "wrong data\n",
+                              size);
+                    error = CL_INVALID_VALUE;
+                }
+                // The unmap is timed below, so the sample covers both
+                cl_int unmap_error = clEnqueueUnmapMemObject(
+                    queue, buffers[0], mapped, 0, nullptr, &event);
+                test_error(unmap_error, "clEnqueueUnmapMemObject failed");
+                break;
+            }
+        }
+        if (error != CL_SUCCESS) return error;
+        error = clWaitForEvents(1, &event);
+        test_error(error, "clWaitForEvents failed");
+        return event_duration(event, seconds);
+    }
+
+    void report(const AllocationKind &kind, const HostAlignment &align,
+                size_t size, const std::vector<double> &samples)
+    {
+        std::string name = std::string(op_name(op)) + "/" + kind.name + "/"
+            + align.name + "/" + std::to_string(size);
+        BenchmarkKey key = { name, 1, "" };
+        BenchmarkStats stats = record_benchmark(key, size, samples);
+        if (!benchmarks_requested() || stats.median <= 0.0) return;
+
+        // Stats are in microseconds per byte
+        log_info("%s %s %s %10zu bytes: %8.2f GB/s, p50 %10.1f us, "
+                 "p99 %10.1f us\n",
+                 op_name(op), kind.name, align.name, size, 1e-3 / stats.median,
+                 stats.median * size, stats.p99 * size);
+    }
+
+    cl_context context;
+    cl_command_queue queue;
+    TransferOp op;
+    size_t alignment;
+};
+
+int test_transfer(cl_device_id device, cl_context context, TransferOp op)
+{
+    cl_int error;
+    clCommandQueueWrapper queue = clCreateCommandQueue(
+        context, device, CL_QUEUE_PROFILING_ENABLE, &error);
+    test_error(error, "clCreateCommandQueue failed");
+
+    cl_ulong max_alloc_size;
+    error = clGetDeviceInfo(device, CL_DEVICE_MAX_MEM_ALLOC_SIZE,
+                            sizeof(max_alloc_size), &max_alloc_size, nullptr);
+    test_error(error, "clGetDeviceInfo failed");
+
+    const bool benchmark = benchmarks_requested();
+    size_t max_size = (size_t)std::min<cl_ulong>(max_alloc_size, SIZE_MAX / 2);
+    if (!benchmark) max_size = std::min(max_size, kDefaultMaxTransferSize);
+    const unsigned warmup = benchmark ? gBenchmarkWarmup : 0;
+    const unsigned repetitions = !benchmark ? 1
+        : gBenchmarkRepetitions             ? gBenchmarkRepetitions
+                                            : kDefaultRepetitions;
+
+    const size_t alignment =
+        std::max(get_min_alignment(context), (size_t)4096);
+    TransferTest transfer_test(context, queue, op, alignment);
+
+    for (const AllocationKind &kind : allocation_kinds)
+    {
+        for (const HostAlignment &align : host_alignments)
+        {
+            // Device-to-device transfers only involve host memory when it
+            // backs the buffers
+            bool uses_host_ptr = op == TransferOp::read
+                || op == TransferOp::write
+                || (kind.flags & CL_MEM_USE_HOST_PTR);
+            if (!uses_host_ptr && align.offset != 0) continue;
+
+            log_info("%s with %s, %s host memory\n", op_name(op), kind.name,
+                     align.name);
+            for (size_t size = kMinTransferSize; size <= max_size; size *= 2)
+            {
+                error = transfer_test.run(kind, align, size, warmup,
+                                          repetitions);
+                if (error == CL_SUCCESS) continue;
+                // Large allocations may fail even below the maximum size
+                if (is_allocation_failure(error)
+                    && size > kDefaultMaxTransferSize)
+                {
+                    log_info("Unable to allocate %zu bytes, stopping sweep\n",
+                             size);
+                    break;
+                }
+                print_error(error, "Transfer failed");
+                return TEST_FAIL;
+            }
+        }
+    }
+    return TEST_PASS;
+}
+
+} // namespace
+
+int test_buffer_read_bandwidth(cl_device_id deviceID, cl_context context,
+                               cl_command_queue queue, int num_elements)
+{
+    return test_transfer(deviceID, context, TransferOp::read);
+}
+
+int test_buffer_write_bandwidth(cl_device_id deviceID, cl_context context,
+                                cl_command_queue queue, int num_elements)
+{
+    return test_transfer(deviceID, context, TransferOp::write);
+}
+
+int test_buffer_map_bandwidth(cl_device_id deviceID, cl_context context,
+                              cl_command_queue queue, int num_elements)
+{
+    return test_transfer(deviceID, context, TransferOp::map);
+}
+
+int test_buffer_copy_bandwidth(cl_device_id deviceID, cl_context context,
+                               cl_command_queue queue, int num_elements)
+{
+    return test_transfer(deviceID, context, TransferOp::copy);
+}
@@ -23,6 +23,7 @@
 
 #include "procs.h"
 #include "harness/errorHelpers.h"
+#include "harness/patternHelpers.h"
 
 #define TEST_PRIME_CHAR        0x77
 #define TEST_PRIME_INT        ((1<<16)+1)
@@ -407,160 +408,37 @@ static const char *struct_kernel_code =
 
 
 
-static int verify_fill_int( void *ptr1, void *ptr2, int n )
+// Checks that the fill wrote the pattern over [offset, offset + fill_size)
+// and left the zero initialized bytes around it untouched
+static int verify_fill(const void *outptr, size_t size, const void *pattern,
+                       size_t pattern_size, size_t offset, size_t fill_size)
 {
-    int     i;
-    cl_int  *inptr = (cl_int *)ptr1;
-    cl_int  *outptr = (cl_int *)ptr2;
-
-    for (i=0; i<n; i++){
-        if ( outptr[i] != inptr[i] )
-            return -1;
-    }
-
-    return 0;
-}
-
-
-static int verify_fill_uint( void *ptr1, void *ptr2, int n )
-{
-    int     i;
-    cl_uint *inptr = (cl_uint *)ptr1;
-    cl_uint *outptr = (cl_uint *)ptr2;
-
-    for (i=0; i<n; i++){
-        if ( outptr[i] != inptr[i] )
-            return -1;
-    }
-
-    return 0;
-}
-
-
-static int verify_fill_short( void *ptr1, void *ptr2, int n )
-{
-    int      i;
-    cl_short *inptr = (cl_short *)ptr1;
-    cl_short *outptr = (cl_short *)ptr2;
-
-    for (i=0; i<n; i++){
-        if ( outptr[i] != inptr[i] )
-            return -1;
-    }
-
-    return 0;
-}
-
-
-static int verify_fill_ushort( void *ptr1, void *ptr2, int n )
-{
-    int       i;
-    cl_ushort *inptr = (cl_ushort *)ptr1;
-    cl_ushort *outptr = (cl_ushort *)ptr2;
-
-    for (i=0; i<n; i++){
-        if ( outptr[i] != inptr[i] )
-            return -1;
-    }
-
-    return 0;
-}
-
-
-static int verify_fill_char( void *ptr1, void *ptr2, int n )
-{
-    int     i;
-    cl_char *inptr = (cl_char *)ptr1;
-    cl_char *outptr = (cl_char *)ptr2;
-
-    for (i=0; i<n; i++){
-        if ( outptr[i] != inptr[i] )
-            return -1;
-    }
-
-    return 0;
-}
-
-
-static int verify_fill_uchar( void *ptr1, void *ptr2, int n )
-{
-    int      i;
-    cl_uchar *inptr = (cl_uchar *)ptr1;
-    cl_uchar *outptr = (cl_uchar *)ptr2;
-
-    for (i=0; i<n; i++){
-        if ( outptr[i] != inptr[i] )
-            return -1;
-    }
-
-    return 0;
-}
-
-
-static int verify_fill_long( void *ptr1, void *ptr2, int n )
-{
-    int     i;
-    cl_long *inptr = (cl_long *)ptr1;
-    cl_long *outptr = (cl_long *)ptr2;
-
-    for (i=0; i<n; i++){
-        if ( outptr[i] != inptr[i] )
-            return -1;
-    }
-
-    return 0;
-}
-
-
-static int verify_fill_ulong( void *ptr1, void *ptr2, int n )
-{
-    int      i;
-    cl_ulong *inptr = (cl_ulong *)ptr1;
-    cl_ulong *outptr = (cl_ulong *)ptr2;
-
-    for (i=0; i<n; i++){
-        if ( outptr[i] != inptr[i] )
-            return -1;
-    }
-
-    return 0;
-}
-
-
-static int verify_fill_float( void *ptr1, void *ptr2, int n )
-{
-    int      i;
-    cl_float *inptr = (cl_float *)ptr1;
-    cl_float *outptr = (cl_float *)ptr2;
-
-    for (i=0; i<n; i++){
-        if ( outptr[i] != inptr[i] )
-            return -1;
+    const cl_uchar *out = (const cl_uchar *)outptr;
+    const cl_uchar zero = 0;
+    size_t mismatch = verify_pattern(out, offset, &zero, 1);
+    if (mismatch == PATTERN_MATCH)
+    {
+        mismatch =
+            verify_pattern(out + offset, fill_size, pattern, pattern_size);
+        if (mismatch != PATTERN_MATCH) mismatch += offset;
     }
-
-    return 0;
-}
-
-
-static int verify_fill_struct( void *ptr1, void *ptr2, int n )
-{
-    int         i;
-    TestStruct  *inptr = (TestStruct *)ptr1;
-    TestStruct  *outptr = (TestStruct *)ptr2;
-
-    for (i=0; i<n; i++){
-        if ( ( outptr[i].a != inptr[i].a ) || ( outptr[i].b != outptr[i].b ) )
-            return -1;
+    if (mismatch == PATTERN_MATCH)
+    {
+        size_t end = offset + fill_size;
+        mismatch = verify_pattern(out + end, size - end, &zero, 1);
+        if (mismatch != PATTERN_MATCH) mismatch += end;
     }
+    if (mismatch == PATTERN_MATCH) return 0;
 
-    return 0;
+    log_error(" First mismatch at byte %zu (element %zu, byte %zu)\n",
+              mismatch, mismatch / pattern_size, mismatch % pattern_size);
+    return -1;
 }
 
 
-
 int test_buffer_fill( cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements, size_t size, char *type,
-                     int loops, void *inptr[5], void *hostptr[5], void *pattern[5], size_t offset_elements, size_t fill_elements,
-                     const char *kernelCode[], const char *kernelName[], int (*fn)(void *,void *,int) )
+                     int loops, void *hostptr[5], void *pattern[5], size_t offset_elements, size_t fill_elements,
+                     const char *kernelCode[], const char *kernelName[] )
 {
     void        *outptr[5];
     clProgramWrapper program[5];
@@ -680,7 +558,10 @@ int test_buffer_fill( cl_device_id deviceID, cl_context context, cl_command_queu
                 print_error( err, "clWaitForEvents() failed" );
             }
 
-            if ( fn( inptr[i], outptr[i], (int)(ptrSizes[i] * (size_t)num_elements / ptrSizes[0]) ) ){
+            if (verify_fill(outptr[i], ptrSizes[i] * num_elements, pattern[i],
+                            ptrSizes[i], ptrSizes[i] * offset_elements,
+                            ptrSizes[i] * fill_elements))
+            {
                 log_error(" %s%d test failed. (cl_mem_flags: %s)\n", type,
                           1 << i, flag_set_names[src_flag_id]);
                 total_errors++;
@@ -706,7 +587,7 @@ int test_buffer_fill_struct( cl_device_id deviceID, cl_context context, cl_comma
     size_t      ptrSize = sizeof( TestStruct );
     size_t      global_work_size[3];
     int         n, err;
-    size_t      j, offset_elements, fill_elements;
+    size_t      offset_elements, fill_elements;
     int         src_flag_id;
     int         total_errors = 0;
     MTdata      d = init_genrand( gRandomSeed );
@@ -739,7 +620,6 @@ int test_buffer_fill_struct( cl_device_id deviceID, cl_context context, cl_comma
             clEventWrapper event[2];
             clMemWrapper buffers[2];
             void *outptr;
-            TestStruct *inptr;
             TestStruct *hostptr;
 
             offset_elements =
@@ -752,25 +632,6 @@ int test_buffer_fill_struct( cl_device_id deviceID, cl_context context, cl_comma
             pattern.a = (cl_int)genrand_int32(d);
             pattern.b = (cl_float)get_random_float(-FLT_MAX, FLT_MAX, d);
 
-            inptr = (TestStruct *)align_malloc(ptrSize * num_elements,
-                                               min_alignment);
-            for (j = 0; j < offset_elements; j++)
-            {
-                inptr[j].a = 0;
-                inptr[j].b = 0;
-            }
-            for (j = offset_elements; j < offset_elements + fill_elements; j++)
-            {
-                inptr[j].a = pattern.a;
-                inptr[j].b = pattern.b;
-            }
-            for (j = offset_elements + fill_elements; j < (size_t)num_elements;
-                 j++)
-            {
-                inptr[j].a = 0;
-                inptr[j].b = 0;
-            }
-
             hostptr = (TestStruct *)align_malloc(ptrSize * num_elements,
                                                  min_alignment);
             memset(hostptr, 0, ptrSize * num_elements);
@@ -781,7 +642,6 @@ int test_buffer_fill_struct( cl_device_id deviceID, cl_context context, cl_comma
                 buffers[0] = clCreateBuffer(context, flag_set[src_flag_id],  ptrSize * num_elements, NULL, &err);
             if ( err ){
                 print_error(err, " clCreateBuffer failed\n" );
-                align_free( (void *)inptr );
                 align_free( (void *)hostptr );
                 free_mtdata(d);
                 return -1;
@@ -790,7 +650,6 @@ int test_buffer_fill_struct( cl_device_id deviceID, cl_context context, cl_comma
                 err = clEnqueueWriteBuffer(queue, buffers[0], CL_FALSE, 0, ptrSize * num_elements, hostptr, 0, NULL, NULL);
                 if ( err != CL_SUCCESS ){
                     print_error(err, " clEnqueueWriteBuffer failed\n" );
-                    align_free( (void *)inptr );
                     align_free( (void *)hostptr );
                     free_mtdata(d);
                     return -1;
@@ -802,7 +661,6 @@ int test_buffer_fill_struct( cl_device_id deviceID, cl_context context, cl_comma
             if ( ! buffers[1] || err){
                 print_error(err, " clCreateBuffer failed\n" );
                 align_free( outptr );
-                align_free( (void *)inptr );
                 align_free( (void *)hostptr );
                 free_mtdata(d);
                 return -1;
@@ -811,13 +669,9 @@ int test_buffer_fill_struct( cl_device_id deviceID, cl_context context, cl_comma
             err = clEnqueueFillBuffer(
                 queue, buffers[0], &pattern, ptrSize, ptrSize * offset_elements,
                 ptrSize * fill_elements, 0, NULL, &(event[0]));
-            /* uncomment for test debugging
-             err = clEnqueueWriteBuffer(queue, buffers[0], CL_FALSE, 0, ptrSize * num_elements, inptr, 0, NULL, &(event[0]));
-             */
             if ( err != CL_SUCCESS ){
                 print_error( err, " clEnqueueFillBuffer failed" );
                 align_free( outptr );
-                align_free( (void *)inptr );
                 align_free( (void *)hostptr );
                 free_mtdata(d);
                 return -1;
@@ -828,7 +682,6 @@ int test_buffer_fill_struct( cl_device_id deviceID, cl_context context, cl_comma
             if ( err != CL_SUCCESS ){
                 print_error( err, " clSetKernelArg failed" );
                 align_free( outptr );
-                align_free( (void *)inptr );
                 align_free( (void *)hostptr );
                 free_mtdata(d);
                 return -1;
@@ -838,7 +691,6 @@ int test_buffer_fill_struct( cl_device_id deviceID, cl_context context, cl_comma
             if ( err != CL_SUCCESS ){
                 print_error( err, "clWaitForEvents() failed" );
                 align_free( outptr );
-                align_free( (void *)inptr );
                 align_free( (void *)hostptr );
                 free_mtdata(d);
                 return -1;
@@ -848,7 +700,6 @@ int test_buffer_fill_struct( cl_device_id deviceID, cl_context context, cl_comma
             if ( err != CL_SUCCESS ){
                 print_error( err, " clEnqueueNDRangeKernel failed" );
                 align_free( outptr );
-                align_free( (void *)inptr );
                 align_free( (void *)hostptr );
                 free_mtdata(d);
                 return -1;
@@ -858,7 +709,6 @@ int test_buffer_fill_struct( cl_device_id deviceID, cl_context context, cl_comma
             if ( err != CL_SUCCESS ){
                 print_error( err, " clEnqueueReadBuffer failed" );
                 align_free( outptr );
-                align_free( (void *)inptr );
                 align_free( (void *)hostptr );
                 free_mtdata(d);
                 return -1;
@@ -869,7 +719,10 @@ int test_buffer_fill_struct( cl_device_id deviceID, cl_context context, cl_comma
                 print_error( err, "clWaitForEvents() failed" );
             }
 
-            if ( verify_fill_struct( inptr, outptr, num_elements) ) {
+            if (verify_fill(outptr, ptrSize * num_elements, &pattern, ptrSize,
+                            ptrSize * offset_elements,
+                            ptrSize * fill_elements))
+            {
                 log_error( " buffer_FILL async struct test failed\n" );
                 total_errors++;
             }
@@ -878,7 +731,6 @@ int test_buffer_fill_struct( cl_device_id deviceID, cl_context context, cl_comma
             }
             // cleanup
             align_free( outptr );
-            align_free((void *)inptr);
             align_free((void *)hostptr);
         } // src cl_mem_flag
     }
@@ -892,19 +744,15 @@ int test_buffer_fill_struct( cl_device_id deviceID, cl_context context, cl_comma
 
 int test_buffer_fill_int( cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements )
 {
-    cl_int  *inptr[5];
     cl_int  *hostptr[5];
     cl_int  *pattern[5];
     size_t  ptrSizes[5];
     int     n, i, err=0;
     size_t  j, offset_elements, fill_elements;
-    int     (*foo)(void *,void *,int);
     MTdata  d = init_genrand( gRandomSeed );
 
     size_t  min_alignment = get_min_alignment(context);
 
-    foo = verify_fill_int;
-
     ptrSizes[0] = sizeof(cl_int);
     ptrSizes[1] = ptrSizes[0] << 1;
     ptrSizes[2] = ptrSizes[1] << 1;
@@ -922,27 +770,18 @@ int test_buffer_fill_int( cl_device_id deviceID, cl_context context, cl_command_
             for ( j = 0; j < ptrSizes[i] / ptrSizes[0]; j++ )
                 pattern[i][j] = TEST_PRIME_INT;
 
-            inptr[i] = (cl_int *)align_malloc(ptrSizes[i] * num_elements, min_alignment);
-            for ( j = 0; j < ptrSizes[i] * offset_elements / ptrSizes[0]; j++ )
-                inptr[i][j] = 0;
-            for ( j = ptrSizes[i] * offset_elements / ptrSizes[0]; j < ptrSizes[i] * (offset_elements + fill_elements) / ptrSizes[0]; j++ )
-                inptr[i][j] = TEST_PRIME_INT;
-            for ( j = ptrSizes[i] * (offset_elements + fill_elements) / ptrSizes[0]; j < ptrSizes[i] * num_elements / ptrSizes[0]; j++ )
-                inptr[i][j] = 0;
-
             hostptr[i] = (cl_int *)align_malloc(ptrSizes[i] * num_elements, min_alignment);
             memset(hostptr[i], 0, ptrSizes[i] * num_elements);
         }
 
         if (test_buffer_fill( deviceID, context, queue, num_elements, sizeof( cl_int ), (char*)"int",
-                             5, (void**)inptr, (void**)hostptr, (void**)pattern,
+                             5, (void**)hostptr, (void**)pattern,
                              offset_elements, fill_elements,
-                             buffer_fill_int_kernel_code, int_kernel_name, foo ))
+                             buffer_fill_int_kernel_code, int_kernel_name ))
             err++;
 
         for ( i = 0; i < 5; i++ ){
             free( (void *)pattern[i] );
-            align_free( (void *)inptr[i] );
             align_free( (void *)hostptr[i] );
         }
 
@@ -957,19 +796,15 @@ int test_buffer_fill_int( cl_device_id deviceID, cl_context context, cl_command_
 
 int test_buffer_fill_uint( cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements )
 {
-    cl_uint *inptr[5];
     cl_uint *hostptr[5];
     cl_uint *pattern[5];
     size_t  ptrSizes[5];
     int     n, i, err=0;
     size_t  j, offset_elements, fill_elements;
     MTdata  d = init_genrand( gRandomSeed );
-    int     (*foo)(void *,void *,int);
 
     size_t  min_alignment = get_min_alignment(context);
 
-    foo = verify_fill_uint;
-
     ptrSizes[0] = sizeof(cl_uint);
     ptrSizes[1] = ptrSizes[0] << 1;
     ptrSizes[2] = ptrSizes[1] << 1;
@@ -987,27 +822,18 @@ int test_buffer_fill_uint( cl_device_id deviceID, cl_context context, cl_command
             for ( j = 0; j < ptrSizes[i] / ptrSizes[0]; j++ )
                 pattern[i][j] = TEST_PRIME_UINT;
 
-            inptr[i] = (cl_uint *)align_malloc(ptrSizes[i] * num_elements, min_alignment);
-            for ( j = 0; j < ptrSizes[i] * offset_elements / ptrSizes[0]; j++ )
-                inptr[i][j] = 0;
-            for ( j = ptrSizes[i] * offset_elements / ptrSizes[0]; j < ptrSizes[i] * (offset_elements + fill_elements) / ptrSizes[0]; j++ )
-                inptr[i][j] = TEST_PRIME_UINT;
-            for ( j = ptrSizes[i] * (offset_elements + fill_elements) / ptrSizes[0]; j < ptrSizes[i] * num_elements / ptrSizes[0]; j++ )
-                inptr[i][j] = 0;
-
             hostptr[i] = (cl_uint *)align_malloc(ptrSizes[i] * num_elements, min_alignment);
             memset(hostptr[i], 0, ptrSizes[i] * num_elements);
         }
 
         if (test_buffer_fill( deviceID, context, queue, num_elements, sizeof( cl_uint ), (char*)"uint",
-                             5, (void**)inptr, (void**)hostptr, (void**)pattern,
+                             5, (void**)hostptr, (void**)pattern,
                              offset_elements, fill_elements,
-                             buffer_fill_uint_kernel_code, uint_kernel_name, foo ))
+                             buffer_fill_uint_kernel_code, uint_kernel_name ))
             err++;
 
         for ( i = 0; i < 5; i++ ){
             free( (void *)pattern[i] );
-            align_free( (void *)inptr[i] );
             align_free( (void *)hostptr[i] );
         }
 
@@ -1022,19 +848,15 @@ int test_buffer_fill_uint( cl_device_id deviceID, cl_context context, cl_command
 
 int test_buffer_fill_short( cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements )
 {
-    cl_short *inptr[5];
     cl_short *hostptr[5];
     cl_short *pattern[5];
     size_t   ptrSizes[5];
     int      n, i, err=0;
     size_t   j, offset_elements, fill_elements;
     MTdata   d = init_genrand( gRandomSeed );
-    int      (*foo)(void *,void *,int);
 
     size_t  min_alignment = get_min_alignment(context);
 
-    foo = verify_fill_short;
-
     ptrSizes[0] = sizeof(cl_short);
     ptrSizes[1] = ptrSizes[0] << 1;
     ptrSizes[2] = ptrSizes[1] << 1;
@@ -1052,27 +874,18 @@ int test_buffer_fill_short( cl_device_id deviceID, cl_context context, cl_comman
             for ( j = 0; j < ptrSizes[i] / ptrSizes[0]; j++ )
                 pattern[i][j] = TEST_PRIME_SHORT;
 
-            inptr[i] = (cl_short *)align_malloc(ptrSizes[i] * num_elements, min_alignment);
-            for ( j = 0; j < ptrSizes[i] * offset_elements / ptrSizes[0]; j++ )
-                inptr[i][j] = 0;
-            for ( j = ptrSizes[i] * offset_elements / ptrSizes[0]; j < ptrSizes[i] * (offset_elements + fill_elements) / ptrSizes[0]; j++ )
-                inptr[i][j] = TEST_PRIME_SHORT;
-            for ( j = ptrSizes[i] * (offset_elements + fill_elements) / ptrSizes[0]; j < ptrSizes[i] * num_elements / ptrSizes[0]; j++ )
-                inptr[i][j] = 0;
-
             hostptr[i] = (cl_short *)align_malloc(ptrSizes[i] * num_elements, min_alignment);
             memset(hostptr[i], 0, ptrSizes[i] * num_elements);
         }
 
         if (test_buffer_fill( deviceID, context, queue, num_elements, sizeof( cl_short ), (char*)"short",
-                             5, (void**)inptr, (void**)hostptr, (void**)pattern,
+                             5, (void**)hostptr, (void**)pattern,
                              offset_elements, fill_elements,
-                             buffer_fill_short_kernel_code, short_kernel_name, foo ))
+                             buffer_fill_short_kernel_code, short_kernel_name ))
             err++;
 
         for ( i = 0; i < 5; i++ ){
             free( (void *)pattern[i] );
-            align_free( (void *)inptr[i] );
             align_free( (void *)hostptr[i] );
         }
 
@@ -1087,19 +900,15 @@ int test_buffer_fill_short( cl_device_id deviceID, cl_context context, cl_comman
 
 int test_buffer_fill_ushort( cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements )
 {
-    cl_ushort *inptr[5];
     cl_ushort *hostptr[5];
     cl_ushort *pattern[5];
     size_t    ptrSizes[5];
     int       n, i, err=0;
     size_t    j, offset_elements, fill_elements;
     MTdata    d = init_genrand( gRandomSeed );
-    int       (*foo)(void *,void *,int);
 
     size_t    min_alignment = get_min_alignment(context);
 
-    foo = verify_fill_ushort;
-
     ptrSizes[0] = sizeof(cl_ushort);
     ptrSizes[1] = ptrSizes[0] << 1;
     ptrSizes[2] = ptrSizes[1] << 1;
@@ -1117,27 +926,18 @@ int test_buffer_fill_ushort( cl_device_id deviceID, cl_context context, cl_comma
             for ( j = 0; j < ptrSizes[i] / ptrSizes[0]; j++ )
                 pattern[i][j] = TEST_PRIME_USHORT;
 
-            inptr[i] = (cl_ushort *)align_malloc(ptrSizes[i] * num_elements, min_alignment);
-            for ( j = 0; j < ptrSizes[i] * offset_elements / ptrSizes[0]; j++ )
-                inptr[i][j] = 0;
-            for ( j = ptrSizes[i] * offset_elements / ptrSizes[0]; j < ptrSizes[i] * (offset_elements + fill_elements) / ptrSizes[0]; j++ )
-                inptr[i][j] = TEST_PRIME_USHORT;
-            for ( j = ptrSizes[i] * (offset_elements + fill_elements) / ptrSizes[0]; j < ptrSizes[i] * num_elements / ptrSizes[0]; j++ )
-                inptr[i][j] = 0;
-
             hostptr[i] = (cl_ushort *)align_malloc(ptrSizes[i] * num_elements, min_alignment);
             memset(hostptr[i], 0, ptrSizes[i] * num_elements);
         }
 
         if (test_buffer_fill( deviceID, context, queue, num_elements, sizeof( cl_ushort ), (char*)"ushort",
-                             5, (void**)inptr, (void**)hostptr, (void**)pattern,
+                             5, (void**)hostptr, (void**)pattern,
                              offset_elements, fill_elements,
-                             buffer_fill_ushort_kernel_code, ushort_kernel_name, foo ))
+                             buffer_fill_ushort_kernel_code, ushort_kernel_name ))
             err++;
 
         for ( i = 0; i < 5; i++ ){
             free( (void *)pattern[i] );
-            align_free( (void *)inptr[i] );
             align_free( (void *)hostptr[i] );
         }
 
@@ -1152,19 +952,15 @@ int test_buffer_fill_ushort( cl_device_id deviceID, cl_context context, cl_comma
 
 int test_buffer_fill_char( cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements )
 {
-    cl_char *inptr[5];
     cl_char *hostptr[5];
     cl_char *pattern[5];
     size_t  ptrSizes[5];
     int     n, i, err=0;
     size_t  j, offset_elements, fill_elements;
     MTdata  d = init_genrand( gRandomSeed );
-    int     (*foo)(void *,void *,int);
 
     size_t  min_alignment = get_min_alignment(context);
 
-    foo = verify_fill_char;
-
     ptrSizes[0] = sizeof(cl_char);
     ptrSizes[1] = ptrSizes[0] << 1;
     ptrSizes[2] = ptrSizes[1] << 1;
@@ -1182,27 +978,18 @@ int test_buffer_fill_char( cl_device_id deviceID, cl_context context, cl_command
             for ( j = 0; j < ptrSizes[i] / ptrSizes[0]; j++ )
                 pattern[i][j] = TEST_PRIME_CHAR;
 
-            inptr[i] = (cl_char *)align_malloc(ptrSizes[i] * num_elements, min_alignment);
-            for ( j = 0; j < ptrSizes[i] * offset_elements / ptrSizes[0]; j++ )
-                inptr[i][j] = 0;
-            for ( j = ptrSizes[i] * offset_elements / ptrSizes[0]; j < ptrSizes[i] * (offset_elements + fill_elements) / ptrSizes[0]; j++ )
-                inptr[i][j] = TEST_PRIME_CHAR;
-            for ( j = ptrSizes[i] * (offset_elements + fill_elements) / ptrSizes[0]; j < ptrSizes[i] * num_elements / ptrSizes[0]; j++ )
-                inptr[i][j] = 0;
-
             hostptr[i] = (cl_char *)align_malloc(ptrSizes[i] * num_elements, min_alignment);
             memset(hostptr[i], 0, ptrSizes[i] * num_elements);
         }
 
         if (test_buffer_fill( deviceID, context, queue, num_elements, sizeof( cl_char ), (char*)"char",
-                             5, (void**)inptr, (void**)hostptr, (void**)pattern,
+                             5, (void**)hostptr, (void**)pattern,
                              offset_elements, fill_elements,
-                             buffer_fill_char_kernel_code, char_kernel_name, foo ))
+                             buffer_fill_char_kernel_code, char_kernel_name ))
             err++;
 
         for ( i = 0; i < 5; i++ ){
             free( (void *)pattern[i] );
-            align_free( (void *)inptr[i] );
             align_free( (void *)hostptr[i] );
         }
 
@@ -1217,19 +1004,15 @@ int test_buffer_fill_char( cl_device_id deviceID, cl_context context, cl_command
 
 int test_buffer_fill_uchar( cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements )
 {
-    cl_uchar *inptr[5];
     cl_uchar *hostptr[5];
     cl_uchar *pattern[5];
     size_t   ptrSizes[5];
     int      n, i, err=0;
     size_t   j, offset_elements, fill_elements;
     MTdata   d = init_genrand( gRandomSeed );
-    int      (*foo)(void *,void *,int);
 
     size_t  min_alignment = get_min_alignment(context);
 
-    foo = verify_fill_uchar;
-
     ptrSizes[0] = sizeof(cl_uchar);
     ptrSizes[1] = ptrSizes[0] << 1;
     ptrSizes[2] = ptrSizes[1] << 1;
@@ -1247,27 +1030,18 @@ int test_buffer_fill_uchar( cl_device_id deviceID, cl_context context, cl_comman
             for ( j = 0; j < ptrSizes[i] / ptrSizes[0]; j++ )
                 pattern[i][j] = TEST_PRIME_CHAR;
 
-            inptr[i] = (cl_uchar *)align_malloc(ptrSizes[i] * num_elements, min_alignment);
-            for ( j = 0; j < ptrSizes[i] * offset_elements / ptrSizes[0]; j++ )
-                inptr[i][j] = 0;
-            for ( j = ptrSizes[i] * offset_elements / ptrSizes[0]; j < ptrSizes[i] * (offset_elements + fill_elements) / ptrSizes[0]; j++ )
-                inptr[i][j] = TEST_PRIME_CHAR;
-            for ( j = ptrSizes[i] * (offset_elements + fill_elements) / ptrSizes[0]; j < ptrSizes[i] * num_elements / ptrSizes[0]; j++ )
-                inptr[i][j] = 0;
-
             hostptr[i] = (cl_uchar *)align_malloc(ptrSizes[i] * num_elements, min_alignment);
             memset(hostptr[i], 0, ptrSizes[i] * num_elements);
         }
 
         if (test_buffer_fill( deviceID, context, queue, num_elements, sizeof( cl_uchar ), (char*)"uchar",
-                             5, (void**)inptr, (void**)hostptr, (void**)pattern,
+                             5, (void**)hostptr, (void**)pattern,
                              offset_elements, fill_elements,
-                             buffer_fill_uchar_kernel_code, uchar_kernel_name, foo ))
+                             buffer_fill_uchar_kernel_code, uchar_kernel_name ))
             err++;
 
         for ( i = 0; i < 5; i++ ){
             free( (void *)pattern[i] );
-            align_free( (void *)inptr[i] );
             align_free( (void *)hostptr[i] );
         }
 
@@ -1282,19 +1056,15 @@ int test_buffer_fill_uchar( cl_device_id deviceID, cl_context context, cl_comman
 
 int test_buffer_fill_long( cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements )
 {
-    cl_long *inptr[5];
     cl_long *hostptr[5];
     cl_long *pattern[5];
     size_t  ptrSizes[5];
     int     n, i, err=0;
     size_t  j, offset_elements, fill_elements;
     MTdata  d = init_genrand( gRandomSeed );
-    int     (*foo)(void *,void *,int);
 
     size_t  min_alignment = get_min_alignment(context);
 
-    foo = verify_fill_long;
-
     ptrSizes[0] = sizeof(cl_long);
     ptrSizes[1] = ptrSizes[0] << 1;
     ptrSizes[2] = ptrSizes[1] << 1;
@@ -1319,27 +1089,18 @@ int test_buffer_fill_long( cl_device_id deviceID, cl_context context, cl_command
             for ( j = 0; j < ptrSizes[i] / ptrSizes[0]; j++ )
                 pattern[i][j] = TEST_PRIME_LONG;
 
-            inptr[i] = (cl_long *)align_malloc(ptrSizes[i] * num_elements, min_alignment);
-            for ( j = 0; j < ptrSizes[i] * offset_elements / ptrSizes[0]; j++ )
-                inptr[i][j] = 0;
-            for ( j = ptrSizes[i] * offset_elements / ptrSizes[0]; j < ptrSizes[i] * (offset_elements + fill_elements) / ptrSizes[0]; j++ )
-                inptr[i][j] = TEST_PRIME_LONG;
-            for ( j = ptrSizes[i] * (offset_elements + fill_elements) / ptrSizes[0]; j < ptrSizes[i] * num_elements / ptrSizes[0]; j++ )
-                inptr[i][j] = 0;
-
             hostptr[i] = (cl_long *)align_malloc(ptrSizes[i] * num_elements, min_alignment);
             memset(hostptr[i], 0, ptrSizes[i] * num_elements);
         }
 
         if (test_buffer_fill( deviceID, context, queue, num_elements, sizeof( cl_long ), (char*)"long",
-                             5, (void**)inptr, (void**)hostptr, (void**)pattern,
+                             5, (void**)hostptr, (void**)pattern,
                              offset_elements, fill_elements,
-                             buffer_fill_long_kernel_code, long_kernel_name, foo ))
+                             buffer_fill_long_kernel_code, long_kernel_name ))
             err++;
 
         for ( i = 0; i < 5; i++ ){
             free( (void *)pattern[i] );
-            align_free( (void *)inptr[i] );
             align_free( (void *)hostptr[i] );
         }
 
@@ -1354,19 +1115,15 @@ int test_buffer_fill_long( cl_device_id deviceID, cl_context context, cl_command
 
 int test_buffer_fill_ulong( cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements )
 {
-    cl_ulong *inptr[5];
     cl_ulong *hostptr[5];
     cl_ulong *pattern[5];
     size_t   ptrSizes[5];
     int      n, i, err=0;
     size_t   j, offset_elements, fill_elements;
     MTdata   d = init_genrand( gRandomSeed );
-    int      (*foo)(void *,void *,int);
 
     size_t   min_alignment = get_min_alignment(context);
 
-    foo = verify_fill_ulong;
-
     ptrSizes[0] = sizeof(cl_ulong);
     ptrSizes[1] = ptrSizes[0] << 1;
     ptrSizes[2] = ptrSizes[1] << 1;
@@ -1390,27 +1147,18 @@ int test_buffer_fill_ulong( cl_device_id deviceID, cl_context context, cl_comman
             for ( j = 0; j < ptrSizes[i] / ptrSizes[0]; j++ )
                 pattern[i][j] = TEST_PRIME_ULONG;
 
-            inptr[i] = (cl_ulong *)align_malloc(ptrSizes[i] * num_elements, min_alignment);
-            for ( j = 0; j < ptrSizes[i] * offset_elements / ptrSizes[0]; j++ )
-                inptr[i][j] = 0;
-            for ( j = ptrSizes[i] * offset_elements / ptrSizes[0]; j < ptrSizes[i] * (offset_elements + fill_elements) / ptrSizes[0]; j++ )
-                inptr[i][j] = TEST_PRIME_ULONG;
-            for ( j = ptrSizes[i] * (offset_elements + fill_elements) / ptrSizes[0]; j < ptrSizes[i] * num_elements / ptrSizes[0]; j++ )
-                inptr[i][j] = 0;
-
             hostptr[i] = (cl_ulong *)align_malloc(ptrSizes[i] * num_elements, min_alignment);
             memset(hostptr[i], 0, ptrSizes[i] * num_elements);
         }
 
         if (test_buffer_fill( deviceID, context, queue, num_elements, sizeof( cl_ulong ), (char*)"ulong",
-                             5, (void**)inptr, (void**)hostptr, (void**)pattern,
+                             5, (void**)hostptr, (void**)pattern,
                              offset_elements, fill_elements,
-                             buffer_fill_ulong_kernel_code, ulong_kernel_name, foo ))
+                             buffer_fill_ulong_kernel_code, ulong_kernel_name ))
             err++;
 
         for ( i = 0; i < 5; i++ ){
             free( (void *)pattern[i] );
-            align_free( (void *)inptr[i] );
             align_free( (void *)hostptr[i] );
         }
 
@@ -1425,19 +1173,15 @@ int test_buffer_fill_ulong( cl_device_id deviceID, cl_context context, cl_comman
 
 int test_buffer_fill_float( cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements )
 {
-    cl_float *inptr[5];
     cl_float *hostptr[5];
     cl_float *pattern[5];
     size_t   ptrSizes[5];
     int      n, i, err=0;
     size_t   j, offset_elements, fill_elements;
     MTdata   d = init_genrand( gRandomSeed );
-    int      (*foo)(void *,void *,int);
 
     size_t  min_alignment = get_min_alignment(context);
 
-    foo = verify_fill_float;
-
     ptrSizes[0] = sizeof(cl_float);
     ptrSizes[1] = ptrSizes[0] << 1;
     ptrSizes[2] = ptrSizes[1] << 1;
@@ -1455,27 +1199,18 @@ int test_buffer_fill_float( cl_device_id deviceID, cl_context context, cl_comman
             for ( j = 0; j < ptrSizes[i] / ptrSizes[0]; j++ )
                 pattern[i][j] = TEST_PRIME_FLOAT;
 
-            inptr[i] = (cl_float *)align_malloc(ptrSizes[i] * num_elements, min_alignment);
-            for ( j = 0; j < ptrSizes[i] * offset_elements / ptrSizes[0]; j++ )
-                inptr[i][j] = 0;
-            for ( j = ptrSizes[i] * offset_elements / ptrSizes[0]; j < ptrSizes[i] * (offset_elements + fill_elements) / ptrSizes[0]; j++ )
-                inptr[i][j] = TEST_PRIME_FLOAT;
-            for ( j = ptrSizes[i] * (offset_elements + fill_elements) / ptrSizes[0]; j < ptrSizes[i] * num_elements / ptrSizes[0]; j++ )
-                inptr[i][j] = 0;
-
             hostptr[i] = (cl_float *)align_malloc(ptrSizes[i] * num_elements, min_alignment);
             memset(hostptr[i], 0, ptrSizes[i] * num_elements);
         }
 
         if (test_buffer_fill( deviceID, context, queue, num_elements, sizeof( cl_float ), (char*)"float",
-                             5, (void**)inptr, (void**)hostptr, (void**)pattern,
+                             5, (void**)hostptr, (void**)pattern,
                              offset_elements, fill_elements,
-                             buffer_fill_float_kernel_code, float_kernel_name, foo ))
+                             buffer_fill_float_kernel_code, float_kernel_name ))
             err++;
 
         for ( i = 0; i < 5; i++ ){
             free( (void *)pattern[i] );
-            align_free( (void *)inptr[i] );
             align_free( (void *)hostptr[i] );
         }
 
@@ -203,6 +203,31 @@ template<> cl_ulong AtomicTypeExtendedInfo<cl_ulong>::MaxValue() {return CL_ULON
 template<> cl_float AtomicTypeExtendedInfo<cl_float>::MaxValue() {return CL_FLT_MAX;}
 template<> cl_double AtomicTypeExtendedInfo<cl_double>::MaxValue() {return CL_DBL_MAX;}
 
+std::string get_batch_kernel_name(size_t variantIndex)
+{
+    std::stringstream ss;
+    ss << "test_atomic_kernel_" << variantIndex;
+    return ss.str();
+}
+
+std::string get_batch_kernel_source(const std::string &source,
+                                    size_t variantIndex)
+{
+    std::stringstream ss;
+    ss << "_" << variantIndex;
+    std::string suffix = ss.str();
+    std::string result = source;
+    const char *names[] = { "test_atomic_kernel", "test_atomic_function" };
+    for (size_t n = 0; n < sizeof(names) / sizeof(names[0]); n++)
+    {
+        std::string name = names[n];
+        for (size_t pos = result.find(name); pos != std::string::npos;
+             pos = result.find(name, pos + name.size() + suffix.size()))
+            result.insert(pos + name.size(), suffix);
+    }
+    return result;
+}
+
 cl_int getSupportedMemoryOrdersAndScopes(
     cl_device_id device, std::vector<TExplicitMemoryOrderType> &memoryOrders,
     std::vector<TExplicitMemoryScopeType> &memoryScopes)
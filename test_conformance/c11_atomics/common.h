@@ -21,12 +21,20 @@
 #include "harness/ThreadPool.h"
 
 #include "host_atomics.h"
+#include "host_executor.h"
 
+#include <algorithm>
+#include <chrono>
+#include <map>
 #include <vector>
 #include <sstream>
 
 #define MAX_DEVICE_THREADS (gHost ? 0U : gMaxDeviceThreads)
-#define MAX_HOST_THREADS GetThreadCount()
+#define MAX_HOST_THREADS                                                       \
+    (gHostThreads < 0 ? GetThreadCount()                                       \
+                      : (gHostThreads == 0                                     \
+                             ? CHostThreadExecutor::Instance().CoreCount()     \
+                             : (cl_uint)gHostThreads))
 
 #define EXECUTE_TEST(error, test)                                              \
     error |= test;                                                             \
@@ -69,6 +77,11 @@ extern int gInternalIterations; // internal test iterations for atomic
                                 // operation, sufficient to verify atomicity
 extern int
     gMaxDeviceThreads; // maximum number of threads executed on OCL device
+extern int gHostThreads; // number of host threads (0 - one per core, < 0 -
+                         // thread pool size)
+extern bool gHostStats; // print host thread timing statistics
+extern bool gBatchCompile; // build all kernel variants of a test up-front
+extern cl_uint gBatchKernelsPerProgram; // kernel variants per batched program
 extern cl_device_atomic_capabilities gAtomicMemCap,
     gAtomicFenceCap; // atomic memory and fence capabilities for this device
 
@@ -81,6 +94,12 @@ extern cl_int getSupportedMemoryOrdersAndScopes(
     cl_device_id device, std::vector<TExplicitMemoryOrderType> &memoryOrders,
     std::vector<TExplicitMemoryScopeType> &memoryScopes);
 
+// Gives the kernel and helper function of a generated kernel variant unique
+// names, so that several variants can be compiled in a single program.
+extern std::string get_batch_kernel_name(size_t variantIndex);
+extern std::string get_batch_kernel_source(const std::string &source,
+                                           size_t variantIndex);
+
 class AtomicTypeInfo {
 public:
     TExplicitAtomicType _type;
@@ -133,15 +152,13 @@ public:
         volatile HostAtomicType *destMemory;
         HostDataType *oldValues;
     } THostThreadContext;
-    static cl_int HostThreadFunction(cl_uint job_id, cl_uint thread_id,
-                                     void *userInfo)
+    static void HostThreadFunction(cl_uint participant, void *userInfo)
     {
         THostThreadContext *threadContext =
-            ((THostThreadContext *)userInfo) + job_id;
+            ((THostThreadContext *)userInfo) + participant;
         threadContext->test->HostFunction(
             threadContext->tid, threadContext->threadCount,
             threadContext->destMemory, threadContext->oldValues);
-        return 0;
     }
     CBasicTest(TExplicitAtomicType dataType, bool useSVM)
         : CTest(), _maxDeviceThreads(MAX_DEVICE_THREADS), _dataType(dataType),
@@ -149,7 +166,8 @@ public:
           _declaredInProgram(false), _usedInFunction(false),
           _genericAddrSpace(false), _oldValueCheck(true),
           _localRefValues(false), _maxGroupSize(0), _passCount(0),
-          _iterations(gInternalIterations)
+          _iterations(gInternalIterations), _batchPhase(BATCH_NONE),
+          _batchCompileTime(0)
     {}
     virtual ~CBasicTest()
     {
@@ -204,6 +222,9 @@ public:
     }
     virtual int ExecuteSingleTest(cl_device_id deviceID, cl_context context,
                                   cl_command_queue queue);
+    int ExecuteBatched(cl_device_id deviceID, cl_context context,
+                       cl_command_queue queue);
+    int BuildBatch(cl_device_id deviceID, cl_context context);
     int ExecuteForEachPointerType(cl_device_id deviceID, cl_context context,
                                   cl_command_queue queue)
     {
@@ -294,6 +315,8 @@ public:
             _maxDeviceThreads = 0;
         }
         if (_maxDeviceThreads + MaxHostThreads() == 0) return 0;
+        if (gBatchCompile && _maxDeviceThreads > 0 && !gOldAPI)
+            return ExecuteBatched(deviceID, context, queue);
         return ExecuteForEachParameterSet(deviceID, context, queue);
     }
     virtual void HostFunction(cl_uint tid, cl_uint threadCount,
@@ -447,6 +470,12 @@ public:
     }
 
 private:
+    enum TBatchPhase
+    {
+        BATCH_NONE, // kernels are built on demand for each single test
+        BATCH_COLLECT, // single tests only record their kernel source
+        BATCH_EXECUTE // single tests use the kernels built by BuildBatch
+    };
     const TExplicitAtomicType _dataType;
     const bool _useSVM;
     HostDataType _startValue;
@@ -460,6 +489,11 @@ private:
     cl_uint _currentGroupSize;
     cl_uint _passCount;
     const cl_int _iterations;
+    TBatchPhase _batchPhase;
+    std::vector<std::string> _batchSources; // unique variants, in sweep order
+    std::map<std::string, size_t> _batchIndices;
+    std::map<std::string, clKernelWrapper> _batchKernels;
+    double _batchCompileTime; // time spent building kernels, in seconds
 };
 
 template <typename HostAtomicType, typename HostDataType>
@@ -1115,17 +1149,18 @@ int CBasicTest<HostAtomicType, HostDataType>::ExecuteSingleTest(
 
     // log_info("\t%s %s%s...\n", local ? "local" : "global",
     // DataType().AtomicTypeName(), memoryOrderScope.c_str());
-    log_info("\t%s...\n", SingleTestName().c_str());
+    if (_batchPhase != BATCH_COLLECT)
+        log_info("\t%s...\n", SingleTestName().c_str());
 
     if (!LocalMemory() && DeclaredInProgram()
         && gNoGlobalVariables) // no support for program scope global variables
     {
-        log_info("\t\tTest disabled\n");
+        if (_batchPhase != BATCH_COLLECT) log_info("\t\tTest disabled\n");
         return 0;
     }
     if (UsedInFunction() && GenericAddrSpace() && gNoGenericAddressSpace)
     {
-        log_info("\t\tTest disabled\n");
+        if (_batchPhase != BATCH_COLLECT) log_info("\t\tTest disabled\n");
         return 0;
     }
     if (!LocalMemory() && DeclaredInProgram())
@@ -1133,7 +1168,8 @@ int CBasicTest<HostAtomicType, HostDataType>::ExecuteSingleTest(
         if (((gAtomicMemCap & CL_DEVICE_ATOMIC_SCOPE_DEVICE) == 0)
             || ((gAtomicMemCap & CL_DEVICE_ATOMIC_ORDER_ACQ_REL) == 0))
         {
-            log_info("\t\tTest disabled\n");
+            if (_batchPhase != BATCH_COLLECT)
+                log_info("\t\tTest disabled\n");
             return 0;
         }
     }
@@ -1157,6 +1193,23 @@ int CBasicTest<HostAtomicType, HostDataType>::ExecuteSingleTest(
     // in program)
     cl_uint numDestItems = NumResults(threadCount, deviceID);
 
+    if (_batchPhase == BATCH_COLLECT)
+    {
+        // Only variants without program scope declarations can share a
+        // program with other variants. The others are built on demand.
+        if (deviceThreadCount > 0 && ProgramHeader(numDestItems).empty())
+        {
+            std::string kernelSource =
+                FunctionCode() + KernelCode(numDestItems);
+            if (_batchIndices.find(kernelSource) == _batchIndices.end())
+            {
+                _batchIndices[kernelSource] = _batchSources.size();
+                _batchSources.push_back(kernelSource);
+            }
+        }
+        return 0;
+    }
+
     if (deviceThreadCount > 0)
     {
         // This loop iteratively reduces the workgroup size by 2 and then
@@ -1165,20 +1218,46 @@ int CBasicTest<HostAtomicType, HostDataType>::ExecuteSingleTest(
         // kernel being run or reduce the wg size to the trivial case of 1
         // (which was separately verified to be accurate for the kernel being
         // run)
+        std::string builtSource;
 
         while ((CurrentGroupSize() > 1))
         {
             // Re-generate the kernel code with the current group size
-            if (kernel) clReleaseKernel(kernel);
-            if (program) clReleaseProgram(program);
             programSource = PragmaHeader(deviceID) + ProgramHeader(numDestItems)
                 + FunctionCode() + KernelCode(numDestItems);
             programLine = programSource.c_str();
-            if (create_single_kernel_helper_with_build_options(
-                    context, &program, &kernel, 1, &programLine,
-                    "test_atomic_kernel", gOldAPI ? "" : nullptr))
+            // The kernel only needs to be rebuilt if its code depends on the
+            // group size
+            if (!kernel || programSource != builtSource)
             {
-                return -1;
+                kernel.reset();
+                program.reset();
+                builtSource = programSource;
+                std::map<std::string, clKernelWrapper>::iterator batched =
+                    _batchKernels.end();
+                if (_batchPhase == BATCH_EXECUTE
+                    && ProgramHeader(numDestItems).empty())
+                    batched = _batchKernels.find(FunctionCode()
+                                                 + KernelCode(numDestItems));
+                if (batched != _batchKernels.end())
+                {
+                    kernel = batched->second;
+                }
+                else
+                {
+                    std::chrono::steady_clock::time_point buildStart =
+                        std::chrono::steady_clock::now();
+                    if (create_single_kernel_helper_with_build_options(
+                            context, &program, &kernel, 1, &programLine,
+                            "test_atomic_kernel", gOldAPI ? "" : nullptr))
+                    {
+                        return -1;
+                    }
+                    _batchCompileTime +=
+                        std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - buildStart)
+                            .count();
+                }
             }
             // Get work group size for the new kernel
             error = clGetKernelWorkGroupInfo(
@@ -1394,10 +1473,14 @@ int CBasicTest<HostAtomicType, HostDataType>::ExecuteSingleTest(
         test_error(error, "clFlush failed");
     }
 
-    /* Start host threads and wait for finish */
+    /* Start host threads simultaneously and wait for finish */
     if (hostThreadCount > 0)
-        ThreadPool_Do(HostThreadFunction, hostThreadCount,
-                      &hostThreadContexts[0]);
+    {
+        CHostThreadExecutor &executor = CHostThreadExecutor::Instance();
+        executor.Run(hostThreadCount, HostThreadFunction,
+                     &hostThreadContexts[0]);
+        if (gHostStats) executor.LogStatistics();
+    }
 
     if (UseSVM())
     {
@@ -1567,4 +1650,91 @@ int CBasicTest<HostAtomicType, HostDataType>::ExecuteSingleTest(
     return 0;
 }
 
+template <typename HostAtomicType, typename HostDataType>
+int CBasicTest<HostAtomicType, HostDataType>::ExecuteBatched(
+    cl_device_id deviceID, cl_context context, cl_command_queue queue)
+{
+    typedef std::chrono::steady_clock clock;
+    int error;
+
+    // First pass over the parameter sweep only records the kernel sources
+    _batchPhase = BATCH_COLLECT;
+    _batchSources.clear();
+    _batchIndices.clear();
+    _batchKernels.clear();
+    _batchCompileTime = 0;
+    clock::time_point start = clock::now();
+    error = ExecuteForEachParameterSet(deviceID, context, queue);
+    if (!error) error = BuildBatch(deviceID, context);
+    double batchTime =
+        std::chrono::duration<double>(clock::now() - start).count();
+    if (error)
+    {
+        _batchPhase = BATCH_NONE;
+        _batchKernels.clear();
+        return error;
+    }
+
+    // Second pass executes the sweep against the prebuilt kernels
+    _batchPhase = BATCH_EXECUTE;
+    _batchCompileTime = 0;
+    start = clock::now();
+    error = ExecuteForEachParameterSet(deviceID, context, queue);
+    double executeTime =
+        std::chrono::duration<double>(clock::now() - start).count();
+    double fallbackTime = _batchCompileTime;
+
+    log_info("\t%s: compile %.3f s (%u kernel variants up-front + %.3f s "
+             "on demand), execute %.3f s\n",
+             DataType().AtomicTypeName(), batchTime + fallbackTime,
+             (cl_uint)_batchKernels.size(), fallbackTime,
+             executeTime - fallbackTime);
+
+    _batchPhase = BATCH_NONE;
+    _batchSources.clear();
+    _batchIndices.clear();
+    _batchKernels.clear();
+    return error;
+}
+
+template <typename HostAtomicType, typename HostDataType>
+int CBasicTest<HostAtomicType, HostDataType>::BuildBatch(cl_device_id deviceID,
+                                                         cl_context context)
+{
+    size_t batchSize = gBatchKernelsPerProgram ? gBatchKernelsPerProgram : 1;
+    for (size_t first = 0; first < _batchSources.size(); first += batchSize)
+    {
+        size_t last = std::min(first + batchSize, _batchSources.size());
+        std::string programSource = PragmaHeader(deviceID);
+        for (size_t i = first; i < last; i++)
+            programSource += get_batch_kernel_source(_batchSources[i], i);
+        const char *programLine = programSource.c_str();
+
+        clProgramWrapper program;
+        clKernelWrapper kernel;
+        if (create_single_kernel_helper_with_build_options(
+                context, &program, &kernel, 1, &programLine,
+                get_batch_kernel_name(first).c_str(), nullptr))
+        {
+            // Variants left out of the batch are built separately when the
+            // sweep reaches them
+            log_info("\t%s: batched build failed, building kernel variants "
+                     "%u to %u separately\n",
+                     DataType().AtomicTypeName(), (cl_uint)first,
+                     (cl_uint)(last - 1));
+            continue;
+        }
+        _batchKernels[_batchSources[first]] = kernel;
+        for (size_t i = first + 1; i < last; i++)
+        {
+            cl_int error;
+            kernel = clCreateKernel(program, get_batch_kernel_name(i).c_str(),
+                                    &error);
+            test_error(error, "clCreateKernel failed for batched kernel");
+            _batchKernels[_batchSources[i]] = kernel;
+        }
+    }
+    return 0;
+}
+
 #endif // COMMON_H_
@@ -0,0 +1,183 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "host_executor.h"
+
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__) && !defined(__ANDROID__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// Number of spin iterations before a waiting thread starts yielding. Keeps the
+// barrier usable when more participants than cores are requested.
+const cl_uint kSpinsBeforeYield = 1 << 16;
+
+double elapsed_us(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+void pin_current_thread(const std::vector<int> &cores, cl_uint index)
+{
+    if (cores.empty()) return;
+    int core = cores[index % cores.size()];
+#if defined(_WIN32)
+    if (core < (int)(sizeof(DWORD_PTR) * 8))
+        SetThreadAffinityMask(GetCurrentThread(), ((DWORD_PTR)1) << core);
+#elif defined(__linux__) && !defined(__ANDROID__)
+    cpu_set_t affinity;
+    CPU_ZERO(&affinity);
+    CPU_SET(core, &affinity);
+    // Failing to pin is not an error, the thread just may migrate
+    pthread_setaffinity_np(pthread_self(), sizeof(affinity), &affinity);
+#else
+    (void)core;
+#endif
+}
+
+} // namespace
+
+CHostThreadExecutor &CHostThreadExecutor::Instance()
+{
+    static CHostThreadExecutor executor;
+    return executor;
+}
+
+CHostThreadExecutor::CHostThreadExecutor()
+    : _generation(0), _finished(0), _shutdown(false), _runThreadCount(0),
+      _func(nullptr), _userInfo(nullptr), _arrived(0)
+{
+#if defined(__linux__) && !defined(__ANDROID__)
+    cpu_set_t affinity;
+    if (0 == sched_getaffinity(0, sizeof(affinity), &affinity))
+    {
+        for (int core = 0; core < CPU_SETSIZE; core++)
+            if (CPU_ISSET(core, &affinity)) _cores.push_back(core);
+    }
+#endif
+    if (_cores.empty())
+    {
+        cl_uint count = std::max(std::thread::hardware_concurrency(), 1U);
+        for (cl_uint core = 0; core < count; core++) _cores.push_back(core);
+    }
+}
+
+CHostThreadExecutor::~CHostThreadExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _shutdown = true;
+    }
+    _wakeUp.notify_all();
+    for (size_t i = 0; i < _threads.size(); i++) _threads[i].join();
+}
+
+void CHostThreadExecutor::WorkerFunction(cl_uint index)
+{
+    pin_current_thread(_cores, index);
+
+    cl_uint seenGeneration = 0;
+    while (true)
+    {
+        cl_uint threadCount;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wakeUp.wait(lock, [&] {
+                return _shutdown || _generation != seenGeneration;
+            });
+            if (_shutdown) return;
+            seenGeneration = _generation;
+            threadCount = _runThreadCount;
+        }
+        if (index >= threadCount) continue;
+
+        // Spin barrier - no participant starts before all of them are awake
+        _arrived.fetch_add(1, std::memory_order_acq_rel);
+        for (cl_uint spins = 0;
+             _arrived.load(std::memory_order_acquire) < threadCount; spins++)
+        {
+            if (spins >= kSpinsBeforeYield) std::this_thread::yield();
+        }
+
+        _timings[index].start = elapsed_us(_runStart);
+        _func(index, _userInfo);
+        _timings[index].finish = elapsed_us(_runStart);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (++_finished == threadCount) _done.notify_one();
+    }
+}
+
+void CHostThreadExecutor::Run(cl_uint threadCount, THostExecutorFunc func,
+                              void *userInfo)
+{
+    if (threadCount == 0) return;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_threads.size() < threadCount)
+        _threads.push_back(std::thread(&CHostThreadExecutor::WorkerFunction,
+                                       this, (cl_uint)_threads.size()));
+
+    _timings.assign(threadCount, TThreadTiming());
+    _runThreadCount = threadCount;
+    _func = func;
+    _userInfo = userInfo;
+    _finished = 0;
+    _arrived.store(0, std::memory_order_relaxed);
+    _runStart = std::chrono::steady_clock::now();
+    _generation++;
+    _wakeUp.notify_all();
+    _done.wait(lock, [&] { return _finished == threadCount; });
+}
+
+void CHostThreadExecutor::LogStatistics() const
+{
+    if (_timings.empty()) return;
+
+    double firstStart = _timings[0].start, lastStart = _timings[0].start;
+    double firstFinish = _timings[0].finish, lastFinish = _timings[0].finish;
+    double minRun = _timings[0].finish - _timings[0].start, maxRun = minRun;
+    double totalRun = 0;
+    for (size_t i = 0; i < _timings.size(); i++)
+    {
+        double run = _timings[i].finish - _timings[i].start;
+        firstStart = std::min(firstStart, _timings[i].start);
+        lastStart = std::max(lastStart, _timings[i].start);
+        firstFinish = std::min(firstFinish, _timings[i].finish);
+        lastFinish = std::max(lastFinish, _timings[i].finish);
+        minRun = std::min(minRun, run);
+        maxRun = std::max(maxRun, run);
+        totalRun += run;
+    }
+    // Share of the host phase during which all participants were running
+    double span = lastFinish - firstStart;
+    double overlap = span > 0 ? std::max(firstFinish - lastStart, 0.0) / span
+                              : 1.0;
+
+    log_info("\t\t(host threads %u on %u cores: wake-up %.1f us, start skew "
+             "%.1f us, overlap %.1f%%, run time min/avg/max "
+             "%.1f/%.1f/%.1f us)\n",
+             (cl_uint)_timings.size(), CoreCount(), firstStart,
+             lastStart - firstStart, overlap * 100.0, minRun,
+             totalRun / _timings.size(), maxRun);
+}
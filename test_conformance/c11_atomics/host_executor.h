@@ -0,0 +1,83 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HOST_EXECUTOR_H_
+#define HOST_EXECUTOR_H_
+
+#include "harness/testHarness.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef void (*THostExecutorFunc)(cl_uint participant, void *userInfo);
+
+// Executes host participants of host/device concurrent tests. Unlike the
+// harness thread pool every participant gets its own thread, pinned to a
+// separate core where possible, and all participants are released together
+// from a spin barrier, so that they really run at the same time as each other
+// and as the device threads already flushed to the queue.
+class CHostThreadExecutor {
+public:
+    struct TThreadTiming
+    {
+        double start; // us since Run() was called
+        double finish; // us since Run() was called
+    };
+
+    static CHostThreadExecutor &Instance();
+    ~CHostThreadExecutor();
+
+    // Number of cores available to the process
+    cl_uint CoreCount() const { return (cl_uint)_cores.size(); }
+
+    // Runs func(participant, userInfo) for participant = 0..threadCount-1 on
+    // threadCount threads started simultaneously, and waits for all of them
+    // to finish.
+    void Run(cl_uint threadCount, THostExecutorFunc func, void *userInfo);
+
+    // Per-thread start/finish timestamps of the last Run()
+    const std::vector<TThreadTiming> &Timings() const { return _timings; }
+
+    // Logs start skew, overlap and run time statistics of the last Run()
+    void LogStatistics() const;
+
+private:
+    CHostThreadExecutor();
+    CHostThreadExecutor(const CHostThreadExecutor &);
+    CHostThreadExecutor &operator=(const CHostThreadExecutor &);
+
+    void WorkerFunction(cl_uint index);
+
+    std::vector<int> _cores;
+    std::vector<std::thread> _threads;
+    std::vector<TThreadTiming> _timings;
+    std::mutex _mutex;
+    std::condition_variable _wakeUp;
+    std::condition_variable _done;
+    cl_uint _generation;
+    cl_uint _finished;
+    bool _shutdown;
+    cl_uint _runThreadCount;
+    THostExecutorFunc _func;
+    void *_userInfo;
+    std::chrono::steady_clock::time_point _runStart;
+    std::atomic<cl_uint> _arrived;
+};
+
+#endif // HOST_EXECUTOR_H_
@@ -26,6 +26,10 @@ bool gUseHostPtr = false; // use malloc/free with CL_MEM_USE_HOST_PTR instead of
 bool gDebug = false; // always print OpenCL kernel code
 int gInternalIterations = 10000; // internal test iterations for atomic operation, sufficient to verify atomicity
 int gMaxDeviceThreads = 1024; // maximum number of threads executed on OCL device
+int gHostThreads = -1; // number of host threads (0 - one per core, < 0 - thread pool size)
+bool gHostStats = false; // print host thread timing statistics
+bool gBatchCompile = false; // build all kernel variants of a test up-front
+cl_uint gBatchKernelsPerProgram = 64; // kernel variants per batched program
 cl_device_atomic_capabilities gAtomicMemCap,
     gAtomicFenceCap; // atomic memory and fence capabilities for this device
 
@@ -220,7 +224,11 @@ int main(int argc, const char *argv[])
       log_info("  '-useHostPtr'              use malloc/free with CL_MEM_USE_HOST_PTR instead of clSVMAlloc/clSVMFree\n");
       log_info("  '-debug'                   always print OpenCL kernel code\n");
       log_info("  '-internalIterations <X>'  internal test iterations for atomic operation, sufficient to verify atomicity\n");
-      log_info("  '-maxDeviceThreads <X>'    maximum number of threads executed on OCL device");
+      log_info("  '-maxDeviceThreads <X>'    maximum number of threads executed on OCL device\n");
+      log_info("  '-hostThreads <X>'         number of host threads executed concurrently with the device (0 - one per core)\n");
+      log_info("  '-hostStats'               print start skew, overlap and run times of host threads\n");
+      log_info("  '-batchCompile'            build all kernel variants of a test in a few programs before executing them\n");
+      log_info("  '-batchSize <X>'           maximum number of kernel variants per batched program (default 64)");
 
       break;
     }
@@ -256,6 +264,33 @@ int main(int argc, const char *argv[])
     }
     else if(std::string(argv[argc-1]) == "-debug") // print OpenCL kernel code
       gDebug = true;
+    else if(std::string(argv[argc-1]) == "-hostStats") // print host thread timing statistics
+      gHostStats = true;
+    else if(argc > 2 && std::string(argv[argc-2]) == "-hostThreads") // number of host threads
+    {
+      gHostThreads = atoi(argv[argc-1]);
+      if(gHostThreads < 0)
+      {
+        log_info("Invalid value: Number of host threads (%d) must be >= 0\n", gHostThreads);
+        return -1;
+      }
+      argc--;
+      noCert = true;
+    }
+    else if(std::string(argv[argc-1]) == "-batchCompile") // build all kernel variants of a test up-front
+      gBatchCompile = true;
+    else if(argc > 2 && std::string(argv[argc-2]) == "-batchSize") // maximum number of kernel variants per batched program
+    {
+      int batchSize = atoi(argv[argc-1]);
+      if(batchSize < 1)
+      {
+        log_info("Invalid value: Batch size (%d) must be > 0\n", batchSize);
+        return -1;
+      }
+      gBatchKernelsPerProgram = batchSize;
+      gBatchCompile = true;
+      argc--;
+    }
     else if(argc > 2 && std::string(argv[argc-2]) == "-internalIterations") // internal test iterations for atomic operation, sufficient to verify atomicity
     {
       gInternalIterations = atoi(argv[argc-1]);
@@ -27,9 +27,12 @@
 #include "harness/testHarness.h"
 #include "harness/typeWrappers.h"
 
+struct ErrorHistogram;
+
 template <typename T>
 using VerifyFuncBinary = int (*)(const T *const, const T *const, const T *const,
-                                 const int num, const int vs, const int vp);
+                                 const size_t num, const int vs, const int vp,
+                                 ErrorHistogram &histogram);
 
 template <typename T>
 using VerifyFuncUnary = int (*)(const T *const, const T *const, const int num);
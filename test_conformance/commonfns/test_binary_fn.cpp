@@ -26,6 +26,7 @@
 
 #include "procs.h"
 #include "test_base.h"
+#include "test_verify.h"
 
 const char *binary_fn_code_pattern =
 "%s\n" /* optional pragma */
@@ -65,7 +66,8 @@ int test_binary_fn(cl_device_id device, cl_context context,
 
     std::vector<clProgramWrapper> programs;
     std::vector<clKernelWrapper> kernels;
-    int err, i, j;
+    int err, i;
+    size_t j;
     MTdataHolder d = MTdataHolder(gRandomSeed);
 
     assert(BaseFunctionTest::type2name.find(sizeof(T))
@@ -75,7 +77,7 @@ int test_binary_fn(cl_device_id device, cl_context context,
     programs.resize(kTotalVecCount);
     kernels.resize(kTotalVecCount);
 
-    int num_elements = n_elems * (1 << (kTotalVecCount - 1));
+    size_t num_elements = (size_t)n_elems * (1 << (kTotalVecCount - 1));
 
     for (i = 0; i < 2; i++) input_ptr[i].resize(num_elements);
     output_ptr.resize(num_elements);
@@ -109,7 +111,7 @@ int test_binary_fn(cl_device_id device, cl_context context,
     {
         const float fval = CL_HALF_MAX;
         pragma_str = "#pragma OPENCL EXTENSION cl_khr_fp16 : enable\n";
-        for (int j = 0; j < num_elements; j++)
+        for (j = 0; j < num_elements; j++)
         {
             input_ptr[0][j] = conv_to_half(get_random_float(-fval, fval, d));
             input_ptr[1][j] = conv_to_half(get_random_float(-fval, fval, d));
@@ -125,6 +127,7 @@ int test_binary_fn(cl_device_id device, cl_context context,
     }
 
     char vecSizeNames[][3] = { "", "2", "4", "8", "16", "3" };
+    ErrorHistogram histogram;
 
     for (i = 0; i < kTotalVecCount; i++)
     {
@@ -160,10 +163,10 @@ int test_binary_fn(cl_device_id device, cl_context context,
                                           (const char**)&programPtr, "test_fn");
         test_error(err, "Unable to create kernel");
 
-        for( j = 0; j < 3; j++ )
+        for (int a = 0; a < 3; a++)
         {
             err =
-                clSetKernelArg(kernels[i], j, sizeof(streams[j]), &streams[j]);
+                clSetKernelArg(kernels[i], a, sizeof(streams[a]), &streams[a]);
             test_error( err, "Unable to set kernel argument" );
         }
 
@@ -180,7 +183,7 @@ int test_binary_fn(cl_device_id device, cl_context context,
 
         if (verifyFn((T*)&input_ptr[0].front(), (T*)&input_ptr[1].front(),
                      &output_ptr[0], n_elems, g_arrVecSizes[i],
-                     vecSecParam ? 1 : 0))
+                     vecSecParam ? 1 : 0, histogram))
         {
             log_error("%s %s%d%s test failed\n", fnName.c_str(), tname.c_str(),
                       ((g_arrVecSizes[i])),
@@ -198,6 +201,7 @@ int test_binary_fn(cl_device_id device, cl_context context,
         if (err)
             break;
     }
+    histogram.report(fnName + " " + tname);
     return err;
 }
 
@@ -205,64 +209,30 @@ namespace {
 
 template <typename T>
 int max_verify(const T* const x, const T* const y, const T* const out,
-               int numElements, int vecSize, int vecParam)
+               size_t numElements, int vecSize, int vecParam,
+               ErrorHistogram& histogram)
 {
-    for (int i = 0; i < numElements; i++)
-    {
-        for (int j = 0; j < vecSize; j++)
-        {
-            int k = i * vecSize + j;
-            int l = (k * vecParam + i * (1 - vecParam));
-            T v = (conv_to_dbl(x[k]) < conv_to_dbl(y[l])) ? y[l] : x[k];
-            if (v != out[k])
-            {
-                if (std::is_same<T, half>::value)
-                    log_error("x[%d]=%g y[%d]=%g out[%d]=%g, expected %g. "
-                              "(index %d is "
-                              "vector %d, element %d, for vector size %d)\n",
-                              k, conv_to_flt(x[k]), l, conv_to_flt(y[l]), k,
-                              conv_to_flt(out[k]), v, k, i, j, vecSize);
-                else
-                    log_error("x[%d]=%g y[%d]=%g out[%d]=%g, expected %g. "
-                              "(index %d is "
-                              "vector %d, element %d, for vector size %d)\n",
-                              k, x[k], l, y[l], k, out[k], v, k, i, j, vecSize);
-                return -1;
-            }
-        }
-    }
-    return 0;
+    std::vector<Operand<T>> inputs = { { x, 1 },
+                                       { y, vecParam ? 1 : (size_t)vecSize } };
+    VerifyParams params = { "max", vecSize, selection_measure<T>(), 0.0 };
+    return verify_results(
+        inputs, out, numElements * vecSize,
+        [](double a, double b, double) { return a < b ? b : a; }, params,
+        histogram);
 }
 
 template <typename T>
 int min_verify(const T* const x, const T* const y, const T* const out,
-               int numElements, int vecSize, int vecParam)
+               size_t numElements, int vecSize, int vecParam,
+               ErrorHistogram& histogram)
 {
-    for (int i = 0; i < numElements; i++)
-    {
-        for (int j = 0; j < vecSize; j++)
-        {
-            int k = i * vecSize + j;
-            int l = (k * vecParam + i * (1 - vecParam));
-            T v = (conv_to_dbl(x[k]) > conv_to_dbl(y[l])) ? y[l] : x[k];
-            if (v != out[k])
-            {
-                if (std::is_same<T, half>::value)
-                    log_error("x[%d]=%g y[%d]=%g out[%d]=%g, expected %g. "
-                              "(index %d is "
-                              "vector %d, element %d, for vector size %d)\n",
-                              k, conv_to_flt(x[k]), l, conv_to_flt(y[l]), k,
-                              conv_to_flt(out[k]), v, k, i, j, vecSize);
-                else
-                    log_error("x[%d]=%g y[%d]=%g out[%d]=%g, expected %g. "
-                              "(index %d is "
-                              "vector %d, element %d, for vector size %d)\n",
-                              k, x[k], l, y[l], k, out[k], v, k, i, j, vecSize);
-                return -1;
-            }
-        }
-    }
-    return 0;
+    std::vector<Operand<T>> inputs = { { x, 1 },
+                                       { y, vecParam ? 1 : (size_t)vecSize } };
+    VerifyParams params = { "min", vecSize, selection_measure<T>(), 0.0 };
+    return verify_results(
+        inputs, out, numElements * vecSize,
+        [](double a, double b, double) { return a > b ? b : a; }, params,
+        histogram);
 }
 
 }
@@ -25,6 +25,7 @@
 
 #include "procs.h"
 #include "test_base.h"
+#include "test_verify.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846264338327950288
@@ -108,44 +109,17 @@ namespace {
 
 template <typename T>
 int verify_clamp(const T *const x, const T *const minval, const T *const maxval,
-                 const T *const outptr, int n)
+                 const T *const outptr, size_t n, int vecSize,
+                 ErrorHistogram &histogram)
 {
-    if (std::is_same<T, half>::value)
-    {
-        float t;
-        for (int i = 0; i < n; i++)
-        {
-            t = std::min(
-                std::max(cl_half_to_float(x[i]), cl_half_to_float(minval[i])),
-                cl_half_to_float(maxval[i]));
-            if (t != cl_half_to_float(outptr[i]))
-            {
-                log_error(
-                    "%d) verification error: clamp( %a, %a, %a) = *%a vs. %a\n",
-                    i, cl_half_to_float(x[i]), cl_half_to_float(minval[i]),
-                    cl_half_to_float(maxval[i]), t,
-                    cl_half_to_float(outptr[i]));
-                return -1;
-            }
-        }
-    }
-    else
-    {
-        T t;
-        for (int i = 0; i < n; i++)
-        {
-            t = std::min(std::max(x[i], minval[i]), maxval[i]);
-            if (t != outptr[i])
-            {
-                log_error(
-                    "%d) verification error: clamp( %a, %a, %a) = *%a vs. %a\n",
-                    i, x[i], minval[i], maxval[i], t, outptr[i]);
-                return -1;
-            }
-        }
-    }
-
-    return 0;
+    std::vector<Operand<T>> inputs = { { x, 1 }, { minval, 1 }, { maxval, 1 } };
+    VerifyParams params = { "clamp", vecSize, ErrorMeasure::ulps, 0.0 };
+    return verify_results(
+        inputs, outptr, n,
+        [](double v, double lo, double hi) {
+            return std::min(std::max(v, lo), hi);
+        },
+        params, histogram);
 }
 }
 
@@ -159,7 +133,8 @@ int test_clamp_fn(cl_device_id device, cl_context context,
     std::vector<clProgramWrapper> programs;
     std::vector<clKernelWrapper> kernels;
 
-    int err, i, j;
+    int err, i;
+    size_t j;
     MTdataHolder d = MTdataHolder(gRandomSeed);
 
     assert(BaseFunctionTest::type2name.find(sizeof(T))
@@ -169,7 +144,7 @@ int test_clamp_fn(cl_device_id device, cl_context context,
     programs.resize(kTotalVecCount);
     kernels.resize(kTotalVecCount);
 
-    int num_elements = n_elems * (1 << (kVectorSizeCount - 1));
+    size_t num_elements = (size_t)n_elems * (1 << (kVectorSizeCount - 1));
 
     for (i = 0; i < 3; i++) input_ptr[i].resize(num_elements);
     output_ptr.resize(num_elements);
@@ -219,6 +194,7 @@ int test_clamp_fn(cl_device_id device, cl_context context,
         test_error(err, "Unable to write input buffer");
     }
 
+    ErrorHistogram histogram;
     for (i = 0; i < kTotalVecCount; i++)
     {
         if (std::is_same<T, float>::value)
@@ -247,10 +223,10 @@ int test_clamp_fn(cl_device_id device, cl_context context,
                  tname.c_str(), i, g_arrVecSizes[i], i);
         fflush(stdout);
 
-        for (j = 0; j < 4; j++)
+        for (int a = 0; a < 4; a++)
         {
             err =
-                clSetKernelArg(kernels[i], j, sizeof(streams[j]), &streams[j]);
+                clSetKernelArg(kernels[i], a, sizeof(streams[a]), &streams[a]);
             test_error(err, "Unable to set kernel argument");
         }
 
@@ -268,7 +244,8 @@ int test_clamp_fn(cl_device_id device, cl_context context,
         if (verify_clamp<T>((T *)&input_ptr[0].front(),
                             (T *)&input_ptr[1].front(),
                             (T *)&input_ptr[2].front(), (T *)&output_ptr[0],
-                            n_elems * ((g_arrVecSizes[i]))))
+                            (size_t)n_elems * g_arrVecSizes[i],
+                            g_arrVecSizes[i], histogram))
         {
             log_error("CLAMP %s%d test failed\n", tname.c_str(),
                       ((g_arrVecSizes[i])));
@@ -283,6 +260,7 @@ int test_clamp_fn(cl_device_id device, cl_context context,
 
         if (err) break;
     }
+    histogram.report("clamp " + tname);
 
     return err;
 }
@@ -22,6 +22,7 @@
 
 #include "procs.h"
 #include "test_base.h"
+#include "test_verify.h"
 
 
 const char *mix_fn_code_pattern =
@@ -60,78 +61,23 @@ namespace {
 
 template <typename T>
 int verify_mix(const T *const inptrX, const T *const inptrY,
-               const T *const inptrA, const T *const outptr, const int n,
-               const int veclen, const bool vecParam)
+               const T *const inptrA, const T *const outptr, const size_t n,
+               const int veclen, const bool vecParam,
+               ErrorHistogram &histogram)
 {
-    double r, o;
-    float delta = 0.f, max_delta = 0.f;
-    int i;
-
-    if (vecParam)
-    {
-        for (i = 0; i < n * veclen; i++)
-        {
-            r = conv_to_dbl(inptrX[i])
-                + ((conv_to_dbl(inptrY[i]) - conv_to_dbl(inptrX[i]))
-                   * conv_to_dbl(inptrA[i]));
-
-            o = conv_to_dbl(outptr[i]);
-            delta = fabs(double(r - o)) / r;
-            if (!std::is_same<T, half>::value)
-            {
-                if (delta > MAX_ERR)
-                {
-                    log_error("%d) verification error: mix(%a, %a, %a) = *%a "
-                              "vs. %a\n",
-                              i, inptrX[i], inptrY[i], inptrA[i], r, outptr[i]);
-                    return -1;
-                }
-            }
-            else
-            {
-                max_delta = std::max(max_delta, delta);
-            }
-        }
-    }
-    else
-    {
-        for (int i = 0; i < n; ++i)
-        {
-            int ii = i / veclen;
-            int vi = i * veclen;
-            for (int j = 0; j < veclen; ++j, ++vi)
-            {
-                r = conv_to_dbl(inptrX[vi])
-                    + ((conv_to_dbl(inptrY[vi]) - conv_to_dbl(inptrX[vi]))
-                       * conv_to_dbl(inptrA[i]));
-                delta = fabs(double(r - conv_to_dbl(outptr[vi]))) / r;
-                if (!std::is_same<T, half>::value)
-                {
-                    if (delta > MAX_ERR)
-                    {
-                        log_error(
-                            "{%d, element %d}) verification error: mix(%a, "
-                            "%a, %a) = *%a vs. %a\n",
-                            ii, j, inptrX[vi], inptrY[vi], inptrA[i], r,
-                            outptr[vi]);
-                        return -1;
-                    }
-                }
-                else
-                {
-                    max_delta = std::max(max_delta, delta);
-                }
-            }
-        }
-    }
-
+    std::vector<Operand<T>> inputs = {
+        { inptrX, 1 }, { inptrY, 1 }, { inptrA, vecParam ? 1 : (size_t)veclen }
+    };
     // due to the fact that accuracy of mix for cl_khr_fp16 is implementation
-    // defined this test only reports maximum error without testing maximum
-    // error threshold
-    if (std::is_same<T, half>::value)
-        log_error("mix half verification result, max delta: %a\n", max_delta);
-
-    return 0;
+    // defined this test only reports the error histogram without testing
+    // maximum error threshold
+    VerifyParams params = { "mix", veclen, ErrorMeasure::relative,
+                            std::is_same<T, half>::value ? INFINITY
+                                                         : MAX_ERR };
+    return verify_results(
+        inputs, outptr, n * veclen,
+        [](double x, double y, double a) { return x + (y - x) * a; }, params,
+        histogram);
 }
 } // namespace
 
@@ -146,6 +92,7 @@ int test_mix_fn(cl_device_id device, cl_context context, cl_command_queue queue,
     std::vector<clKernelWrapper> kernels;
 
     int err, i;
+    size_t j;
     MTdataHolder d(gRandomSeed);
 
     assert(BaseFunctionTest::type2name.find(sizeof(T))
@@ -155,7 +102,7 @@ int test_mix_fn(cl_device_id device, cl_context context, cl_command_queue queue,
     programs.resize(kTotalVecCount);
     kernels.resize(kTotalVecCount);
 
-    int num_elements = n_elems * (1 << (kTotalVecCount - 1));
+    size_t num_elements = (size_t)n_elems * (1 << (kTotalVecCount - 1));
 
 
     for (i = 0; i < 3; i++) input_ptr[i].resize(num_elements);
@@ -177,20 +124,20 @@ int test_mix_fn(cl_device_id device, cl_context context, cl_command_queue queue,
     if (std::is_same<T, half>::value)
     {
         pragma_str = "#pragma OPENCL EXTENSION cl_khr_fp16 : enable\n";
-        for (i = 0; i < num_elements; i++)
+        for (j = 0; j < num_elements; j++)
         {
-            input_ptr[0][i] = conv_to_half((float)genrand_real1(d));
-            input_ptr[1][i] = conv_to_half((float)genrand_real1(d));
-            input_ptr[2][i] = conv_to_half((float)genrand_real1(d));
+            input_ptr[0][j] = conv_to_half((float)genrand_real1(d));
+            input_ptr[1][j] = conv_to_half((float)genrand_real1(d));
+            input_ptr[2][j] = conv_to_half((float)genrand_real1(d));
         }
     }
     else
     {
-        for (i = 0; i < num_elements; i++)
+        for (j = 0; j < num_elements; j++)
         {
-            input_ptr[0][i] = (T)genrand_real1(d);
-            input_ptr[1][i] = (T)genrand_real1(d);
-            input_ptr[2][i] = (T)genrand_real1(d);
+            input_ptr[0][j] = (T)genrand_real1(d);
+            input_ptr[1][j] = (T)genrand_real1(d);
+            input_ptr[2][j] = (T)genrand_real1(d);
         }
     }
 
@@ -203,6 +150,7 @@ int test_mix_fn(cl_device_id device, cl_context context, cl_command_queue queue,
     }
 
     char vecSizeNames[][3] = { "", "2", "4", "8", "16", "3" };
+    ErrorHistogram histogram;
     for (i = 0; i < kTotalVecCount; i++)
     {
         std::string kernelSource;
@@ -259,7 +207,7 @@ int test_mix_fn(cl_device_id device, cl_context context, cl_command_queue queue,
 
         if (verify_mix(&input_ptr[0].front(), &input_ptr[1].front(),
                        &input_ptr[2].front(), &output_ptr.front(), n_elems,
-                       g_arrVecSizes[i], vecParam))
+                       g_arrVecSizes[i], vecParam, histogram))
         {
             log_error("mix %s%d%s test failed\n", tname.c_str(),
                       ((g_arrVecSizes[i])),
@@ -276,6 +224,7 @@ int test_mix_fn(cl_device_id device, cl_context context, cl_command_queue queue,
 
         if (err) break;
     }
+    histogram.report("mix " + tname);
 
     return err;
 }
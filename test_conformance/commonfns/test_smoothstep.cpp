@@ -22,6 +22,7 @@
 
 #include "procs.h"
 #include "test_base.h"
+#include "test_verify.h"
 
 const char *smoothstep_fn_code_pattern =
     "%s\n" /* optional pragma */
@@ -60,81 +61,31 @@ namespace {
 
 template <typename T>
 int verify_smoothstep(const T *const edge0, const T *const edge1,
-                      const T *const x, const T *const outptr, const int n,
-                      const int veclen, const bool vecParam)
+                      const T *const x, const T *const outptr, const size_t n,
+                      const int veclen, const bool vecParam,
+                      ErrorHistogram &histogram)
 {
-    double r, t;
-    float delta = 0, max_delta = 0;
-
-    if (vecParam)
-    {
-        for (int i = 0; i < n * veclen; i++)
-        {
-            t = (conv_to_dbl(x[i]) - conv_to_dbl(edge0[i]))
-                / (conv_to_dbl(edge1[i]) - conv_to_dbl(edge0[i]));
+    size_t edge_broadcast = vecParam ? 1 : (size_t)veclen;
+    std::vector<Operand<T>> inputs = { { edge0, edge_broadcast },
+                                       { edge1, edge_broadcast },
+                                       { x, 1 } };
+    // due to the fact that accuracy of smoothstep for cl_khr_fp16 is
+    // implementation defined this test only reports the error histogram
+    // without testing maximum error threshold
+    VerifyParams params = { "smoothstep", veclen, ErrorMeasure::absolute,
+                            std::is_same<T, half>::value ? INFINITY
+                                                         : MAX_ERR };
+    return verify_results(
+        inputs, outptr, n * veclen,
+        [](double e0, double e1, double v) {
+            double t = (v - e0) / (e1 - e0);
             if (t < 0.0)
                 t = 0.0;
             else if (t > 1.0)
                 t = 1.0;
-            r = t * t * (3.0 - 2.0 * t);
-            delta = (float)fabs(r - conv_to_dbl(outptr[i]));
-            if (!std::is_same<T, half>::value)
-            {
-                if (delta > MAX_ERR)
-                {
-                    log_error(
-                        "%d) verification error: smoothstep(%a, %a, %a) = "
-                        "*%a vs. %a\n",
-                        i, x[i], edge0[i], edge1[i], r, outptr[i]);
-                    return -1;
-                }
-            }
-            else
-                max_delta = std::max(max_delta, delta);
-        }
-    }
-    else
-    {
-        for (int i = 0; i < n; ++i)
-        {
-            int ii = i / veclen;
-            int vi = i * veclen;
-            for (int j = 0; j < veclen; ++j, ++vi)
-            {
-                t = (conv_to_dbl(x[vi]) - conv_to_dbl(edge0[i]))
-                    / (conv_to_dbl(edge1[i]) - conv_to_dbl(edge0[i]));
-                if (t < 0.0)
-                    t = 0.0;
-                else if (t > 1.0)
-                    t = 1.0;
-                r = t * t * (3.0 - 2.0 * t);
-                delta = (float)fabs(r - conv_to_dbl(outptr[vi]));
-
-                if (!std::is_same<T, half>::value)
-                {
-                    if (delta > MAX_ERR)
-                    {
-                        log_error("{%d, element %d}) verification error: "
-                                  "smoothstep(%a, %a, %a) = *%a vs. %a\n",
-                                  ii, j, x[vi], edge0[i], edge1[i], r,
-                                  outptr[vi]);
-                        return -1;
-                    }
-                }
-                else
-                    max_delta = std::max(max_delta, delta);
-            }
-        }
-    }
-
-    // due to the fact that accuracy of smoothstep for cl_khr_fp16 is
-    // implementation defined this test only reports maximum error without
-    // testing maximum error threshold
-    if (std::is_same<T, half>::value)
-        log_error("smoothstep half verification result, max delta: %a\n",
-                  max_delta);
-
-    return 0;
+            return t * t * (3.0 - 2.0 * t);
+        },
+        params, histogram);
 }
 
 }
@@ -151,6 +102,7 @@ int test_smoothstep_fn(cl_device_id device, cl_context context,
     std::vector<clKernelWrapper> kernels;
 
     int err, i;
+    size_t j;
     MTdataHolder d = MTdataHolder(gRandomSeed);
 
     assert(BaseFunctionTest::type2name.find(sizeof(T))
@@ -160,7 +112,7 @@ int test_smoothstep_fn(cl_device_id device, cl_context context,
     programs.resize(kTotalVecCount);
     kernels.resize(kTotalVecCount);
 
-    int num_elements = n_elems * (1 << (kTotalVecCount - 1));
+    size_t num_elements = (size_t)n_elems * (1 << (kTotalVecCount - 1));
 
     for (i = 0; i < 3; i++) input_ptr[i].resize(num_elements);
     output_ptr.resize(num_elements);
@@ -175,32 +127,32 @@ int test_smoothstep_fn(cl_device_id device, cl_context context,
     std::string pragma_str;
     if (std::is_same<T, float>::value)
     {
-        for (i = 0; i < num_elements; i++)
+        for (j = 0; j < num_elements; j++)
         {
-            input_ptr[0][i] = get_random_float(-0x00200000, 0x00010000, d);
-            input_ptr[1][i] = get_random_float(input_ptr[0][i], 0x00200000, d);
-            input_ptr[2][i] = get_random_float(-0x20000000, 0x20000000, d);
+            input_ptr[0][j] = get_random_float(-0x00200000, 0x00010000, d);
+            input_ptr[1][j] = get_random_float(input_ptr[0][j], 0x00200000, d);
+            input_ptr[2][j] = get_random_float(-0x20000000, 0x20000000, d);
         }
     }
     else if (std::is_same<T, double>::value)
     {
         pragma_str = "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n";
-        for (i = 0; i < num_elements; i++)
+        for (j = 0; j < num_elements; j++)
         {
-            input_ptr[0][i] = get_random_double(-0x00200000, 0x00010000, d);
-            input_ptr[1][i] = get_random_double(input_ptr[0][i], 0x00200000, d);
-            input_ptr[2][i] = get_random_double(-0x20000000, 0x20000000, d);
+            input_ptr[0][j] = get_random_double(-0x00200000, 0x00010000, d);
+            input_ptr[1][j] = get_random_double(input_ptr[0][j], 0x00200000, d);
+            input_ptr[2][j] = get_random_double(-0x20000000, 0x20000000, d);
         }
     }
     else if (std::is_same<T, half>::value)
     {
         pragma_str = "#pragma OPENCL EXTENSION cl_khr_fp16 : enable\n";
-        for (i = 0; i < num_elements; i++)
+        for (j = 0; j < num_elements; j++)
         {
-            input_ptr[0][i] = conv_to_half(get_random_float(-65503, 65503, d));
-            input_ptr[1][i] = conv_to_half(
-                get_random_float(conv_to_flt(input_ptr[0][i]), 65503, d));
-            input_ptr[2][i] = conv_to_half(get_random_float(-65503, 65503, d));
+            input_ptr[0][j] = conv_to_half(get_random_float(-65503, 65503, d));
+            input_ptr[1][j] = conv_to_half(
+                get_random_float(conv_to_flt(input_ptr[0][j]), 65503, d));
+            input_ptr[2][j] = conv_to_half(get_random_float(-65503, 65503, d));
         }
     }
 
@@ -213,6 +165,7 @@ int test_smoothstep_fn(cl_device_id device, cl_context context,
     }
 
     const char vecSizeNames[][3] = { "", "2", "4", "8", "16", "3" };
+    ErrorHistogram histogram;
 
     for (i = 0; i < kTotalVecCount; i++)
     {
@@ -272,7 +225,7 @@ int test_smoothstep_fn(cl_device_id device, cl_context context,
         if (verify_smoothstep((T *)&input_ptr[0].front(),
                               (T *)&input_ptr[1].front(),
                               (T *)&input_ptr[2].front(), &output_ptr[0],
-                              n_elems, g_arrVecSizes[i], vecParam))
+                              n_elems, g_arrVecSizes[i], vecParam, histogram))
         {
             log_error("smoothstep %s%d%s test failed\n", tname.c_str(),
                       ((g_arrVecSizes[i])),
@@ -289,6 +242,7 @@ int test_smoothstep_fn(cl_device_id device, cl_context context,
 
         if (err) break;
     }
+    histogram.report("smoothstep " + tname);
 
     return err;
 }
@@ -22,6 +22,7 @@
 
 #include "procs.h"
 #include "test_base.h"
+#include "test_verify.h"
 
 const char *step_fn_code_pattern = "%s\n" /* optional pragma */
                                    "__kernel void test_fn(__global %s%s *edge, "
@@ -53,47 +54,16 @@ namespace {
 
 template <typename T>
 int verify_step(const T *const inptrA, const T *const inptrB,
-                const T *const outptr, const int n, const int veclen,
-                const bool vecParam)
+                const T *const outptr, const size_t n, const int veclen,
+                const bool vecParam, ErrorHistogram &histogram)
 {
-    T r;
-
-    if (vecParam)
-    {
-        for (int i = 0; i < n * veclen; i++)
-        {
-            r = (conv_to_dbl(inptrB[i]) < conv_to_dbl(inptrA[i])) ? 0.0 : 1.0;
-            if (r != conv_to_dbl(outptr[i])) return -1;
-        }
-    }
-    else
-    {
-        for (int i = 0; i < n;)
-        {
-            int ii = i / veclen;
-            for (int j = 0; j < veclen && i < n; ++j, ++i)
-            {
-                r = (conv_to_dbl(inptrB[i]) < conv_to_dbl(inptrA[ii])) ? 0.0f
-                                                                       : 1.0f;
-                if (r != conv_to_dbl(outptr[i]))
-                {
-                    if (std::is_same<T, half>::value)
-                        log_error(
-                            "Failure @ {%d, element %d}: step(%a,%a) -> *%a "
-                            "vs %a\n",
-                            ii, j, conv_to_flt(inptrA[ii]),
-                            conv_to_flt(inptrB[i]), r, conv_to_flt(outptr[i]));
-                    else
-                        log_error(
-                            "Failure @ {%d, element %d}: step(%a,%a) -> *%a "
-                            "vs %a\n",
-                            ii, j, inptrA[ii], inptrB[i], r, outptr[i]);
-                    return -1;
-                }
-            }
-        }
-    }
-    return 0;
+    std::vector<Operand<T>> inputs = { { inptrA, vecParam ? 1 : (size_t)veclen },
+                                       { inptrB, 1 } };
+    VerifyParams params = { "step", veclen, selection_measure<T>(), 0.0 };
+    return verify_results(
+        inputs, outptr, n * veclen,
+        [](double edge, double x, double) { return x < edge ? 0.0 : 1.0; },
+        params, histogram);
 }
 
 }
@@ -109,12 +79,13 @@ int test_step_fn(cl_device_id device, cl_context context,
     std::vector<clKernelWrapper> kernels;
 
     int err, i;
+    size_t j;
     MTdataHolder d = MTdataHolder(gRandomSeed);
 
     assert(BaseFunctionTest::type2name.find(sizeof(T))
            != BaseFunctionTest::type2name.end());
     auto tname = BaseFunctionTest::type2name[sizeof(T)];
-    int num_elements = n_elems * (1 << (kTotalVecCount - 1));
+    size_t num_elements = (size_t)n_elems * (1 << (kTotalVecCount - 1));
 
     programs.resize(kTotalVecCount);
     kernels.resize(kTotalVecCount);
@@ -132,29 +103,29 @@ int test_step_fn(cl_device_id device, cl_context context,
     std::string pragma_str;
     if (std::is_same<T, float>::value)
     {
-        for (i = 0; i < num_elements; i++)
+        for (j = 0; j < num_elements; j++)
         {
-            input_ptr[0][i] = get_random_float(-0x40000000, 0x40000000, d);
-            input_ptr[1][i] = get_random_float(-0x40000000, 0x40000000, d);
+            input_ptr[0][j] = get_random_float(-0x40000000, 0x40000000, d);
+            input_ptr[1][j] = get_random_float(-0x40000000, 0x40000000, d);
         }
     }
     else if (std::is_same<T, double>::value)
     {
         pragma_str = "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n";
-        for (i = 0; i < num_elements; i++)
+        for (j = 0; j < num_elements; j++)
         {
-            input_ptr[0][i] = get_random_double(-0x40000000, 0x40000000, d);
-            input_ptr[1][i] = get_random_double(-0x40000000, 0x40000000, d);
+            input_ptr[0][j] = get_random_double(-0x40000000, 0x40000000, d);
+            input_ptr[1][j] = get_random_double(-0x40000000, 0x40000000, d);
         }
     }
     else if (std::is_same<T, half>::value)
     {
         const float fval = CL_HALF_MAX;
         pragma_str = "#pragma OPENCL EXTENSION cl_khr_fp16 : enable\n";
-        for (i = 0; i < num_elements; i++)
+        for (j = 0; j < num_elements; j++)
         {
-            input_ptr[0][i] = conv_to_half(get_random_float(-fval, fval, d));
-            input_ptr[1][i] = conv_to_half(get_random_float(-fval, fval, d));
+            input_ptr[0][j] = conv_to_half(get_random_float(-fval, fval, d));
+            input_ptr[1][j] = conv_to_half(get_random_float(-fval, fval, d));
         }
     }
 
@@ -167,6 +138,7 @@ int test_step_fn(cl_device_id device, cl_context context,
     }
 
     char vecSizeNames[][3] = { "", "2", "4", "8", "16", "3" };
+    ErrorHistogram histogram;
 
     for (i = 0; i < kTotalVecCount; i++)
     {
@@ -223,7 +195,7 @@ int test_step_fn(cl_device_id device, cl_context context,
 
         err = verify_step(&input_ptr[0].front(), &input_ptr[1].front(),
                           &output_ptr.front(), n_elems, g_arrVecSizes[i],
-                          vecParam);
+                          vecParam, histogram);
         if (err)
         {
             log_error("step %s%d%s test failed\n", tname.c_str(),
@@ -242,6 +214,7 @@ int test_step_fn(cl_device_id device, cl_context context,
         if (err)
             break;
     }
+    histogram.report("step " + tname);
 
     return err;
 }
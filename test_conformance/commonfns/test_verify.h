@@ -0,0 +1,331 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef TEST_COMMONFNS_VERIFY_H
+#define TEST_COMMONFNS_VERIFY_H
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "harness/ThreadPool.h"
+#include "test_base.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Verification of large result sets on the thread pool. Each job converts a
+// chunk of the inputs and results to double, runs the reference over the
+// whole chunk and bins the error of every element, so that a run reports
+// the distribution of the errors rather than only the first failure.
+
+// Elements per job, kept small enough for the scratch arrays to fit on the
+// stack of a worker thread
+#define VERIFY_CHUNK_SIZE 512
+#define VERIFY_MAX_OPERANDS 3
+
+enum class ErrorMeasure
+{
+    ulps, // the functions returning one of their inputs use a limit of 0
+    relative,
+    absolute,
+    // The result must have the bit pattern of the reference, which tells -0
+    // from +0. A mismatch counts as at least 1 ulp.
+    bits
+};
+
+// min, max and step return one of their inputs or a constant. Half results
+// have always been compared bit for bit.
+template <typename T> ErrorMeasure selection_measure()
+{
+    return std::is_same<T, cl_half>::value ? ErrorMeasure::bits
+                                           : ErrorMeasure::ulps;
+}
+
+struct VerifyParams
+{
+    const char *name;
+    int vecSize;
+    ErrorMeasure measure;
+    // Largest error accepted, or INFINITY to only report the errors
+    double limit;
+};
+
+// Counts of errors by power of two. Bin 0 holds the exact results and bin i
+// the errors in [2^(i - 1 + kMinExp), 2^(i + kMinExp)), with the outer bins
+// also holding everything beyond them.
+struct ErrorHistogram
+{
+    static const int kMinExp = -32;
+    static const int kMaxExp = 32;
+    static const int kBins = kMaxExp - kMinExp + 2;
+
+    ErrorHistogram(): counts(), max_error(0.0) {}
+
+    void add(double error)
+    {
+        counts[bin(error)]++;
+        // NaN errors only land in the last bin
+        if (error > max_error) max_error = error;
+    }
+
+    void merge(const ErrorHistogram &other)
+    {
+        for (int i = 0; i < kBins; i++) counts[i] += other.counts[i];
+        max_error = std::max(max_error, other.max_error);
+    }
+
+    void report(const std::string &label) const
+    {
+        std::string line;
+        char bin_text[64];
+        for (int i = 0; i < kBins; i++)
+        {
+            if (!counts[i]) continue;
+            if (i == 0)
+                snprintf(bin_text, sizeof(bin_text), " 0:%zu", counts[i]);
+            else if (i == kBins - 1)
+                snprintf(bin_text, sizeof(bin_text), " >=2^%d:%zu", kMaxExp,
+                         counts[i]);
+            else
+                snprintf(bin_text, sizeof(bin_text), " <2^%d:%zu",
+                         i + kMinExp, counts[i]);
+            line += bin_text;
+        }
+        log_info("%s: max error %g, histogram%s\n", label.c_str(), max_error,
+                 line.c_str());
+    }
+
+    static int bin(double error)
+    {
+        if (error == 0.0) return 0;
+        if (!(error < ldexp(1.0, kMaxExp))) return kBins - 1;
+        int exp;
+        frexp(error, &exp);
+        return std::max(exp - kMinExp, 1);
+    }
+
+    size_t counts[kBins];
+    double max_error;
+};
+
+// An input of the function. Consecutive elements share a value when the
+// argument is a scalar passed with vectors, broadcast is then the vector
+// size.
+template <typename T> struct Operand
+{
+    const T *data;
+    size_t broadcast;
+};
+
+inline const float *half_to_float_table()
+{
+    static const std::vector<float> table = [] {
+        std::vector<float> values(1 << 16);
+        for (size_t i = 0; i < values.size(); i++)
+            values[i] = cl_half_to_float((cl_half)i);
+        return values;
+    }();
+    return table.data();
+}
+
+// Converts n elements starting at begin to double
+inline void to_double(const double *src, size_t broadcast, size_t begin,
+                      size_t n, double *dst)
+{
+    if (broadcast == 1)
+        memcpy(dst, src + begin, n * sizeof(double));
+    else
+        for (size_t i = 0; i < n; i++) dst[i] = src[(begin + i) / broadcast];
+}
+
+inline void to_double(const float *src, size_t broadcast, size_t begin,
+                      size_t n, double *dst)
+{
+    if (broadcast != 1)
+    {
+        for (size_t i = 0; i < n; i++) dst[i] = src[(begin + i) / broadcast];
+        return;
+    }
+    size_t i = 0;
+    src += begin;
+#ifdef __SSE2__
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 v = _mm_loadu_ps(src + i);
+        _mm_storeu_pd(dst + i, _mm_cvtps_pd(v));
+        _mm_storeu_pd(dst + i + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+    }
+#endif
+    for (; i < n; i++) dst[i] = src[i];
+}
+
+inline void to_double(const cl_half *src, size_t broadcast, size_t begin,
+                      size_t n, double *dst)
+{
+    const float *table = half_to_float_table();
+    for (size_t i = 0; i < n; i++)
+        dst[i] = table[src[(begin + i) / broadcast]];
+}
+
+// Converts a reference to T, exactly for the results checked bit for bit
+inline void from_double(double value, double *dst) { *dst = value; }
+inline void from_double(double value, float *dst) { *dst = (float)value; }
+inline void from_double(double value, cl_half *dst)
+{
+    *dst = cl_half_from_float((float)value, CL_HALF_RTE);
+}
+
+template <typename T>
+double element_error(const T &result, double value, double expected,
+                     ErrorMeasure measure)
+{
+    if (measure == ErrorMeasure::bits)
+    {
+        T reference;
+        from_double(expected, &reference);
+        if (memcmp(&result, &reference, sizeof(T)) == 0
+            || (std::isnan(value) && std::isnan(expected)))
+            return 0.0;
+        return std::max((double)fabs(UlpFn(result, expected)), 1.0);
+    }
+    if (value == expected || (std::isnan(value) && std::isnan(expected)))
+        return 0.0;
+    switch (measure)
+    {
+        case ErrorMeasure::ulps: return fabs(UlpFn(result, expected));
+        case ErrorMeasure::relative:
+            return fabs(expected - value) / fabs(expected);
+        case ErrorMeasure::absolute: return fabs(expected - value);
+        case ErrorMeasure::bits: break;
+    }
+    return NAN;
+}
+
+struct VerifyThreadResult
+{
+    ErrorHistogram histogram;
+    size_t failures;
+    size_t first_failure;
+};
+
+template <typename T, typename Ref> struct VerifyJob
+{
+    const std::vector<Operand<T>> *inputs;
+    const T *out;
+    size_t count;
+    const Ref *ref;
+    VerifyParams params;
+    std::vector<VerifyThreadResult> results; // indexed by thread id
+};
+
+template <typename T, typename Ref>
+cl_int verify_chunk(cl_uint job_id, cl_uint thread_id, void *userInfo)
+{
+    VerifyJob<T, Ref> &job = *(VerifyJob<T, Ref> *)userInfo;
+    VerifyThreadResult &result = job.results[thread_id];
+    const size_t begin = (size_t)job_id * VERIFY_CHUNK_SIZE;
+    const size_t n = std::min<size_t>(VERIFY_CHUNK_SIZE, job.count - begin);
+
+    double args[VERIFY_MAX_OPERANDS][VERIFY_CHUNK_SIZE] = {};
+    double values[VERIFY_CHUNK_SIZE];
+    double expected[VERIFY_CHUNK_SIZE];
+    for (size_t o = 0; o < job.inputs->size(); o++)
+    {
+        const Operand<T> &input = (*job.inputs)[o];
+        to_double(input.data, input.broadcast, begin, n, args[o]);
+    }
+    to_double(job.out, 1, begin, n, values);
+
+    const Ref &ref = *job.ref;
+    for (size_t i = 0; i < n; i++)
+        expected[i] = ref(args[0][i], args[1][i], args[2][i]);
+
+    const bool report_only = std::isinf(job.params.limit);
+    for (size_t i = 0; i < n; i++)
+    {
+        double error = element_error(job.out[begin + i], values[i],
+                                     expected[i], job.params.measure);
+        result.histogram.add(error);
+        if (!report_only && !(error <= job.params.limit))
+        {
+            if (!result.failures || begin + i < result.first_failure)
+                result.first_failure = begin + i;
+            result.failures++;
+        }
+    }
+    return CL_SUCCESS;
+}
+
+// Checks count results of a function against ref, which computes the
+// reference in double from up to VERIFY_MAX_OPERANDS arguments, the unused
+// ones being 0. The errors are added to histogram. Returns -1 and logs the
+// first failing element if any error is above the limit.
+template <typename T, typename Ref>
+int verify_results(const std::vector<Operand<T>> &inputs, const T *out,
+                   size_t count, const Ref &ref, const VerifyParams &params,
+                   ErrorHistogram &histogram)
+{
+    assert(inputs.size() <= VERIFY_MAX_OPERANDS);
+
+    VerifyJob<T, Ref> job;
+    job.inputs = &inputs;
+    job.out = out;
+    job.count = count;
+    job.ref = &ref;
+    job.params = params;
+    job.results.resize(GetThreadCount(), VerifyThreadResult{});
+
+    cl_uint jobs =
+        (cl_uint)((count + VERIFY_CHUNK_SIZE - 1) / VERIFY_CHUNK_SIZE);
+    cl_int error = ThreadPool_Do(verify_chunk<T, Ref>, jobs, &job);
+    test_error_ret(error, "ThreadPool_Do failed", -1);
+
+    size_t failures = 0, first_failure = 0;
+    for (const VerifyThreadResult &result : job.results)
+    {
+        histogram.merge(result.histogram);
+        if (result.failures
+            && (!failures || result.first_failure < first_failure))
+            first_failure = result.first_failure;
+        failures += result.failures;
+    }
+    if (!failures) return 0;
+
+    double args[VERIFY_MAX_OPERANDS] = {};
+    for (size_t o = 0; o < inputs.size(); o++)
+        to_double(inputs[o].data, inputs[o].broadcast, first_failure, 1,
+                  &args[o]);
+    double value;
+    to_double(out, 1, first_failure, 1, &value);
+    double expected = ref(args[0], args[1], args[2]);
+
+    log_error("{%zu, element %zu} verification error: %s(%a, %a, %a) = *%a "
+              "vs. %a, error %g\n",
+              first_failure / params.vecSize, first_failure % params.vecSize,
+              params.name, args[0], args[1], args[2], expected, value,
+              element_error(out[first_failure], value, expected,
+                            params.measure));
+    log_error("%zu of %zu results out of tolerance\n", failures, count);
+    return -1;
+}
+
+#endif // TEST_COMMONFNS_VERIFY_H
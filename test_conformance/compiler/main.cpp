@@ -38,6 +38,8 @@ test_definition test_list[] = {
 
     ADD_TEST(large_compile),
     ADD_TEST(async_build),
+    ADD_TEST(compile_throughput),
+    ADD_TEST(parallel_build_throughput),
 
     ADD_TEST(options_build_optimizations),
     ADD_TEST(options_build_macro),
@@ -76,6 +76,12 @@ extern int test_large_compile(cl_device_id deviceID, cl_context context,
                               cl_command_queue queue, int num_elements);
 extern int test_async_build(cl_device_id deviceID, cl_context context,
                             cl_command_queue queue, int num_elements);
+extern int test_compile_throughput(cl_device_id deviceID, cl_context context,
+                                   cl_command_queue queue, int num_elements);
+extern int test_parallel_build_throughput(cl_device_id deviceID,
+                                          cl_context context,
+                                          cl_command_queue queue,
+                                          int num_elements);
 
 extern int test_options_build_optimizations(cl_device_id deviceID,
                                             cl_context context,
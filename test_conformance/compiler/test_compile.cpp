@@ -38,6 +38,8 @@ const char *sample_kernel_lines[] = { "dst[tid] = src[tid];\n",
                                       "temp = src[tid] / 4.f;\n",
                                       "dst[tid] = dot(temp,src[tid]);\n",
                                       "dst[tid] = dst[tid] + temp;\n" };
+extern const size_t sample_kernel_line_count =
+    sizeof(sample_kernel_lines) / sizeof(sample_kernel_lines[0]);
 
 /* I compile and link therefore I am. Robert Ioffe */
 /* The following kernels are used in testing Improved Compilation and Linking
@@ -0,0 +1,281 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "testBase.h"
+#include "harness/benchmarkHelpers.h"
+#include "harness/parseParameters.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Compile latency benchmarks on programs generated like the large_compile
+// ones. Latencies are normalized to the number of source lines, so one
+// microsecond per line is one millisecond per thousand lines (KLOC).
+
+extern const char *sample_kernel_end;
+extern const char *sample_kernel_lines[];
+extern const size_t sample_kernel_line_count;
+
+namespace {
+
+const unsigned kDefaultRepetitions = 3;
+const unsigned kParallelLines = 2048;
+const unsigned kParallelKernels = 16;
+const unsigned kProgramsPerThread = 2;
+
+// Seconds spent in clBuildProgram, or in clCompileProgram and clLinkProgram
+struct ProgramTimes
+{
+    double compile;
+    double link;
+};
+
+struct GeneratedProgram
+{
+    std::string source;
+    size_t lines;
+};
+
+// Every generated program is made unique, so that compilers caching
+// binaries across builds, or across runs, are still measured compiling
+class ProgramGenerator {
+public:
+    explicit ProgramGenerator(cl_uint seed)
+        : d(seed),
+          tag((cl_uint)std::chrono::system_clock::now().time_since_epoch()
+                  .count())
+    {}
+
+    GeneratedProgram generate(unsigned lines, unsigned kernels)
+    {
+        GeneratedProgram program;
+        char header[256];
+        unsigned lines_per_kernel = std::max(lines / kernels, 1u);
+        for (unsigned k = 0; k < kernels; k++)
+        {
+            snprintf(header, sizeof(header),
+                     "__kernel void throughput_test%u(__global float *src, "
+                     "__global int *dst)\n"
+                     "{\n"
+                     "    float temp = 0.0f;\n"
+                     "    int  tid = get_global_id(0);\n"
+                     "    dst[tid] = %u;\n",
+                     k, tag++);
+            program.source += header;
+            for (unsigned i = 0; i < lines_per_kernel; i++)
+                program.source +=
+                    sample_kernel_lines[genrand_int32(d)
+                                        % sample_kernel_line_count];
+            program.source += sample_kernel_end;
+        }
+        program.lines = std::count(program.source.begin(),
+                                   program.source.end(), '\n');
+        return program;
+    }
+
+private:
+    MTdataHolder d;
+    cl_uint tag;
+};
+
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                         - start)
+        .count();
+}
+
+// Builds the program with clBuildProgram, or with clCompileProgram followed by
+// clLinkProgram when separate is set
+cl_int build_program(cl_context context, cl_device_id device,
+                     const GeneratedProgram &generated, bool separate,
+                     ProgramTimes &times)
+{
+    cl_int error;
+    const char *source = generated.source.c_str();
+    clProgramWrapper program =
+        clCreateProgramWithSource(context, 1, &source, nullptr, &error);
+    if (error != CL_SUCCESS) return error;
+
+    times.link = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    if (!separate)
+    {
+        error = clBuildProgram(program, 1, &device, nullptr, nullptr, nullptr);
+        times.compile = seconds_since(start);
+        return error;
+    }
+
+    error = clCompileProgram(program, 1, &device, nullptr, 0, nullptr, nullptr,
+                             nullptr, nullptr);
+    times.compile = seconds_since(start);
+    if (error != CL_SUCCESS) return error;
+
+    start = std::chrono::steady_clock::now();
+    clProgramWrapper linked = clLinkProgram(context, 1, &device, nullptr, 1,
+                                            &program, nullptr, nullptr, &error);
+    times.link = seconds_since(start);
+    return error;
+}
+
+// Up to the number of cores in benchmark runs. Conformance runs only check
+// that concurrent builds work, which two threads are enough for.
+std::vector<unsigned> thread_counts()
+{
+    if (!benchmarks_requested()) return { 1, 2 };
+
+    unsigned cores = std::max(std::thread::hardware_concurrency(), 2u);
+    std::vector<unsigned> counts;
+    for (unsigned n = 1; n < cores; n *= 2) counts.push_back(n);
+    counts.push_back(cores);
+    return counts;
+}
+
+} // namespace
+
+int test_compile_throughput(cl_device_id deviceID, cl_context context,
+                            cl_command_queue queue, int num_elements)
+{
+    check_compiler_available(deviceID);
+    if (gCompilationMode != kOnline)
+    {
+        log_info("Skipping test - compile latency is only measured with "
+                 "online compilation.\n");
+        return TEST_SKIPPED_ITSELF;
+    }
+
+    // The larger programs take minutes to build on some implementations, so
+    // they are only part of benchmark runs
+    std::vector<unsigned> line_counts = { 1024, 4096 };
+    std::vector<unsigned> kernel_counts = { 1, 16 };
+    if (benchmarks_requested())
+    {
+        line_counts = { 1024, 4096, 16384, 65536 };
+        kernel_counts = { 1, 16, 256 };
+    }
+    unsigned repetitions =
+        gBenchmarkRepetitions ? gBenchmarkRepetitions : kDefaultRepetitions;
+
+    ProgramGenerator generator(gRandomSeed);
+    log_info("\t%7s %7s %15s %15s %15s\n", "lines", "kernels",
+             "build ms/KLOC", "compile ms/KLOC", "link ms/KLOC");
+    for (unsigned lines : line_counts)
+    {
+        for (unsigned kernels : kernel_counts)
+        {
+            std::vector<double> build, compile, link;
+            size_t program_lines = 0;
+            for (unsigned r = 0; r < repetitions; r++)
+            {
+                ProgramTimes times;
+                GeneratedProgram program = generator.generate(lines, kernels);
+                cl_int error =
+                    build_program(context, deviceID, program, false, times);
+                test_error(error, "Unable to build generated program");
+                build.push_back(times.compile);
+
+                program = generator.generate(lines, kernels);
+                error = build_program(context, deviceID, program, true, times);
+                test_error(error, "Unable to compile and link generated "
+                                  "program");
+                compile.push_back(times.compile);
+                link.push_back(times.link);
+                program_lines = program.lines;
+            }
+
+            std::string name = "compile_throughput/"
+                + std::to_string(lines) + "x" + std::to_string(kernels) + "/";
+            BenchmarkStats build_stats = record_benchmark(
+                { name + "build", 1, "" }, program_lines, build);
+            BenchmarkStats compile_stats = record_benchmark(
+                { name + "compile", 1, "" }, program_lines, compile);
+            BenchmarkStats link_stats = record_benchmark(
+                { name + "link", 1, "" }, program_lines, link);
+            log_info("\t%7zu %7u %15.3f %15.3f %15.3f\n", program_lines,
+                     kernels, build_stats.median, compile_stats.median,
+                     link_stats.median);
+        }
+    }
+    return 0;
+}
+
+int test_parallel_build_throughput(cl_device_id deviceID, cl_context context,
+                                   cl_command_queue queue, int num_elements)
+{
+    check_compiler_available(deviceID);
+    if (gCompilationMode != kOnline)
+    {
+        log_info("Skipping test - compile latency is only measured with "
+                 "online compilation.\n");
+        return TEST_SKIPPED_ITSELF;
+    }
+
+    ProgramGenerator generator(gRandomSeed);
+    log_info("\t%-12s %7s %10s %12s %12s %8s\n", "calls", "threads",
+             "programs/s", "p50 ms/KLOC", "p99 ms/KLOC", "speedup");
+    for (bool separate : { false, true })
+    {
+        const char *calls = separate ? "compile+link" : "build";
+        double single_thread_rate = 0.0;
+        for (unsigned threads : thread_counts())
+        {
+            // Sources are generated up front, MTdata is not thread safe
+            size_t count = threads * kProgramsPerThread;
+            std::vector<GeneratedProgram> programs;
+            for (size_t i = 0; i < count; i++)
+                programs.push_back(
+                    generator.generate(kParallelLines, kParallelKernels));
+            std::vector<ProgramTimes> times(count);
+            std::vector<cl_int> errors(count, CL_SUCCESS);
+
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::thread> workers;
+            for (unsigned t = 0; t < threads; t++)
+            {
+                workers.emplace_back([&, t] {
+                    for (size_t i = t; i < count; i += threads)
+                        errors[i] = build_program(context, deviceID,
+                                                  programs[i], separate,
+                                                  times[i]);
+                });
+            }
+            for (std::thread &worker : workers) worker.join();
+            double wall = seconds_since(start);
+
+            std::vector<double> latencies;
+            for (size_t i = 0; i < count; i++)
+            {
+                test_error(errors[i], "Unable to build generated program");
+                latencies.push_back(times[i].compile + times[i].link);
+            }
+
+            double rate = count / wall;
+            if (threads == 1) single_thread_rate = rate;
+            std::string name = std::string("parallel_build/")
+                + (separate ? "compile_link/" : "build/")
+                + std::to_string(threads);
+            BenchmarkStats stats = record_benchmark({ name, 1, "" },
+                                                    programs[0].lines,
+                                                    latencies);
+            log_info("\t%-12s %7u %10.2f %12.3f %12.3f %8.2f\n", calls,
+                     threads, rate, stats.median, stats.p99,
+                     rate / single_thread_rate);
+        }
+    }
+    return 0;
+}
@@ -17,6 +17,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <vector>
 #include "harness/testHarness.h"
 
 #if !defined(_WIN32)
@@ -28,6 +29,7 @@
 test_definition test_list[] = {
     ADD_TEST( timer_resolution_queries ),
     ADD_TEST( device_and_host_timers ),
+    ADD_TEST( kernel_launch_latency ),
 };
 
 test_status InitCL(cl_device_id device)
@@ -75,6 +77,28 @@ const int test_num = ARRAY_SIZE( test_list );
 
 int main(int argc, const char *argv[])
 {
-    return runTestHarnessWithCheck( argc, argv, test_num, test_list, false, 0, InitCL );
+    std::vector<const char *> args(argv, argv + argc);
+    for (auto it = args.begin() + 1; it != args.end();)
+    {
+        if (strcmp(*it, "--launch-latency") != 0)
+        {
+            ++it;
+            continue;
+        }
+        char *end = nullptr;
+        if (it + 1 == args.end()
+            || (gLaunchLatencyLaunches = (unsigned)strtoul(it[1], &end, 10))
+                == 0
+            || *end)
+        {
+            log_error("--launch-latency requires a positive number of "
+                      "launches\n");
+            return EXIT_FAILURE;
+        }
+        it = args.erase(it, it + 2);
+    }
+
+    return runTestHarnessWithCheck((int)args.size(), args.data(), test_num,
+                                   test_list, false, 0, InitCL);
 }
 
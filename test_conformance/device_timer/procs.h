@@ -21,4 +21,11 @@ extern int test_device_and_host_timers(cl_device_id deviceID, cl_context context
 
 extern int test_timer_resolution_queries(cl_device_id deviceID, cl_context context,
                              cl_command_queue queue, int num_elements);
+
+extern int test_kernel_launch_latency(cl_device_id deviceID, cl_context context,
+                                      cl_command_queue queue, int num_elements);
+
+// Launches per run of the launch latency benchmark, set with
+// --launch-latency <launches>. The benchmark is skipped when 0.
+extern unsigned gLaunchLatencyLaunches;
 #endif // #ifndef __PROCS_H__
@@ -0,0 +1,298 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "harness/compat.h"
+#include "harness/errorHelpers.h"
+#include "harness/kernelHelpers.h"
+#include "harness/latencyHistogram.h"
+#include "harness/testHarness.h"
+#include "harness/typeWrappers.h"
+#include "procs.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Measures how long the host waits for tiny kernels, using event profiling
+// for the device side and clGetHostTimer for the host side. The host times
+// are moved to the device timer, which is the time base of the profiling
+// timestamps, with clGetDeviceAndHostTimer samples taken around each run.
+
+unsigned gLaunchLatencyLaunches = 0;
+
+namespace {
+
+const size_t kSmallGlobalSize = 1024;
+// Launches enqueued before waiting in the back-to-back runs
+const unsigned kBackToBackBatch = 32;
+
+const char *empty_kernel_source[] = { "__kernel void empty_kernel() {}\n" };
+
+const char *small_kernel_source[] = {
+    "__kernel void small_kernel(__global uint *out)\n"
+    "{\n"
+    "    size_t gid = get_global_id(0);\n"
+    "    out[gid] = (uint)gid;\n"
+    "}\n"
+};
+
+struct TimerSync
+{
+    cl_ulong host[2];
+    cl_ulong device[2];
+
+    cl_int sample(cl_device_id device_id, int index)
+    {
+        return clGetDeviceAndHostTimer(device_id, &device[index],
+                                       &host[index]);
+    }
+
+    // Interpolates between the two samples, so that a drift between the
+    // clocks during the run is accounted for
+    cl_long to_device(cl_ulong host_time) const
+    {
+        double scale = host[1] > host[0]
+            ? (double)(device[1] - device[0]) / (double)(host[1] - host[0])
+            : 1.0;
+        // Subtracted as integers, a double only holds timestamps counted
+        // from the epoch to within hundreds of nanoseconds
+        return (cl_long)device[0]
+            + (cl_long)((double)(cl_long)(host_time - host[0]) * scale);
+    }
+};
+
+// Written by record_notification() on a runtime thread
+struct LaunchRecord
+{
+    cl_device_id device;
+    cl_ulong enqueued;
+    cl_ulong notified;
+    std::atomic<unsigned> *pending;
+};
+
+struct LaunchTimes
+{
+    cl_ulong enqueued;
+    cl_ulong notified;
+    cl_ulong start;
+    cl_ulong end;
+};
+
+void CL_CALLBACK record_notification(cl_event, cl_int, void *user_data)
+{
+    LaunchRecord *record = (LaunchRecord *)user_data;
+    if (clGetHostTimer(record->device, &record->notified) != CL_SUCCESS)
+        record->notified = 0;
+    record->pending->fetch_sub(1, std::memory_order_release);
+}
+
+struct Scenario
+{
+    const char *name;
+    cl_kernel kernel;
+    size_t global_size;
+    unsigned batch;
+    bool flush;
+};
+
+// Enqueues one batch of launches, waits for them and for their completion
+// callbacks, and appends their timestamps to times
+cl_int run_batch(cl_device_id device, cl_command_queue queue,
+                 const Scenario &scenario, unsigned batch,
+                 std::vector<LaunchTimes> &times)
+{
+    std::atomic<unsigned> pending(batch);
+    std::vector<LaunchRecord> records(batch);
+    std::vector<cl_event> events;
+    events.reserve(batch);
+
+    cl_int error = CL_SUCCESS;
+    unsigned registered = 0;
+    for (unsigned i = 0; i < batch && error == CL_SUCCESS; i++)
+    {
+        LaunchRecord &record = records[i];
+        record.device = device;
+        record.notified = 0;
+        record.pending = &pending;
+
+        cl_event event = nullptr;
+        error = clGetHostTimer(device, &record.enqueued);
+        if (error == CL_SUCCESS)
+            error = clEnqueueNDRangeKernel(queue, scenario.kernel, 1, NULL,
+                                           &scenario.global_size, NULL, 0,
+                                           NULL, &event);
+        if (error != CL_SUCCESS) break;
+        events.push_back(event);
+        error = clSetEventCallback(event, CL_COMPLETE, record_notification,
+                                   &record);
+        if (error == CL_SUCCESS) registered++;
+    }
+    // Launches without a registered callback will not decrement pending
+    pending.fetch_sub(batch - registered, std::memory_order_relaxed);
+
+    if (error == CL_SUCCESS && scenario.flush) error = clFlush(queue);
+    if (error == CL_SUCCESS)
+        error = clWaitForEvents((cl_uint)events.size(), events.data());
+    else
+        clFinish(queue);
+    // Callbacks may still be running after the wait returns
+    while (pending.load(std::memory_order_acquire)) std::this_thread::yield();
+
+    for (size_t i = 0; i < events.size() && error == CL_SUCCESS; i++)
+    {
+        LaunchTimes t;
+        t.enqueued = records[i].enqueued;
+        t.notified = records[i].notified;
+        error = clGetEventProfilingInfo(events[i], CL_PROFILING_COMMAND_START,
+                                        sizeof(t.start), &t.start, NULL);
+        if (error == CL_SUCCESS)
+            error = clGetEventProfilingInfo(events[i], CL_PROFILING_COMMAND_END,
+                                            sizeof(t.end), &t.end, NULL);
+        times.push_back(t);
+    }
+    for (cl_event event : events) clReleaseEvent(event);
+    return error;
+}
+
+void report_row(const char *name, const char *metric,
+                const LatencyHistogram &h)
+{
+    // Timer values are in nanoseconds, report microseconds
+    const double us = 1e-3;
+    log_info("  %-28s %-14s %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f\n", name,
+             metric, h.min() * us, h.percentile(50.0) * us,
+             h.percentile(90.0) * us, h.percentile(99.0) * us,
+             h.percentile(99.9) * us, h.max() * us);
+}
+
+int run_scenario(cl_device_id device, cl_command_queue queue,
+                 const Scenario &scenario)
+{
+    std::vector<LaunchTimes> times;
+    times.reserve(gLaunchLatencyLaunches);
+
+    TimerSync sync;
+    cl_int error = sync.sample(device, 0);
+    test_error(error, "clGetDeviceAndHostTimer failed");
+    for (unsigned launched = 0; launched < gLaunchLatencyLaunches;)
+    {
+        unsigned batch =
+            std::min(scenario.batch, gLaunchLatencyLaunches - launched);
+        error = run_batch(device, queue, scenario, batch, times);
+        test_error(error, "Unable to run launch batch");
+        launched += batch;
+    }
+    error = sync.sample(device, 1);
+    test_error(error, "clGetDeviceAndHostTimer failed");
+
+    LatencyHistogram to_start, to_notification;
+    size_t skewed = 0;
+    for (const LaunchTimes &t : times)
+    {
+        cl_long enqueued = sync.to_device(t.enqueued);
+        cl_long notified = sync.to_device(t.notified);
+        // A timestamp on the wrong side means the timers are not precise
+        // enough at this scale, these launches are left out
+        if ((cl_long)t.start < enqueued || notified < (cl_long)t.end
+            || t.notified == 0)
+        {
+            skewed++;
+            continue;
+        }
+        to_start.record((cl_ulong)((cl_long)t.start - enqueued));
+        to_notification.record((cl_ulong)(notified - (cl_long)t.end));
+    }
+
+    report_row(scenario.name, "host to start", to_start);
+    report_row(scenario.name, "end to host", to_notification);
+    if (skewed)
+        log_info("  %-28s %zu of %zu launches left out, their host and "
+                 "device timestamps are out of order\n",
+                 "", skewed, times.size());
+    return 0;
+}
+
+} // namespace
+
+int test_kernel_launch_latency(cl_device_id deviceID, cl_context context,
+                               cl_command_queue queue, int num_elements)
+{
+    if (gLaunchLatencyLaunches == 0)
+    {
+        log_info("Launch latency benchmark disabled, enable it with "
+                 "--launch-latency <launches>\n");
+        return TEST_SKIPPED_ITSELF;
+    }
+
+    cl_int error;
+    cl_queue_properties props[] = { CL_QUEUE_PROPERTIES,
+                                    CL_QUEUE_PROFILING_ENABLE, 0 };
+    clCommandQueueWrapper profiling_queue =
+        clCreateCommandQueueWithProperties(context, deviceID, props, &error);
+    test_error(error, "Unable to create a profiling command queue");
+
+    clProgramWrapper empty_program, small_program;
+    clKernelWrapper empty_kernel, small_kernel;
+    error = create_single_kernel_helper(context, &empty_program, &empty_kernel,
+                                        1, empty_kernel_source,
+                                        "empty_kernel");
+    test_error(error, "Unable to create empty kernel");
+    error = create_single_kernel_helper(context, &small_program, &small_kernel,
+                                        1, small_kernel_source,
+                                        "small_kernel");
+    test_error(error, "Unable to create small kernel");
+
+    clMemWrapper out = clCreateBuffer(context, CL_MEM_WRITE_ONLY,
+                                      kSmallGlobalSize * sizeof(cl_uint),
+                                      NULL, &error);
+    test_error(error, "Unable to create output buffer");
+    error = clSetKernelArg(small_kernel, 0, sizeof(out), &out);
+    test_error(error, "Unable to set kernel argument");
+
+    const Scenario scenarios[] = {
+        { "empty kernel, flush", empty_kernel, 1, 1, true },
+        { "empty kernel", empty_kernel, 1, 1, false },
+        { "small NDRange, flush", small_kernel, kSmallGlobalSize, 1, true },
+        { "small NDRange", small_kernel, kSmallGlobalSize, 1, false },
+        { "back-to-back empty, flush", empty_kernel, 1, kBackToBackBatch,
+          true },
+        { "back-to-back empty", empty_kernel, 1, kBackToBackBatch, false },
+        { "back-to-back small, flush", small_kernel, kSmallGlobalSize,
+          kBackToBackBatch, true },
+        { "back-to-back small", small_kernel, kSmallGlobalSize,
+          kBackToBackBatch, false },
+    };
+
+    log_info("Launch latency over %u launches per run, back-to-back runs "
+             "wait every %u launches (us)\n",
+             gLaunchLatencyLaunches, kBackToBackBatch);
+    log_info("  %-28s %-14s %9s %9s %9s %9s %9s %9s\n", "", "", "min", "p50",
+             "p90", "p99", "p99.9", "max");
+    for (const Scenario &scenario : scenarios)
+    {
+        // An unmeasured launch first, so that one-time costs are not counted
+        error = clEnqueueNDRangeKernel(profiling_queue, scenario.kernel, 1,
+                                       NULL, &scenario.global_size, NULL, 0,
+                                       NULL, NULL);
+        test_error(error, "Unable to enqueue warm-up launch");
+        error = clFinish(profiling_queue);
+        test_error(error, "clFinish failed");
+
+        if (run_scenario(deviceID, profiling_queue, scenario)) return TEST_FAIL;
+    }
+
+    return TEST_PASS;
+}
@@ -0,0 +1,37 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef ENQUEUE_CONTENTION_PROCS_H
+#define ENQUEUE_CONTENTION_PROCS_H
+
+#include "harness/errorHelpers.h"
+#include "harness/kernelHelpers.h"
+#include "harness/testHarness.h"
+#include "harness/typeWrappers.h"
+
+extern int test_enqueue_contention_ndrange(cl_device_id deviceID,
+                                           cl_context context,
+                                           cl_command_queue queue,
+                                           int num_elements);
+extern int test_enqueue_contention_copy(cl_device_id deviceID,
+                                        cl_context context,
+                                        cl_command_queue queue,
+                                        int num_elements);
+extern int test_enqueue_contention_map(cl_device_id deviceID,
+                                       cl_context context,
+                                       cl_command_queue queue,
+                                       int num_elements);
+
+#endif // ENQUEUE_CONTENTION_PROCS_H
@@ -0,0 +1,340 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "procs.h"
+#include "harness/benchmarkHelpers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// N host threads enqueue small commands, first all into one shared queue and
+// then each into its own queue, with N doubling up to the number of cores.
+// Each point of the curve reports the distribution of the time spent in the
+// enqueue calls and the command throughput. When N threads together enqueue
+// slower than one thread does on its own, they are most likely serialized on
+// a lock in the runtime and spend more time handing it over than holding it
+// (a lock convoy), which is reported as a warning. With per-thread queues
+// this points at a lock shared by the whole context or device.
+
+namespace {
+
+enum class CommandType
+{
+    ndrange,
+    copy,
+    map
+};
+
+const char *command_names[] = { "ndrange", "copy", "map" };
+
+const size_t kBufferElements = 1024;
+const size_t kBufferSize = kBufferElements * sizeof(cl_uint);
+// Overridden by --benchmark-repeat
+const unsigned kDefaultCommandsPerThread = 512;
+
+const char *kIncrementSource = "__kernel void increment(__global uint *data)\n"
+                               "{\n"
+                               "    data[get_global_id(0)]++;\n"
+                               "}\n";
+
+// Objects used by a single host thread. Kernel arguments in particular must
+// not be set from several threads.
+struct ThreadResources
+{
+    clMemWrapper src;
+    clMemWrapper dst;
+    clKernelWrapper kernel;
+    clCommandQueueWrapper queue; // only with per-thread queues
+    std::vector<double> latencies; // seconds spent in each enqueue
+    cl_int error = CL_SUCCESS;
+};
+
+// Holds the threads until all of them are ready, so that they contend from
+// the first command
+class StartGate {
+public:
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        waiting++;
+        changed.notify_all();
+        changed.wait(lock, [this] { return open; });
+    }
+
+    void release(unsigned threads)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return waiting == threads; });
+        open = true;
+        changed.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable changed;
+    unsigned waiting = 0;
+    bool open = false;
+};
+
+struct ContentionPoint
+{
+    double enqueue_rate; // commands per second, enqueue calls only
+    double command_rate; // commands per second, until all have completed
+    BenchmarkStats latency; // microseconds per enqueue
+};
+
+std::vector<unsigned> thread_counts()
+{
+    unsigned cores = std::max(std::thread::hardware_concurrency(), 2u);
+    std::vector<unsigned> counts;
+    for (unsigned n = 1; n < cores; n *= 2) counts.push_back(n);
+    counts.push_back(cores);
+    return counts;
+}
+
+cl_int enqueue_command(CommandType type, cl_command_queue queue,
+                       ThreadResources &r)
+{
+    switch (type)
+    {
+        case CommandType::ndrange: {
+            size_t global = kBufferElements;
+            return clEnqueueNDRangeKernel(queue, r.kernel, 1, nullptr,
+                                          &global, nullptr, 0, nullptr,
+                                          nullptr);
+        }
+        case CommandType::copy:
+            return clEnqueueCopyBuffer(queue, r.src, r.dst, 0, 0, kBufferSize,
+                                       0, nullptr, nullptr);
+        case CommandType::map: {
+            // A map and its unmap count as one command
+            cl_int error;
+            void *ptr = clEnqueueMapBuffer(queue, r.dst, CL_FALSE, CL_MAP_READ,
+                                           0, kBufferSize, 0, nullptr, nullptr,
+                                           &error);
+            if (error != CL_SUCCESS) return error;
+            return clEnqueueUnmapMemObject(queue, r.dst, ptr, 0, nullptr,
+                                           nullptr);
+        }
+    }
+    return CL_INVALID_VALUE;
+}
+
+void enqueue_thread(CommandType type, cl_command_queue queue,
+                    unsigned commands, StartGate *gate, ThreadResources *r)
+{
+    r->latencies.reserve(commands);
+    gate->wait();
+    for (unsigned i = 0; i < commands; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        cl_int error = enqueue_command(type, queue, *r);
+        auto end = std::chrono::steady_clock::now();
+        if (error != CL_SUCCESS)
+        {
+            r->error = error;
+            return;
+        }
+        r->latencies.push_back(
+            std::chrono::duration<double>(end - start).count());
+    }
+    r->error = clFlush(queue);
+}
+
+cl_int setup_resources(cl_context context, cl_program program, unsigned index,
+                       ThreadResources &r)
+{
+    cl_int error;
+    std::vector<cl_uint> data(kBufferElements);
+    for (size_t i = 0; i < kBufferElements; i++)
+        data[i] = (cl_uint)(index * kBufferElements + i);
+    r.src = clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                           kBufferSize, data.data(), &error);
+    if (error != CL_SUCCESS) return error;
+
+    std::fill(data.begin(), data.end(), 0);
+    r.dst = clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+                           kBufferSize, data.data(), &error);
+    if (error != CL_SUCCESS) return error;
+
+    r.kernel = clCreateKernel(program, "increment", &error);
+    if (error != CL_SUCCESS) return error;
+    return clSetKernelArg(r.kernel, 0, sizeof(cl_mem), &r.dst);
+}
+
+int verify_results(CommandType type, cl_command_queue queue, unsigned index,
+                   unsigned commands, ThreadResources &r)
+{
+    if (type == CommandType::map) return 0;
+
+    std::vector<cl_uint> data(kBufferElements);
+    cl_int error = clEnqueueReadBuffer(queue, r.dst, CL_TRUE, 0, kBufferSize,
+                                       data.data(), 0, nullptr, nullptr);
+    test_error(error, "Unable to read results");
+
+    for (size_t i = 0; i < kBufferElements; i++)
+    {
+        cl_uint expected = type == CommandType::ndrange
+            ? commands
+            : (cl_uint)(index * kBufferElements + i);
+        if (data[i] != expected)
+        {
+            log_error("ERROR: Element %zu of thread %u is %u, expected %u\n", i,
+                      index, data[i], expected);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int run_point(cl_device_id device, cl_context context,
+              cl_command_queue shared_queue, cl_program program,
+              CommandType type, unsigned threads, bool shared,
+              unsigned commands, ContentionPoint &point)
+{
+    cl_int error;
+    std::vector<ThreadResources> resources(threads);
+    for (unsigned t = 0; t < threads; t++)
+    {
+        error = setup_resources(context, program, t, resources[t]);
+        test_error(error, "Unable to set up thread resources");
+        if (!shared)
+        {
+            resources[t].queue =
+                clCreateCommandQueue(context, device, 0, &error);
+            test_error(error, "Unable to create command queue");
+        }
+    }
+
+    StartGate gate;
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++)
+    {
+        cl_command_queue queue =
+            shared ? shared_queue : (cl_command_queue)resources[t].queue;
+        workers.emplace_back(enqueue_thread, type, queue, commands, &gate,
+                             &resources[t]);
+    }
+    gate.release(threads);
+    auto start = std::chrono::steady_clock::now();
+    for (std::thread &worker : workers) worker.join();
+    auto enqueued = std::chrono::steady_clock::now();
+
+    if (shared)
+    {
+        error = clFinish(shared_queue);
+        test_error(error, "clFinish failed");
+    }
+    else
+    {
+        for (ThreadResources &r : resources)
+        {
+            error = clFinish(r.queue);
+            test_error(error, "clFinish failed");
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::vector<double> latencies;
+    for (unsigned t = 0; t < threads; t++)
+    {
+        ThreadResources &r = resources[t];
+        test_error(r.error, "Enqueue from host thread failed");
+        if (verify_results(type, shared_queue, t, commands, r)) return -1;
+        latencies.insert(latencies.end(), r.latencies.begin(),
+                         r.latencies.end());
+    }
+
+    double total = (double)threads * commands;
+    point.enqueue_rate =
+        total / std::chrono::duration<double>(enqueued - start).count();
+    point.command_rate =
+        total / std::chrono::duration<double>(end - start).count();
+
+    std::string name = std::string("enqueue_contention/")
+        + command_names[(int)type] + (shared ? "/shared/" : "/per_thread/")
+        + std::to_string(threads);
+    point.latency = record_benchmark({ name, 1, "" }, 1, latencies);
+    return 0;
+}
+
+int test_contention(cl_device_id device, cl_context context,
+                    cl_command_queue queue, CommandType type)
+{
+    cl_int error;
+    clProgramWrapper program;
+    clKernelWrapper kernel;
+    error = create_single_kernel_helper(context, &program, &kernel, 1,
+                                        &kIncrementSource, "increment");
+    test_error(error, "Unable to create kernel");
+
+    unsigned commands = gBenchmarkRepetitions ? gBenchmarkRepetitions
+                                              : kDefaultCommandsPerThread;
+    log_info("\t%u %s commands per thread\n", commands,
+             command_names[(int)type]);
+    log_info("\t%-10s %7s %11s %11s %9s %9s %9s %7s\n", "queues", "threads",
+             "enqueue/s", "complete/s", "p50 us", "p99 us", "max us",
+             "scaling");
+
+    for (bool shared : { true, false })
+    {
+        const char *queues = shared ? "shared" : "per-thread";
+        double single_thread_rate = 0.0;
+        for (unsigned threads : thread_counts())
+        {
+            ContentionPoint point;
+            if (run_point(device, context, queue, program, type, threads,
+                          shared, commands, point))
+                return -1;
+
+            if (threads == 1) single_thread_rate = point.enqueue_rate;
+            double scaling = point.enqueue_rate / single_thread_rate;
+            log_info("\t%-10s %7u %11.0f %11.0f %9.2f %9.2f %9.2f %7.2f\n",
+                     queues, threads, point.enqueue_rate, point.command_rate,
+                     point.latency.median, point.latency.p99,
+                     point.latency.max, scaling);
+            if (threads > 1 && scaling < 1.0)
+                log_info("\tWARNING: %u threads enqueue into %s queues slower "
+                         "than one thread, possible lock convoy\n",
+                         threads, queues);
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+int test_enqueue_contention_ndrange(cl_device_id deviceID, cl_context context,
+                                    cl_command_queue queue, int num_elements)
+{
+    return test_contention(deviceID, context, queue, CommandType::ndrange);
+}
+
+int test_enqueue_contention_copy(cl_device_id deviceID, cl_context context,
+                                 cl_command_queue queue, int num_elements)
+{
+    return test_contention(deviceID, context, queue, CommandType::copy);
+}
+
+int test_enqueue_contention_map(cl_device_id deviceID, cl_context context,
+                                cl_command_queue queue, int num_elements)
+{
+    return test_contention(deviceID, context, queue, CommandType::map);
+}
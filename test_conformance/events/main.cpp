@@ -57,6 +57,7 @@ test_definition test_list[] = {
     ADD_TEST(callbacks),
     ADD_TEST(callbacks_simultaneous),
     ADD_TEST(userevents_multithreaded),
+    ADD_TEST(event_graph_stress),
 };
 
 const int test_num = ARRAY_SIZE(test_list);
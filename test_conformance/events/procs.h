@@ -116,3 +116,5 @@ extern int test_userevents_multithreaded(cl_device_id deviceID,
                                          cl_context context,
                                          cl_command_queue queue,
                                          int num_elements);
+extern int test_event_graph_stress(cl_device_id deviceID, cl_context context,
+                                   cl_command_queue queue, int num_elements);
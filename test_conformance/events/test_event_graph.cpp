@@ -0,0 +1,341 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "testBase.h"
+#include "action_classes.h"
+#include "harness/mt19937.h"
+#include "harness/testHarness.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+extern const char *IGetStatusString(cl_int status);
+
+// Builds a random DAG of actions over several in-order and out-of-order
+// queues, with event wait lists and user events as edges, and checks from
+// the profiling timestamps that no command started before the commands it
+// depends on had ended. The graph only depends on the random seed, so a
+// failure can be reproduced with -seed.
+
+namespace {
+
+const size_t kGraphNodes = 1000;
+const size_t kActionsPerType = 2;
+const size_t kMaxWaits = 4;
+// Dependencies are drawn from this many preceding nodes, which keeps the
+// graph deep rather than wide
+const size_t kWaitWindow = 64;
+const size_t kUserEvents = 4;
+// Percentage of nodes without dependencies that wait on a user event
+const cl_uint kUserEventGatePercent = 10;
+
+enum class Requires
+{
+    nothing,
+    images,
+    images3D
+};
+
+struct ActionType
+{
+    Action *(*create)();
+    Requires needs;
+};
+
+template <typename T> Action *create_action() { return new T; }
+
+// Map and unmap actions are left out, they cannot be executed repeatedly
+const ActionType action_types[] = {
+    { create_action<NDRangeKernelAction>, Requires::nothing },
+    { create_action<ReadBufferAction>, Requires::nothing },
+    { create_action<WriteBufferAction>, Requires::nothing },
+    { create_action<ReadImage2DAction>, Requires::images },
+    { create_action<WriteImage2DAction>, Requires::images },
+    { create_action<CopyImage2Dto2DAction>, Requires::images },
+    { create_action<Copy2DImageToBufferAction>, Requires::images },
+    { create_action<CopyBufferTo2DImageAction>, Requires::images },
+    { create_action<ReadImage3DAction>, Requires::images3D },
+    { create_action<WriteImage3DAction>, Requires::images3D },
+    { create_action<CopyImage2Dto3DAction>, Requires::images3D },
+    { create_action<CopyImage3Dto2DAction>, Requires::images3D },
+    { create_action<CopyImage3Dto3DAction>, Requires::images3D },
+    { create_action<Copy3DImageToBufferAction>, Requires::images3D },
+    { create_action<CopyBufferTo3DImageAction>, Requires::images3D },
+};
+
+struct GraphQueue
+{
+    clCommandQueueWrapper queue;
+    bool in_order;
+};
+
+struct GraphNode
+{
+    size_t queue;
+    size_t action; // index into the action pool
+    std::vector<size_t> waits; // indices of earlier nodes
+    int user_event; // index of the user event waited on, or -1
+    bool gated; // waits on a user event, directly or not
+};
+
+struct NodeTimes
+{
+    cl_ulong submit;
+    cl_ulong start;
+    cl_ulong end;
+};
+
+std::vector<GraphNode> generate_graph(size_t queue_count, size_t action_count,
+                                      MTdata d)
+{
+    std::vector<GraphNode> nodes(kGraphNodes);
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        GraphNode &node = nodes[i];
+        node.queue = genrand_int32(d) % queue_count;
+        node.user_event = -1;
+        node.gated = false;
+
+        size_t window = std::min(i, kWaitWindow);
+        size_t wait_count = window ? genrand_int32(d) % (kMaxWaits + 1) : 0;
+        for (size_t w = 0; w < wait_count; w++)
+        {
+            size_t dep = i - 1 - genrand_int32(d) % window;
+            if (std::find(node.waits.begin(), node.waits.end(), dep)
+                != node.waits.end())
+                continue;
+            node.waits.push_back(dep);
+            node.gated |= nodes[dep].gated;
+        }
+        if (node.waits.empty()
+            && genrand_int32(d) % 100 < kUserEventGatePercent)
+        {
+            node.user_event = (int)(genrand_int32(d) % kUserEvents);
+            node.gated = true;
+        }
+        // Drawn last so that the shape of the graph does not depend on the
+        // action types available
+        node.action = genrand_int32(d) % action_count;
+    }
+    return nodes;
+}
+
+cl_int get_times(cl_event event, NodeTimes &times)
+{
+    cl_int error = clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_SUBMIT,
+                                           sizeof(times.submit), &times.submit,
+                                           NULL);
+    error |= clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START,
+                                     sizeof(times.start), &times.start, NULL);
+    error |= clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END,
+                                     sizeof(times.end), &times.end, NULL);
+    return error;
+}
+
+double percentile(std::vector<double> &sorted, double p)
+{
+    if (sorted.empty()) return 0.0;
+    size_t index = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+} // namespace
+
+int test_event_graph_stress(cl_device_id deviceID, cl_context context,
+                            cl_command_queue queue, int num_elements)
+{
+    cl_int error;
+
+    // Queues
+    std::vector<GraphQueue> queues;
+    cl_command_queue_properties ooo_props =
+        CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE | CL_QUEUE_PROFILING_ENABLE;
+    bool ooo_supported = checkDeviceForQueueSupport(deviceID, ooo_props);
+    for (int i = 0; i < 4; i++)
+    {
+        bool in_order = i < 2 || !ooo_supported;
+        GraphQueue q;
+        q.queue = clCreateCommandQueue(
+            context, deviceID, in_order ? CL_QUEUE_PROFILING_ENABLE : ooo_props,
+            &error);
+        test_error(error, "Unable to create command queue");
+        q.in_order = in_order;
+        queues.push_back(std::move(q));
+    }
+    if (!ooo_supported)
+        log_info("\tOut-of-order queues are not supported, using in-order "
+                 "queues only\n");
+
+    // Actions, a few instances of every type the device supports
+    bool images = checkForImageSupport(deviceID) == 0;
+    bool images3D = images && checkFor3DImageSupport(deviceID) == 0;
+    std::vector<std::unique_ptr<Action>> actions;
+    for (const ActionType &type : action_types)
+    {
+        if ((type.needs == Requires::images && !images)
+            || (type.needs == Requires::images3D && !images3D))
+            continue;
+        for (size_t i = 0; i < kActionsPerType; i++)
+        {
+            std::unique_ptr<Action> action(type.create());
+            error = action->Setup(deviceID, context, queues[0].queue);
+            test_error(error, "Unable to set up action");
+            actions.push_back(std::move(action));
+        }
+    }
+
+    // Graph
+    log_info("\tGenerating a graph of %zu commands over %zu queues and %zu "
+             "actions with seed %u\n",
+             kGraphNodes, queues.size(), actions.size(), gRandomSeed);
+    MTdata d = init_genrand(gRandomSeed);
+    std::vector<GraphNode> nodes =
+        generate_graph(queues.size(), actions.size(), d);
+    free_mtdata(d);
+
+    clEventWrapper user_events[kUserEvents];
+    for (clEventWrapper &user_event : user_events)
+    {
+        user_event = clCreateUserEvent(context, &error);
+        test_error(error, "Unable to create user event");
+    }
+
+    // Execute
+    std::vector<clEventWrapper> events(nodes.size());
+    std::vector<cl_event> waits;
+    auto start_time = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        const GraphNode &node = nodes[i];
+        Action *action = actions[node.action].get();
+        waits.clear();
+        for (size_t dep : node.waits) waits.push_back(events[dep]);
+        if (node.user_event >= 0) waits.push_back(user_events[node.user_event]);
+
+        error = action->Execute(queues[node.queue].queue,
+                                (cl_uint)waits.size(),
+                                waits.empty() ? NULL : waits.data(),
+                                &events[i]);
+        if (error != CL_SUCCESS)
+        {
+            log_error("ERROR: Unable to execute %s as command %zu\n",
+                      action->GetName(), i);
+            for (clEventWrapper &user_event : user_events)
+                clSetUserEventStatus(user_event, -1);
+            return TEST_FAIL;
+        }
+    }
+    auto enqueue_time = std::chrono::steady_clock::now();
+    for (GraphQueue &q : queues)
+    {
+        error = clFlush(q.queue);
+        test_error(error, "clFlush failed");
+    }
+
+    int failures = 0;
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        if (!nodes[i].gated) continue;
+        cl_int status;
+        error = clGetEventInfo(events[i], CL_EVENT_COMMAND_EXECUTION_STATUS,
+                               sizeof(status), &status, NULL);
+        test_error(error, "Unable to get event status");
+        if (status == CL_RUNNING || status == CL_COMPLETE)
+        {
+            log_error("ERROR: Command %zu (%s) started before the user event "
+                      "it waits on was set (status: %s)\n",
+                      i, actions[nodes[i].action]->GetName(),
+                      IGetStatusString(status));
+            failures++;
+        }
+    }
+
+    for (clEventWrapper &user_event : user_events)
+    {
+        error = clSetUserEventStatus(user_event, CL_COMPLETE);
+        test_error(error, "Unable to set user event status");
+    }
+    for (GraphQueue &q : queues)
+    {
+        error = clFinish(q.queue);
+        test_error(error, "clFinish failed");
+    }
+    auto end_time = std::chrono::steady_clock::now();
+
+    // Validate the completion order
+    std::vector<NodeTimes> times(nodes.size());
+    std::vector<size_t> previous_on_queue(queues.size(), nodes.size());
+    std::vector<double> latencies;
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        const GraphNode &node = nodes[i];
+        cl_int status;
+        error = clGetEventInfo(events[i], CL_EVENT_COMMAND_EXECUTION_STATUS,
+                               sizeof(status), &status, NULL);
+        test_error(error, "Unable to get event status");
+        if (status != CL_COMPLETE)
+        {
+            log_error("ERROR: Command %zu (%s) did not complete (status: "
+                      "%s)\n",
+                      i, actions[node.action]->GetName(),
+                      IGetStatusString(status));
+            failures++;
+            continue;
+        }
+        error = get_times(events[i], times[i]);
+        test_error(error, "Unable to get profiling info");
+
+        std::vector<size_t> predecessors = node.waits;
+        size_t previous = previous_on_queue[node.queue];
+        if (queues[node.queue].in_order && previous < nodes.size())
+            predecessors.push_back(previous);
+        previous_on_queue[node.queue] = i;
+
+        cl_ulong ready = times[i].submit;
+        for (size_t dep : predecessors)
+        {
+            if (times[i].start < times[dep].end)
+            {
+                log_error("ERROR: Command %zu (%s) started before command %zu "
+                          "(%s) it depends on ended\n",
+                          i, actions[node.action]->GetName(), dep,
+                          actions[nodes[dep].action]->GetName());
+                failures++;
+            }
+            ready = std::max(ready, times[dep].end);
+        }
+        // The host time at which user events were set is not known
+        if (!node.gated && times[i].start >= ready)
+            latencies.push_back((times[i].start - ready) * 1e-3);
+    }
+
+    double total_seconds =
+        std::chrono::duration<double>(end_time - start_time).count();
+    double enqueue_seconds =
+        std::chrono::duration<double>(enqueue_time - start_time).count();
+    std::sort(latencies.begin(), latencies.end());
+    log_info("\tEnqueued %zu commands in %.3f s (%.0f commands/s), all "
+             "complete after %.3f s (%.0f commands/s)\n",
+             nodes.size(), enqueue_seconds, nodes.size() / enqueue_seconds,
+             total_seconds, nodes.size() / total_seconds);
+    log_info("\tScheduling latency from ready to start: p50 %.1f us, p99 "
+             "%.1f us, max %.1f us\n",
+             percentile(latencies, 50), percentile(latencies, 99),
+             latencies.empty() ? 0.0 : latencies.back());
+
+    return failures ? TEST_FAIL : TEST_PASS;
+}
@@ -15,8 +15,11 @@
 //
 #include "harness/compat.h"
 
+#include <ctype.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <vector>
 #include "procs.h"
 #include "harness/testHarness.h"
 #if !defined(_WIN32)
@@ -32,12 +35,27 @@ test_definition test_list[] = {
     ADD_TEST( geom_fast_length ),
     ADD_TEST( geom_normalize ),
     ADD_TEST( geom_fast_normalize ),
+    ADD_TEST( geom_brute_force ),
 };
 
 const int test_num = ARRAY_SIZE( test_list );
 
 int main(int argc, const char *argv[])
 {
-    return runTestHarness(argc, argv, test_num, test_list, false, 0);
+    std::vector<const char *> argList;
+    for (int i = 0; i < argc; i++)
+    {
+        if (strcmp(argv[i], "brute_force") == 0)
+        {
+            gBruteForceBlocks = 16;
+            if (i + 1 < argc && isdigit(argv[i + 1][0]))
+                gBruteForceBlocks = (cl_uint)strtoul(argv[++i], NULL, 10);
+        }
+        else
+            argList.push_back(argv[i]);
+    }
+
+    return runTestHarness((int)argList.size(), argList.data(), test_num,
+                          test_list, false, 0);
 }
 
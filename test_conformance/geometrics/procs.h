@@ -28,8 +28,29 @@ extern int test_geom_fast_length(cl_device_id deviceID, cl_context context, cl_c
 extern int test_geom_normalize(cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements);
 extern int test_geom_fast_normalize(cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements);
 
+extern int test_geom_brute_force(cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements);
+
 extern int test_geom_cross_double(cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements, MTdata d);
 extern int test_geom_dot_double(cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements, MTdata d);
 extern int test_geom_distance_double(cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements, MTdata d);
 extern int test_geom_length_double(cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements, MTdata d);
 extern int test_geom_normalize_double(cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements, MTdata d);
+
+// Blocks per function and vector size of geom_brute_force, set with
+// brute_force [blocks]. The test is skipped when 0.
+extern cl_uint gBruteForceBlocks;
+
+// Kernels and references of the float tests, shared with geom_brute_force
+extern const char *crossKernelSource;
+extern const char *crossKernelSourceV3;
+extern const char *twoToFloatKernelPattern;
+extern const char *twoToFloatKernelPatternV3;
+extern const char *oneToFloatKernelPattern;
+extern const char *oneToFloatKernelPatternV3;
+extern const char *oneToOneKernelPattern;
+extern const char *oneToOneKernelPatternV3;
+
+extern void vector2string(char *string, float *vector, size_t elements);
+extern void fillWithTrickyNumbers(float *aVectors, float *bVectors, size_t vecSize);
+extern void cross_product(const float *vecA, const float *vecB, float *outVector, float *errorTolerances, float ulpTolerance);
+extern void verifyNormalize(float *srcA, float *dst, size_t vecSize);
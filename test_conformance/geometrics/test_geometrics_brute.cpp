@@ -0,0 +1,583 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "testBase.h"
+#include "harness/conversions.h"
+#include "harness/testHarness.h"
+#include "harness/ThreadPool.h"
+
+#include <float.h>
+#include <math.h>
+
+#include <algorithm>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Large-scale mode in the style of math_brute_force. Every function and
+// vector size is run over gBruteForceBlocks blocks of random vectors, the
+// first block starting with the tricky inputs of the regular tests. Inputs
+// are generated and references checked on the thread pool, with the device
+// running one block while the host works on the next.
+
+cl_uint gBruteForceBlocks = 0;
+
+namespace {
+
+const size_t kBlockVectors = 1 << 20;
+const size_t kVectorsPerJob = 4096;
+const size_t kSlots = 2;
+
+enum GeomKind
+{
+    kDot,
+    kDistance,
+    kLength,
+    kNormalize,
+    kCross
+};
+
+struct GeomFunction
+{
+    const char *name;
+    GeomKind kind;
+    bool fast;
+    // Negative when the function is checked against an absolute tolerance
+    // computed for each sample instead
+    float (*ulp_limit)(float vecSize);
+};
+
+// The limits of the regular tests
+const GeomFunction functions[] = {
+    { "dot", kDot, false, [](float) { return -1.0f; } },
+    { "distance", kDistance, false,
+      [](float n) { return 3.0f + (1.5f * n + 0.5f * (n - 1.0f)); } },
+    { "fast_distance", kDistance, true,
+      [](float n) { return 8192.0f + (1.5f * n + 0.5f * (n - 1.0f)); } },
+    { "length", kLength, false,
+      [](float n) { return 3.0f + 0.5f * (0.5f * n + 0.5f * (n - 1.0f)); } },
+    { "fast_length", kLength, true,
+      [](float n) { return 8192.0f + (0.5f * n + 0.5f * (n - 1.0f)); } },
+    { "normalize", kNormalize, false,
+      [](float n) { return 2.5f + (0.5f * n + 0.5f * (n - 1.0f)); } },
+    { "fast_normalize", kNormalize, true,
+      [](float n) { return 8192.5f + (0.5f * n + 0.5f * (n - 1.0f)); } },
+    { "cross", kCross, false, [](float) { return -1.0f; } },
+};
+
+size_t input_count(GeomKind kind)
+{
+    return kind == kDot || kind == kDistance || kind == kCross ? 2 : 1;
+}
+
+size_t result_size(GeomKind kind, size_t vecSize)
+{
+    return kind == kNormalize || kind == kCross ? vecSize : 1;
+}
+
+#ifdef __SSE2__
+__m128d load_pair(const float *p)
+{
+    return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i *)p)));
+}
+#endif
+
+// Sum of a[k] * b[k], or of (a[k] - b[k])^2 with difference set, in double
+// precision. Products of floats are exact in double, so the order of the
+// additions only moves the result by a fraction of a double ulp.
+double accumulate(const float *a, const float *b, size_t n, bool difference)
+{
+    double total = 0.0;
+    size_t k = 0;
+#ifdef __SSE2__
+    if (n >= 2)
+    {
+        __m128d acc = _mm_setzero_pd();
+        for (; k + 2 <= n; k += 2)
+        {
+            __m128d x = load_pair(a + k);
+            __m128d y = load_pair(b + k);
+            if (difference)
+            {
+                x = _mm_sub_pd(x, y);
+                y = x;
+            }
+            acc = _mm_add_pd(acc, _mm_mul_pd(x, y));
+        }
+        total = _mm_cvtsd_f64(acc)
+            + _mm_cvtsd_f64(_mm_unpackhi_pd(acc, acc));
+    }
+#endif
+    for (; k < n; k++)
+    {
+        double x = a[k];
+        double y = b[k];
+        if (difference)
+        {
+            x -= y;
+            y = x;
+        }
+        total += x * y;
+    }
+    return total;
+}
+
+struct BruteSlot
+{
+    std::vector<cl_float> a;
+    std::vector<cl_float> b;
+    std::vector<cl_float> out;
+    clMemWrapper a_mem;
+    clMemWrapper b_mem;
+    clMemWrapper out_mem;
+    clEventWrapper done;
+    cl_uint block;
+};
+
+// Finishes the queue when leaving scope, so that no transfer of an in-flight
+// block outlives the slot it writes to.
+struct QueueDrain
+{
+    cl_command_queue queue;
+    ~QueueDrain() { clFinish(queue); }
+};
+
+struct ThreadStats
+{
+    double max_ulp;
+    size_t failures;
+    size_t first_failure;
+};
+
+struct BruteJob
+{
+    const GeomFunction *fn;
+    size_t vecSize;
+    BruteSlot *slot;
+    cl_uint seed;
+    float ulp_limit;
+    bool has_inf_nan;
+    bool rtz;
+    std::vector<ThreadStats> stats; // indexed by thread id
+};
+
+void generate_inputs(const BruteJob &job, MTdata d, cl_float *p, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        if (job.fn->kind != kNormalize)
+            p[i] = get_random_float(-512.f, 512.f, d);
+        else if (!job.fn->fast)
+            p[i] = any_float(d);
+        else
+        {
+            // Keep the problematic cases out of fast_normalize
+            cl_float z = get_random_float(-MAKE_HEX_FLOAT(0x1.0p60f, 1, 60),
+                                          MAKE_HEX_FLOAT(0x1.0p60f, 1, 60), d);
+            if (fabsf(z) < MAKE_HEX_FLOAT(0x1.0p-60f, 1, -60))
+                z = copysignf(0.0f, z);
+            p[i] = z;
+        }
+    }
+}
+
+void clamp_to_fast_range(std::vector<cl_float> &values, MTdata d)
+{
+    for (cl_float &value : values)
+        if (fabsf(value) > MAKE_HEX_FLOAT(0x1.0p62f, 0x1L, 62)
+            || fabsf(value) < MAKE_HEX_FLOAT(0x1.0p-62f, 0x1L, -62))
+            value = get_random_float(-512.f, 512.f, d);
+}
+
+cl_int generate_job(cl_uint job_id, cl_uint thread_id, void *userInfo)
+{
+    const BruteJob &job = *(const BruteJob *)userInfo;
+    BruteSlot &slot = *job.slot;
+    // Seeded by the position in the sweep, so a block does not depend on
+    // which thread generated it
+    const cl_uint jobs = (cl_uint)(kBlockVectors / kVectorsPerJob);
+    MTdataHolder d(job.seed + slot.block * jobs + job_id);
+
+    size_t first = job_id * kVectorsPerJob * job.vecSize;
+    size_t n = kVectorsPerJob * job.vecSize;
+    generate_inputs(job, d, slot.a.data() + first, n);
+    if (input_count(job.fn->kind) == 2)
+        generate_inputs(job, d, slot.b.data() + first, n);
+    return CL_SUCCESS;
+}
+
+bool is_nan_pair(float test, double reference)
+{
+    return isnan(test) && isnan(reference);
+}
+
+// Checks one sample. ulp is set to the largest error of its components, or
+// left alone when they are not comparable.
+bool check_sample(const BruteJob &job, const cl_float *a, const cl_float *b,
+                  const cl_float *out, double &ulp)
+{
+    const size_t n = job.vecSize;
+
+    if (!job.has_inf_nan)
+    {
+        for (size_t k = 0; k < n * input_count(job.fn->kind); k++)
+            if (!isfinite(k < n ? a[k] : b[k - n])) return true;
+    }
+
+    switch (job.fn->kind)
+    {
+        case kDot:
+        case kDistance:
+        case kLength: {
+            double expected = job.fn->kind == kDot
+                ? accumulate(a, b, n, false)
+                : sqrt(accumulate(a, job.fn->kind == kLength ? a : b, n,
+                                  job.fn->kind == kDistance));
+            if ((float)expected == out[0] || is_nan_pair(out[0], expected))
+                return true;
+            if (!job.has_inf_nan && !isfinite((float)expected)) return true;
+
+            double error = fabs(Ulp_Error(out[0], expected));
+            if (isfinite(error)) ulp = std::max(ulp, error);
+            if (job.ulp_limit >= 0.0f) return !(error > job.ulp_limit);
+
+            // Dot accrues up to 2n - 1 rounding errors of the largest term
+            float maxValue = fabsf(a[0]);
+            for (size_t k = 0; k < n; k++)
+                maxValue = fmaxf(maxValue, fmaxf(fabsf(a[k]), fabsf(b[k])));
+            float tolerance =
+                maxValue * maxValue * (2.f * (float)n - 1.f) * FLT_EPSILON;
+            return !(fabs(expected - (double)out[0]) > tolerance);
+        }
+        case kNormalize: {
+            float expected[4];
+            verifyNormalize((float *)a, expected, n);
+
+            bool pass = true;
+            for (size_t k = 0; k < n; k++)
+            {
+                if (expected[k] == out[k] || is_nan_pair(out[k], expected[k]))
+                    continue;
+                double error = fabs(Ulp_Error(out[k], expected[k]));
+                if (isfinite(error)) ulp = std::max(ulp, error);
+                if (error > job.ulp_limit) pass = false;
+            }
+            if (pass || !gFlushDenormsToZero) return pass;
+
+            // Try again with subnormals flushed, on the input and the result
+            float flushed[4];
+            for (size_t k = 0; k < n; k++)
+                flushed[k] = IsFloatSubnormal(a[k]) ? copysignf(0.0f, a[k])
+                                                    : a[k];
+            verifyNormalize(flushed, expected, n);
+            for (size_t k = 0; k < n; k++)
+            {
+                if (IsFloatSubnormal(expected[k]))
+                    expected[k] = copysignf(0.0f, expected[k]);
+                if (expected[k] == out[k] || is_nan_pair(out[k], expected[k]))
+                    continue;
+                if (fabs(Ulp_Error(out[k], expected[k])) > job.ulp_limit)
+                    return false;
+            }
+            return true;
+        }
+        case kCross: {
+            float expected[4], tolerances[4];
+            // On an embedded device w/ round-to-zero, 3 ulps is the
+            // worst-case tolerance for cross product
+            cross_product(a, b, expected, tolerances, 3.f);
+            bool pass = true;
+            for (size_t k = 0; k < 3; k++)
+            {
+                float tolerance = job.rtz ? 2.0f * tolerances[k]
+                                          : tolerances[k];
+                if (fabsf(expected[k] - out[k]) > tolerance) pass = false;
+                double error = fabs(Ulp_Error(out[k], expected[k]));
+                if (isfinite(error)) ulp = std::max(ulp, error);
+            }
+            return pass;
+        }
+    }
+    return false;
+}
+
+cl_int verify_job(cl_uint job_id, cl_uint thread_id, void *userInfo)
+{
+    BruteJob &job = *(BruteJob *)userInfo;
+    const BruteSlot &slot = *job.slot;
+    ThreadStats &stats = job.stats[thread_id];
+    const size_t n = job.vecSize;
+    const size_t width = result_size(job.fn->kind, n);
+    const cl_float *b = input_count(job.fn->kind) == 2 ? slot.b.data() : NULL;
+
+    size_t first = job_id * kVectorsPerJob;
+    for (size_t i = first; i < first + kVectorsPerJob; i++)
+    {
+        if (!check_sample(job, slot.a.data() + i * n, b ? b + i * n : NULL,
+                          slot.out.data() + i * width, stats.max_ulp))
+        {
+            if (!stats.failures || i < stats.first_failure)
+                stats.first_failure = i;
+            stats.failures++;
+        }
+    }
+    return CL_SUCCESS;
+}
+
+void report_failure(const BruteJob &job, size_t i)
+{
+    const BruteSlot &slot = *job.slot;
+    const size_t n = job.vecSize;
+    const size_t width = result_size(job.fn->kind, n);
+    char vecA[1000], vecB[1000], result[1000];
+
+    vector2string(vecA, (float *)slot.a.data() + i * n, n);
+    vector2string(result, (float *)slot.out.data() + i * width, width);
+    log_error("ERROR: %s vector size %zu, sample %zu of block %u does not "
+              "validate! Got %s\n",
+              job.fn->name, n, i, slot.block, result);
+    if (input_count(job.fn->kind) == 2)
+    {
+        vector2string(vecB, (float *)slot.b.data() + i * n, n);
+        log_error("\tvector A: %s, vector B: %s\n", vecA, vecB);
+    }
+    else
+        log_error("\tvector: %s\n", vecA);
+}
+
+int run_brute_force(cl_device_id device, cl_context context,
+                    cl_command_queue queue, const GeomFunction &fn,
+                    size_t vecSize, bool has_inf_nan, bool rtz, MTdata d)
+{
+    static const char *sizeNames[] = { "", "2", "3", "4" };
+    const size_t inputs = input_count(fn.kind);
+    const size_t width = result_size(fn.kind, vecSize);
+    int error;
+
+    char kernelSource[10240];
+    const char *programPtr = kernelSource;
+    switch (fn.kind)
+    {
+        case kDot:
+        case kDistance:
+            sprintf(kernelSource,
+                    vecSize == 3 ? twoToFloatKernelPatternV3
+                                 : twoToFloatKernelPattern,
+                    sizeNames[vecSize - 1], sizeNames[vecSize - 1], fn.name);
+            break;
+        case kLength:
+            sprintf(kernelSource,
+                    vecSize == 3 ? oneToFloatKernelPatternV3
+                                 : oneToFloatKernelPattern,
+                    sizeNames[vecSize - 1], fn.name);
+            break;
+        case kNormalize:
+            sprintf(kernelSource,
+                    vecSize == 3 ? oneToOneKernelPatternV3
+                                 : oneToOneKernelPattern,
+                    sizeNames[vecSize - 1], sizeNames[vecSize - 1], fn.name);
+            break;
+        case kCross:
+            programPtr =
+                vecSize == 3 ? crossKernelSourceV3 : crossKernelSource;
+            break;
+    }
+
+    clProgramWrapper program;
+    clKernelWrapper kernel;
+    if (create_single_kernel_helper(context, &program, &kernel, 1,
+                                    &programPtr, "sample_test"))
+        return -1;
+
+    BruteJob job;
+    job.fn = &fn;
+    job.vecSize = vecSize;
+    job.seed = genrand_int32(d);
+    job.ulp_limit = fn.ulp_limit((float)vecSize);
+    if (rtz && job.ulp_limit >= 0.0f) job.ulp_limit *= 2.0f;
+    job.has_inf_nan = has_inf_nan;
+    job.rtz = rtz;
+
+    BruteSlot slots[kSlots];
+    QueueDrain drain{ queue };
+    for (BruteSlot &slot : slots)
+    {
+        slot.a.resize(kBlockVectors * vecSize);
+        slot.b.resize(inputs == 2 ? kBlockVectors * vecSize : 0);
+        slot.out.resize(kBlockVectors * width);
+
+        slot.a_mem = clCreateBuffer(context, CL_MEM_READ_ONLY,
+                                    sizeof(cl_float) * slot.a.size(), NULL,
+                                    &error);
+        test_error(error, "Creating input array A failed");
+        if (inputs == 2)
+        {
+            slot.b_mem = clCreateBuffer(context, CL_MEM_READ_ONLY,
+                                        sizeof(cl_float) * slot.b.size(), NULL,
+                                        &error);
+            test_error(error, "Creating input array B failed");
+        }
+        slot.out_mem = clCreateBuffer(context, CL_MEM_WRITE_ONLY,
+                                      sizeof(cl_float) * slot.out.size(), NULL,
+                                      &error);
+        test_error(error, "Creating output array failed");
+    }
+
+    const cl_uint jobs = (cl_uint)(kBlockVectors / kVectorsPerJob);
+    double max_ulp = 0.0;
+    for (cl_uint block = 0; block <= gBruteForceBlocks; block++)
+    {
+        // Generate and submit the next block before checking this one
+        if (block < gBruteForceBlocks)
+        {
+            BruteSlot &next = slots[block % kSlots];
+            next.block = block;
+            job.slot = &next;
+            error = ThreadPool_Do(generate_job, jobs, &job);
+            test_error(error, "Unable to generate inputs");
+
+            if (block == 0 && fn.kind != kNormalize)
+                fillWithTrickyNumbers(next.a.data(),
+                                      inputs == 2 ? next.b.data() : NULL,
+                                      vecSize);
+            if (block == 0 && fn.kind == kNormalize)
+                memset(next.a.data(), 0, sizeof(cl_float) * vecSize);
+            if (block == 0 && fn.fast && fn.kind != kNormalize)
+            {
+                // Clamp the tricky values to the range of the fast_ functions
+                clamp_to_fast_range(next.a, d);
+                clamp_to_fast_range(next.b, d);
+            }
+
+            error = clEnqueueWriteBuffer(queue, next.a_mem, CL_FALSE, 0,
+                                         sizeof(cl_float) * next.a.size(),
+                                         next.a.data(), 0, NULL, NULL);
+            test_error(error, "Unable to write input array A");
+            error = clSetKernelArg(kernel, 0, sizeof(cl_mem), &next.a_mem);
+            test_error(error, "Unable to set indexed kernel arguments");
+            if (inputs == 2)
+            {
+                error = clEnqueueWriteBuffer(queue, next.b_mem, CL_FALSE, 0,
+                                             sizeof(cl_float) * next.b.size(),
+                                             next.b.data(), 0, NULL, NULL);
+                test_error(error, "Unable to write input array B");
+                error =
+                    clSetKernelArg(kernel, 1, sizeof(cl_mem), &next.b_mem);
+                test_error(error, "Unable to set indexed kernel arguments");
+            }
+            error = clSetKernelArg(kernel, (cl_uint)inputs, sizeof(cl_mem),
+                                   &next.out_mem);
+            test_error(error, "Unable to set indexed kernel arguments");
+
+            size_t threads[1] = { kBlockVectors };
+            error = clEnqueueNDRangeKernel(queue, kernel, 1, NULL, threads,
+                                           NULL, 0, NULL, NULL);
+            test_error(error, "Unable to execute test kernel");
+
+            next.done.reset();
+            error = clEnqueueReadBuffer(queue, next.out_mem, CL_FALSE, 0,
+                                        sizeof(cl_float) * next.out.size(),
+                                        next.out.data(), 0, NULL, &next.done);
+            test_error(error, "Unable to read output array!");
+            error = clFlush(queue);
+            test_error(error, "clFlush failed");
+        }
+
+        if (block == 0) continue;
+
+        BruteSlot &current = slots[(block - 1) % kSlots];
+        error = clWaitForEvents(1, &current.done);
+        test_error(error, "clWaitForEvents failed");
+
+        job.slot = &current;
+        job.stats.assign(GetThreadCount(), ThreadStats{ 0.0, 0, 0 });
+        error = ThreadPool_Do(verify_job, jobs, &job);
+        test_error(error, "Unable to verify results");
+
+        size_t failures = 0, first_failure = 0;
+        for (const ThreadStats &stats : job.stats)
+        {
+            max_ulp = std::max(max_ulp, stats.max_ulp);
+            if (stats.failures
+                && (!failures || stats.first_failure < first_failure))
+                first_failure = stats.first_failure;
+            failures += stats.failures;
+        }
+        if (failures)
+        {
+            report_failure(job, first_failure);
+            log_error("\t%zu of %zu samples of the block failed\n", failures,
+                      kBlockVectors);
+            return -1;
+        }
+    }
+
+    if (job.ulp_limit >= 0.0f)
+        log_info("   %-16s %2zu %12.3f %12.1f\n", fn.name, vecSize, max_ulp,
+                 job.ulp_limit);
+    else
+        log_info("   %-16s %2zu %12.3f %12s\n", fn.name, vecSize, max_ulp,
+                 "tolerance");
+    return 0;
+}
+
+} // namespace
+
+int test_geom_brute_force(cl_device_id deviceID, cl_context context,
+                          cl_command_queue queue, int num_elements)
+{
+    if (gBruteForceBlocks == 0)
+    {
+        log_info("Brute force mode not enabled, pass brute_force to run "
+                 "it.\n");
+        return TEST_SKIPPED_ITSELF;
+    }
+
+    cl_device_fp_config config = 0;
+    cl_int error = clGetDeviceInfo(deviceID, CL_DEVICE_SINGLE_FP_CONFIG,
+                                   sizeof(config), &config, NULL);
+    test_error(error, "Unable to get CL_DEVICE_SINGLE_FP_CONFIG");
+    bool has_inf_nan = (config & CL_FP_INF_NAN) != 0;
+
+    cl_device_fp_config defaultRoundingMode =
+        get_default_rounding_mode(deviceID);
+    if (0 == defaultRoundingMode) return -1;
+    // RTZ devices accrue approximately double the amount of error per
+    // operation
+    bool rtz = defaultRoundingMode == CL_FP_ROUND_TO_ZERO;
+
+    RandomSeed seed(gRandomSeed);
+    log_info("Testing %u blocks of %zu vectors per function and size\n",
+             gBruteForceBlocks, kBlockVectors);
+    log_info("   %-16s %2s %12s %12s\n", "function", "n", "max ulp", "limit");
+
+    int retVal = 0;
+    for (const GeomFunction &fn : functions)
+    {
+        for (size_t vecSize = fn.kind == kCross ? 3 : 1; vecSize <= 4;
+             vecSize++)
+        {
+            if (run_brute_force(deviceID, context, queue, fn, vecSize,
+                                has_inf_nan, rtz, seed))
+            {
+                log_error("   %s vector size %zu FAILED\n", fn.name, vecSize);
+                retVal = -1;
+            }
+        }
+    }
+    return retVal;
+}
@@ -13,6 +13,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //
+#include "harness/benchmarkHelpers.h"
 #include "harness/compat.h"
 #include "harness/kernelHelpers.h"
 #include "harness/testHarness.h"
@@ -247,6 +248,46 @@ static cl_half double2half_rtn(double f)
     return cl_half_from_double(f, CL_HALF_RTN);
 }
 
+// Times a conversion kernel over count elements with the benchmark harness
+static cl_int TimeKernel(cl_device_id device, cl_kernel kernel, cl_mem inBuf,
+                         const char *kernelName, const char *roundName,
+                         int vectorSize, cl_uint count, bool aligned,
+                         unsigned loopCount, BenchmarkStats &stats)
+{
+    BenchmarkKey key = { kernelName, g_arrVecSizes[vectorSize],
+                         roundName[0] == '_' ? roundName + 1 : roundName };
+    return run_benchmark(
+        key, count, loopCount,
+        [&]() -> cl_int {
+            cl_int error = RunKernel(device, kernel, inBuf, gOutBuffer_half,
+                                     numVecs(count, vectorSize, aligned),
+                                     runsOverBy(count, vectorSize, aligned));
+            if (error) return error;
+            if ((error = clFinish(gQueue))) vlog_error("Failure in clFinish\n");
+            return error;
+        },
+        &stats);
+}
+
+static void ReportKernelTimes(const char *testName, const char *roundName,
+                              const char *suffix, const char *unitSuffix,
+                              int minVectorSize, const BenchmarkStats *stats)
+{
+    double scale = gDeviceFrequency * gComputeDevices;
+    std::string avgUnit = std::string("average us/elem") + unitSuffix;
+    std::string bestUnit = std::string("best us/elem") + unitSuffix;
+    for (int vectorSize = minVectorSize; vectorSize < kLastVectorSizeToTest;
+         vectorSize++)
+        vlog_perf(stats[vectorSize].mean * scale, 0, avgUnit.c_str(),
+                  "%s%s avg.%s (%s vector size: %d)", testName, roundName,
+                  suffix, addressSpaceNames[0], (g_arrVecSizes[vectorSize]));
+    for (int vectorSize = minVectorSize; vectorSize < kLastVectorSizeToTest;
+         vectorSize++)
+        vlog_perf(stats[vectorSize].min * scale, 0, bestUnit.c_str(),
+                  "%s%s best%s (%s vector size: %d)", testName, roundName,
+                  suffix, addressSpaceNames[0], (g_arrVecSizes[vectorSize]));
+}
+
 int test_vstore_half(cl_device_id deviceID, cl_context context,
                      cl_command_queue queue, int num_elements)
 {
@@ -344,16 +385,11 @@ int Test_vStoreHalf_private(cl_device_id device, f2h referenceFunc,
     cl_program resetProgram;
     cl_kernel resetKernel;
 
-    uint64_t time[kVectorSizeCount + kStrangeVectorSizeCount] = { 0 };
-    uint64_t min_time[kVectorSizeCount + kStrangeVectorSizeCount] = { 0 };
-    memset(min_time, -1, sizeof(min_time));
+    BenchmarkStats stats[kVectorSizeCount + kStrangeVectorSizeCount] = {};
     cl_program doublePrograms[kVectorSizeCount + kStrangeVectorSizeCount][3];
     cl_kernel doubleKernels[kVectorSizeCount + kStrangeVectorSizeCount][3];
-    uint64_t doubleTime[kVectorSizeCount + kStrangeVectorSizeCount] = { 0 };
-    uint64_t min_double_time[kVectorSizeCount + kStrangeVectorSizeCount] = {
-        0
-    };
-    memset(min_double_time, -1, sizeof(min_double_time));
+    BenchmarkStats doubleStats[kVectorSizeCount + kStrangeVectorSizeCount] =
+        {};
 
     bool aligned = false;
 
@@ -1059,7 +1095,7 @@ int Test_vStoreHalf_private(cl_device_id device, f2h referenceFunc,
     } // end last case
 
     loopCount = count == blockCount ? 1 : 100;
-    if (gReportTimes)
+    if (gReportTimes || benchmarks_requested())
     {
         // Init the input stream
         cl_float *p = (cl_float *)gIn_single;
@@ -1096,101 +1132,36 @@ int Test_vStoreHalf_private(cl_device_id device, f2h referenceFunc,
         for (vectorSize = kMinVectorSize; vectorSize < kLastVectorSizeToTest;
              vectorSize++)
         {
-            uint64_t bestTime = -1ULL;
-            for (j = 0; j < loopCount; j++)
+            if ((error = TimeKernel(device, kernels[vectorSize][0],
+                                    gInBuffer_single, "vstore_half", roundName,
+                                    vectorSize, count, aligned, loopCount,
+                                    stats[vectorSize])))
             {
-                uint64_t startTime = ReadTime();
-
-
-                if ((error = RunKernel(device, kernels[vectorSize][0],
-                                       gInBuffer_single, gOutBuffer_half,
-                                       numVecs(count, vectorSize, aligned),
-                                       runsOverBy(count, vectorSize, aligned))))
-                {
-                    gFailCount++;
-                    goto exit;
-                }
-
-                if ((error = clFinish(gQueue)))
-                {
-                    vlog_error("Failure in clFinish\n");
-                    gFailCount++;
-                    goto exit;
-                }
-                uint64_t currentTime = ReadTime() - startTime;
-                if (currentTime < bestTime) bestTime = currentTime;
-                time[vectorSize] += currentTime;
+                gFailCount++;
+                goto exit;
             }
-            if (bestTime < min_time[vectorSize])
-                min_time[vectorSize] = bestTime;
 
             if (gTestDouble)
             {
-                bestTime = -1ULL;
-                for (j = 0; j < loopCount; j++)
+                if ((error = TimeKernel(device, doubleKernels[vectorSize][0],
+                                        gInBuffer_double, "vstore_half_double",
+                                        roundName, vectorSize, count, aligned,
+                                        loopCount, doubleStats[vectorSize])))
                 {
-                    uint64_t startTime = ReadTime();
-                    if ((error =
-                             RunKernel(device, doubleKernels[vectorSize][0],
-                                       gInBuffer_double, gOutBuffer_half,
-                                       numVecs(count, vectorSize, aligned),
-                                       runsOverBy(count, vectorSize, aligned))))
-                    {
-                        gFailCount++;
-                        goto exit;
-                    }
-
-                    if ((error = clFinish(gQueue)))
-                    {
-                        vlog_error("Failure in clFinish\n");
-                        gFailCount++;
-                        goto exit;
-                    }
-                    uint64_t currentTime = ReadTime() - startTime;
-                    if (currentTime < bestTime) bestTime = currentTime;
-                    doubleTime[vectorSize] += currentTime;
+                    gFailCount++;
+                    goto exit;
                 }
-                if (bestTime < min_double_time[vectorSize])
-                    min_double_time[vectorSize] = bestTime;
             }
         }
     }
 
     if (gReportTimes)
     {
-        for (vectorSize = kMinVectorSize; vectorSize < kLastVectorSizeToTest;
-             vectorSize++)
-            vlog_perf(SubtractTime(time[vectorSize], 0) * 1e6 * gDeviceFrequency
-                          * gComputeDevices / (double)(count * loopCount),
-                      0, "average us/elem",
-                      "vStoreHalf%s avg. (%s vector size: %d)", roundName,
-                      addressSpaceNames[0], (g_arrVecSizes[vectorSize]));
-        for (vectorSize = kMinVectorSize; vectorSize < kLastVectorSizeToTest;
-             vectorSize++)
-            vlog_perf(SubtractTime(min_time[vectorSize], 0) * 1e6
-                          * gDeviceFrequency * gComputeDevices / (double)count,
-                      0, "best us/elem",
-                      "vStoreHalf%s best (%s vector size: %d)", roundName,
-                      addressSpaceNames[0], (g_arrVecSizes[vectorSize]));
+        ReportKernelTimes("vStoreHalf", roundName, "", "", kMinVectorSize,
+                          stats);
         if (gTestDouble)
-        {
-            for (vectorSize = kMinVectorSize;
-                 vectorSize < kLastVectorSizeToTest; vectorSize++)
-                vlog_perf(SubtractTime(doubleTime[vectorSize], 0) * 1e6
-                              * gDeviceFrequency * gComputeDevices
-                              / (double)(count * loopCount),
-                          0, "average us/elem (double)",
-                          "vStoreHalf%s avg. d (%s vector size: %d)", roundName,
-                          addressSpaceNames[0], (g_arrVecSizes[vectorSize]));
-            for (vectorSize = kMinVectorSize;
-                 vectorSize < kLastVectorSizeToTest; vectorSize++)
-                vlog_perf(SubtractTime(min_double_time[vectorSize], 0) * 1e6
-                              * gDeviceFrequency * gComputeDevices
-                              / (double)count,
-                          0, "best us/elem (double)",
-                          "vStoreHalf%s best d (%s vector size: %d)", roundName,
-                          addressSpaceNames[0], (g_arrVecSizes[vectorSize]));
-        }
+            ReportKernelTimes("vStoreHalf", roundName, " d", " (double)",
+                              kMinVectorSize, doubleStats);
     }
 
 exit:
@@ -1228,16 +1199,11 @@ int Test_vStoreaHalf_private(cl_device_id device, f2h referenceFunc,
     cl_program resetProgram;
     cl_kernel resetKernel;
 
-    uint64_t time[kVectorSizeCount + kStrangeVectorSizeCount] = { 0 };
-    uint64_t min_time[kVectorSizeCount + kStrangeVectorSizeCount] = { 0 };
-    memset(min_time, -1, sizeof(min_time));
+    BenchmarkStats stats[kVectorSizeCount + kStrangeVectorSizeCount] = {};
     cl_program doublePrograms[kVectorSizeCount + kStrangeVectorSizeCount][3];
     cl_kernel doubleKernels[kVectorSizeCount + kStrangeVectorSizeCount][3];
-    uint64_t doubleTime[kVectorSizeCount + kStrangeVectorSizeCount] = { 0 };
-    uint64_t min_double_time[kVectorSizeCount + kStrangeVectorSizeCount] = {
-        0
-    };
-    memset(min_double_time, -1, sizeof(min_double_time));
+    BenchmarkStats doubleStats[kVectorSizeCount + kStrangeVectorSizeCount] =
+        {};
 
     bool aligned = true;
 
@@ -1904,7 +1870,7 @@ int Test_vStoreaHalf_private(cl_device_id device, f2h referenceFunc,
     } // for end lastcase
 
     loopCount = count == blockCount ? 1 : 100;
-    if (gReportTimes)
+    if (gReportTimes || benchmarks_requested())
     {
         // Init the input stream
         cl_float *p = (cl_float *)gIn_single;
@@ -1941,100 +1907,36 @@ int Test_vStoreaHalf_private(cl_device_id device, f2h referenceFunc,
         for (vectorSize = minVectorSize; vectorSize < kLastVectorSizeToTest;
              vectorSize++)
         {
-            uint64_t bestTime = -1ULL;
-            for (j = 0; j < loopCount; j++)
+            if ((error = TimeKernel(device, kernels[vectorSize][0],
+                                    gInBuffer_single, "vstorea_half", roundName,
+                                    vectorSize, count, aligned, loopCount,
+                                    stats[vectorSize])))
             {
-                uint64_t startTime = ReadTime();
-                if ((error = RunKernel(device, kernels[vectorSize][0],
-                                       gInBuffer_single, gOutBuffer_half,
-                                       numVecs(count, vectorSize, aligned),
-                                       runsOverBy(count, vectorSize, aligned))))
-                {
-                    gFailCount++;
-                    goto exit;
-                }
-
-                if ((error = clFinish(gQueue)))
-                {
-                    vlog_error("Failure in clFinish\n");
-                    gFailCount++;
-                    goto exit;
-                }
-                uint64_t currentTime = ReadTime() - startTime;
-                if (currentTime < bestTime) bestTime = currentTime;
-                time[vectorSize] += currentTime;
+                gFailCount++;
+                goto exit;
             }
-            if (bestTime < min_time[vectorSize])
-                min_time[vectorSize] = bestTime;
 
             if (gTestDouble)
             {
-                bestTime = -1ULL;
-                for (j = 0; j < loopCount; j++)
+                if ((error = TimeKernel(device, doubleKernels[vectorSize][0],
+                                        gInBuffer_double, "vstorea_half_double",
+                                        roundName, vectorSize, count, aligned,
+                                        loopCount, doubleStats[vectorSize])))
                 {
-                    uint64_t startTime = ReadTime();
-                    if ((error =
-                             RunKernel(device, doubleKernels[vectorSize][0],
-                                       gInBuffer_double, gOutBuffer_half,
-                                       numVecs(count, vectorSize, aligned),
-                                       runsOverBy(count, vectorSize, aligned))))
-                    {
-                        gFailCount++;
-                        goto exit;
-                    }
-
-                    if ((error = clFinish(gQueue)))
-                    {
-                        vlog_error("Failure in clFinish\n");
-                        gFailCount++;
-                        goto exit;
-                    }
-                    uint64_t currentTime = ReadTime() - startTime;
-                    if (currentTime < bestTime) bestTime = currentTime;
-                    doubleTime[vectorSize] += currentTime;
+                    gFailCount++;
+                    goto exit;
                 }
-                if (bestTime < min_double_time[vectorSize])
-                    min_double_time[vectorSize] = bestTime;
             }
         }
     }
 
     if (gReportTimes)
     {
-        for (vectorSize = minVectorSize; vectorSize < kLastVectorSizeToTest;
-             vectorSize++)
-            vlog_perf(SubtractTime(time[vectorSize], 0) * 1e6 * gDeviceFrequency
-                          * gComputeDevices / (double)(count * loopCount),
-                      0, "average us/elem",
-                      "vStoreaHalf%s avg. (%s vector size: %d)", roundName,
-                      addressSpaceNames[0], (g_arrVecSizes[vectorSize]));
-        for (vectorSize = minVectorSize; vectorSize < kLastVectorSizeToTest;
-             vectorSize++)
-            vlog_perf(SubtractTime(min_time[vectorSize], 0) * 1e6
-                          * gDeviceFrequency * gComputeDevices / (double)count,
-                      0, "best us/elem",
-                      "vStoreaHalf%s best (%s vector size: %d)", roundName,
-                      addressSpaceNames[0], (g_arrVecSizes[vectorSize]));
+        ReportKernelTimes("vStoreaHalf", roundName, "", "", minVectorSize,
+                          stats);
         if (gTestDouble)
-        {
-            for (vectorSize = minVectorSize; vectorSize < kLastVectorSizeToTest;
-                 vectorSize++)
-                vlog_perf(SubtractTime(doubleTime[vectorSize], 0) * 1e6
-                              * gDeviceFrequency * gComputeDevices
-                              / (double)(count * loopCount),
-                          0, "average us/elem (double)",
-                          "vStoreaHalf%s avg. d (%s vector size: %d)",
-                          roundName, addressSpaceNames[0],
-                          (g_arrVecSizes[vectorSize]));
-            for (vectorSize = minVectorSize; vectorSize < kLastVectorSizeToTest;
-                 vectorSize++)
-                vlog_perf(
-                    SubtractTime(min_double_time[vectorSize], 0) * 1e6
-                        * gDeviceFrequency * gComputeDevices / (double)count,
-                    0, "best us/elem (double)",
-                    "vStoreaHalf%s best d (%s vector size: %d)", roundName,
-                    addressSpaceNames[0], (g_arrVecSizes[vectorSize]));
-        }
+            ReportKernelTimes("vStoreaHalf", roundName, " d", " (double)",
+                              minVectorSize, doubleStats);
     }
 
 exit:
@@ -266,13 +266,15 @@ int test_read_image(cl_context context, cl_command_queue queue,
     clSamplerWrapper actualSampler;
     BufferOwningPtr<char> maxImageUseHostPtrBackingStore;
 
-    // Create offset data
-    BufferOwningPtr<cl_float> xOffsetValues(
-        malloc(sizeof(cl_float) * image_size));
-    BufferOwningPtr<cl_float> yOffsetValues(
-        malloc(sizeof(cl_float) * image_size));
-    BufferOwningPtr<cl_float> zOffsetValues(
-        malloc(sizeof(cl_float) * image_size));
+    // Create offset data, recycled across images by the host arena
+    size_t offsetValuesSize = sizeof(cl_float) * image_size;
+    BufferOwningPtr<cl_float> xOffsetValues, yOffsetValues, zOffsetValues;
+    xOffsetValues.reset(arena_alloc(offsetValuesSize, sizeof(cl_float)), NULL,
+                        0, offsetValuesSize, false, true);
+    yOffsetValues.reset(arena_alloc(offsetValuesSize, sizeof(cl_float)), NULL,
+                        0, offsetValuesSize, false, true);
+    zOffsetValues.reset(arena_alloc(offsetValuesSize, sizeof(cl_float)), NULL,
+                        0, offsetValuesSize, false, true);
 
     if (imageInfo->format->image_channel_data_type == CL_HALF_FLOAT)
         if (DetectFloatToHalfRoundingMode(queue)) return 1;
@@ -549,7 +551,9 @@ int test_read_image(cl_context context, cl_command_queue queue,
         test_assert_error(0 != image_lod_size, "Invalid image size");
         size_t resultValuesSize =
             image_lod_size * get_explicit_type_size(outputType) * 4;
-        BufferOwningPtr<char> resultValues(malloc(resultValuesSize));
+        BufferOwningPtr<char> resultValues;
+        resultValues.reset(arena_alloc(resultValuesSize, sizeof(cl_float4)),
+                           NULL, 0, resultValuesSize, false, true);
         float lod_float = (float)lod;
         if (gTestMipmaps)
         {
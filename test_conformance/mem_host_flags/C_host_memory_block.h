@@ -22,7 +22,17 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <type_traits>
+
+#include "harness/patternHelpers.h"
+
+// Host side copy of a buffer or image, used as the reference of the device
+// contents. Blocks are filled and compared with wide stores and compares,
+// which relies on T being an integer type without padding bits.
 template <class T> class C_host_memory_block {
+    static_assert(std::is_integral<T>::value,
+                  "blocks are compared bytewise");
+
 public:
     size_t num_elements;
     int element_size;
@@ -41,6 +51,9 @@ public:
                     size_t *region, size_t host_row_pitch,
                     size_t host_slice_pitch);
     bool Equal(T *pData, size_t num_elements);
+    // Compares count elements starting at offset with pIn_Data, which points
+    // to the same range of another copy, e.g. one chunk of a mapped buffer
+    bool Equal_range(T *pIn_Data, size_t offset, size_t count);
 
     bool Equal_rect_from_orig(C_host_memory_block<T> &another, size_t *soffset,
                               size_t *region, size_t host_row_pitch,
@@ -67,9 +80,8 @@ template <class T> void C_host_memory_block<T>::Init(size_t num_elem, T &value)
 {
     if (pData != NULL) delete[] pData;
     pData = new T[num_elem];
-    for (size_t i = 0; i < num_elem; i++) pData[i] = value;
-
     num_elements = num_elem;
+    Set_to(value);
 }
 
 template <class T> void C_host_memory_block<T>::Init(size_t num_elem)
@@ -82,38 +94,24 @@ template <class T> void C_host_memory_block<T>::Init(size_t num_elem)
 }
 template <class T> void C_host_memory_block<T>::Set_to_zero()
 {
-    T v = 0;
-    Set_to(v);
+    memset(pData, 0, num_elements * sizeof(T));
 }
 
 template <class T> void C_host_memory_block<T>::Set_to(T &val)
 {
-    for (size_t i = 0; i < num_elements; i++) pData[i] = val;
+    fill_pattern(pData, num_elements * sizeof(T), &val, sizeof(T));
 }
 
 template <class T> bool C_host_memory_block<T>::Equal_to(T &val)
 {
-    size_t count = 0;
-
-    for (size_t i = 0; i < num_elements; i++)
-    {
-        if (pData[i] == val) count++;
-    }
-
-    return (count == num_elements);
+    return verify_pattern(pData, num_elements * sizeof(T), &val, sizeof(T))
+        == PATTERN_MATCH;
 }
 
 template <class T>
 bool C_host_memory_block<T>::Equal(C_host_memory_block<T> &another)
 {
-    size_t count = 0;
-
-    for (size_t i = 0; i < num_elements; i++)
-    {
-        if (pData[i] == another.pData[i]) count++;
-    }
-
-    return (count == num_elements);
+    return Equal_range(another.pData, 0, num_elements);
 }
 
 template <class T>
@@ -121,23 +119,23 @@ bool C_host_memory_block<T>::Equal(T *pIn_Data, size_t Innum_elements)
 {
     if (this->num_elements != Innum_elements) return false;
 
-    size_t count = 0;
+    return Equal_range(pIn_Data, 0, num_elements);
+}
 
-    for (size_t i = 0; i < num_elements; i++)
-    {
-        if (pData[i] == pIn_Data[i]) count++;
-    }
+template <class T>
+bool C_host_memory_block<T>::Equal_range(T *pIn_Data, size_t offset,
+                                         size_t count)
+{
+    if (offset > num_elements || count > num_elements - offset) return false;
 
-    return (count == num_elements);
+    return memcmp(pData + offset, pIn_Data, count * sizeof(T)) == 0;
 }
 
 template <class T> size_t C_host_memory_block<T>::Count(T &val)
 {
+    // Branch free so that the compiler can vectorize it
     size_t count = 0;
-    for (size_t i = 0; i < num_elements; i++)
-    {
-        if (pData[i] == val) count++;
-    }
+    for (size_t i = 0; i < num_elements; i++) count += pData[i] == val;
 
     return count;
 }
@@ -151,22 +149,17 @@ bool C_host_memory_block<T>::Equal_rect(C_host_memory_block<T> &another,
     size_t row_pitch = host_row_pitch ? host_row_pitch : region[0];
     size_t slice_pitch = host_slice_pitch ? host_row_pitch : region[1];
 
-    size_t count = 0;
-
-    size_t total = region[0] * region[1] * region[2];
-
-    size_t x, y, z;
-    size_t orig = (size_t)(soffset[0] + row_pitch * soffset[1]
-                           + slice_pitch * soffset[2]);
-    for (z = 0; z < region[2]; z++)
-        for (y = 0; y < region[1]; y++)
-            for (x = 0; x < region[0]; x++)
-            {
-                int p1 = (int)(x + row_pitch * y + slice_pitch * z + orig);
-                if (pData[p1] == another.pData[p1]) count++;
-            }
-
-    return (count == total);
+    size_t orig =
+        soffset[0] + row_pitch * soffset[1] + slice_pitch * soffset[2];
+    for (size_t z = 0; z < region[2]; z++)
+        for (size_t y = 0; y < region[1]; y++)
+        {
+            size_t p1 = row_pitch * y + slice_pitch * z + orig;
+            if (memcmp(pData + p1, another.pData + p1, region[0] * sizeof(T)))
+                return false;
+        }
+
+    return true;
 }
 
 template <class T>
@@ -174,26 +167,8 @@ bool C_host_memory_block<T>::Equal_rect_from_orig(
     C_host_memory_block<T> &another, size_t *soffset, size_t *region,
     size_t host_row_pitch, size_t host_slice_pitch)
 {
-    size_t row_pitch = host_row_pitch ? host_row_pitch : region[0];
-    size_t slice_pitch = host_slice_pitch ? host_row_pitch : region[1];
-
-    size_t count = 0;
-
-    size_t total = region[0] * region[1] * region[2];
-
-    size_t x, y, z;
-    size_t orig =
-        soffset[0] + row_pitch * soffset[1] + slice_pitch * soffset[2];
-    for (z = 0; z < region[2]; z++)
-        for (y = 0; y < region[1]; y++)
-            for (x = 0; x < region[0]; x++)
-            {
-                size_t p1 = x + (row_pitch * y) + (slice_pitch * z);
-                size_t p2 = p1 + orig;
-                if (pData[p2] == another.pData[p1]) count++;
-            }
-
-    return (count == total);
+    return Equal_rect_from_orig(another.pData, soffset, region, host_row_pitch,
+                                host_slice_pitch);
 }
 
 template <class T>
@@ -206,23 +181,18 @@ bool C_host_memory_block<T>::Equal_rect_from_orig(T *another_pdata,
     size_t row_pitch = host_row_pitch ? host_row_pitch : region[0];
     size_t slice_pitch = host_slice_pitch ? host_row_pitch : region[1];
 
-    size_t count = 0;
-
-    size_t total = region[0] * region[1] * region[2];
-
-    size_t x, y, z;
     size_t orig =
         soffset[0] + row_pitch * soffset[1] + slice_pitch * soffset[2];
-    for (z = 0; z < region[2]; z++)
-        for (y = 0; y < region[1]; y++)
-            for (x = 0; x < region[0]; x++)
-            {
-                size_t p1 = x + (row_pitch * y) + (slice_pitch * z);
-                size_t p2 = p1 + orig;
-                if (pData[p2] == another_pdata[p1]) count++;
-            }
-
-    return (count == total);
+    for (size_t z = 0; z < region[2]; z++)
+        for (size_t y = 0; y < region[1]; y++)
+        {
+            size_t p1 = (row_pitch * y) + (slice_pitch * z);
+            size_t p2 = p1 + orig;
+            if (memcmp(pData + p2, another_pdata + p1, region[0] * sizeof(T)))
+                return false;
+        }
+
+    return true;
 }
 
 #endif
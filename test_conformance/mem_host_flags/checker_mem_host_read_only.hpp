@@ -18,6 +18,9 @@
 
 #include "checker.h"
 
+#include <algorithm>
+#include <vector>
+
 template <class T>
 class cBuffer_check_mem_host_read_only : public cBuffer_checker<T> {
 public:
@@ -36,8 +39,13 @@ public:
     cl_int verify_RW_Buffer();
     cl_int verify_RW_Buffer_rect();
     cl_int verify_RW_Buffer_mapping();
+    cl_int verify_RW_Buffer_mapping_chunked();
 };
 
+// Number of sub-ranges the buffer is mapped in by
+// verify_RW_Buffer_mapping_chunked()
+#define MAP_CHUNK_COUNT 8
+
 template <class T> cl_int cBuffer_check_mem_host_read_only<T>::SetupBuffer()
 {
     this->m_buffer_type = _BUFFER;
@@ -267,6 +275,9 @@ cl_int cBuffer_check_mem_host_read_only<T>::verify_RW_Buffer_mapping()
                                   nullptr, nullptr);
     test_error(err, "clEnqueueUnmapMemObject error");
 
+    err = verify_RW_Buffer_mapping_chunked();
+    if (err != CL_SUCCESS) return err;
+
     //  test blocking map read
     clEnqueueMapBuffer(this->m_queue, this->m_buffer, this->m_blocking,
                        CL_MAP_WRITE, 0, this->get_block_size_bytes(), 0, NULL,
@@ -289,4 +300,80 @@ cl_int cBuffer_check_mem_host_read_only<T>::verify_RW_Buffer_mapping()
     return err;
 }
 
+// Maps the buffer in MAP_CHUNK_COUNT sub-ranges, all enqueued up front, and
+// checks each one as soon as its map completes, while the following ones are
+// still in flight.
+template <class T>
+cl_int cBuffer_check_mem_host_read_only<T>::verify_RW_Buffer_mapping_chunked()
+{
+    if (this->m_nNumber_elements == 0) return CL_SUCCESS;
+
+    size_t chunk_elements =
+        (this->m_nNumber_elements + MAP_CHUNK_COUNT - 1) / MAP_CHUNK_COUNT;
+    size_t chunk_count =
+        (this->m_nNumber_elements + chunk_elements - 1) / chunk_elements;
+
+    std::vector<clEventWrapper> events(chunk_count);
+    std::vector<void *> chunks(chunk_count, nullptr);
+    cl_int err = CL_SUCCESS;
+    for (size_t i = 0; i < chunk_count && err == CL_SUCCESS; i++)
+    {
+        size_t offset = i * chunk_elements;
+        size_t count = std::min(chunk_elements,
+                                this->m_nNumber_elements - offset);
+        chunks[i] = clEnqueueMapBuffer(
+            this->m_queue, this->m_buffer, CL_FALSE, CL_MAP_READ,
+            offset * sizeof(T), count * sizeof(T), 0, NULL, &events[i], &err);
+        if (err != CL_SUCCESS) print_error(err, "clEnqueueMapBuffer error");
+    }
+    if (err == CL_SUCCESS)
+    {
+        err = clFlush(this->m_queue);
+        if (err != CL_SUCCESS) print_error(err, "clFlush error");
+    }
+
+    cl_int result = err;
+    for (size_t i = 0; i < chunk_count && result == CL_SUCCESS; i++)
+    {
+        result = clWaitForEvents(1, &events[i]);
+        if (result != CL_SUCCESS)
+        {
+            print_error(result, "clWaitForEvents error");
+            break;
+        }
+
+        size_t offset = i * chunk_elements;
+        size_t count = std::min(chunk_elements,
+                                this->m_nNumber_elements - offset);
+        if (!this->host_m_1.Equal_range((T *)chunks[i], offset, count))
+        {
+            log_error("Buffer content difference found in the mapped range "
+                      "[%zu, %zu)\n",
+                      offset, offset + count);
+            result = FAILURE;
+        }
+    }
+
+    // Unmap whatever was mapped, also after a failure
+    for (size_t i = 0; i < chunk_count; i++)
+    {
+        if (chunks[i] == nullptr) continue;
+        err = clEnqueueUnmapMemObject(this->m_queue, this->m_buffer, chunks[i],
+                                      0, nullptr, nullptr);
+        if (err != CL_SUCCESS && result == CL_SUCCESS)
+        {
+            print_error(err, "clEnqueueUnmapMemObject error");
+            result = err;
+        }
+    }
+    err = clFinish(this->m_queue);
+    if (err != CL_SUCCESS && result == CL_SUCCESS)
+    {
+        print_error(err, "clFinish error");
+        result = err;
+    }
+
+    return result;
+}
+
 #endif
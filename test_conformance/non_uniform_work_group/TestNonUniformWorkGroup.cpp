@@ -248,7 +248,8 @@ TestNonUniformWorkGroup::TestNonUniformWorkGroup(
     const cl_command_queue &queue, const cl_uint dims, size_t *globalSize,
     const size_t *localSize, const size_t *buffersSize,
     const size_t *globalWorkOffset, const size_t *reqdWorkGroupSize)
-    : _device(device), _context(context), _queue(queue), _dims(dims)
+    : _device(device), _context(context), _queue(queue), _dims(dims),
+      _programCache(nullptr)
 {
 
     if (globalSize == NULL || dims < 1 || dims > 3)
@@ -402,47 +403,43 @@ void TestNonUniformWorkGroup::setGlobalWorkgroupSize (const size_t *globalSize)
    }
 }
 
-void TestNonUniformWorkGroup::verifyData (DataContainerAttrib * reference, DataContainerAttrib * results, short regionNumber) {
-
+static std::string regionLocation (short regionNumber, int dim = -1) {
   std::ostringstream tmp;
-  std::string errorLocation;
+  tmp << "region number: " << regionNumber;
+  if (dim >= 0)
+    tmp << " for dim: " << dim;
+  return tmp.str();
+}
+
+void TestNonUniformWorkGroup::verifyData (DataContainerAttrib * reference, DataContainerAttrib * results, short regionNumber) {
 
   if (_testRange & Range::BASIC) {
     for (unsigned short i = 0; i < MAX_DIMS; i++) {
-      tmp.str("");
-      tmp.clear();
-      tmp << "region number: " << regionNumber << " for dim: " << i;
-      errorLocation = tmp.str();
-
       if (results->get_global_size[i] != reference->get_global_size[i]) {
-        _err.show(Error::ERR_GLOBAL_SIZE, errorLocation, results->get_global_size[i], reference->get_global_size[i]);
+        _err.show(Error::ERR_GLOBAL_SIZE, regionLocation(regionNumber, i), results->get_global_size[i], reference->get_global_size[i]);
       }
 
       if (results->get_global_offset[i] != reference->get_global_offset[i]) {
-        _err.show(Error::ERR_GLOBAL_WORK_OFFSET, errorLocation, results->get_global_offset[i], reference->get_global_offset[i]);
+        _err.show(Error::ERR_GLOBAL_WORK_OFFSET, regionLocation(regionNumber, i), results->get_global_offset[i], reference->get_global_offset[i]);
       }
 
       if (results->get_local_size[i] != reference->get_local_size[i] || results->get_local_size[i] > _maxWorkItemSizes[i]) {
-        _err.show(Error::ERR_LOCAL_SIZE, errorLocation, results->get_local_size[i], reference->get_local_size[i]);
+        _err.show(Error::ERR_LOCAL_SIZE, regionLocation(regionNumber, i), results->get_local_size[i], reference->get_local_size[i]);
       }
 
       if (results->get_enqueued_local_size[i] != reference->get_enqueued_local_size[i] || results->get_enqueued_local_size[i] > _maxWorkItemSizes[i]) {
-        _err.show(Error::ERR_ENQUEUED_LOCAL_SIZE, errorLocation, results->get_enqueued_local_size[i], reference->get_enqueued_local_size[i]);
+        _err.show(Error::ERR_ENQUEUED_LOCAL_SIZE, regionLocation(regionNumber, i), results->get_enqueued_local_size[i], reference->get_enqueued_local_size[i]);
       }
 
       if (results->get_num_groups[i] != reference->get_num_groups[i]) {
-        _err.show(Error::ERR_NUM_GROUPS, errorLocation, results->get_num_groups[i], reference->get_num_groups[i]);
+        _err.show(Error::ERR_NUM_GROUPS, regionLocation(regionNumber, i), results->get_num_groups[i], reference->get_num_groups[i]);
       }
     }
   }
 
-  tmp.str("");
-  tmp.clear();
-  tmp << "region number: " << regionNumber;
-  errorLocation = tmp.str();
   if (_testRange & Range::BASIC) {
     if (results->get_work_dim != reference->get_work_dim) {
-      _err.show(Error::ERR_WORK_DIM, errorLocation, results->get_work_dim, reference->get_work_dim);
+      _err.show(Error::ERR_WORK_DIM, regionLocation(regionNumber), results->get_work_dim, reference->get_work_dim);
     }
   }
 }
@@ -557,6 +554,13 @@ int TestNonUniformWorkGroup::prepareDevice () {
   if (_testRange & Range::BARRIERS)
     buildOptions += " -D TESTBARRIERS";
 
+  if (_programCache && _programCache->count(buildOptions)) {
+    _program = (*_programCache)[buildOptions];
+    _testKernel = clCreateKernel(_program, "testKernel", &err);
+    test_error(err, "clCreateKernel failed");
+    return 0;
+  }
+
   err = create_single_kernel_helper_with_build_options (_context, &_program, &_testKernel, 1,
     &KERNEL_FUNCTION, "testKernel", buildOptions.c_str());
   if (err)
@@ -565,6 +569,9 @@ int TestNonUniformWorkGroup::prepareDevice () {
     return -1;
   }
 
+  if (_programCache)
+    (*_programCache)[buildOptions] = _program;
+
   return 0;
 }
 
@@ -713,19 +720,23 @@ size_t TestNonUniformWorkGroup::adjustGlobalBufferSize(size_t globalBufferSize)
 }
 
 int TestNonUniformWorkGroup::runKernel () {
-  int err;
+  int err = enqueueKernel();
+  if (err)
+    return err;
+  return collectResults();
+}
 
-  // TEST INFO
-  showTestInfo();
+int TestNonUniformWorkGroup::enqueueKernel () {
+  int err;
 
   size_t localArraySize = (_localSize_IsNull)?TestNonUniformWorkGroup::getMaxLocalWorkgroupSize(_device):(_enqueuedLocalSize[0]*_enqueuedLocalSize[1]*_enqueuedLocalSize[2]);
-  clMemWrapper resultsRegionArray = clCreateBuffer(_context, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, _resultsRegionArray.size() * sizeof(DataContainerAttrib), &_resultsRegionArray.front(), &err);
+  _resultsBuffer = clCreateBuffer(_context, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, _resultsRegionArray.size() * sizeof(DataContainerAttrib), &_resultsRegionArray.front(), &err);
   test_error(err, "clCreateBuffer failed");
 
   size_t *localSizePtr = (_localSize_IsNull)?NULL:_enqueuedLocalSize;
   size_t *globalWorkOffsetPtr = (_globalWorkOffset_IsNull)?NULL:_globalWorkOffset;
 
-  err = clSetKernelArg(_testKernel, 0, sizeof(resultsRegionArray), &resultsRegionArray);
+  err = clSetKernelArg(_testKernel, 0, sizeof(_resultsBuffer), &_resultsBuffer);
   test_error(err, "clSetKernelArg failed");
 
   //creating local buffer
@@ -734,52 +745,87 @@ int TestNonUniformWorkGroup::runKernel () {
   test_error(err, "clSetKernelArg failed");
 
   size_t globalBufferSize = adjustGlobalBufferSize(_numOfGlobalWorkItems*sizeof(cl_uint));
-  clMemWrapper testGlobalArray = clCreateBuffer(_context, CL_MEM_READ_WRITE, globalBufferSize, NULL, &err);
+  _testGlobalBuffer = clCreateBuffer(_context, CL_MEM_READ_WRITE, globalBufferSize, NULL, &err);
   test_error(err, "clCreateBuffer failed");
 
-  err = clSetKernelArg(_testKernel, 2, sizeof(testGlobalArray), &testGlobalArray);
+  err = clSetKernelArg(_testKernel, 2, sizeof(_testGlobalBuffer), &_testGlobalBuffer);
   test_error(err, "clSetKernelArg failed");
 
   _globalAtomicTestValue = 0;
-  clMemWrapper globalAtomicTestVariable = clCreateBuffer(_context, (CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR), sizeof(_globalAtomicTestValue), &_globalAtomicTestValue, &err);
+  _globalAtomicBuffer = clCreateBuffer(_context, (CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR), sizeof(_globalAtomicTestValue), &_globalAtomicTestValue, &err);
   test_error(err, "clCreateBuffer failed");
 
-  err = clSetKernelArg(_testKernel, 3, sizeof(globalAtomicTestVariable), &globalAtomicTestVariable);
+  err = clSetKernelArg(_testKernel, 3, sizeof(_globalAtomicBuffer), &_globalAtomicBuffer);
   test_error(err, "clSetKernelArg failed");
 
-  clMemWrapper errorArray = clCreateBuffer(_context, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, _err.errorArrayCounterSize(), _err.errorArrayCounter(), &err);
+  _errorBuffer = clCreateBuffer(_context, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, _err.errorArrayCounterSize(), _err.errorArrayCounter(), &err);
   test_error(err, "clCreateBuffer failed");
 
-  err = clSetKernelArg(_testKernel, 4, sizeof(errorArray), &errorArray);
+  err = clSetKernelArg(_testKernel, 4, sizeof(_errorBuffer), &_errorBuffer);
   test_error(err, "clSetKernelArg failed");
 
   err = clEnqueueNDRangeKernel(_queue, _testKernel, _dims, globalWorkOffsetPtr, _globalSize,
     localSizePtr, 0, NULL, NULL);
   test_error(err, "clEnqueueNDRangeKernel failed");
 
-
-  err = clFinish(_queue);
-  test_error(err, "clFinish failed");
-
-  err = clEnqueueReadBuffer(_queue, globalAtomicTestVariable, CL_TRUE, 0, sizeof(unsigned int), &_globalAtomicTestValue, 0, NULL, NULL);
+  // The queue is in order, so the last read completing means all of them did
+  err = clEnqueueReadBuffer(_queue, _globalAtomicBuffer, CL_FALSE, 0, sizeof(unsigned int), &_globalAtomicTestValue, 0, NULL, NULL);
   test_error(err, "clEnqueueReadBuffer failed");
 
-  if (_err.checkError()) {
-    return -1;
-  }
-
   // synchronization of main buffer
-  err = clEnqueueReadBuffer(_queue, resultsRegionArray, CL_TRUE, 0, _resultsRegionArray.size() * sizeof(DataContainerAttrib), &_resultsRegionArray.front(), 0, NULL, NULL);
+  err = clEnqueueReadBuffer(_queue, _resultsBuffer, CL_FALSE, 0, _resultsRegionArray.size() * sizeof(DataContainerAttrib), &_resultsRegionArray.front(), 0, NULL, NULL);
   test_error(err, "clEnqueueReadBuffer failed");
 
-  err = clEnqueueReadBuffer(_queue, errorArray, CL_TRUE, 0, _err.errorArrayCounterSize(), _err.errorArrayCounter(), 0, NULL, NULL);
+  err = clEnqueueReadBuffer(_queue, _errorBuffer, CL_FALSE, 0, _err.errorArrayCounterSize(), _err.errorArrayCounter(), 0, NULL, &_readEvent);
   test_error(err, "clEnqueueReadBuffer failed");
+
+  err = clFlush(_queue);
+  test_error(err, "clFlush failed");
+
+  return 0;
+}
+
+int TestNonUniformWorkGroup::collectResults () {
+  // TEST INFO
+  showTestInfo();
+
+  int err = clWaitForEvents(1, &_readEvent);
+  test_error(err, "clWaitForEvents failed");
+
   // Synchronization of errors occurred in kernel into general error stats
   _err.synchronizeStatsMap();
 
   return 0;
 }
 
+SubTestExecutor::SubTestExecutor(const cl_device_id &device,
+                                 const cl_context &context,
+                                 const cl_command_queue &queue)
+    : _device(device), _context(context), _queue(queue), _failCounter(0),
+      _overallCounter(0)
+{
+    // Without queues of its own the executor still keeps several sub-tests
+    // in flight on the harness queue
+    for (int i = 0; i < MAX_SUBTESTS_IN_FLIGHT; i++)
+    {
+        cl_int err;
+        clCommandQueueWrapper q = clCreateCommandQueue(context, device, 0, &err);
+        if (err != CL_SUCCESS)
+        {
+            print_error(err, "Unable to create a sub-test queue");
+            break;
+        }
+        _queues.push_back(std::move(q));
+    }
+}
+
+SubTestExecutor::~SubTestExecutor()
+{
+    // Sub-tests can still be in flight when a test function returns early
+    for (clCommandQueueWrapper &q : _queues) clFinish(q);
+    clFinish(_queue);
+}
+
 void SubTestExecutor::runTestNonUniformWorkGroup(const cl_uint dims,
                                                  size_t *globalSize,
                                                  const size_t *localSize,
@@ -792,16 +838,18 @@ void SubTestExecutor::runTestNonUniformWorkGroup(
     const cl_uint dims, size_t *globalSize, const size_t *localSize,
     const size_t *globalWorkOffset, const size_t *reqdWorkGroupSize, int range)
 {
-
-
     int err;
+    cl_command_queue queue = _queues.empty()
+        ? _queue
+        : _queues[_overallCounter % _queues.size()].operator cl_command_queue();
     ++_overallCounter;
-    TestNonUniformWorkGroup test(_device, _context, _queue, dims, globalSize,
-                                 localSize, NULL, globalWorkOffset,
-                                 reqdWorkGroupSize);
+    std::unique_ptr<TestNonUniformWorkGroup> test(new TestNonUniformWorkGroup(
+        _device, _context, queue, dims, globalSize, localSize, NULL,
+        globalWorkOffset, reqdWorkGroupSize));
 
-    test.setTestRange(range);
-    err = test.prepareDevice();
+    test->setTestRange(range);
+    test->setProgramCache(&_programs);
+    err = test->prepareDevice();
     if (err)
     {
         log_error("Error: prepare device\n");
@@ -809,7 +857,25 @@ void SubTestExecutor::runTestNonUniformWorkGroup(
         return;
     }
 
-    err = test.runKernel();
+    err = test->enqueueKernel();
+    if (err)
+    {
+        log_error("Error: run kernel\n");
+        ++_failCounter;
+        return;
+    }
+
+    _inFlight.push_back(std::move(test));
+    if (_inFlight.size() >= MAX_SUBTESTS_IN_FLIGHT) completeOldestSubTest();
+}
+
+void SubTestExecutor::completeOldestSubTest()
+{
+    std::unique_ptr<TestNonUniformWorkGroup> test =
+        std::move(_inFlight.front());
+    _inFlight.pop_front();
+
+    int err = test->collectResults();
     if (err)
     {
         log_error("Error: run kernel\n");
@@ -817,7 +883,7 @@ void SubTestExecutor::runTestNonUniformWorkGroup(
         return;
     }
 
-    err = test.verifyResults();
+    err = test->verifyResults();
     if (err)
     {
         log_error("Error: verify results\n");
@@ -858,6 +924,9 @@ int SubTestExecutor::calculateWorkGroupSize(size_t &maxWgSize, int testRange) {
 
 int SubTestExecutor::status() {
 
+  while (!_inFlight.empty())
+    completeOldestSubTest();
+
   if (_failCounter>0) {
     log_error ("%d subtest(s) (of %d) failed\n", _failCounter, _overallCounter);
     return -1;
@@ -20,6 +20,10 @@
 #include <vector>
 #include "tools.h"
 #include <algorithm>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
 
 #define MAX_SIZE_OF_ALLOCATED_MEMORY (400*1024*1024)
 
@@ -57,6 +61,10 @@ namespace Range {
 
 std::string showArray (const size_t *arr, cl_uint dims);
 
+// Programs built for the test kernel, keyed by build options. Sub-tests with
+// the same range and reqd_work_group_size share one build.
+typedef std::map<std::string, clProgramWrapper> ProgramCache;
+
 // Main class responsible for testing
 class TestNonUniformWorkGroup {
 public:
@@ -78,9 +86,14 @@ public:
   static void enableStrictMode (bool state);
 
   void setTestRange (int range) {_testRange = range;}
+  void setProgramCache (ProgramCache *cache) {_programCache = cache;}
   int prepareDevice ();
   int verifyResults ();
   int runKernel ();
+  // runKernel() in two steps: enqueueKernel() only flushes the kernel and
+  // the reads of its results, collectResults() waits for them
+  int enqueueKernel ();
+  int collectResults ();
 
 private:
   size_t _globalSize[MAX_DIMS];
@@ -106,6 +119,14 @@ private:
 
   clProgramWrapper _program;
   clKernelWrapper _testKernel;
+  ProgramCache *_programCache;
+
+  // Buffers and the last read of the kernel in flight
+  clMemWrapper _resultsBuffer;
+  clMemWrapper _testGlobalBuffer;
+  clMemWrapper _globalAtomicBuffer;
+  clMemWrapper _errorBuffer;
+  clEventWrapper _readEvent;
 
   Error::ErrorClass _err;
 
@@ -121,11 +142,16 @@ private:
   size_t adjustGlobalBufferSize(size_t globalBufferSize);
 };
 
-// Class responsible for running subtest scenarios in test function
+// Class responsible for running subtest scenarios in test function.
+// Sub-tests are enqueued round-robin on several queues, and each one is
+// verified once MAX_SUBTESTS_IN_FLIGHT later ones have been enqueued, so the
+// device is kept busy while the host prepares and checks the others.
+#define MAX_SUBTESTS_IN_FLIGHT 4
+
 class SubTestExecutor {
 public:
-  SubTestExecutor(const cl_device_id &device, const cl_context &context, const cl_command_queue &queue)
-    : _device (device), _context (context), _queue (queue), _failCounter (0), _overallCounter (0) {}
+  SubTestExecutor(const cl_device_id &device, const cl_context &context, const cl_command_queue &queue);
+  ~SubTestExecutor();
 
   void runTestNonUniformWorkGroup(const cl_uint dims, size_t *globalSize,
                                   const size_t *localSize, int range);
@@ -140,11 +166,16 @@ public:
 
 private:
   SubTestExecutor();
+  void completeOldestSubTest();
+
   const cl_device_id _device;
   const cl_context _context;
   const cl_command_queue _queue;
   unsigned int _failCounter;
   unsigned int _overallCounter;
+  std::vector<clCommandQueueWrapper> _queues;
+  std::deque<std::unique_ptr<TestNonUniformWorkGroup>> _inFlight;
+  ProgramCache _programs;
 };
 
 #endif // TESTNONUNIFORMWORKGROUP_H
@@ -14,6 +14,7 @@
 // limitations under the License.
 //
 #include "tools.h"
+#include <algorithm>
 #include <sstream>
 #include "harness/errorHelpers.h"
 
@@ -23,25 +24,13 @@ void PrimeNumbers::generatePrimeNumbers (unsigned int maxValue) {
 
   primeNumbers.clear();
 
-  for (unsigned int i=2; i < maxValue; i++)
+  std::vector<bool> composite(maxValue, false);
+  for (unsigned int i = 2; i < maxValue; i++) {
+    if (composite[i])
+      continue;
     primeNumbers.push_back(i);
-
-  PrimeNumbersCollection::iterator it, it2;
-  it = primeNumbers.begin();
-  it2 = primeNumbers.begin();
-
-  unsigned int maxValueSqrt = (unsigned int)sqrt((double)maxValue);
-
-  for (; it != primeNumbers.end(); it++) {
-    it2 = it;
-    ++it2;
-    if(*it>maxValueSqrt)
-      break;
-    for (;it2 != primeNumbers.end();)
-      if (*it2 % *it == 0)
-        it2 = primeNumbers.erase(it2);
-      else
-        ++it2;
+    for (size_t multiple = (size_t)i * i; multiple < maxValue; multiple += i)
+      composite[multiple] = true;
   }
 }
 
@@ -50,36 +39,27 @@ int PrimeNumbers::getPrimeNumberInRange (size_t lowerValue, size_t higherValue)
   if(lowerValue >= higherValue)
     return -1;
 
-  if(primeNumbers.back() < lowerValue)
+  if(primeNumbers.empty() || primeNumbers.back() < lowerValue)
     return -2;
 
-  PrimeNumbersCollection::iterator it = primeNumbers.begin();
+  // The collection is sorted, the first prime above lowerValue is found by
+  // binary search
+  PrimeNumbersCollection::iterator it =
+    std::upper_bound(primeNumbers.begin(), primeNumbers.end(), lowerValue);
+  if (it == primeNumbers.end())
+    return -1;
 
-  for (; it != primeNumbers.end(); ++it) {
-    if (lowerValue<*it) {
-      if(higherValue>*it)
-        return *it;
-      else
-        return -3;
-    }
-  }
-  return -1;
+  if (higherValue > *it)
+    return *it;
+  return -3;
 }
 
 
 int PrimeNumbers::getNextLowerPrimeNumber(size_t upperValue) {
-    size_t retVal = 1;
-
-    PrimeNumbersCollection::iterator it = primeNumbers.begin();
-
-    for (; it != primeNumbers.end(); ++it) {
-        if (upperValue > *it) {
-            retVal = *it;
-        } else {
-            break;
-        }
-    }
-    return retVal;
+    PrimeNumbersCollection::iterator it =
+        std::lower_bound(primeNumbers.begin(), primeNumbers.end(), upperValue);
+    if (it == primeNumbers.begin()) return 1;
+    return *(it - 1);
 }
 
 PrimeNumbers::Result1d PrimeNumbers::fitMaxPrime1d(size_t val1, size_t maxVal){
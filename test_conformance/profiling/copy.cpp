@@ -95,7 +95,7 @@ static cl_uchar *generate_image( int n, MTdata d )
 }
 
 
-static int copy_size( cl_device_id device, cl_context context, cl_command_queue queue, int num_elements, MTdata d )
+static int copy_size( cl_device_id device, cl_context context, cl_command_queue queue, int num_elements, MTdata d, bool latency )
 {
     cl_mem                streams[2];
     cl_event            copyEvent;
@@ -225,6 +225,16 @@ static int copy_size( cl_device_id device, cl_context context, cl_command_queue
         err = 0;
     }
 
+    if (latency)
+    {
+        auto enqueue = [&](cl_event *event) {
+            return clEnqueueCopyBuffer(queue, streams[0], streams[1], 0, 0,
+                                       sizeof(cl_int) * num_elements, 0, NULL,
+                                       event);
+        };
+        if (measure_latency("copy_array", enqueue)) err = -1;
+    }
+
     // cleanup
     clReleaseEvent(copyEvent);
     clReleaseMemObject( streams[0] );
@@ -389,13 +399,13 @@ int test_copy_array( cl_device_id device, cl_context context, cl_command_queue q
 
     // test the preset size
     log_info( "set size: %d: ", num_elements );
-    err = copy_size( device, context, queue, num_elements, d );
+    err = copy_size( device, context, queue, num_elements, d, true );
 
     // now test random sizes
     for( i = 0; i < 8; i++ ){
         size = (int)get_random_float(2.f,131072.f, d);
         log_info( "random size: %d: ", size );
-        err |= copy_size( device, context, queue, size, d );
+        err |= copy_size( device, context, queue, size, d, false );
     }
 
     free_mtdata(d);
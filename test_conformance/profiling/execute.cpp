@@ -327,6 +327,12 @@ static int kernelFilter( cl_device_id device, cl_context context, cl_command_que
         return -1;
     }
 
+    auto enqueue = [&](cl_event *event) {
+        return clEnqueueNDRangeKernel(queue, kernel[0], 2, NULL, threads, NULL,
+                                      0, NULL, event);
+    };
+    if (measure_latency("execute", enqueue)) err = -1;
+
     // release event, kernel, program, and memory objects
   clReleaseEvent( executeEvent );
     clReleaseKernel( kernel[0] );
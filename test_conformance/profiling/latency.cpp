@@ -0,0 +1,130 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "latency.h"
+
+#include <algorithm>
+
+unsigned gLatencyCommands = 0;
+
+namespace {
+
+// Commands in flight before waiting for them
+const unsigned kLatencyBatchSize = 256;
+
+void release_events(std::vector<cl_event> &events)
+{
+    for (cl_event event : events) clReleaseEvent(event);
+    events.clear();
+}
+
+void report_row(const char *name, const LatencyHistogram &h)
+{
+    // Timestamps are in nanoseconds, report microseconds
+    const double us = 1e-3;
+    cl_ulong p50 = h.percentile(50.0);
+    cl_ulong p99 = h.percentile(99.0);
+    log_info("  %-16s %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f\n",
+             name, h.min() * us, p50 * us, h.percentile(90.0) * us,
+             p99 * us, h.percentile(99.9) * us, h.max() * us,
+             (p99 - p50) * us);
+}
+
+} // namespace
+
+int measure_latency(const char *path, LatencyEnqueueFn enqueue)
+{
+    if (gLatencyCommands == 0) return 0;
+
+    static const cl_profiling_info params[] = {
+        CL_PROFILING_COMMAND_QUEUED, CL_PROFILING_COMMAND_SUBMIT,
+        CL_PROFILING_COMMAND_START, CL_PROFILING_COMMAND_END
+    };
+    static const char *phase_names[] = { "queue to submit", "submit to start",
+                                         "start to end" };
+    LatencyHistogram phases[3];
+    size_t out_of_order = 0;
+
+    std::vector<cl_event> events;
+    events.reserve(kLatencyBatchSize);
+    for (unsigned submitted = 0; submitted < gLatencyCommands;)
+    {
+        unsigned batch =
+            std::min(kLatencyBatchSize, gLatencyCommands - submitted);
+        for (unsigned i = 0; i < batch; i++)
+        {
+            cl_event event = nullptr;
+            cl_int error = enqueue(&event);
+            if (error != CL_SUCCESS)
+            {
+                print_error(error, "Unable to enqueue command");
+                release_events(events);
+                return -1;
+            }
+            events.push_back(event);
+        }
+
+        cl_int error = clWaitForEvents((cl_uint)events.size(), events.data());
+        if (error != CL_SUCCESS)
+        {
+            print_error(error, "clWaitForEvents failed");
+            release_events(events);
+            return -1;
+        }
+
+        for (cl_event event : events)
+        {
+            cl_ulong times[4];
+            for (int t = 0; t < 4; t++)
+            {
+                error = clGetEventProfilingInfo(event, params[t],
+                                                sizeof(times[t]), &times[t],
+                                                nullptr);
+                if (error != CL_SUCCESS)
+                {
+                    print_error(error, "clGetEventProfilingInfo failed");
+                    release_events(events);
+                    return -1;
+                }
+            }
+            if (times[0] > times[1] || times[1] > times[2]
+                || times[2] > times[3])
+            {
+                out_of_order++;
+                continue;
+            }
+            for (int phase = 0; phase < 3; phase++)
+                phases[phase].record(times[phase + 1] - times[phase]);
+        }
+        release_events(events);
+        submitted += batch;
+    }
+
+    log_info("%s: latency of %u commands in batches of %u (us)\n", path,
+             gLatencyCommands, kLatencyBatchSize);
+    log_info("  %-16s %10s %10s %10s %10s %10s %10s %10s\n", "", "min", "p50",
+             "p90", "p99", "p99.9", "max", "jitter");
+    for (int phase = 0; phase < 3; phase++)
+        report_row(phase_names[phase], phases[phase]);
+
+    if (out_of_order)
+    {
+        log_error("%s: %zu of %u commands have out of order profiling "
+                  "timestamps\n",
+                  path, out_of_order, gLatencyCommands);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,38 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef PROFILING_LATENCY_H
+#define PROFILING_LATENCY_H
+
+#include "harness/errorHelpers.h"
+#include "harness/latencyHistogram.h"
+
+#include <functional>
+
+// Number of commands submitted per driver path in repeated-submission mode,
+// set with --latency <commands>. The mode is disabled when 0.
+extern unsigned gLatencyCommands;
+
+// Enqueues one command and returns its event
+typedef std::function<cl_int(cl_event *)> LatencyEnqueueFn;
+
+// Submits gLatencyCommands commands in batches, so the queue is under load,
+// and reports histograms of their queue-to-submit, submit-to-start and
+// start-to-end times. The median is the stable overhead of the path and the
+// distance from the median to the 99th percentile its jitter.
+// Returns 0 when the mode is disabled or all timestamps were consistent.
+int measure_latency(const char *path, LatencyEnqueueFn enqueue);
+
+#endif // PROFILING_LATENCY_H
@@ -18,6 +18,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <cinttypes>
+#include <cstdlib>
+#include <vector>
 #include "procs.h"
 #include "harness/testHarness.h"
 
@@ -132,7 +134,30 @@ int check_times(cl_ulong queueStart, cl_ulong commandSubmit, cl_ulong commandSta
 
 int main( int argc, const char *argv[] )
 {
-    return runTestHarness(argc, argv, test_num, test_list, false,
-                          CL_QUEUE_PROFILING_ENABLE);
+    std::vector<const char *> args(argv, argv + argc);
+    for (auto it = args.begin() + 1; it != args.end();)
+    {
+        if (strcmp(*it, "--latency") != 0)
+        {
+            ++it;
+            continue;
+        }
+        char *end = nullptr;
+        if (it + 1 == args.end()
+            || (gLatencyCommands = (unsigned)strtoul(it[1], &end, 10)) == 0
+            || *end)
+        {
+            log_error("--latency requires a positive number of commands\n");
+            return EXIT_FAILURE;
+        }
+        it = args.erase(it, it + 2);
+    }
+
+    if (gLatencyCommands)
+        log_info("Measuring the latency of %u commands per path\n",
+                 gLatencyCommands);
+
+    return runTestHarness((int)args.size(), args.data(), test_num, test_list,
+                          false, CL_QUEUE_PROFILING_ENABLE);
 }
 
@@ -20,6 +20,7 @@
 #include "harness/kernelHelpers.h"
 #include "harness/imageHelpers.h"
 #include "harness/mt19937.h"
+#include "latency.h"
 
 
 extern int check_times(cl_ulong queueStart, cl_ulong submitStart, cl_ulong commandStart, cl_ulong commandEnd, cl_device_id device);
@@ -21,6 +21,8 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 
+#include <string>
+
 #include "procs.h"
 #include "harness/testHarness.h"
 
@@ -745,6 +747,17 @@ int test_stream_read( cl_device_id device, cl_context context, cl_command_queue
     if (check_times(queueStart, submitStart, readStart, readEnd, device))
       err_count++;
 
+        if (i == 0)
+        {
+            std::string path = std::string("read_array_") + type;
+            auto enqueue = [&](cl_event *event) {
+                return clEnqueueReadBuffer(queue, streams[i], false, 0,
+                                           ptrSizes[i] * num_elements,
+                                           outptr[i], 0, NULL, event);
+            };
+            if (measure_latency(path.c_str(), enqueue)) err_count++;
+        }
+
         // cleanup
         clReleaseEvent(readEvent);
         clReleaseKernel( kernel[i] );
@@ -20,6 +20,8 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 
+#include <string>
+
 #include "procs.h"
 #include "harness/testHarness.h"
 #include "harness/errorHelpers.h"
@@ -807,6 +809,17 @@ int test_stream_write( cl_device_id device, cl_context context, cl_command_queue
         if (check_times(queueStart, submitStart, writeStart, writeEnd, device))
             err_count++;
 
+        if (i == 0)
+        {
+            std::string path = std::string("write_array_") + type;
+            auto enqueue = [&](cl_event *event) {
+                return clEnqueueWriteBuffer(queue, streams[ii], false, 0,
+                                            ptrSizes[i] * num_elements,
+                                            inptr[i], 0, NULL, event);
+            };
+            if (measure_latency(path.c_str(), enqueue)) err_count++;
+        }
+
         // cleanup
         clReleaseEvent(writeEvent);
         clReleaseKernel( kernel[i] );
@@ -21,6 +21,8 @@
 #include <time.h>
 #include <string.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cinttypes>
 #include <vector>
 
@@ -36,6 +38,7 @@
 #include "harness/kernelHelpers.h"
 #include "harness/mt19937.h"
 #include "harness/parseParameters.h"
+#include "harness/ThreadPool.h"
 
 
 //-----------------------------------------
@@ -310,12 +313,227 @@ static cl_program makeSelectProgram(cl_kernel *kernel_ptr,
 
 #define VECTOR_SIZE_COUNT   6
 
+static const size_t element_count[VECTOR_SIZE_COUNT] = { 1, 2, 3, 4, 8, 16 };
+
+// The sweep is shared between workers run as thread pool jobs, each with its
+// own queue, kernels and buffers. A worker keeps SLOTS_PER_WORKER blocks in
+// flight, so the host builds the references of one block and checks it while
+// the device runs the next one.
+#define SLOTS_PER_WORKER 2
+
+// A worker holds about 16 blocks of host memory. Past this count the device
+// is kept busy already and more workers only cost memory.
+#define MAX_WORKERS 16
+
+struct SelectSlot
+{
+    clMemWrapper cmp;
+    clMemWrapper dest;
+    std::vector<char> cmp_host;
+    std::vector<char> dest_host[VECTOR_SIZE_COUNT];
+    clEventWrapper done; // the last read of the block
+    uint64_t block;
+    bool busy;
+};
+
+struct SelectWorker
+{
+    clCommandQueueWrapper queue;
+    clKernelWrapper kernels[VECTOR_SIZE_COUNT];
+    SelectSlot slots[SLOTS_PER_WORKER];
+    std::vector<char> ref;
+    std::vector<char> sref;
+};
+
+struct SelectSweep
+{
+    Type stype;
+    Type cmptype;
+    cl_ulong blocks;
+    size_t step;
+    cl_ulong cmp_stride;
+    size_t block_elements;
+    const char *src1_host;
+    const char *src2_host;
+    std::vector<SelectWorker> workers;
+    std::atomic<bool> failed;
+};
+
+static int setupWorker(SelectWorker &worker, cl_context context,
+                       cl_device_id device, const clKernelWrapper *prototypes,
+                       cl_mem src1, cl_mem src2)
+{
+    int err = CL_SUCCESS;
+
+    worker.queue = clCreateCommandQueue(context, device, 0, &err);
+    test_error_count(err, "Error: could not create worker queue\n");
+
+    for (size_t vecsize = 0; vecsize < VECTOR_SIZE_COUNT; ++vecsize)
+    {
+        char name[256];
+        cl_program program;
+        err = clGetKernelInfo(prototypes[vecsize], CL_KERNEL_FUNCTION_NAME,
+                              sizeof(name), name, NULL);
+        test_error_count(err, "Error: could not get kernel name\n");
+        err = clGetKernelInfo(prototypes[vecsize], CL_KERNEL_PROGRAM,
+                              sizeof(program), &program, NULL);
+        test_error_count(err, "Error: could not get kernel program\n");
+
+        worker.kernels[vecsize] = clCreateKernel(program, name, &err);
+        test_error_count(err, "Error: could not create worker kernel\n");
+        err = clSetKernelArg(worker.kernels[vecsize], 1, sizeof(cl_mem),
+                             &src1);
+        test_error_count(err, "Error: Cannot set kernel arg src1!\n");
+        err = clSetKernelArg(worker.kernels[vecsize], 2, sizeof(cl_mem),
+                             &src2);
+        test_error_count(err, "Error: Cannot set kernel arg src2!\n");
+    }
+
+    for (SelectSlot &slot : worker.slots)
+    {
+        slot.cmp = clCreateBuffer(context, CL_MEM_READ_ONLY, BUFFER_SIZE, NULL,
+                                  &err);
+        test_error_count(err, "Error: could not allocate cmp buffer\n");
+        slot.dest = clCreateBuffer(context, CL_MEM_WRITE_ONLY, BUFFER_SIZE,
+                                   NULL, &err);
+        test_error_count(err, "Error: could not allocate dest buffer\n");
+
+        slot.cmp_host.resize(BUFFER_SIZE);
+        for (std::vector<char> &dest_host : slot.dest_host)
+            dest_host.resize(BUFFER_SIZE);
+        slot.busy = false;
+    }
+
+    worker.ref.resize(BUFFER_SIZE);
+    worker.sref.resize(BUFFER_SIZE);
+    return err;
+}
+
+// Enqueues the compare values, the kernels for every vector size and the
+// reads of their results, without waiting for any of them
+static cl_int submitBlock(const SelectSweep *sweep, SelectWorker &worker,
+                          SelectSlot &slot, uint64_t block)
+{
+    cl_int err;
+
+    initCmpBuffer(slot.cmp_host.data(), sweep->cmptype,
+                  block * sweep->cmp_stride, sweep->block_elements);
+    err = clEnqueueWriteBuffer(worker.queue, slot.cmp, CL_FALSE, 0,
+                               BUFFER_SIZE, slot.cmp_host.data(), 0, NULL,
+                               NULL);
+    test_error(err, "Error: Could not write cmp");
+
+    slot.done.reset();
+    for (size_t vecsize = 0; vecsize < VECTOR_SIZE_COUNT; ++vecsize)
+    {
+        size_t vector_size = element_count[vecsize] * type_size[sweep->stype];
+        size_t vector_count = (BUFFER_SIZE + vector_size - 1) / vector_size;
+        cl_kernel kernel = worker.kernels[vecsize];
+
+        err = clSetKernelArg(kernel, 0, sizeof(cl_mem), &slot.dest);
+        test_error(err, "Error: Cannot set kernel arg dest!\n");
+        err = clSetKernelArg(kernel, 3, sizeof(cl_mem), &slot.cmp);
+        test_error(err, "Error: Cannot set kernel arg cmp!\n");
+
+        // The queue is in order, so the fill waits for the previous read
+        const cl_int pattern = -1;
+        err = clEnqueueFillBuffer(worker.queue, slot.dest, &pattern,
+                                  sizeof(cl_int), 0, BUFFER_SIZE, 0, nullptr,
+                                  nullptr);
+        test_error(err, "clEnqueueFillBuffer failed");
+
+        err = clEnqueueNDRangeKernel(worker.queue, kernel, 1, NULL,
+                                     &vector_count, NULL, 0, NULL, NULL);
+        test_error(err, "clEnqueueNDRangeKernel failed errcode\n");
+
+        err = clEnqueueReadBuffer(
+            worker.queue, slot.dest, CL_FALSE, 0, BUFFER_SIZE,
+            slot.dest_host[vecsize].data(), 0, NULL,
+            vecsize + 1 == VECTOR_SIZE_COUNT ? &slot.done : NULL);
+        test_error(err, "Error: Reading buffer from dest to dest_host failed\n");
+    }
+
+    err = clFlush(worker.queue);
+    test_error(err, "clFlush failed");
+
+    slot.block = block;
+    slot.busy = true;
+    return CL_SUCCESS;
+}
+
+static cl_int checkBlock(const SelectSweep *sweep, SelectWorker &worker,
+                         SelectSlot &slot)
+{
+    slot.busy = false;
+
+    // The references only need host data, build them before waiting
+    (*vrefSelects[sweep->stype])(worker.ref.data(), sweep->src1_host,
+                                 sweep->src2_host, slot.cmp_host.data(),
+                                 sweep->block_elements);
+    (*refSelects[sweep->stype])(worker.sref.data(), sweep->src1_host,
+                                sweep->src2_host, slot.cmp_host.data(),
+                                sweep->block_elements);
+
+    cl_int err = clWaitForEvents(1, &slot.done);
+    test_error(err, "clWaitForEvents failed");
+
+    for (size_t vecsize = 0; vecsize < VECTOR_SIZE_COUNT; ++vecsize)
+    {
+        if ((*checkResults[sweep->stype])(
+                slot.dest_host[vecsize].data(),
+                vecsize == 0 ? worker.sref.data() : worker.ref.data(),
+                sweep->block_elements, element_count[vecsize])
+            != 0)
+        {
+            log_error("vec_size:%d indx: 0x%16.16" PRIx64 "\n",
+                      (int)element_count[vecsize], slot.block);
+            return TEST_FAIL;
+        }
+    }
+    return CL_SUCCESS;
+}
+
+// Job job_id visits every workers.size()-th block of the sweep, starting at
+// block job_id, with the worker of the same index
+static cl_int selectJob(cl_uint job_id, cl_uint thread_id, void *userInfo)
+{
+    SelectSweep *sweep = (SelectSweep *)userInfo;
+    SelectWorker &worker = sweep->workers[job_id];
+    const cl_ulong stride = sweep->workers.size() * sweep->step;
+    size_t next = 0;
+    cl_int err = CL_SUCCESS;
+
+    for (cl_ulong i = job_id * sweep->step; i < sweep->blocks; i += stride)
+    {
+        if (sweep->failed) break;
+
+        // Reuse the slot of the oldest block in flight
+        SelectSlot &slot = worker.slots[next];
+        next = (next + 1) % SLOTS_PER_WORKER;
+        if (slot.busy)
+        {
+            err = checkBlock(sweep, worker, slot);
+            if (err != CL_SUCCESS) break;
+        }
+        err = submitBlock(sweep, worker, slot, i);
+        if (err != CL_SUCCESS) break;
+    }
+
+    for (size_t s = 0; s < SLOTS_PER_WORKER && err == CL_SUCCESS; ++s)
+    {
+        SelectSlot &slot = worker.slots[(next + s) % SLOTS_PER_WORKER];
+        if (slot.busy) err = checkBlock(sweep, worker, slot);
+    }
+
+    if (err != CL_SUCCESS) sweep->failed = true;
+    return err;
+}
+
 static int doTest(cl_command_queue queue, cl_context context, Type stype, Type cmptype, cl_device_id device)
 {
     int err = CL_SUCCESS;
     MTdataHolder d(gRandomSeed);
-    const size_t element_count[VECTOR_SIZE_COUNT] = { 1, 2, 3, 4, 8, 16 };
-    clMemWrapper src1, src2, cmp, dest;
+    clMemWrapper src1, src2;
 
     cl_ulong blocks = type_size[stype] * 0x100000000ULL / BUFFER_SIZE;
     const size_t block_elements = BUFFER_SIZE / type_size[stype];
@@ -355,52 +573,30 @@ static int doTest(cl_command_queue queue, cl_context context, Type stype, Type c
        }
     }
 
-    src1 = clCreateBuffer( context, CL_MEM_READ_ONLY, BUFFER_SIZE, NULL, &err );
+    // The sources are the same for every block, only the compare values
+    // change
+    std::vector<char> src1_host(BUFFER_SIZE);
+    std::vector<char> src2_host(BUFFER_SIZE);
+    initSrcBuffer(src1_host.data(), stype, d);
+    initSrcBuffer(src2_host.data(), stype, d);
+
+    src1 = clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                          BUFFER_SIZE, src1_host.data(), &err);
     test_error_count(err, "Error: could not allocate src1 buffer\n");
-    src2 = clCreateBuffer( context, CL_MEM_READ_ONLY, BUFFER_SIZE, NULL, &err );
+    src2 = clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                          BUFFER_SIZE, src2_host.data(), &err);
     test_error_count(err, "Error: could not allocate src2 buffer\n");
-    cmp = clCreateBuffer( context, CL_MEM_READ_ONLY, BUFFER_SIZE, NULL, &err );
-    test_error_count(err, "Error: could not allocate cmp buffer\n");
-    dest = clCreateBuffer( context, CL_MEM_WRITE_ONLY, BUFFER_SIZE, NULL, &err );
-    test_error_count(err, "Error: could not allocate dest buffer\n");
-
-    programs[0] = makeSelectProgram(&kernels[0], context, stype, cmptype,
-                                    element_count[0]);
-    programs[1] = makeSelectProgram(&kernels[1], context, stype, cmptype,
-                                    element_count[1]);
-    programs[2] = makeSelectProgram(&kernels[2], context, stype, cmptype,
-                                    element_count[2]);
-    programs[3] = makeSelectProgram(&kernels[3], context, stype, cmptype,
-                                    element_count[3]);
-    programs[4] = makeSelectProgram(&kernels[4], context, stype, cmptype,
-                                    element_count[4]);
-    programs[5] = makeSelectProgram(&kernels[5], context, stype, cmptype,
-                                    element_count[5]);
 
     for (size_t vecsize = 0; vecsize < VECTOR_SIZE_COUNT; ++vecsize)
     {
+        programs[vecsize] = makeSelectProgram(&kernels[vecsize], context, stype,
+                                              cmptype, element_count[vecsize]);
         if (!programs[vecsize] || !kernels[vecsize])
         {
             return -1;
         }
-
-        err = clSetKernelArg(kernels[vecsize], 0, sizeof dest, &dest);
-        test_error_count(err, "Error: Cannot set kernel arg dest!\n");
-        err = clSetKernelArg(kernels[vecsize], 1, sizeof src1, &src1);
-        test_error_count(err, "Error: Cannot set kernel arg dest!\n");
-        err = clSetKernelArg(kernels[vecsize], 2, sizeof src2, &src2);
-        test_error_count(err, "Error: Cannot set kernel arg dest!\n");
-        err = clSetKernelArg(kernels[vecsize], 3, sizeof cmp, &cmp);
-        test_error_count(err, "Error: Cannot set kernel arg dest!\n");
     }
 
-    std::vector<char> ref(BUFFER_SIZE);
-    std::vector<char> sref(BUFFER_SIZE);
-    std::vector<char> src1_host(BUFFER_SIZE);
-    std::vector<char> src2_host(BUFFER_SIZE);
-    std::vector<char> cmp_host(BUFFER_SIZE);
-    std::vector<char> dest_host(BUFFER_SIZE);
-
     // We block the test as we are running over the range of compare values
     // "block the test" means "break the test into blocks"
     if( type_size[stype] == 4 )
@@ -408,67 +604,35 @@ static int doTest(cl_command_queue queue, cl_context context, Type stype, Type c
     if( type_size[stype] == 8 )
         cmp_stride = block_elements * step * (0xffffffffffffffffULL / 0x100000000ULL + 1);
 
-    log_info("Testing...");
-    uint64_t i;
-
-    initSrcBuffer(src1_host.data(), stype, d);
-    initSrcBuffer(src2_host.data(), stype, d);
-    for (i=0; i < blocks; i+=step)
+    SelectSweep sweep;
+    sweep.stype = stype;
+    sweep.cmptype = cmptype;
+    sweep.blocks = blocks;
+    sweep.step = step;
+    sweep.cmp_stride = cmp_stride;
+    sweep.block_elements = block_elements;
+    sweep.src1_host = src1_host.data();
+    sweep.src2_host = src2_host.data();
+    sweep.failed = false;
+
+    cl_ulong visited = (blocks + step - 1) / step;
+    size_t worker_count = std::min<cl_ulong>(
+        std::min<cl_ulong>(GetThreadCount(), MAX_WORKERS), visited);
+    sweep.workers.resize(worker_count);
+    for (SelectWorker &worker : sweep.workers)
     {
-        initCmpBuffer(cmp_host.data(), cmptype, i * cmp_stride, block_elements);
-
-        err = clEnqueueWriteBuffer(queue, src1, CL_FALSE, 0, BUFFER_SIZE,
-                                   src1_host.data(), 0, NULL, NULL);
-        test_error_count(err, "Error: Could not write src1");
-
-        err = clEnqueueWriteBuffer(queue, src2, CL_FALSE, 0, BUFFER_SIZE,
-                                   src2_host.data(), 0, NULL, NULL);
-        test_error_count(err, "Error: Could not write src2");
-
-        err = clEnqueueWriteBuffer(queue, cmp, CL_FALSE, 0, BUFFER_SIZE,
-                                   cmp_host.data(), 0, NULL, NULL);
-        test_error_count(err, "Error: Could not write cmp");
-
-        Select sfunc = (cmptype == ctype[stype][0]) ? vrefSelects[stype][0]
-                                                    : vrefSelects[stype][1];
-        (*sfunc)(ref.data(), src1_host.data(), src2_host.data(),
-                 cmp_host.data(), block_elements);
-
-        sfunc = (cmptype == ctype[stype][0]) ? refSelects[stype][0]
-                                             : refSelects[stype][1];
-        (*sfunc)(sref.data(), src1_host.data(), src2_host.data(),
-                 cmp_host.data(), block_elements);
-
-        for (int vecsize = 0; vecsize < VECTOR_SIZE_COUNT; ++vecsize)
-        {
-            size_t vector_size = element_count[vecsize] * type_size[stype];
-            size_t vector_count =  (BUFFER_SIZE + vector_size - 1) / vector_size;
-
-            const cl_int pattern = -1;
-            err = clEnqueueFillBuffer(queue, dest, &pattern, sizeof(cl_int), 0,
-                                      BUFFER_SIZE, 0, nullptr, nullptr);
-            test_error_count(err, "clEnqueueFillBuffer failed");
+        err = setupWorker(worker, context, device, kernels, src1, src2);
+        if (err != CL_SUCCESS) return err;
+    }
 
+    log_info("Testing...");
 
-            err = clEnqueueNDRangeKernel(queue, kernels[vecsize], 1, NULL, &vector_count, NULL, 0, NULL, NULL);
-            test_error_count(err, "clEnqueueNDRangeKernel failed errcode\n");
+    err = ThreadPool_Do(selectJob, (cl_uint)worker_count, &sweep);
 
-            err = clEnqueueReadBuffer(queue, dest, CL_TRUE, 0, BUFFER_SIZE,
-                                      dest_host.data(), 0, NULL, NULL);
-            test_error_count(
-                err, "Error: Reading buffer from dest to dest_host failed\n");
+    // Results of a stopped sweep may still be in flight into host memory
+    for (SelectWorker &worker : sweep.workers) clFinish(worker.queue);
 
-            if ((*checkResults[stype])(dest_host.data(),
-                                       vecsize == 0 ? sref.data() : ref.data(),
-                                       block_elements, element_count[vecsize])
-                != 0)
-            {
-                log_error("vec_size:%d indx: 0x%16.16" PRIx64 "\n",
-                          (int)element_count[vecsize], i);
-                return TEST_FAIL;
-            }
-        } // for vecsize
-    } // for i
+    if (err != CL_SUCCESS) return err;
 
     if (!s_wimpy_mode)
         log_info(" Passed\n\n");
@@ -57,14 +57,15 @@ extern const size_t type_size[kTypeCount];
 // Associated comparison types
 extern const Type ctype[kTypeCount][2];
 
-// Reference functions for the primitive (non vector) type
+// Reference functions for the primitive (non vector) type. They are shared
+// by both comparison types of a source type.
 typedef void (*Select)(void *const dest, const void *const src1,
                        const void *const src2, const void *const cmp, size_t c);
-extern Select refSelects[kTypeCount][2];
+extern Select refSelects[kTypeCount];
 
 // Reference functions for the primtive type but uses the vector
 // definition of true and false
-extern Select vrefSelects[kTypeCount][2];
+extern Select vrefSelects[kTypeCount];
 
 // Check functions for each output type
 typedef size_t (*CheckResults)(const void *const out1, const void *const out2,
@@ -54,583 +54,75 @@ const Type ctype[kTypeCount][2] = {
 // Reference functions
 //-----------------------------------------
 
-void refselect_1i8(void *const dest, const void *const src1,
-                   const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_char *const d = (cl_char *)dest;
-    const cl_char *const x = (cl_char *)src1;
-    const cl_char *const y = (cl_char *)src2;
-    const cl_char *const m = (cl_char *)cmp;
-    for (i=0; i < count; ++i) {
-        d[i] = m[i] ? y[i] : x[i];
+// The references work on the bit patterns of the source type, so half, float
+// and double share the integer implementations of the same size. Only the
+// size of the comparison type matters too: select() tests it against zero
+// for scalars and its most significant bit for vectors, neither of which
+// depends on its signedness.
+//
+// Both are written as a blend of the sources under an all-ones or all-zeros
+// mask rather than with a conditional, which the compiler turns into wide
+// vector code.
+
+template <typename T>
+void refselect(void *const dest, const void *const src1,
+               const void *const src2, const void *const cmp, size_t count)
+{
+    T *const d = (T *)dest;
+    const T *const x = (const T *)src1;
+    const T *const y = (const T *)src2;
+    const T *const m = (const T *)cmp;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const T mask = (T)((T)0 - (T)(m[i] != 0));
+        d[i] = (T)((x[i] & ~mask) | (y[i] & mask));
     }
 }
 
-void refselect_1u8(void *const dest, const void *const src1,
-                   const void *const src2, const void *const cmp, size_t count)
+template <typename T>
+void vrefselect(void *const dest, const void *const src1,
+                const void *const src2, const void *const cmp, size_t count)
 {
-    size_t i;
-    cl_uchar *const d = (cl_uchar *)dest;
-    const cl_uchar *const x = (cl_uchar *)src1;
-    const cl_uchar *const y = (cl_uchar *)src2;
-    const cl_char *const m = (cl_char *)cmp;
-    for (i=0; i < count; ++i) {
-        d[i] = m[i] ? y[i] : x[i];
+    const unsigned sign_shift = 8 * sizeof(T) - 1;
+    T *const d = (T *)dest;
+    const T *const x = (const T *)src1;
+    const T *const y = (const T *)src2;
+    const T *const m = (const T *)cmp;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const T mask = (T)((T)0 - (T)(m[i] >> sign_shift));
+        d[i] = (T)((x[i] & ~mask) | (y[i] & mask));
     }
 }
 
-void refselect_1i16(void *const dest, const void *const src1,
-                    const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_short *const d = (cl_short *)dest;
-    const cl_short *const x = (cl_short *)src1;
-    const cl_short *const y = (cl_short *)src2;
-    const cl_short *const m = (cl_short *)cmp;
-
-    for (i=0; i < count; ++i)
-        d[i] = m[i] ? y[i] : x[i];
-}
-
-void refselect_1u16(void *const dest, const void *const src1,
-                    const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_ushort *const d = (cl_ushort *)dest;
-    const cl_ushort *const x = (cl_ushort *)src1;
-    const cl_ushort *const y = (cl_ushort *)src2;
-    const cl_short *const m = (cl_short *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = m[i] ? y[i] : x[i];
-}
-
-void refselect_1i32(void *const dest, const void *const src1,
-                    const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_int *const d = (cl_int *)dest;
-    const cl_int *const x = (cl_int *)src1;
-    const cl_int *const y = (cl_int *)src2;
-    const cl_int *const m = (cl_int *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = m[i] ? y[i] : x[i];
-}
-
-void refselect_1u32(void *const dest, const void *const src1,
-                    const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_uint *const d = (cl_uint *)dest;
-    const cl_uint *const x = (cl_uint *)src1;
-    const cl_uint *const y = (cl_uint *)src2;
-    const cl_int *const m = (cl_int *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = m[i] ? y[i] : x[i];
-}
-
-void refselect_1i64(void *const dest, const void *const src1,
-                    const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_long *const d = (cl_long *)dest;
-    const cl_long *const x = (cl_long *)src1;
-    const cl_long *const y = (cl_long *)src2;
-    const cl_long *const m = (cl_long *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = m[i] ? y[i] : x[i];
-}
-
-void refselect_1u64(void *const dest, const void *const src1,
-                    const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_ulong *const d = (cl_ulong *)dest;
-    const cl_ulong *const x = (cl_ulong *)src1;
-    const cl_ulong *const y = (cl_ulong *)src2;
-    const cl_long *const m = (cl_long *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = m[i] ? y[i] : x[i];
-}
-
-void refselect_1i8u(void *const dest, const void *const src1,
-                    const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_char *const d = (cl_char *)dest;
-    const cl_char *const x = (cl_char *)src1;
-    const cl_char *const y = (cl_char *)src2;
-    const cl_uchar *const m = (cl_uchar *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = m[i] ? y[i] : x[i];
-}
-
-void refselect_1u8u(void *const dest, const void *const src1,
-                    const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_uchar *const d = (cl_uchar *)dest;
-    const cl_uchar *const x = (cl_uchar *)src1;
-    const cl_uchar *const y = (cl_uchar *)src2;
-    const cl_uchar *const m = (cl_uchar *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = m[i] ? y[i] : x[i];
-}
-
-void refselect_1i16u(void *const dest, const void *const src1,
-                     const void *const src2, const void *const cmp,
-                     size_t count)
-{
-    size_t i;
-    cl_short *const d = (cl_short *)dest;
-    const cl_short *const x = (cl_short *)src1;
-    const cl_short *const y = (cl_short *)src2;
-    const cl_ushort *const m = (cl_ushort *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = m[i] ? y[i] : x[i];
-}
-
-void refselect_1u16u(void *const dest, const void *const src1,
-                     const void *const src2, const void *const cmp,
-                     size_t count)
-{
-    size_t i;
-    cl_ushort *const d = (cl_ushort *)dest;
-    const cl_ushort *const x = (cl_ushort *)src1;
-    const cl_ushort *const y = (cl_ushort *)src2;
-    const cl_ushort *const m = (cl_ushort *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = m[i] ? y[i] : x[i];
-}
-
-void refselect_1i32u(void *const dest, const void *const src1,
-                     const void *const src2, const void *const cmp,
-                     size_t count)
-{
-    size_t i;
-    cl_int *const d = (cl_int *)dest;
-    const cl_int *const x = (cl_int *)src1;
-    const cl_int *const y = (cl_int *)src2;
-    const cl_uint *const m = (cl_uint *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = m[i] ? y[i] : x[i];
-}
-
-void refselect_1u32u(void *const dest, const void *const src1,
-                     const void *const src2, const void *const cmp,
-                     size_t count)
-{
-    size_t i;
-    cl_uint *const d = (cl_uint *)dest;
-    const cl_uint *const x = (cl_uint *)src1;
-    const cl_uint *const y = (cl_uint *)src2;
-    const cl_uint *const m = (cl_uint *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = m[i] ? y[i] : x[i];
-}
-
-void refselect_1i64u(void *const dest, const void *const src1,
-                     const void *const src2, const void *const cmp,
-                     size_t count)
-{
-    size_t i;
-    cl_long *const d = (cl_long *)dest;
-    const cl_long *const x = (cl_long *)src1;
-    const cl_long *const y = (cl_long *)src2;
-    const cl_ulong *const m = (cl_ulong *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = m[i] ? y[i] : x[i];
-}
-
-void refselect_1u64u(void *const dest, const void *const src1,
-                     const void *const src2, const void *const cmp,
-                     size_t count)
-{
-    size_t i;
-    cl_ulong *const d = (cl_ulong *)dest;
-    const cl_ulong *const x = (cl_ulong *)src1;
-    const cl_ulong *const y = (cl_ulong *)src2;
-    const cl_ulong *const m = (cl_ulong *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = m[i] ? y[i] : x[i];
-}
-
-void refselect_hhi(void *const dest, const void *const src1,
-                   const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_short *const d = (cl_short *)dest;
-    const cl_short *const x = (cl_short *)src1;
-    const cl_short *const y = (cl_short *)src2;
-    const cl_short *const m = (cl_short *)cmp;
-    for (i = 0; i < count; ++i) d[i] = m[i] ? y[i] : x[i];
-}
-
-void refselect_hhu(void *const dest, const void *const src1,
-                   const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_ushort *const d = (cl_ushort *)dest;
-    const cl_ushort *const x = (cl_ushort *)src1;
-    const cl_ushort *const y = (cl_ushort *)src2;
-    const cl_ushort *const m = (cl_ushort *)cmp;
-    for (i = 0; i < count; ++i) d[i] = m[i] ? y[i] : x[i];
-}
-
-void refselect_ffi(void *const dest, const void *const src1,
-                   const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_int *const d = (cl_int *)dest;
-    const cl_int *const x = (cl_int *)src1;
-    const cl_int *const y = (cl_int *)src2;
-    const cl_int *const m = (cl_int *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = m[i] ? y[i] : x[i];
-}
-
-void refselect_ffu(void *const dest, const void *const src1,
-                   const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_uint *const d = (cl_uint *)dest;
-    const cl_uint *const x = (cl_uint *)src1;
-    const cl_uint *const y = (cl_uint *)src2;
-    const cl_uint *const m = (cl_uint *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = m[i] ? y[i] : x[i];
-}
-
-void refselect_ddi(void *const dest, const void *const src1,
-                   const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_long *const d = (cl_long *)dest;
-    const cl_long *const x = (cl_long *)src1;
-    const cl_long *const y = (cl_long *)src2;
-    const cl_long *const m = (cl_long *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = m[i] ? y[i] : x[i];
-}
-
-void refselect_ddu(void *const dest, const void *const src1,
-                   const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_long *const d = (cl_long *)dest;
-    const cl_long *const x = (cl_long *)src1;
-    const cl_long *const y = (cl_long *)src2;
-    const cl_ulong *const m = (cl_ulong *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = m[i] ? y[i] : x[i];
-}
-
-void vrefselect_1i8(void *const dest, const void *const src1,
-                    const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_char *const d = (cl_char *)dest;
-    const cl_char *const x = (cl_char *)src1;
-    const cl_char *const y = (cl_char *)src2;
-    const cl_char *const m = (cl_char *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = (m[i] & 0x80) ? y[i] : x[i];
-}
-
-void vrefselect_1u8(void *const dest, const void *const src1,
-                    const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_uchar *const d = (cl_uchar *)dest;
-    const cl_uchar *const x = (cl_uchar *)src1;
-    const cl_uchar *const y = (cl_uchar *)src2;
-    const cl_char *const m = (cl_char *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = (m[i] & 0x80) ? y[i] : x[i];
-}
-
-void vrefselect_1i16(void *const dest, const void *const src1,
-                     const void *const src2, const void *const cmp,
-                     size_t count)
-{
-    size_t i;
-    cl_short *const d = (cl_short *)dest;
-    const cl_short *const x = (cl_short *)src1;
-    const cl_short *const y = (cl_short *)src2;
-    const cl_short *const m = (cl_short *)cmp;
-
-    for (i=0; i < count; ++i)
-        d[i] = (m[i] & 0x8000) ? y[i] : x[i];
-}
-
-void vrefselect_1u16(void *const dest, const void *const src1,
-                     const void *const src2, const void *const cmp,
-                     size_t count)
-{
-    size_t i;
-    cl_ushort *const d = (cl_ushort *)dest;
-    const cl_ushort *const x = (cl_ushort *)src1;
-    const cl_ushort *const y = (cl_ushort *)src2;
-    const cl_short *const m = (cl_short *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = (m[i] & 0x8000) ? y[i] : x[i];
-}
-
-void vrefselect_1i32(void *const dest, const void *const src1,
-                     const void *const src2, const void *const cmp,
-                     size_t count)
-{
-    size_t i;
-    cl_int *const d = (cl_int *)dest;
-    const cl_int *const x = (cl_int *)src1;
-    const cl_int *const y = (cl_int *)src2;
-    const cl_int *const m = (cl_int *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = (m[i] & 0x80000000) ? y[i] : x[i];
-}
-
-void vrefselect_1u32(void *const dest, const void *const src1,
-                     const void *const src2, const void *const cmp,
-                     size_t count)
-{
-    size_t i;
-    cl_uint *const d = (cl_uint *)dest;
-    const cl_uint *const x = (cl_uint *)src1;
-    const cl_uint *const y = (cl_uint *)src2;
-    const cl_int *const m = (cl_int *)cmp;
-
-    for (i=0; i < count; ++i)
-        d[i] = (m[i] & 0x80000000) ? y[i] : x[i];
-}
-
-void vrefselect_1i64(void *const dest, const void *const src1,
-                     const void *const src2, const void *const cmp,
-                     size_t count)
-{
-    size_t i;
-    cl_long *const d = (cl_long *)dest;
-    const cl_long *const x = (cl_long *)src1;
-    const cl_long *const y = (cl_long *)src2;
-    const cl_long *const m = (cl_long *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = (m[i] & 0x8000000000000000LL) ? y[i] : x[i];
-}
-
-void vrefselect_1u64(void *const dest, const void *const src1,
-                     const void *const src2, const void *const cmp,
-                     size_t count)
-{
-    size_t i;
-    cl_ulong *const d = (cl_ulong *)dest;
-    const cl_ulong *const x = (cl_ulong *)src1;
-    const cl_ulong *const y = (cl_ulong *)src2;
-    const cl_long *const m = (cl_long *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = (m[i] & 0x8000000000000000LL) ? y[i] : x[i];
-}
-
-void vrefselect_1i8u(void *const dest, const void *const src1,
-                     const void *const src2, const void *const cmp,
-                     size_t count)
-{
-    size_t i;
-    cl_char *const d = (cl_char *)dest;
-    const cl_char *const x = (cl_char *)src1;
-    const cl_char *const y = (cl_char *)src2;
-    const cl_uchar *const m = (cl_uchar *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = (m[i] & 0x80U) ? y[i] : x[i];
-}
-
-void vrefselect_1u8u(void *const dest, const void *const src1,
-                     const void *const src2, const void *const cmp,
-                     size_t count)
-{
-    size_t i;
-    cl_uchar *const d = (cl_uchar *)dest;
-    const cl_uchar *const x = (cl_uchar *)src1;
-    const cl_uchar *const y = (cl_uchar *)src2;
-    const cl_uchar *const m = (cl_uchar *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = (m[i] & 0x80U) ? y[i] : x[i];
-}
-
-void vrefselect_1i16u(void *const dest, const void *const src1,
-                      const void *const src2, const void *const cmp,
-                      size_t count)
-{
-    size_t i;
-    cl_short *const d = (cl_short *)dest;
-    const cl_short *const x = (cl_short *)src1;
-    const cl_short *const y = (cl_short *)src2;
-    const cl_ushort *const m = (cl_ushort *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = (m[i] & 0x8000U) ? y[i] : x[i];
-}
-
-void vrefselect_1u16u(void *const dest, const void *const src1,
-                      const void *const src2, const void *const cmp,
-                      size_t count)
-{
-    size_t i;
-    cl_ushort *const d = (cl_ushort *)dest;
-    const cl_ushort *const x = (cl_ushort *)src1;
-    const cl_ushort *const y = (cl_ushort *)src2;
-    const cl_ushort *const m = (cl_ushort *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = (m[i] & 0x8000U) ? y[i] : x[i];
-}
-
-void vrefselect_1i32u(void *const dest, const void *const src1,
-                      const void *const src2, const void *const cmp,
-                      size_t count)
-{
-    size_t i;
-    cl_int *const d = (cl_int *)dest;
-    const cl_int *const x = (cl_int *)src1;
-    const cl_int *const y = (cl_int *)src2;
-    const cl_uint *const m = (cl_uint *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = (m[i] & 0x80000000U) ? y[i] : x[i];
-}
-
-void vrefselect_1u32u(void *const dest, const void *const src1,
-                      const void *const src2, const void *const cmp,
-                      size_t count)
-{
-    size_t i;
-    cl_uint *const d = (cl_uint *)dest;
-    const cl_uint *const x = (cl_uint *)src1;
-    const cl_uint *const y = (cl_uint *)src2;
-    const cl_uint *const m = (cl_uint *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = (m[i] & 0x80000000U) ? y[i] : x[i];
-}
-
-void vrefselect_1i64u(void *const dest, const void *const src1,
-                      const void *const src2, const void *const cmp,
-                      size_t count)
-{
-    size_t i;
-    cl_long *const d = (cl_long *)dest;
-    const cl_long *const x = (cl_long *)src1;
-    const cl_long *const y = (cl_long *)src2;
-    const cl_ulong *const m = (cl_ulong *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = (m[i] & 0x8000000000000000ULL) ? y[i] : x[i];
-}
-
-void vrefselect_1u64u(void *const dest, const void *const src1,
-                      const void *const src2, const void *const cmp,
-                      size_t count)
-{
-    size_t i;
-    cl_ulong *const d = (cl_ulong *)dest;
-    const cl_ulong *const x = (cl_ulong *)src1;
-    const cl_ulong *const y = (cl_ulong *)src2;
-    const cl_ulong *const m = (cl_ulong *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = (m[i] & 0x8000000000000000ULL) ? y[i] : x[i];
-}
-
-void vrefselect_hhi(void *const dest, const void *const src1,
-                    const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_ushort *const d = (cl_ushort *)dest;
-    const cl_ushort *const x = (cl_ushort *)src1;
-    const cl_ushort *const y = (cl_ushort *)src2;
-    const cl_short *const m = (cl_short *)cmp;
-    for (i = 0; i < count; ++i) d[i] = (m[i] & 0x8000) ? y[i] : x[i];
-}
-
-void vrefselect_hhu(void *const dest, const void *const src1,
-                    const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_ushort *const d = (cl_ushort *)dest;
-    const cl_ushort *const x = (cl_ushort *)src1;
-    const cl_ushort *const y = (cl_ushort *)src2;
-    const cl_ushort *const m = (cl_ushort *)cmp;
-    for (i = 0; i < count; ++i) d[i] = (m[i] & 0x8000U) ? y[i] : x[i];
-}
-
-void vrefselect_ffi(void *const dest, const void *const src1,
-                    const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_uint *const d = (cl_uint *)dest;
-    const cl_uint *const x = (cl_uint *)src1;
-    const cl_uint *const y = (cl_uint *)src2;
-    const cl_int *const m = (cl_int *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = (m[i] & 0x80000000) ? y[i] : x[i];
-}
-
-void vrefselect_ffu(void *const dest, const void *const src1,
-                    const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_uint *const d = (cl_uint *)dest;
-    const cl_uint *const x = (cl_uint *)src1;
-    const cl_uint *const y = (cl_uint *)src2;
-    const cl_uint *const m = (cl_uint *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = (m[i] & 0x80000000U) ? y[i] : x[i];
-}
-
-void vrefselect_ddi(void *const dest, const void *const src1,
-                    const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_ulong *const d = (cl_ulong *)dest;
-    const cl_ulong *const x = (cl_ulong *)src1;
-    const cl_ulong *const y = (cl_ulong *)src2;
-    const cl_long *const m = (cl_long *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = (m[i] & 0x8000000000000000LL) ? y[i] : x[i];
-}
-
-void vrefselect_ddu(void *const dest, const void *const src1,
-                    const void *const src2, const void *const cmp, size_t count)
-{
-    size_t i;
-    cl_ulong *const d = (cl_ulong *)dest;
-    const cl_ulong *const x = (cl_ulong *)src1;
-    const cl_ulong *const y = (cl_ulong *)src2;
-    const cl_ulong *const m = (cl_ulong *)cmp;
-    for (i=0; i < count; ++i)
-        d[i] = (m[i] & 0x8000000000000000ULL) ? y[i] : x[i];
-}
-
 // Define refSelects
-Select refSelects[kTypeCount][2] = {
-    { refselect_1u8u, refselect_1u8 }, // cl_uchar
-    { refselect_1i8u, refselect_1i8 }, // char
-    { refselect_1u16u, refselect_1u16 }, // ushort
-    { refselect_1i16u, refselect_1i16 }, // short
-    { refselect_hhu, refselect_hhi }, // half
-    { refselect_1u32u, refselect_1u32 }, // uint
-    { refselect_1i32u, refselect_1i32 }, // int
-    { refselect_ffu, refselect_ffi }, // float
-    { refselect_1u64u, refselect_1u64 }, // ulong
-    { refselect_1i64u, refselect_1i64 }, // long
-    { refselect_ddu, refselect_ddi } // double
+Select refSelects[kTypeCount] = {
+    refselect<cl_uchar>, // uchar
+    refselect<cl_uchar>, // char
+    refselect<cl_ushort>, // ushort
+    refselect<cl_ushort>, // short
+    refselect<cl_ushort>, // half
+    refselect<cl_uint>, // uint
+    refselect<cl_uint>, // int
+    refselect<cl_uint>, // float
+    refselect<cl_ulong>, // ulong
+    refselect<cl_ulong>, // long
+    refselect<cl_ulong> // double
 };
 
 // Define vrefSelects (vector refSelects)
-Select vrefSelects[kTypeCount][2] = {
-    { vrefselect_1u8u, vrefselect_1u8 }, // cl_uchar
-    { vrefselect_1i8u, vrefselect_1i8 }, // char
-    { vrefselect_1u16u, vrefselect_1u16 }, // ushort
-    { vrefselect_1i16u, vrefselect_1i16 }, // short
-    { vrefselect_hhu, vrefselect_hhi }, // half
-    { vrefselect_1u32u, vrefselect_1u32 }, // uint
-    { vrefselect_1i32u, vrefselect_1i32 }, // int
-    { vrefselect_ffu, vrefselect_ffi }, // float
-    { vrefselect_1u64u, vrefselect_1u64 }, // ulong
-    { vrefselect_1i64u, vrefselect_1i64 }, // long
-    { vrefselect_ddu, vrefselect_ddi } // double
+Select vrefSelects[kTypeCount] = {
+    vrefselect<cl_uchar>, // uchar
+    vrefselect<cl_uchar>, // char
+    vrefselect<cl_ushort>, // ushort
+    vrefselect<cl_ushort>, // short
+    vrefselect<cl_ushort>, // half
+    vrefselect<cl_uint>, // uint
+    vrefselect<cl_uint>, // int
+    vrefselect<cl_uint>, // float
+    vrefselect<cl_ulong>, // ulong
+    vrefselect<cl_ulong>, // long
+    vrefselect<cl_ulong> // double
 };
 
 
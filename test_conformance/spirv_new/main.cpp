@@ -17,6 +17,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "procs.h"
+#include "module_cache.h"
 #if !defined(_WIN32)
 #include <unistd.h>
 #endif
@@ -64,10 +65,15 @@ std::vector<unsigned char> readBinary(const char *file_name)
 }
 
 
+static std::string spirvModulePath(const char *file_name)
+{
+    return spvBinariesPath + slash + file_name + spvExt + gAddrWidth;
+}
+
 std::vector<unsigned char> readSPIRV(const char *file_name)
 {
-    std::string full_name_str = spvBinariesPath + slash + file_name + spvExt + gAddrWidth;
-    return readBinary(full_name_str.c_str());
+    SpirvModule module = get_spirv_module(spirvModulePath(file_name));
+    return std::vector<unsigned char>(module.data, module.data + module.size);
 }
 
 test_definition *spirvTestsRegistry::getTestDefinitions()
@@ -152,16 +158,19 @@ int get_program_with_il(clProgramWrapper &prog, const cl_device_id deviceID,
         return offline_get_program_with_il(prog, deviceID, context, prog_name);
     }
 
-    std::vector<unsigned char> buffer_vec = readSPIRV(prog_name);
+    std::string path = spirvModulePath(prog_name);
+    SpirvModule module = get_spirv_module(path);
 
-    int file_bytes = buffer_vec.size();
-    if (file_bytes == 0)
-    {
-        log_error("File %s not found\n", prog_name);
-        return -1;
-    }
+    // get_spirv_module() has logged the missing file
+    size_t file_bytes = module.size;
+    if (file_bytes == 0) return -1;
+
+    // Programs with specialization constants differ from the plain build
+    bool cacheable = spec_const_def.spec_value == NULL;
+    if (cacheable && find_cached_program(prog, context, deviceID, path))
+        return CL_SUCCESS;
 
-    unsigned char *buffer = &buffer_vec[0];
+    const unsigned char *buffer = module.data;
     if (gCoreILProgram)
     {
         prog = clCreateProgramWithIL(context, buffer, file_bytes, &err);
@@ -203,6 +212,8 @@ int get_program_with_il(clProgramWrapper &prog, const cl_device_id deviceID,
     err = clBuildProgram(prog, 1, &deviceID, NULL, NULL, NULL);
     SPIRV_CHECK_ERROR(err, "Failed to build program");
 
+    if (cacheable) cache_program(prog, context, deviceID, path);
+
     return err;
 }
 
@@ -270,8 +281,10 @@ int main(int argc, const char *argv[])
        printUsage();
     }
 
-    return runTestHarnessWithCheck(
+    int result = runTestHarnessWithCheck(
         argc, argv, spirvTestsRegistry::getInstance().getNumTests(),
         spirvTestsRegistry::getInstance().getTestDefinitions(), false, 0,
         InitCL);
+    release_spirv_caches();
+    return result;
 }
@@ -0,0 +1,166 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "module_cache.h"
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// A module file, mapped read-only where mmap is available and read into
+// memory otherwise
+class ModuleFile {
+public:
+    ~ModuleFile()
+    {
+#if !defined(_WIN32)
+        if (mapping != nullptr) munmap(mapping, size);
+#endif
+    }
+
+    bool load(const std::string &path)
+    {
+#if !defined(_WIN32)
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            void *map = mmap(nullptr, (size_t)info.st_size, PROT_READ,
+                             MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED)
+            {
+                mapping = map;
+                size = (size_t)info.st_size;
+            }
+        }
+        close(fd);
+        if (mapping != nullptr) return true;
+#endif
+        // Fall back to reading the whole file
+        std::ifstream file(path,
+                           std::ios::in | std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return false;
+        std::streamoff end = file.tellg();
+        if (end <= 0) return false;
+        bytes.resize((size_t)end);
+        file.seekg(0, std::ios::beg);
+        file.read((char *)bytes.data(), bytes.size());
+        if (!file || (size_t)file.gcount() != bytes.size()) return false;
+        size = bytes.size();
+        return true;
+    }
+
+    SpirvModule module() const
+    {
+        const unsigned char *data = mapping != nullptr
+            ? (const unsigned char *)mapping
+            : bytes.data();
+        return SpirvModule{ data, size };
+    }
+
+private:
+    void *mapping = nullptr;
+    std::vector<unsigned char> bytes;
+    size_t size = 0;
+};
+
+struct CacheStats
+{
+    size_t module_loads = 0;
+    size_t module_hits = 0;
+    size_t module_bytes = 0;
+    size_t program_builds = 0;
+    size_t program_hits = 0;
+};
+
+std::map<std::string, std::unique_ptr<ModuleFile>> modules;
+
+// Programs belong to a context and the harness creates one per test, so only
+// the programs of the most recent context are kept
+cl_context program_context = nullptr;
+std::map<std::pair<cl_device_id, std::string>, clProgramWrapper> programs;
+
+CacheStats stats;
+
+void select_context(cl_context context)
+{
+    if (context == program_context) return;
+    programs.clear();
+    program_context = context;
+}
+
+} // namespace
+
+SpirvModule get_spirv_module(const std::string &path)
+{
+    auto found = modules.find(path);
+    if (found != modules.end())
+    {
+        stats.module_hits++;
+        return found->second->module();
+    }
+
+    std::unique_ptr<ModuleFile> file(new ModuleFile);
+    if (!file->load(path))
+    {
+        log_error("File %s not found or not readable\n", path.c_str());
+        return SpirvModule{ nullptr, 0 };
+    }
+    stats.module_loads++;
+    stats.module_bytes += file->module().size;
+    SpirvModule module = file->module();
+    modules[path] = std::move(file);
+    return module;
+}
+
+bool find_cached_program(clProgramWrapper &prog, cl_context context,
+                         cl_device_id device, const std::string &path)
+{
+    select_context(context);
+    auto found = programs.find(std::make_pair(device, path));
+    if (found == programs.end()) return false;
+    stats.program_hits++;
+    prog = found->second;
+    return true;
+}
+
+void cache_program(const clProgramWrapper &prog, cl_context context,
+                   cl_device_id device, const std::string &path)
+{
+    select_context(context);
+    stats.program_builds++;
+    programs[std::make_pair(device, path)] = prog;
+}
+
+void release_spirv_caches()
+{
+    select_context(nullptr);
+    log_info("SPIR-V module cache: %zu files loaded (%zu bytes), %zu reuses; "
+             "program cache: %zu builds, %zu reuses\n",
+             stats.module_loads, stats.module_bytes, stats.module_hits,
+             stats.program_builds, stats.program_hits);
+}
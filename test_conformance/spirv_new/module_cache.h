@@ -0,0 +1,51 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef SPIRV_NEW_MODULE_CACHE_H
+#define SPIRV_NEW_MODULE_CACHE_H
+
+#include "harness/typeWrappers.h"
+
+#include <stddef.h>
+
+#include <string>
+
+// SPIR-V module files are read once per process and kept mapped, and the
+// programs built from them are reused by later requests in the same context.
+
+// Contents of a module file, valid until the end of the process. size is 0
+// when the file could not be read.
+struct SpirvModule
+{
+    const unsigned char *data;
+    size_t size;
+};
+
+// Returns the module stored at path, which includes the address width
+// suffix, loading it on first use
+SpirvModule get_spirv_module(const std::string &path);
+
+// Sets prog to the program built from the module at path for this context
+// and device, if there is one. Programs created with specialization
+// constants must not be cached.
+bool find_cached_program(clProgramWrapper &prog, cl_context context,
+                         cl_device_id device, const std::string &path);
+void cache_program(const clProgramWrapper &prog, cl_context context,
+                   cl_device_id device, const std::string &path);
+
+// Releases the cached programs and logs how often the caches were hit
+void release_spirv_caches();
+
+#endif // SPIRV_NEW_MODULE_CACHE_H
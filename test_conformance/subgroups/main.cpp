@@ -21,7 +21,7 @@
 #include "harness/testHarness.h"
 #include "CL/cl_half.h"
 
-MTdata gMTdata;
+thread_local MTdata gMTdata;
 cl_half_rounding_mode g_rounding_mode;
 
 test_definition test_list[] = {
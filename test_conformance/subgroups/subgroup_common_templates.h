@@ -402,6 +402,53 @@ void generate_inputs(Ty *x, Ty *t, cl_int *m, int ns, int nw, int ng)
     }
 }
 
+// Reference for the uniform case of the reduce and scan checks, where every
+// work-item of a sub group is active. A sub group is checked with flat loops
+// over contiguous storage, which the compiler can vectorize, instead of
+// walking a set of active work-items. The operations are applied in the same
+// order as in the generic path, so floating point results are identical. On
+// a mismatch the generic path runs to report it.
+template <typename Ty, ArithmeticOp operation> struct UniformReference
+{
+    static constexpr bool supported = std::is_arithmetic<Ty>::value
+        && (operation == ArithmeticOp::add_ || operation == ArithmeticOp::max_
+            || operation == ArithmeticOp::min_);
+
+    static bool check_reduce(const Ty *in, const Ty *out, int n)
+    {
+        Ty tr = in[0];
+        for (int i = 1; i < n; ++i) tr = calculate<Ty>(tr, in[i], operation);
+        bool match = true;
+        for (int i = 0; i < n; ++i) match &= compare_ordered<Ty>(out[i], tr);
+        return match;
+    }
+
+    static bool check_scan_inclusive(const Ty *in, const Ty *out, int n)
+    {
+        if (n == 1) return compare_ordered<Ty>(out[0], in[0]);
+        Ty tr = TypeManager<Ty>::identify_limits(operation);
+        bool match = true;
+        for (int i = 0; i < n; ++i)
+        {
+            tr = calculate<Ty>(tr, in[i], operation);
+            match &= compare_ordered<Ty>(out[i], tr);
+        }
+        return match;
+    }
+
+    static bool check_scan_exclusive(const Ty *in, const Ty *out, int n)
+    {
+        Ty tr = TypeManager<Ty>::identify_limits(operation);
+        bool match = true;
+        for (int i = 0; i < n; ++i)
+        {
+            match &= compare_ordered<Ty>(out[i], tr);
+            tr = calculate<Ty>(tr, in[i], operation);
+        }
+        return match;
+    }
+};
+
 template <typename Ty, ShuffleOp operation> struct SHF
 {
     static void log_test(const WorkGroupParams &test_params,
@@ -597,7 +644,8 @@ template <typename Ty, ArithmeticOp operation> struct SCEX_NU
                                      : "sub_group_scan_exclusive");
 
         // for uniform case take into consideration all workitems
-        if (!work_items_mask.any())
+        bool uniform = !work_items_mask.any();
+        if (uniform)
         {
             work_items_mask.set();
         }
@@ -613,6 +661,12 @@ template <typename Ty, ArithmeticOp operation> struct SCEX_NU
             {
                 ii = j * ns;
                 n = ii + ns > nw ? nw - ii : ns;
+                if (uniform && UniformReference<Ty, operation>::supported
+                    && UniformReference<Ty, operation>::check_scan_exclusive(
+                        &mx[ii], &my[ii], n))
+                {
+                    continue;
+                }
                 std::set<int> active_work_items;
                 for (i = 0; i < n; ++i)
                 {
@@ -697,7 +751,8 @@ template <typename Ty, ArithmeticOp operation> struct SCIN_NU
                                      : "sub_group_scan_inclusive");
 
         // for uniform case take into consideration all workitems
-        if (!work_items_mask.any())
+        bool uniform = !work_items_mask.any();
+        if (uniform)
         {
             work_items_mask.set();
         }
@@ -715,6 +770,12 @@ template <typename Ty, ArithmeticOp operation> struct SCIN_NU
             {
                 ii = j * ns;
                 n = ii + ns > nw ? nw - ii : ns;
+                if (uniform && UniformReference<Ty, operation>::supported
+                    && UniformReference<Ty, operation>::check_scan_inclusive(
+                        &mx[ii], &my[ii], n))
+                {
+                    continue;
+                }
                 std::set<int> active_work_items;
                 int catch_frist_active = -1;
 
@@ -806,6 +867,7 @@ template <typename Ty, ArithmeticOp operation> struct RED_NU
         int nj = (nw + ns - 1) / ns;
         ng = ng / nw;
         Ty tr, rr;
+        bool uniform = !work_items_mask.any();
 
         std::string func_name = (test_params.all_work_item_masks.size() > 0
                                      ? "sub_group_non_uniform_reduce"
@@ -830,6 +892,12 @@ template <typename Ty, ArithmeticOp operation> struct RED_NU
             {
                 ii = j * ns;
                 n = ii + ns > nw ? nw - ii : ns;
+                if (uniform && UniformReference<Ty, operation>::supported
+                    && UniformReference<Ty, operation>::check_reduce(
+                        &mx[ii], &my[ii], n))
+                {
+                    continue;
+                }
                 std::set<int> active_work_items;
                 int catch_frist_active = -1;
                 for (i = 0; i < n; ++i)
@@ -207,6 +207,35 @@ void set_last_workgroup_params(int non_uniform_size, int &number_of_subgroups,
     workgroup_size = non_uniform_size;
 }
 
+std::vector<WorkGroupPartition>
+partition_work_groups(const WorkGroupParams &test_params)
+{
+    size_t global = test_params.global_workgroup_size;
+    size_t local = test_params.local_workgroup_size;
+    size_t groups = global / local;
+    size_t groups_per_partition =
+        std::max<size_t>(1, ITEMS_PER_REFERENCE_PARTITION / local);
+    std::vector<WorkGroupPartition> partitions;
+
+    // Tests with a dynamic input/output scale do not lay out their data per
+    // work-item, keep them in a single partition
+    if (test_params.dynsc != 0 || groups <= groups_per_partition)
+    {
+        partitions.push_back({ 0, global });
+        return partitions;
+    }
+
+    for (size_t first = 0; first < groups; first += groups_per_partition)
+    {
+        size_t count = std::min(groups_per_partition, groups - first);
+        size_t items = count * local;
+        // The last partition also owns the non-uniform work-group
+        if (first + count == groups) items += global % local;
+        partitions.push_back({ first, items });
+    }
+    return partitions;
+}
+
 void fill_and_shuffle_safe_values(std::vector<cl_ulong> &safe_values,
                                   size_t sb_size)
 {
@@ -20,7 +20,9 @@
 #include "kernelHelpers.h"
 #include "typeWrappers.h"
 #include "imageHelpers.h"
+#include "ThreadPool.h"
 
+#include <algorithm>
 #include <limits>
 #include <vector>
 #include <type_traits>
@@ -28,7 +30,9 @@
 #include <regex>
 #include <map>
 
-extern MTdata gMTdata;
+// Per-thread generator used by the Fns::gen implementations. Reference data
+// is generated on the thread pool, see PartitionedReference.
+extern thread_local MTdata gMTdata;
 typedef std::bitset<128> bs128;
 extern cl_half_rounding_mode g_rounding_mode;
 
@@ -1291,14 +1295,131 @@ inline bool compare_ordered(const subgroups::cl_half &lhs, const int &rhs)
     return cl_half_to_float(lhs.data) == rhs;
 }
 
+// Number of work-items in each partition of the reference generation and
+// verification. Partitions only depend on the NDRange, so the generated data
+// and the reported results do not depend on the number of threads.
+static const size_t ITEMS_PER_REFERENCE_PARTITION = 16384;
+
+struct WorkGroupPartition
+{
+    size_t first_group; // index of the first work-group of the partition
+    size_t global_size; // work-items in the partition, non-uniform tail incl.
+};
+
+std::vector<WorkGroupPartition>
+partition_work_groups(const WorkGroupParams &test_params);
+
+// Runs Fns::gen and Fns::chk partitioned per work-group on the harness thread
+// pool. Each partition sees a WorkGroupParams whose global size only covers
+// its own work-groups, and gets its own scratch buffers for the per
+// work-group mapping, so the Fns implementations need no changes.
+template <typename Ty, typename Fns> class PartitionedReference {
+public:
+    static void gen(Ty *x, cl_int *m, const WorkGroupParams &test_params)
+    {
+        JobInfo info(x, nullptr, m, test_params);
+        // Every partition generates its data from its own seed, drawn in
+        // partition order from the generator of the calling thread
+        info.seeds.resize(info.partitions.size());
+        for (size_t i = 0; i < info.seeds.size(); i++)
+            info.seeds[i] = gMTdata ? genrand_int32(gMTdata) : (cl_uint)i;
+        run_jobs(gen_job, info);
+    }
+
+    static test_status chk(Ty *x, Ty *y, cl_int *m,
+                           const WorkGroupParams &test_params)
+    {
+        JobInfo info(x, y, m, test_params);
+        run_jobs(chk_job, info);
+
+        test_status status = TEST_PASS;
+        for (size_t i = 0; i < info.status.size(); i++)
+        {
+            if (info.status[i] == TEST_FAIL) return TEST_FAIL;
+            if (status == TEST_PASS) status = info.status[i];
+        }
+        return status;
+    }
+
+private:
+    struct JobInfo
+    {
+        JobInfo(Ty *x_, Ty *y_, cl_int *m_, const WorkGroupParams &params_)
+            : x(x_), y(y_), m(m_), params(params_),
+              partitions(partition_work_groups(params_)),
+              status(partitions.size(), TEST_PASS)
+        {}
+        Ty *x;
+        Ty *y;
+        cl_int *m;
+        const WorkGroupParams &params;
+        std::vector<WorkGroupPartition> partitions;
+        std::vector<cl_uint> seeds;
+        std::vector<test_status> status;
+    };
+
+    static void run_jobs(TPFuncPtr job, JobInfo &info)
+    {
+        cl_uint count = (cl_uint)info.partitions.size();
+        if (count == 1 || ThreadPool_Do(job, count, &info) != CL_SUCCESS)
+        {
+            for (cl_uint i = 0; i < count; i++) job(i, 0, &info);
+        }
+    }
+
+    static WorkGroupParams partition_params(const JobInfo &info,
+                                            const WorkGroupPartition &part)
+    {
+        WorkGroupParams params = info.params;
+        params.global_workgroup_size = part.global_size;
+        return params;
+    }
+
+    static cl_int gen_job(cl_uint job_id, cl_uint thread_id, void *userInfo)
+    {
+        JobInfo &info = *static_cast<JobInfo *>(userInfo);
+        const WorkGroupPartition &part = info.partitions[job_id];
+        size_t offset = part.first_group * info.params.local_workgroup_size;
+        std::vector<Ty> mapin(info.params.local_workgroup_size);
+
+        MTdata saved = gMTdata;
+        gMTdata = init_genrand(info.seeds[job_id]);
+        Fns::gen(info.x + offset, mapin.data(), info.m + 4 * offset,
+                 partition_params(info, part));
+        free_mtdata(gMTdata);
+        gMTdata = saved;
+        return CL_SUCCESS;
+    }
+
+    static cl_int chk_job(cl_uint job_id, cl_uint thread_id, void *userInfo)
+    {
+        JobInfo &info = *static_cast<JobInfo *>(userInfo);
+        const WorkGroupPartition &part = info.partitions[job_id];
+        size_t offset = part.first_group * info.params.local_workgroup_size;
+        std::vector<Ty> mapin(info.params.local_workgroup_size);
+        std::vector<Ty> mapout(info.params.local_workgroup_size);
+
+        info.status[job_id] =
+            Fns::chk(info.x + offset, info.y + offset, mapin.data(),
+                     mapout.data(), info.m + 4 * offset,
+                     partition_params(info, part));
+        if (info.status[job_id] == TEST_FAIL && part.first_group != 0)
+        {
+            log_error("ERROR: group numbers above are relative to work-group "
+                      "%zu\n",
+                      part.first_group);
+        }
+        return CL_SUCCESS;
+    }
+};
+
 template <typename Ty, typename Fns> class KernelExecutor {
 public:
     KernelExecutor(cl_context c, cl_command_queue q, cl_kernel k, size_t g,
-                   size_t l, Ty *id, size_t is, Ty *mid, Ty *mod, cl_int *md,
-                   size_t ms, Ty *od, size_t os, size_t ts = 0)
+                   size_t l, Ty *id, size_t is, cl_int *md, size_t ms, Ty *od,
+                   size_t os, size_t ts = 0)
         : context(c), queue(q), kernel(k), global(g), local(l), idata(id),
-          isize(is), mapin_data(mid), mapout_data(mod), mdata(md), msize(ms),
-          odata(od), osize(os), tsize(ts)
+          isize(is), mdata(md), msize(ms), odata(od), osize(os), tsize(ts)
     {
         has_status = false;
         run_failed = false;
@@ -1310,8 +1431,6 @@ public:
     size_t local;
     Ty *idata;
     size_t isize;
-    Ty *mapin_data;
-    Ty *mapout_data;
     cl_int *mdata;
     size_t msize;
     Ty *odata;
@@ -1403,8 +1522,8 @@ private:
             return status;
         }
 
-        test_status tmp_status =
-            Fns::chk(idata, odata, mapin_data, mapout_data, mdata, test_params);
+        test_status tmp_status = PartitionedReference<Ty, Fns>::chk(
+            idata, odata, mdata, test_params);
 
         if (!has_status || tmp_status == TEST_FAIL
             || (tmp_status == TEST_PASS && status != TEST_FAIL))
@@ -1464,10 +1583,6 @@ template <typename Ty, typename Fns, size_t TSIZE = 0> struct test
         cl_platform_id platform;
         std::vector<cl_int> sgmap;
         sgmap.resize(4 * global);
-        std::vector<Ty> mapin;
-        mapin.resize(local);
-        std::vector<Ty> mapout;
-        mapout.resize(local);
         std::stringstream kernel_sstr;
 
         Fns::log_test(test_params, "");
@@ -1598,8 +1713,8 @@ template <typename Ty, typename Fns, size_t TSIZE = 0> struct test
 
         KernelExecutor<Ty, Fns> executor(
             context, queue, kernel, global, local, idata.data(),
-            input_array_size * sizeof(Ty), mapin.data(), mapout.data(),
-            sgmap.data(), global * sizeof(cl_int4), odata.data(),
+            input_array_size * sizeof(Ty), sgmap.data(),
+            global * sizeof(cl_int4), odata.data(),
             output_array_size * sizeof(Ty), TSIZE * sizeof(Ty));
 
         // Run the kernel once on zeroes to get the map
@@ -1609,7 +1724,8 @@ template <typename Ty, typename Fns, size_t TSIZE = 0> struct test
 
         // Generate the desired input for the kernel
         test_params.subgroup_size = subgroup_size;
-        Fns::gen(idata.data(), mapin.data(), sgmap.data(), test_params);
+        PartitionedReference<Ty, Fns>::gen(idata.data(), sgmap.data(),
+                                           test_params);
 
         test_status status;
 
@@ -21,6 +21,8 @@
 #include <sys/stat.h>
 
 #include "procs.h"
+#include "harness/ThreadPool.h"
+#include "harness/patternHelpers.h"
 
 #define ITERATIONS 4
 #define DEBUG 0
@@ -292,6 +294,192 @@ char *print_dimensions2(size_t x, size_t y, size_t z, cl_uint dim)
 }
 
 
+// Elements verified per thread pool job
+#define VERIFY_CHUNK_ELEMENTS (1 << 20)
+
+struct VerifyJob
+{
+    const cl_uint *data;
+    cl_uint count;
+    volatile cl_int errors;
+};
+
+// Every work-item increments its element once, so all elements must be 1
+static cl_int verify_chunk(cl_uint job_id, cl_uint thread_id, void *userInfo)
+{
+    VerifyJob *job = (VerifyJob *)userInfo;
+    cl_uint start = job_id * VERIFY_CHUNK_ELEMENTS;
+    cl_uint count = job->count - start < VERIFY_CHUNK_ELEMENTS
+        ? job->count - start
+        : VERIFY_CHUNK_ELEMENTS;
+    const cl_uint *data = job->data + start;
+    const cl_uint expected = 1;
+
+    if (verify_pattern(data, count * sizeof(cl_uint), &expected,
+                       sizeof(expected))
+        == PATTERN_MATCH)
+        return CL_SUCCESS;
+
+    cl_int errors = 0;
+    for (cl_uint i = 0; i < count; i++)
+        if (data[i] != expected) errors++;
+    ThreadPool_AtomicAdd(&job->errors, errors);
+    return CL_SUCCESS;
+}
+
+static int count_errors(const cl_uint *data, cl_uint count)
+{
+    VerifyJob job = { data, count, 0 };
+    cl_uint jobs = (count + VERIFY_CHUNK_ELEMENTS - 1) / VERIFY_CHUNK_ELEMENTS;
+    if (jobs == 1)
+        verify_chunk(0, 0, &job);
+    else
+        ThreadPool_Do(verify_chunk, jobs, &job);
+    return job.errors;
+}
+
+/*
+ Overlaps the host verification of one kernel execution with the next
+ execution on the device. Executions alternate between two buffers when a
+ second one could be allocated: the results of an execution are mapped
+ without blocking, and only checked once the next execution has been
+ enqueued. With a single buffer every execution is verified before the
+ buffer is reused.
+ */
+class VerificationPipeline {
+public:
+    VerificationPipeline(cl_command_queue queue, cl_mem *arrays,
+                         int array_count)
+        : queue(queue), array_count(array_count), next(0)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            this->arrays[i] = i < array_count ? arrays[i] : NULL;
+            pending[i].event = NULL;
+        }
+    }
+
+    ~VerificationPipeline() { discard(); }
+
+    // Returns the buffer for the next execution, verifying its previous
+    // results first if needed. Returns the number of errors found, or a
+    // negative value on failure.
+    int acquire(cl_mem *array)
+    {
+        int errors = complete(next);
+        *array = arrays[next];
+        return errors;
+    }
+
+    // Maps the first count elements of the buffer returned by acquire() once
+    // the execution using it completes, and verifies the results of the
+    // other buffer in the meantime
+    int submit(cl_uint count, const char *label)
+    {
+        Pending &p = pending[next];
+        int err;
+        p.count = count;
+        snprintf(p.label, sizeof(p.label), "%s", label);
+        p.mapped = clEnqueueMapBuffer(queue, arrays[next], CL_FALSE,
+                                      CL_MAP_READ, 0, count * sizeof(cl_uint),
+                                      0, NULL, &p.event, &err);
+        if (err != CL_SUCCESS)
+        {
+            print_error(err, "Failed to map results\n");
+            return -4;
+        }
+        err = clFlush(queue);
+        if (err != CL_SUCCESS)
+        {
+            print_error(err, "Failed to flush\n");
+            return -4;
+        }
+
+        int current = next;
+        next = (next + 1) % array_count;
+        return next == current ? 0 : complete(next);
+    }
+
+    // Verifies all outstanding results
+    int finish()
+    {
+        int errors = 0;
+        for (int i = 0; i < array_count; i++)
+        {
+            int err = complete((next + i) % array_count);
+            if (err < 0) return err;
+            errors += err;
+        }
+        return errors;
+    }
+
+    // Unmaps the outstanding results without verifying them and waits for
+    // the queue to drain, so that the buffers can be released after a
+    // failure
+    void discard()
+    {
+        for (int i = 0; i < array_count; i++)
+        {
+            Pending &p = pending[i];
+            if (p.event == NULL) continue;
+            if (clWaitForEvents(1, &p.event) == CL_SUCCESS)
+                clEnqueueUnmapMemObject(queue, arrays[i], p.mapped, 0, NULL,
+                                        NULL);
+            clReleaseEvent(p.event);
+            p.event = NULL;
+        }
+        clFinish(queue);
+    }
+
+private:
+    struct Pending
+    {
+        cl_event event; // map, NULL when nothing is pending
+        void *mapped;
+        cl_uint count;
+        char label[256];
+    };
+
+    int complete(int index)
+    {
+        Pending &p = pending[index];
+        if (p.event == NULL) return 0;
+
+        int err = clWaitForEvents(1, &p.event);
+        clReleaseEvent(p.event);
+        p.event = NULL;
+        if (err != CL_SUCCESS)
+        {
+            print_error(err, "Failed to map results\n");
+            return -4;
+        }
+
+        int errors = count_errors((const cl_uint *)p.mapped, p.count);
+
+        err = clEnqueueUnmapMemObject(queue, arrays[index], p.mapped, 0, NULL,
+                                      NULL);
+        if (err != CL_SUCCESS)
+        {
+            print_error(err, "Failed to unmap results\n");
+            return -4;
+        }
+
+        if (errors)
+        {
+            log_error("%d errors.\n", errors);
+            log_error("Test %s failed.\n", p.label);
+        }
+        return errors;
+    }
+
+    cl_command_queue queue;
+    cl_mem arrays[2];
+    Pending pending[2];
+    int array_count;
+    int next;
+};
+
+
 /*
  This tests thread dimensions by executing a kernel across a range of
  dimensions. Each kernel instance does an atomic write into a specific location
@@ -301,7 +489,8 @@ char *print_dimensions2(size_t x, size_t y, size_t z, cl_uint dim)
  multiple times.
  */
 int run_test(cl_context context, cl_command_queue queue, cl_kernel kernel,
-             cl_mem array, cl_uint memory_size, cl_uint dimensions,
+             VerificationPipeline &pipeline, cl_uint memory_size,
+             cl_uint dimensions,
              cl_uint final_x_size, cl_uint final_y_size, cl_uint final_z_size,
              cl_uint local_x_size, cl_uint local_y_size, cl_uint local_z_size,
              int explict_local)
@@ -332,10 +521,23 @@ int run_test(cl_context context, cl_command_queue queue, cl_kernel kernel,
     // log_info("Last memory address: %llu, memory_size: %llu\n",
     // last_memory_address, memory_size);
 
+    char label[256];
+    snprintf(label, sizeof(label), "global %s local %s",
+             print_dimensions(final_x_size, final_y_size, final_z_size,
+                              dimensions),
+             print_dimensions2(local_x_size, local_y_size, local_z_size,
+                               dimensions));
+
     while (end_valid_memory_address <= last_memory_address)
     {
         int err;
         const int fill_pattern = 0x0;
+        cl_mem array;
+
+        err = pipeline.acquire(&array);
+        if (err < 0) return err;
+        errors += err;
+
         err = clEnqueueFillBuffer(queue, array, (void *)&fill_pattern,
                                   sizeof(fill_pattern), 0, memory_size, 0, NULL,
                                   NULL);
@@ -420,53 +622,13 @@ int run_test(cl_context context, cl_command_queue queue, cl_kernel kernel,
             return -3;
         }
 
-        void *mapped = clEnqueueMapBuffer(queue, array, CL_TRUE, CL_MAP_READ, 0,
-                                          memory_size, 0, NULL, NULL, &err);
-        if (err != CL_SUCCESS)
-        {
-            print_error(err, "Failed to map results\n");
-            return -4;
-        }
-        cl_uint *data = (cl_uint *)mapped;
-
         // Verify the data
-        cl_uint i;
         cl_uint last_address =
             (cl_uint)(end_valid_memory_address - start_valid_memory_address)
             / (cl_uint)sizeof(cl_uint);
-        for (i = 0; i < last_address; i++)
-        {
-            if (i < last_address)
-            {
-                if (data[i] != 1)
-                {
-                    errors++;
-                    //        log_info("%d expected 1 got %d\n", i, data[i]);
-                }
-            }
-            else
-            {
-                if (data[i] != 0)
-                {
-                    errors++;
-                    log_info("%d expected 0 got %d\n", i, data[i]);
-                }
-            }
-        }
-
-        err = clEnqueueUnmapMemObject(queue, array, mapped, 0, NULL, NULL);
-        if (err != CL_SUCCESS)
-        {
-            print_error(err, "Failed to unmap results\n");
-            return -4;
-        }
-
-        err = clFlush(queue);
-        if (err != CL_SUCCESS)
-        {
-            print_error(err, "Failed to flush\n");
-            return -4;
-        }
+        err = pipeline.submit(last_address, label);
+        if (err < 0) return err;
+        errors += err;
 
         // Increment the addresses
         if (end_valid_memory_address == last_memory_address) break;
@@ -477,7 +639,6 @@ int run_test(cl_context context, cl_command_queue queue, cl_kernel kernel,
             end_valid_memory_address = last_memory_address;
     }
 
-    if (errors) log_error("%d errors.\n", errors);
     return errors;
 }
 
@@ -663,6 +824,19 @@ int test_thread_dimensions(cl_device_id device, cl_context context,
                  memory_size / (1024.0 * 1024.0));
     }
 
+    // A second buffer lets the next kernel run while the results of the
+    // previous one are verified
+    cl_mem arrays[2] = { array, NULL };
+    int array_count = 1;
+    if ((cl_ulong)memory_size * 2 <= max_physical / 2)
+    {
+        arrays[1] =
+            clCreateBuffer(context, CL_MEM_READ_WRITE, memory_size, NULL, &err);
+        if (err == CL_SUCCESS) array_count = 2;
+    }
+    if (array_count == 1)
+        log_info("Note: verification is not overlapped with execution.\n");
+
     int errors = 0;
     // Each dimension's size is multiplied by this amount on each iteration.
     //  uint size_increase_per_iteration = 4;
@@ -710,6 +884,7 @@ int test_thread_dimensions(cl_device_id device, cl_context context,
         log_info("Testing with buffer step %d.\n", bufferStep);
     }
     cl_uint x_size, y_size, z_size;
+    VerificationPipeline pipeline(queue, arrays, array_count);
 
     d = init_genrand(gRandomSeed);
     z_size = min_z_size;
@@ -1032,34 +1207,20 @@ int test_thread_dimensions(cl_device_id device, cl_context context,
                             }
                         }
 
-                        err =
-                            run_test(context, queue, kernel, array, memory_size,
-                                     dimensions, final_x_size, final_y_size,
-                                     final_z_size, local_x_size, local_y_size,
-                                     local_z_size, explicit_local);
-
-                        // If we failed to execute, then return so we don't
-                        // crash.
-                        if (err < 0)
-                        {
-                            clReleaseMemObject(array);
-                            clReleaseKernel(kernel);
-                            clReleaseProgram(program);
-                            free_mtdata(d);
-                            return -1;
-                        }
+                        err = run_test(context, queue, kernel, pipeline,
+                                       memory_size, dimensions, final_x_size,
+                                       final_y_size, final_z_size,
+                                       local_x_size, local_y_size,
+                                       local_z_size, explicit_local);
 
-                        // Otherwise, if we had errors add them up.
+                        // Stop at the first failure. The verification logs
+                        // the sizes that failed, which may be those of an
+                        // earlier execution.
                         if (err)
                         {
-                            log_error(
-                                "Test global %s local %s failed.\n",
-                                print_dimensions(final_x_size, final_y_size,
-                                                 final_z_size, dimensions),
-                                print_dimensions2(local_x_size, local_y_size,
-                                                  local_z_size, dimensions));
-                            errors++;
+                            pipeline.discard();
                             clReleaseMemObject(array);
+                            if (arrays[1]) clReleaseMemObject(arrays[1]);
                             clReleaseKernel(kernel);
                             clReleaseProgram(program);
                             free_mtdata(d);
@@ -1091,9 +1252,14 @@ int test_thread_dimensions(cl_device_id device, cl_context context,
         if (z_size > max_z_size) z_size = max_z_size;
     } // z_size
 
+    err = pipeline.finish();
+    if (err) errors++;
+    // finish() stops at the first failure to map or unmap
+    if (err < 0) pipeline.discard();
 
     free_mtdata(d);
     clReleaseMemObject(array);
+    if (arrays[1]) clReleaseMemObject(arrays[1]);
     clReleaseKernel(kernel);
     clReleaseProgram(program);
     if (errors) log_error("%d total errors.\n", errors);
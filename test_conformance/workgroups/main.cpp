@@ -17,12 +17,33 @@
 
 #include "harness/testHarness.h"
 #include "procs.h"
+#include <set>
 #include <stdio.h>
 #include <string.h>
+#include <vector>
 #if !defined(_WIN32)
 #include <unistd.h>
 #endif
 
+bool gWorkGroupSweep = false;
+
+std::vector<size_t> get_test_work_group_sizes(size_t max_wg_size)
+{
+    std::vector<size_t> sizes(1, max_wg_size);
+    if (!gWorkGroupSweep) return sizes;
+
+    // Every power of two and its neighbours, which covers both full and
+    // partial sub-groups on any device
+    std::set<size_t> sweep;
+    for (size_t p = 1; p <= max_wg_size; p *= 2)
+    {
+        for (size_t size : { p - 1, p, p + 1 })
+            if (size > 0 && size < max_wg_size) sweep.insert(size);
+    }
+    sizes.insert(sizes.end(), sweep.begin(), sweep.end());
+    return sizes;
+}
+
 test_definition test_list[] = {
     ADD_TEST_VERSION(work_group_all, Version(2, 0)),
     ADD_TEST_VERSION(work_group_any, Version(2, 0)),
@@ -77,6 +98,16 @@ test_status InitCL(cl_device_id device) {
 }
 
 int main(int argc, const char *argv[]) {
-  return runTestHarnessWithCheck(argc, argv, test_num, test_list, false, 0, InitCL);
+  std::vector<const char *> argList;
+  for (int i = 0; i < argc; i++)
+  {
+      if (strcmp(argv[i], "wg_sweep") == 0)
+          gWorkGroupSweep = true;
+      else
+          argList.push_back(argv[i]);
+  }
+
+  return runTestHarnessWithCheck((int)argList.size(), argList.data(), test_num,
+                                 test_list, false, 0, InitCL);
 }
 
@@ -20,6 +20,16 @@
 #include "harness/conversions.h"
 #include "harness/mt19937.h"
 
+#include <vector>
+
+// Set by the wg_sweep argument: the scan and reduce tests then run with
+// work-group sizes around every power of two up to the maximum, not only
+// the maximum
+extern bool gWorkGroupSweep;
+
+// Local sizes to test a kernel with, the maximum allowed one first
+extern std::vector<size_t> get_test_work_group_sizes(size_t max_wg_size);
+
 extern int create_program_and_kernel(const char *source,
                                      const char *kernel_name,
                                      cl_program *program_ret,
@@ -20,7 +20,10 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 
+#include <algorithm>
+
 #include "procs.h"
+#include "wg_verify.h"
 
 
 const char *wg_any_kernel_code =
@@ -36,28 +39,38 @@ const char *wg_any_kernel_code =
 static int
 verify_wg_any(float *inptr, int *outptr, size_t n, size_t wg_size)
 {
-    size_t     i, j;
-
-    for (i=0; i<n; i+=wg_size)
-    {
-        int predicate_any = 0x0;
-        for (j=0; j<((n-i) > wg_size ? wg_size : (n-i)); j++)
-        {
-            if (inptr[i+j] > inptr[i+j+1])
-            {
-                predicate_any = 0xFFFFFFFF;
-                break;
-            }
-        }
-        for (j=0; j<((n-i) > wg_size ? wg_size : (n-i)); j++)
-        {
-            if ( (predicate_any && (outptr[i+j] == 0)) ||
-                 ((predicate_any == 0) && outptr[i+j]) )
+    size_t groups = (n + wg_size - 1) / wg_size;
+    size_t mismatch = verify_parallel(
+        groups, verify_units_per_job(wg_size),
+        [=](size_t first, size_t last) {
+            for (size_t i = first * wg_size; i < std::min(last * wg_size, n);
+                 i += wg_size)
             {
-                log_info("work_group_any: Error at %lu: expected = %d, got = %d\n", i+j, predicate_any, outptr[i+j]);
-                return -1;
+                size_t local_size = std::min(wg_size, n - i);
+                int predicate_any = 0x0;
+                for (size_t j = 0; j < local_size; j++)
+                {
+                    if (inptr[i + j] > inptr[i + j + 1])
+                    {
+                        predicate_any = 0xFFFFFFFF;
+                        break;
+                    }
+                }
+                for (size_t j = 0; j < local_size; j++)
+                {
+                    if ((predicate_any && (outptr[i + j] == 0))
+                        || ((predicate_any == 0) && outptr[i + j]))
+                        return i + j;
+                }
             }
-        }
+            return WG_MATCH;
+        });
+
+    if (mismatch != WG_MATCH)
+    {
+        log_info("work_group_any: Error at %zu: got = %d\n", mismatch,
+                 outptr[mismatch]);
+        return -1;
     }
 
     return 0;
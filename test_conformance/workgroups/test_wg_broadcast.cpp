@@ -23,6 +23,7 @@
 #include <algorithm>
 
 #include "procs.h"
+#include "wg_verify.h"
 
 
 const char *wg_broadcast_1D_kernel_code =
@@ -65,103 +66,116 @@ const char *wg_broadcast_3D_kernel_code =
 static int
 verify_wg_broadcast_1D(float *inptr, float *outptr, size_t n, size_t wg_size)
 {
-    size_t     i, j;
-    size_t     group_id;
-
-    for (i=0,group_id=0; i<n; i+=wg_size,group_id++)
-    {
-        size_t local_size = (n - i) > wg_size ? wg_size : (n - i);
-        float broadcast_result = inptr[i + (group_id % local_size)];
-        for (j=0; j<local_size; j++)
-        {
-            if ( broadcast_result != outptr[i+j] )
+    size_t groups = (n + wg_size - 1) / wg_size;
+    size_t mismatch = verify_parallel(
+        groups, verify_units_per_job(wg_size),
+        [=](size_t first, size_t last) {
+            for (size_t group_id = first; group_id < last; group_id++)
             {
-                log_info("work_group_broadcast: Error at %zu: expected = %f, "
-                         "got = %f\n",
-                         i + j, broadcast_result, outptr[i + j]);
-                return -1;
+                size_t i = group_id * wg_size;
+                size_t local_size = std::min(wg_size, n - i);
+                float broadcast_result = inptr[i + (group_id % local_size)];
+                for (size_t j = 0; j < local_size; j++)
+                {
+                    if (broadcast_result != outptr[i + j]) return i + j;
+                }
             }
-        }
+            return WG_MATCH;
+        });
+
+    if (mismatch != WG_MATCH)
+    {
+        size_t i = mismatch - mismatch % wg_size;
+        size_t local_size = std::min(wg_size, n - i);
+        log_info("work_group_broadcast: Error at %zu: expected = %f, "
+                 "got = %f\n",
+                 mismatch, inptr[i + (i / wg_size) % local_size],
+                 outptr[mismatch]);
+        return -1;
     }
 
     return 0;
 }
 
+// The 2D and 3D checks run on the thread pool one row of the global range
+// at a time. Every element is compared with the input its work-group
+// broadcasts, found from the coordinates of the element alone.
 static int
 verify_wg_broadcast_2D(float *inptr, float *outptr, size_t nx, size_t ny, size_t wg_size_x, size_t wg_size_y)
 {
-    size_t i, j, _i, _j;
-    size_t group_id_x, group_id_y;
-
-    for (i=0,group_id_y=0; i<ny; i+=wg_size_y,group_id_y++)
-    {
-        size_t y = group_id_y % wg_size_y;
-        size_t local_size_y = (ny-i) > wg_size_y ? wg_size_y : (ny-i);
-        for (_i=0; _i < local_size_y; _i++)
-        {
-            for (j=0,group_id_x=0; j<nx; j+=wg_size_x,group_id_x++)
+    size_t mismatch = verify_parallel(
+        ny, verify_units_per_job(nx), [=](size_t first, size_t last) {
+            for (size_t gy = first; gy < last; gy++)
             {
-                size_t x = group_id_x % wg_size_x;
-                size_t local_size_x = (nx-j) > wg_size_x ? wg_size_x : (nx-j);
-                float  broadcast_result = inptr[(i + y) * nx + (j + x)];
-                for (_j=0; _j < local_size_x; _j++)
+                size_t i = gy - gy % wg_size_y;
+                size_t y = (gy / wg_size_y) % wg_size_y;
+                for (size_t gx = 0; gx < nx; gx++)
                 {
-                    size_t indx = (i + _i) * nx + (j + _j);
-                    if ( broadcast_result != outptr[indx] )
-                    {
-                        log_info("work_group_broadcast: Error at (%zu, %zu): "
-                                 "expected = %f, got = %f\n",
-                                 j + _j, i + _i, broadcast_result,
-                                 outptr[indx]);
-                        return -1;
-                    }
+                    size_t j = gx - gx % wg_size_x;
+                    size_t x = (gx / wg_size_x) % wg_size_x;
+                    size_t indx = gy * nx + gx;
+                    if (inptr[(i + y) * nx + (j + x)] != outptr[indx])
+                        return indx;
                 }
             }
-        }
+            return WG_MATCH;
+        });
+
+    if (mismatch != WG_MATCH)
+    {
+        size_t gx = mismatch % nx, gy = mismatch / nx;
+        size_t i = gy - gy % wg_size_y, y = (gy / wg_size_y) % wg_size_y;
+        size_t j = gx - gx % wg_size_x, x = (gx / wg_size_x) % wg_size_x;
+        log_info("work_group_broadcast: Error at (%zu, %zu): "
+                 "expected = %f, got = %f\n",
+                 gx, gy, inptr[(i + y) * nx + (j + x)], outptr[mismatch]);
+        return -1;
     }
 
     return 0;
 }
 
+static size_t
+broadcast_3D_source(size_t gx, size_t gy, size_t gz, size_t nx, size_t ny,
+                    size_t wg_size_x, size_t wg_size_y, size_t wg_size_z)
+{
+    size_t i = gz - gz % wg_size_z, z = (gz / wg_size_z) % wg_size_z;
+    size_t j = gy - gy % wg_size_y, y = (gy / wg_size_y) % wg_size_y;
+    size_t k = gx - gx % wg_size_x, x = (gx / wg_size_x) % wg_size_x;
+    return (i + z) * ny * nx + (j + y) * nx + (k + x);
+}
+
 static int
 verify_wg_broadcast_3D(float *inptr, float *outptr, size_t nx, size_t ny, size_t nz, size_t wg_size_x, size_t wg_size_y, size_t wg_size_z)
 {
-    size_t i, j, k, _i, _j, _k;
-    size_t group_id_x, group_id_y, group_id_z;
-
-    for (i=0,group_id_z=0; i<nz; i+=wg_size_z,group_id_z++)
-    {
-        size_t z = group_id_z % wg_size_z;
-        size_t local_size_z = (nz-i) > wg_size_z ? wg_size_z : (nz-i);
-        for (_i=0; _i < local_size_z; _i++)
-        {
-            for (j=0,group_id_y=0; j<ny; j+=wg_size_y,group_id_y++)
+    size_t mismatch = verify_parallel(
+        ny * nz, verify_units_per_job(nx), [=](size_t first, size_t last) {
+            for (size_t row = first; row < last; row++)
             {
-                size_t y = group_id_y % wg_size_y;
-                size_t local_size_y = (ny-j) > wg_size_y ? wg_size_y : (ny-j);
-                for (_j=0; _j < local_size_y; _j++)
+                size_t gy = row % ny, gz = row / ny;
+                for (size_t gx = 0; gx < nx; gx++)
                 {
-                    for (k=0,group_id_x=0; k<nx; k+=wg_size_x,group_id_x++)
-                    {
-                        size_t x = group_id_x % wg_size_x;
-                        size_t local_size_x = (nx-k) > wg_size_x ? wg_size_x : (nx-k);
-                        float  broadcast_result = inptr[(i + z) * ny * nz + (j + y) * nx + (k + x)];
-                        for (_k=0; _k < local_size_x; _k++)
-                        {
-                            size_t indx = (i + _i) * ny * nx + (j + _j) * nx + (k + _k);
-                            if ( broadcast_result != outptr[indx] )
-                            {
-                                log_info("work_group_broadcast: Error at (%zu, "
-                                         "%zu, %zu): expected = %f, got = %f\n",
-                                         k + _k, j + _j, i + _i,
-                                         broadcast_result, outptr[indx]);
-                                return -1;
-                            }
-                        }
-                    }
+                    size_t indx = row * nx + gx;
+                    size_t source =
+                        broadcast_3D_source(gx, gy, gz, nx, ny, wg_size_x,
+                                            wg_size_y, wg_size_z);
+                    if (inptr[source] != outptr[indx]) return indx;
                 }
             }
-        }
+            return WG_MATCH;
+        });
+
+    if (mismatch != WG_MATCH)
+    {
+        size_t gx = mismatch % nx, gy = mismatch / nx % ny,
+               gz = mismatch / nx / ny;
+        log_info("work_group_broadcast: Error at (%zu, %zu, %zu): "
+                 "expected = %f, got = %f\n",
+                 gx, gy, gz,
+                 inptr[broadcast_3D_source(gx, gy, gz, nx, ny, wg_size_x,
+                                           wg_size_y, wg_size_z)],
+                 outptr[mismatch]);
+        return -1;
     }
 
     return 0;
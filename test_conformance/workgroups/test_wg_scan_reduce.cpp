@@ -17,9 +17,15 @@
 
 #include <algorithm>
 #include <limits>
+#include <string.h>
 #include <vector>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "procs.h"
+#include "wg_verify.h"
 
 static std::string make_kernel_string(const std::string &type,
                                       const std::string &kernelName,
@@ -88,6 +94,148 @@ template <typename T> struct Min
     static T combine(T a, T b) { return std::min(a, b); }
 };
 
+enum class ScanKind
+{
+    reduce,
+    inclusive,
+    exclusive
+};
+
+// Checks out[begin, n) of one work-group against its reduction or scan,
+// starting from the running value init. Returns the offset of the first
+// mismatch or n.
+template <typename C>
+size_t scalar_group_check(const typename C::Type *in,
+                          const typename C::Type *out, size_t begin, size_t n,
+                          ScanKind kind, typename C::Type init)
+{
+    using Type = typename C::Type;
+
+    if (kind == ScanKind::reduce)
+    {
+        Type result = init;
+        for (size_t j = begin; j < n; j++) result = C::combine(result, in[j]);
+        for (size_t j = begin; j < n; j++)
+            if (result != out[j]) return j;
+        return n;
+    }
+
+    Type result = init;
+    for (size_t j = begin; j < n; j++)
+    {
+        Type next = C::combine(result, in[j]);
+        if (out[j] != (kind == ScanKind::inclusive ? next : result)) return j;
+        result = next;
+    }
+    return n;
+}
+
+template <typename C> struct GroupScan
+{
+    static size_t check(const typename C::Type *in,
+                        const typename C::Type *out, size_t n, ScanKind kind)
+    {
+        return scalar_group_check<C>(in, out, 0, n, kind, C::identityValue);
+    }
+};
+
+#ifdef __SSE2__
+// Scans of additions compute a prefix sum of a whole register of elements
+// with shifts, and carry its last lane into the next register
+template <typename T> struct SSE2AddScan
+{
+    static const size_t lanes = sizeof(__m128i) / sizeof(T);
+
+    static __m128i add(__m128i a, __m128i b)
+    {
+        return sizeof(T) == 4 ? _mm_add_epi32(a, b) : _mm_add_epi64(a, b);
+    }
+
+    static __m128i sub(__m128i a, __m128i b)
+    {
+        return sizeof(T) == 4 ? _mm_sub_epi32(a, b) : _mm_sub_epi64(a, b);
+    }
+
+    static __m128i prefix(__m128i x)
+    {
+        if (sizeof(T) == 4) x = add(x, _mm_slli_si128(x, 4));
+        return add(x, _mm_slli_si128(x, 8));
+    }
+
+    static __m128i broadcast_last(__m128i x)
+    {
+        return _mm_shuffle_epi32(x, sizeof(T) == 4 ? 0xFF : 0xEE);
+    }
+
+    static size_t check(const T *in, const T *out, size_t n, ScanKind kind)
+    {
+        if (kind == ScanKind::reduce)
+            return scalar_group_check<Add<T>>(in, out, 0, n, kind, 0);
+
+        __m128i carry = _mm_setzero_si128();
+        size_t j = 0;
+        for (; j + lanes <= n; j += lanes)
+        {
+            __m128i x = _mm_loadu_si128((const __m128i *)(in + j));
+            __m128i inclusive = add(prefix(x), carry);
+            __m128i expected =
+                kind == ScanKind::inclusive ? inclusive : sub(inclusive, x);
+            __m128i equal = _mm_cmpeq_epi8(
+                expected, _mm_loadu_si128((const __m128i *)(out + j)));
+            // The scalar check below locates the mismatching element
+            if (_mm_movemask_epi8(equal) != 0xFFFF) break;
+            carry = broadcast_last(inclusive);
+        }
+        T running;
+        memcpy(&running, &carry, sizeof(running));
+        return scalar_group_check<Add<T>>(in, out, j, n, kind, running);
+    }
+};
+
+template <> struct GroupScan<Add<cl_int>> : SSE2AddScan<cl_int>
+{
+};
+template <> struct GroupScan<Add<cl_uint>> : SSE2AddScan<cl_uint>
+{
+};
+template <> struct GroupScan<Add<cl_long>> : SSE2AddScan<cl_long>
+{
+};
+template <> struct GroupScan<Add<cl_ulong>> : SSE2AddScan<cl_ulong>
+{
+};
+#endif
+
+// Checks the work-groups of wg_size elements concurrently on the thread pool
+template <typename C>
+static int verify_work_groups(const typename C::Type *inptr,
+                              const typename C::Type *outptr, size_t n_elems,
+                              size_t wg_size, ScanKind kind,
+                              const char *testName)
+{
+    size_t groups = (n_elems + wg_size - 1) / wg_size;
+    size_t mismatch = verify_parallel(
+        groups, verify_units_per_job(wg_size),
+        [=](size_t first, size_t last) {
+            for (size_t g = first; g < last; g++)
+            {
+                size_t begin = g * wg_size;
+                size_t size = std::min(wg_size, n_elems - begin);
+                size_t offset = GroupScan<C>::check(inptr + begin,
+                                                    outptr + begin, size, kind);
+                if (offset < size) return begin + offset;
+            }
+            return WG_MATCH;
+        });
+    if (mismatch != WG_MATCH)
+    {
+        log_info("%s_%s: Error at %zu (work-group size %zu)\n", testName,
+                 C::opName, mismatch, wg_size);
+        return -1;
+    }
+    return 0;
+}
+
 template <typename C> struct Reduce
 {
     using Type = typename C::Type;
@@ -100,27 +248,8 @@ template <typename C> struct Reduce
     static int verify(Type *inptr, Type *outptr, size_t n_elems,
                       size_t max_wg_size)
     {
-        for (size_t i = 0; i < n_elems; i += max_wg_size)
-        {
-            size_t wg_size = std::min(max_wg_size, n_elems - i);
-
-            Type result = C::identityValue;
-            for (size_t j = 0; j < wg_size; j++)
-            {
-                result = C::combine(result, inptr[i + j]);
-            }
-
-            for (size_t j = 0; j < wg_size; j++)
-            {
-                if (result != outptr[i + j])
-                {
-                    log_info("%s_%s: Error at %zu\n", testName, testOpName,
-                             i + j);
-                    return -1;
-                }
-            }
-        }
-        return 0;
+        return verify_work_groups<C>(inptr, outptr, n_elems, max_wg_size,
+                                     ScanKind::reduce, testName);
     }
 };
 
@@ -136,23 +265,8 @@ template <typename C> struct ScanInclusive
     static int verify(Type *inptr, Type *outptr, size_t n_elems,
                       size_t max_wg_size)
     {
-        for (size_t i = 0; i < n_elems; i += max_wg_size)
-        {
-            size_t wg_size = std::min(max_wg_size, n_elems - i);
-
-            Type result = C::identityValue;
-            for (size_t j = 0; j < wg_size; ++j)
-            {
-                result = C::combine(result, inptr[i + j]);
-                if (result != outptr[i + j])
-                {
-                    log_info("%s_%s: Error at %zu\n", testName, testOpName,
-                             i + j);
-                    return -1;
-                }
-            }
-        }
-        return 0;
+        return verify_work_groups<C>(inptr, outptr, n_elems, max_wg_size,
+                                     ScanKind::inclusive, testName);
     }
 };
 
@@ -168,23 +282,8 @@ template <typename C> struct ScanExclusive
     static int verify(Type *inptr, Type *outptr, size_t n_elems,
                       size_t max_wg_size)
     {
-        for (size_t i = 0; i < n_elems; i += max_wg_size)
-        {
-            size_t wg_size = std::min(max_wg_size, n_elems - i);
-
-            Type result = C::identityValue;
-            for (size_t j = 0; j < wg_size; ++j)
-            {
-                if (result != outptr[i + j])
-                {
-                    log_info("%s_%s: Error at %zu\n", testName, testOpName,
-                             i + j);
-                    return -1;
-                }
-                result = C::combine(result, inptr[i + j]);
-            }
-        }
-        return 0;
+        return verify_work_groups<C>(inptr, outptr, n_elems, max_wg_size,
+                                     ScanKind::exclusive, testName);
     }
 };
 
@@ -232,7 +331,7 @@ static int run_test(cl_device_id device, cl_context context,
     std::vector<T> input_ptr(n_elems);
 
     MTdataHolder d(gRandomSeed);
-    for (int i = 0; i < n_elems; i++)
+    for (size_t i = 0; i < input_ptr.size(); i++)
     {
         input_ptr[i] = (T)genrand_int64(d);
     }
@@ -246,25 +345,36 @@ static int run_test(cl_device_id device, cl_context context,
     err |= clSetKernelArg(kernel, 1, sizeof(dst), &dst);
     test_error(err, "Unable to set dst buffer kernel arg");
 
-    size_t global_work_size[] = { (size_t)n_elems };
-    err = clEnqueueNDRangeKernel(queue, kernel, 1, NULL, global_work_size,
-                                 wg_size, 0, NULL, NULL);
-    test_error(err, "Unable to enqueue test kernel");
-
     std::vector<T> output_ptr(n_elems);
 
-    cl_uint dead = 0xdeaddead;
-    memset_pattern4(output_ptr.data(), &dead, sizeof(T) * n_elems);
-    err = clEnqueueReadBuffer(queue, dst, CL_TRUE, 0, sizeof(T) * n_elems,
-                              output_ptr.data(), 0, NULL, NULL);
-    test_error(err, "clEnqueueReadBuffer to read read dst buffer failed");
-
-    if (TestInfo::verify(input_ptr.data(), output_ptr.data(), n_elems,
-                         wg_size[0]))
+    for (size_t local_size : get_test_work_group_sizes(wg_size[0]))
     {
-        log_error("%s_%s %s failed\n", TestInfo::testName, TestInfo::testOpName,
-                  TestInfo::deviceTypeName);
-        return TEST_FAIL;
+        // Sizes other than the maximum run uniform work-groups only
+        size_t global_size = local_size == wg_size[0]
+            ? (size_t)n_elems
+            : (size_t)n_elems - (size_t)n_elems % local_size;
+        if (global_size == 0) continue;
+
+        size_t global_work_size[] = { global_size };
+        size_t local_work_size[] = { local_size };
+        err = clEnqueueNDRangeKernel(queue, kernel, 1, NULL, global_work_size,
+                                     local_work_size, 0, NULL, NULL);
+        test_error(err, "Unable to enqueue test kernel");
+
+        cl_uint dead = 0xdeaddead;
+        memset_pattern4(output_ptr.data(), &dead, sizeof(T) * n_elems);
+        err = clEnqueueReadBuffer(queue, dst, CL_TRUE, 0,
+                                  sizeof(T) * global_size, output_ptr.data(), 0,
+                                  NULL, NULL);
+        test_error(err, "clEnqueueReadBuffer to read read dst buffer failed");
+
+        if (TestInfo::verify(input_ptr.data(), output_ptr.data(), global_size,
+                             local_size))
+        {
+            log_error("%s_%s %s failed\n", TestInfo::testName,
+                      TestInfo::testOpName, TestInfo::deviceTypeName);
+            return TEST_FAIL;
+        }
     }
 
     log_info("%s_%s %s passed\n", TestInfo::testName, TestInfo::testOpName,
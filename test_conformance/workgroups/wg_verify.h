@@ -0,0 +1,85 @@
+//
+// Copyright (c) 2024 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef WORKGROUPS_WG_VERIFY_H
+#define WORKGROUPS_WG_VERIFY_H
+
+#include <algorithm>
+#include <atomic>
+#include <stddef.h>
+
+#include "harness/ThreadPool.h"
+#include "harness/errorHelpers.h"
+
+// Returned by verify_parallel() when every element matches
+#define WG_MATCH ((size_t)-1)
+
+// Units checked by one thread pool job, for units of unit_elements each.
+// Work-group checks use whole groups as units so that a job never sees part
+// of a group.
+inline size_t verify_units_per_job(size_t unit_elements)
+{
+    const size_t elements_per_job = 65536;
+    return std::max((size_t)1,
+                    elements_per_job / std::max((size_t)1, unit_elements));
+}
+
+template <typename Check> struct ParallelVerifyJob
+{
+    const Check *check;
+    size_t units;
+    size_t units_per_job;
+    std::atomic<size_t> first_mismatch;
+};
+
+template <typename Check>
+cl_int parallel_verify_job(cl_uint job_id, cl_uint thread_id, void *userInfo)
+{
+    ParallelVerifyJob<Check> &job = *(ParallelVerifyJob<Check> *)userInfo;
+    size_t begin = (size_t)job_id * job.units_per_job;
+    size_t end = std::min(begin + job.units_per_job, job.units);
+
+    size_t mismatch = (*job.check)(begin, end);
+    size_t current = job.first_mismatch.load();
+    while (mismatch < current
+           && !job.first_mismatch.compare_exchange_weak(current, mismatch))
+    {
+    }
+    return CL_SUCCESS;
+}
+
+// Runs check(unit_begin, unit_end) over [0, units) on the thread pool.
+// check returns the element index of the first mismatch in its units, or
+// WG_MATCH, and verify_parallel() returns the lowest of these, so the
+// reported failure does not depend on the scheduling of the jobs.
+template <typename Check>
+size_t verify_parallel(size_t units, size_t units_per_job, const Check &check)
+{
+    ParallelVerifyJob<Check> job;
+    job.check = &check;
+    job.units = units;
+    job.units_per_job = units_per_job;
+    job.first_mismatch = WG_MATCH;
+
+    cl_uint jobs = (cl_uint)((units + units_per_job - 1) / units_per_job);
+    if (jobs && ThreadPool_Do(parallel_verify_job<Check>, jobs, &job))
+    {
+        log_error("ThreadPool_Do failed\n");
+        return 0;
+    }
+    return job.first_mismatch;
+}
+
+#endif // WORKGROUPS_WG_VERIFY_H